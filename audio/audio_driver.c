@@ -31,6 +31,7 @@
 #include <memalign.h>
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
+#include <audio/conversion/s16_resample.h>
 #include <audio/conversion/dual_mono.h>
 #ifdef HAVE_AUDIOMIXER
 #include <audio/audio_mixer.h>
@@ -433,6 +434,23 @@ bool audio_driver_find_driver(const char *audio_drv,
    return true;
 }
 
+#ifdef HAVE_AUDIOMIXER
+static void audio_driver_mixer_mix(float *buf, size_t frames, void *data)
+{
+   audio_driver_state_t *audio_st = (audio_driver_state_t*)data;
+   bool override                  = true;
+   float mixer_gain               = 0.0f;
+
+   if (!audio_st->mixer_mute_enable)
+   {
+      if (audio_st->mixer_volume_gain == 1.0f)
+         override                 = false;
+      mixer_gain                  = audio_st->mixer_volume_gain;
+   }
+   audio_mixer_mix(buf, frames, mixer_gain, override);
+}
+#endif
+
 /**
  * Writes audio samples to audio driver's output.
  * Will first perform DSP processing (if enabled) and resampling.
@@ -451,22 +469,22 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
       bool is_slowmotion, bool is_fastforward)
 {
    struct resampler_data src_data;
+   s16_resample_mix_t mix            = NULL;
    float audio_volume_gain           =
          (audio_st->mute_enable || audio_st->flags & AUDIO_FLAG_MUTED)
                ? 0.0f
                : audio_st->volume_gain;
 
+   src_data.data_in                  = NULL;
    src_data.data_out                 = NULL;
+   src_data.input_frames             = samples >> 1;
    src_data.output_frames            = 0;
    /* We'll assign a proper output to the resampler later in this function */
 
-   convert_s16_to_float(audio_st->input_data, data, samples,
-         audio_volume_gain);
-
-   /* The resampler operates on floating-point frames,
-    * so we have to convert the input first */
-   src_data.data_in                  = audio_st->input_data;
-   src_data.input_frames             = samples >> 1;
+#ifdef HAVE_AUDIOMIXER
+   if (audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE)
+      mix                            = audio_driver_mixer_mix;
+#endif
 
    /* Remember, we allocated buffers that are twice as big as needed.
     * (see audio_driver_init) */
@@ -477,6 +495,13 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
    {
       struct retro_dsp_data dsp_data;
 
+      /* The DSP filter operates on floating-point frames,
+       * so we have to convert the input first */
+      convert_s16_to_float(audio_st->input_data, data, samples,
+            audio_volume_gain);
+
+      src_data.data_in               = audio_st->input_data;
+
       dsp_data.input                 = audio_st->input_data;
       dsp_data.input_frames          = (unsigned)(samples >> 1);
       dsp_data.output                = NULL;
@@ -500,10 +525,6 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
    }
 #endif
 
-   src_data.data_out                 = audio_st->output_samples_buf;
-
-   /* Now the resampler will write to the driver state's scratch buffer */
-
    /* Count samples. */
    {
       unsigned write_idx             =
@@ -576,26 +597,34 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
       audio_st->last_flush_time = flush_time;
    }
 
-   audio_st->resampler->process(audio_st->resampler_data, &src_data);
+   src_data.data_out                 = audio_st->output_samples_buf;
 
-#ifdef HAVE_AUDIOMIXER
-   if (audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE)
+   /* Now the resampler will write to the driver state's scratch buffer */
+
+   if (src_data.data_in)
    {
-      bool override                       = true;
-      float mixer_gain                    = 0.0f;
-      bool audio_driver_mixer_mute_enable = audio_st->mixer_mute_enable;
+      /* Filtered input is already in floating-point,
+       * run the remaining stages one after another */
+      audio_st->resampler->process(audio_st->resampler_data, &src_data);
 
-      if (!audio_driver_mixer_mute_enable)
-      {
-         if (audio_st->mixer_volume_gain == 1.0f)
-            override                      = false;
-         mixer_gain                       = audio_st->mixer_volume_gain;
+      if (mix && src_data.output_frames)
+         mix(audio_st->output_samples_buf, src_data.output_frames, audio_st);
 
-      }
-      audio_mixer_mix(audio_st->output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
+      if (!(audio_st->flags & AUDIO_FLAG_USE_FLOAT))
+         convert_float_to_s16(audio_st->output_samples_conv_buf,
+               audio_st->output_samples_buf, src_data.output_frames * 2);
    }
-#endif
+   else
+      /* Fast path: convert, resample, mix and convert back in a
+       * single pass, using input_data as the per-chunk scratch */
+      src_data.output_frames         = convert_s16_resample(
+            audio_st->resampler, audio_st->resampler_data,
+            data, samples >> 1, audio_volume_gain, src_data.ratio,
+            audio_st->input_data, audio_st->output_samples_buf,
+            (audio_st->flags & AUDIO_FLAG_USE_FLOAT)
+            ? NULL
+            : audio_st->output_samples_conv_buf,
+            mix, audio_st);
 
    /* Now we write our processed audio output to the driver.
     * It may not be played immediately, depending on
@@ -610,9 +639,6 @@ static void audio_driver_flush(audio_driver_state_t *audio_st,
          output_frames       *= sizeof(float); /* Unit: bytes */
       else
       {
-         convert_float_to_s16(audio_st->output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
-
          output_data          = audio_st->output_samples_conv_buf;
          output_frames       *= sizeof(int16_t);  /* Unit: bytes */
       }
@@ -28,6 +28,10 @@
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -325,6 +329,9 @@ static void cheat_manager_free(void)
    if (cheat_st->matches)
       free(cheat_st->matches);
 
+   if (cheat_st->candidates)
+      free(cheat_st->candidates);
+
    if (cheat_st->memory_buf_list)
       free(cheat_st->memory_buf_list);
 
@@ -339,6 +346,8 @@ static void cheat_manager_free(void)
    cheat_st->memory_buf_list           = NULL;
    cheat_st->memory_size_list          = NULL;
    cheat_st->matches                   = NULL;
+   cheat_st->candidates                = NULL;
+   cheat_st->num_candidates            = 0;
    cheat_st->num_memory_buffers        = 0;
    cheat_st->total_memory_size         = 0;
    cheat_st->memory_initialized        = false;
@@ -905,6 +914,13 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
 
       memset(cheat_st->matches, 0xFF, cheat_st->total_memory_size);
 
+      /* Every item is a match again, so the
+       * next search has to look at all of them */
+      if (cheat_st->candidates)
+         free(cheat_st->candidates);
+      cheat_st->candidates     = NULL;
+      cheat_st->num_candidates = 0;
+
       offset = 0;
 
       for (i = 0; i < cheat_st->num_memory_buffers; i++)
@@ -997,16 +1013,488 @@ static void cheat_manager_setup_search_meta(
    }
 }
 
+/* Once no more than one item in this many still matches,
+ * searches walk a list of the survivors instead of all
+ * of memory */
+#define CHEAT_SEARCH_SPARSE_RATIO 8
+
+static bool cheat_manager_search_match(const cheat_manager_t *cheat_st,
+      enum cheat_search_type search_type,
+      unsigned int curr_val, unsigned int prev_val)
+{
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         return (curr_val == cheat_st->search_exact_value);
+      case CHEAT_SEARCH_TYPE_LT:
+         return (curr_val <  prev_val);
+      case CHEAT_SEARCH_TYPE_GT:
+         return (curr_val >  prev_val);
+      case CHEAT_SEARCH_TYPE_LTE:
+         return (curr_val <= prev_val);
+      case CHEAT_SEARCH_TYPE_GTE:
+         return (curr_val >= prev_val);
+      case CHEAT_SEARCH_TYPE_EQ:
+         return (curr_val == prev_val);
+      case CHEAT_SEARCH_TYPE_NEQ:
+         return (curr_val != prev_val);
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         return (curr_val == prev_val + cheat_st->search_eqplus_value);
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         return (curr_val == prev_val - cheat_st->search_eqminus_value);
+   }
+
+   return false;
+}
+
+static unsigned int cheat_manager_search_read(const uint8_t *s,
+      unsigned int bytes_per_item, bool big_endian)
+{
+   /* little endian FF000000 = 256 */
+   switch (bytes_per_item)
+   {
+      case 2:
+         return big_endian
+            ? ((s[0] << 8) | s[1])
+            : (s[0] | (s[1] << 8));
+      case 4:
+         return big_endian
+            ? (((unsigned)s[0] << 24) | (s[1] << 16) | (s[2] << 8) | s[3])
+            : (s[0] | (s[1] << 8) | (s[2] << 16) | ((unsigned)s[3] << 24));
+      default:
+         break;
+   }
+
+   return s[0];
+}
+
+/* Copies out an item that runs from one
+ * memory descriptor into the next one */
+static void cheat_manager_search_gather(unsigned int idx,
+      unsigned int bytes_per_item, uint8_t *s)
+{
+   unsigned i;
+
+   for (i = 0; i < bytes_per_item; i++)
+   {
+      unsigned char *curr = NULL;
+      unsigned offset     = translate_address(idx + i, &curr);
+      s[i]                = curr[idx + i - offset];
+   }
+}
+
+/* Compares the item at @idx, whose current bytes are at @curr,
+ * against the search and clears its match bits where it fails.
+ * Returns how many matches the item still holds. */
+static unsigned cheat_manager_search_item(cheat_manager_t *cheat_st,
+      enum cheat_search_type search_type, unsigned int idx,
+      const uint8_t *curr, unsigned int bytes_per_item,
+      unsigned int bits, unsigned int mask)
+{
+   unsigned byte_part;
+   unsigned int curr_val, prev_val;
+   unsigned matches = 0;
+   uint8_t *match   = cheat_st->matches + idx;
+
+   if (!*match)
+      return 0;
+
+   curr_val = cheat_manager_search_read(curr,
+         bytes_per_item, cheat_st->big_endian);
+   prev_val = cheat_manager_search_read(cheat_st->prev_memory_buf + idx,
+         bytes_per_item, cheat_st->big_endian);
+
+   if (bits >= 8)
+   {
+      if (cheat_manager_search_match(cheat_st, search_type,
+               curr_val, prev_val))
+         return 1;
+      memset(match, 0, bytes_per_item);
+      return 0;
+   }
+
+   for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+   {
+      unsigned int field = mask << (byte_part * bits);
+
+      if (!(*match & field))
+         continue;
+
+      if (cheat_manager_search_match(cheat_st, search_type,
+               (curr_val >> (byte_part * bits)) & mask,
+               (prev_val >> (byte_part * bits)) & mask))
+         matches++;
+      else
+         *match &= (~field) & 0xFF;
+   }
+
+   return matches;
+}
+
+#if defined(__SSE2__)
+static INLINE __m128i cheat_manager_sse2_set1(unsigned int v,
+      unsigned int bytes_per_item)
+{
+   switch (bytes_per_item)
+   {
+      case 1:
+         return _mm_set1_epi8((char)v);
+      case 2:
+         return _mm_set1_epi16((short)v);
+      default:
+         break;
+   }
+   return _mm_set1_epi32((int)v);
+}
+
+static INLINE __m128i cheat_manager_sse2_bswap(__m128i v,
+      unsigned int bytes_per_item)
+{
+   v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+   if (bytes_per_item == 4)
+      v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v,
+               _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+   return v;
+}
+
+static INLINE __m128i cheat_manager_sse2_cmpeq(__m128i a, __m128i b,
+      unsigned int bytes_per_item)
+{
+   switch (bytes_per_item)
+   {
+      case 1:
+         return _mm_cmpeq_epi8(a, b);
+      case 2:
+         return _mm_cmpeq_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_cmpeq_epi32(a, b);
+}
+
+/* Unsigned a > b; SSE2 only compares signed,
+ * so both sides get their sign bit flipped */
+static INLINE __m128i cheat_manager_sse2_cmpgt(__m128i a, __m128i b,
+      __m128i sign, unsigned int bytes_per_item)
+{
+   a = _mm_xor_si128(a, sign);
+   b = _mm_xor_si128(b, sign);
+   switch (bytes_per_item)
+   {
+      case 1:
+         return _mm_cmpgt_epi8(a, b);
+      case 2:
+         return _mm_cmpgt_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_cmpgt_epi32(a, b);
+}
+
+static INLINE __m128i cheat_manager_sse2_add(__m128i a, __m128i b,
+      unsigned int bytes_per_item)
+{
+   switch (bytes_per_item)
+   {
+      case 1:
+         return _mm_add_epi8(a, b);
+      case 2:
+         return _mm_add_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_add_epi32(a, b);
+}
+
+static INLINE __m128i cheat_manager_sse2_sub(__m128i a, __m128i b,
+      unsigned int bytes_per_item)
+{
+   switch (bytes_per_item)
+   {
+      case 1:
+         return _mm_sub_epi8(a, b);
+      case 2:
+         return _mm_sub_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_sub_epi32(a, b);
+}
+
+/* Compares @len bytes' worth of whole 8, 16 or 32-bit items,
+ * 16 bytes at a time. Failing items get all of their match
+ * bytes cleared, like cheat_manager_search_item() does.
+ * @value has to fit the item width.
+ * Returns how many bytes were done; the rest is up to the caller. */
+static size_t cheat_manager_search_sse2(
+      const uint8_t *curr, const uint8_t *prev, uint8_t *matches,
+      size_t len, unsigned int bytes_per_item, bool big_endian,
+      enum cheat_search_type search_type, unsigned int value)
+{
+   size_t i;
+   __m128i val   = cheat_manager_sse2_set1(value, bytes_per_item);
+   __m128i sign  = cheat_manager_sse2_set1(
+         1u << (bytes_per_item * 8 - 1), bytes_per_item);
+   __m128i first = cheat_manager_sse2_set1(0xFF, bytes_per_item);
+   __m128i ones  = _mm_cmpeq_epi8(val, val);
+   bool swap     = big_endian && bytes_per_item > 1;
+   /* Below 32 bits the original comparisons don't wrap
+    * around, which the lane arithmetic has to make up for */
+   bool narrow   = bytes_per_item < 4;
+
+   for (i = 0; i + 16 <= len; i += 16)
+   {
+      __m128i c = _mm_loadu_si128((const __m128i*)(curr    + i));
+      __m128i p = _mm_loadu_si128((const __m128i*)(prev    + i));
+      __m128i m = _mm_loadu_si128((const __m128i*)(matches + i));
+      __m128i keep;
+
+      if (swap)
+      {
+         c = cheat_manager_sse2_bswap(c, bytes_per_item);
+         p = cheat_manager_sse2_bswap(p, bytes_per_item);
+      }
+
+      switch (search_type)
+      {
+         case CHEAT_SEARCH_TYPE_EXACT:
+            keep = cheat_manager_sse2_cmpeq(c, val, bytes_per_item);
+            break;
+         case CHEAT_SEARCH_TYPE_LT:
+            keep = cheat_manager_sse2_cmpgt(p, c, sign, bytes_per_item);
+            break;
+         case CHEAT_SEARCH_TYPE_GT:
+            keep = cheat_manager_sse2_cmpgt(c, p, sign, bytes_per_item);
+            break;
+         case CHEAT_SEARCH_TYPE_LTE:
+            keep = _mm_xor_si128(ones,
+                  cheat_manager_sse2_cmpgt(c, p, sign, bytes_per_item));
+            break;
+         case CHEAT_SEARCH_TYPE_GTE:
+            keep = _mm_xor_si128(ones,
+                  cheat_manager_sse2_cmpgt(p, c, sign, bytes_per_item));
+            break;
+         case CHEAT_SEARCH_TYPE_EQ:
+            keep = cheat_manager_sse2_cmpeq(c, p, bytes_per_item);
+            break;
+         case CHEAT_SEARCH_TYPE_NEQ:
+            keep = _mm_xor_si128(ones,
+                  cheat_manager_sse2_cmpeq(c, p, bytes_per_item));
+            break;
+         case CHEAT_SEARCH_TYPE_EQPLUS:
+            keep = cheat_manager_sse2_cmpeq(c,
+                  cheat_manager_sse2_add(p, val, bytes_per_item),
+                  bytes_per_item);
+            /* p + value carried out of the item when c < value */
+            if (narrow)
+               keep = _mm_andnot_si128(
+                     cheat_manager_sse2_cmpgt(val, c, sign, bytes_per_item),
+                     keep);
+            break;
+         case CHEAT_SEARCH_TYPE_EQMINUS:
+         default:
+            keep = cheat_manager_sse2_cmpeq(c,
+                  cheat_manager_sse2_sub(p, val, bytes_per_item),
+                  bytes_per_item);
+            /* p - value borrowed when p < value */
+            if (narrow)
+               keep = _mm_andnot_si128(
+                     cheat_manager_sse2_cmpgt(val, p, sign, bytes_per_item),
+                     keep);
+            break;
+      }
+
+      /* Only the first match byte of an item says whether
+       * it's still a match; leave the others alone if not */
+      if (bytes_per_item > 1)
+         keep = _mm_or_si128(keep, cheat_manager_sse2_cmpeq(
+                  _mm_and_si128(m, first), _mm_setzero_si128(),
+                  bytes_per_item));
+
+      _mm_storeu_si128((__m128i*)(matches + i), _mm_and_si128(m, keep));
+   }
+
+   return i;
+}
+#endif
+
+/* Compares every item that still has match bits set */
+static void cheat_manager_search_dense(cheat_manager_t *cheat_st,
+      enum cheat_search_type search_type,
+      unsigned int bytes_per_item, unsigned int bits, unsigned int mask)
+{
+   unsigned i;
+   unsigned offset = 0;
+   unsigned total  = cheat_st->total_memory_size;
+   unsigned end    = total - (total % bytes_per_item);
+#if defined(__SSE2__)
+   unsigned value  = 0;
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         value = cheat_st->search_exact_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         value = cheat_st->search_eqplus_value;
+         break;
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         value = cheat_st->search_eqminus_value;
+         break;
+      default:
+         break;
+   }
+#endif
+
+   for (i = 0; i < cheat_st->num_memory_buffers; i++)
+   {
+      const uint8_t *buf = cheat_st->memory_buf_list[i];
+      unsigned buf_end   = offset + cheat_st->memory_size_list[i];
+      unsigned last      = MIN(buf_end, end);
+      /* Items are aligned to their size across all of memory,
+       * not within each descriptor */
+      unsigned idx       = offset
+         + (bytes_per_item - offset % bytes_per_item) % bytes_per_item;
+
+#if defined(__SSE2__)
+      /* Values that don't fit the item width are rare enough
+       * to leave to the generic comparison */
+      if (bits == 8 && value <= mask && idx < last)
+         idx += (unsigned)cheat_manager_search_sse2(
+               buf + idx - offset,
+               cheat_st->prev_memory_buf + idx,
+               cheat_st->matches + idx,
+               last - idx, bytes_per_item, cheat_st->big_endian,
+               search_type, value);
+#endif
+
+      for (; idx + bytes_per_item <= last; idx += bytes_per_item)
+         cheat_manager_search_item(cheat_st, search_type, idx,
+               buf + idx - offset, bytes_per_item, bits, mask);
+
+      if (idx < buf_end && idx + bytes_per_item <= end)
+      {
+         uint8_t s[4];
+         cheat_manager_search_gather(idx, bytes_per_item, s);
+         cheat_manager_search_item(cheat_st, search_type, idx,
+               s, bytes_per_item, bits, mask);
+      }
+
+      offset = buf_end;
+   }
+
+   /* A partial item at the very end never holds a value */
+   if (end < total)
+      memset(cheat_st->matches + end, 0, total - end);
+}
+
+/* Compares only the items on the candidate list,
+ * and drops the ones that no longer match from it */
+static void cheat_manager_search_sparse(cheat_manager_t *cheat_st,
+      enum cheat_search_type search_type,
+      unsigned int bytes_per_item, unsigned int bits, unsigned int mask)
+{
+   unsigned i;
+   unsigned buf         = 0;
+   unsigned offset      = 0;
+   unsigned kept        = 0;
+   unsigned num_matches = 0;
+
+   for (i = 0; i < cheat_st->num_candidates; i++)
+   {
+      unsigned idx = cheat_st->candidates[i];
+      unsigned n;
+
+      if (idx + bytes_per_item > cheat_st->total_memory_size)
+         break;
+
+      while (idx >= offset + cheat_st->memory_size_list[buf])
+         offset += cheat_st->memory_size_list[buf++];
+
+      if (idx + bytes_per_item <= offset + cheat_st->memory_size_list[buf])
+         n = cheat_manager_search_item(cheat_st, search_type, idx,
+               cheat_st->memory_buf_list[buf] + idx - offset,
+               bytes_per_item, bits, mask);
+      else
+      {
+         uint8_t s[4];
+         cheat_manager_search_gather(idx, bytes_per_item, s);
+         n = cheat_manager_search_item(cheat_st, search_type, idx,
+               s, bytes_per_item, bits, mask);
+      }
+
+      if (n)
+      {
+         cheat_st->candidates[kept++] = idx;
+         num_matches                 += n;
+      }
+   }
+
+   cheat_st->num_candidates = kept;
+   cheat_st->num_matches    = num_matches;
+}
+
+/* Counts the matches left after a search over all of memory,
+ * and lists the items holding them if there are few enough */
+static void cheat_manager_search_collect(cheat_manager_t *cheat_st,
+      unsigned int bytes_per_item, unsigned int bits, unsigned int mask)
+{
+   unsigned idx;
+   unsigned items       = 0;
+   unsigned num_matches = 0;
+   unsigned total       = cheat_st->total_memory_size;
+   unsigned end         = total - (total % bytes_per_item);
+   const uint8_t *match = cheat_st->matches;
+
+   if (bits < 8)
+   {
+      for (idx = 0; idx < end; idx++)
+      {
+         unsigned byte_part;
+
+         if (!match[idx])
+            continue;
+
+         items++;
+         for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+            if (match[idx] & (mask << (byte_part * bits)))
+               num_matches++;
+      }
+   }
+   else
+   {
+      for (idx = 0; idx < end; idx += bytes_per_item)
+         items += (match[idx] != 0);
+      num_matches = items;
+   }
+
+   cheat_st->num_matches = num_matches;
+
+   if (cheat_st->candidates)
+      free(cheat_st->candidates);
+   cheat_st->candidates     = NULL;
+   cheat_st->num_candidates = 0;
+
+   if (items > (end / bytes_per_item) / CHEAT_SEARCH_SPARSE_RATIO)
+      return;
+
+   /* Failing this just means the next search is a full one */
+   if (!(cheat_st->candidates = (unsigned*)malloc(
+               MAX(items, 1) * sizeof(unsigned))))
+      return;
+
+   for (idx = 0; idx < end; idx += bytes_per_item)
+      if (match[idx])
+         cheat_st->candidates[cheat_st->num_candidates++] = idx;
+
+   cheat_st->candidates_bit_size = cheat_st->search_bit_size;
+}
+
 static int cheat_manager_search(enum cheat_search_type search_type)
 {
    size_t _len;
    char msg[100];
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char *curr         = cheat_st->curr_memory_buf;
-   unsigned char *prev         = cheat_st->prev_memory_buf;
-   unsigned int idx            = 0;
-   unsigned int curr_val       = 0;
-   unsigned int prev_val       = 0;
    unsigned int mask           = 0;
    unsigned int bytes_per_item = 1;
    unsigned int bits           = 8;
@@ -1016,7 +1504,9 @@ static int cheat_manager_search(enum cheat_search_type search_type)
    struct menu_state *menu_st  = menu_state_get_ptr();
 #endif
 
-   if (cheat_st->num_memory_buffers == 0 || !prev || !cheat_st->matches)
+   if (     cheat_st->num_memory_buffers == 0
+         || !cheat_st->prev_memory_buf
+         || !cheat_st->matches)
    {
       _len = strlcpy(msg, msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), sizeof(msg));
       runloop_msg_queue_push(msg, _len, 1, 180, true, NULL,
@@ -1026,99 +1516,21 @@ static int cheat_manager_search(enum cheat_search_type search_type)
 
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-   /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   /* The candidate list is only good for the
+    * item size it was built with */
+   if (     cheat_st->candidates
+         && cheat_st->candidates_bit_size == cheat_st->search_bit_size)
+      cheat_manager_search_sparse(cheat_st, search_type,
+            bytes_per_item, bits, mask);
+   else
    {
-      unsigned byte_part;
-
-      offset = translate_address(idx, &curr);
-
-      switch (bytes_per_item)
-      {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256) + *(prev + idx + 1) :
-               *(prev + idx) + (*(prev + idx + 1) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            prev_val = *(prev + idx);
-            break;
-      }
-
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
-      {
-         unsigned int curr_subval = (curr_val >> (byte_part * bits)) & mask;
-         unsigned int prev_subval = (prev_val >> (byte_part * bits)) & mask;
-         unsigned int prev_match;
-
-         if (bits < 8)
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-         else
-            prev_match = *(cheat_st->matches + idx);
-
-         if (prev_match > 0)
-         {
-            bool match = false;
-            switch (search_type)
-            {
-               case CHEAT_SEARCH_TYPE_EXACT:
-                  match = (curr_subval == cheat_st->search_exact_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_LT:
-                  match = (curr_subval < prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GT:
-                  match = (curr_subval > prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE:
-                  match = (curr_subval <= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE:
-                  match = (curr_subval >= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ:
-                  match = (curr_subval == prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ:
-                  match = (curr_subval != prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS:
-                  match = (curr_subval == prev_subval + cheat_st->search_eqplus_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS:
-                  match = (curr_subval == prev_subval - cheat_st->search_eqminus_value);
-                  break;
-            }
-
-            if (!match)
-            {
-               if (bits < 8)
-                  *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                     ((~(mask << (byte_part * bits))) & 0xFF);
-               else
-                  memset(cheat_st->matches + idx, 0, bytes_per_item);
-               if (cheat_st->num_matches > 0)
-                  cheat_st->num_matches--;
-            }
-         }
-      }
+      cheat_manager_search_dense(cheat_st, search_type,
+            bytes_per_item, bits, mask);
+      cheat_manager_search_collect(cheat_st, bytes_per_item, bits, mask);
    }
 
-   offset = 0;
-
+   /* All of memory, not just the candidates, since
+    * browsing shows previous values at any address */
    for (i = 0; i < cheat_st->num_memory_buffers; i++)
    {
       memcpy(cheat_st->prev_memory_buf + offset, cheat_st->memory_buf_list[i], cheat_st->memory_size_list[i]);
@@ -162,6 +162,9 @@ struct cheat_manager
    uint8_t *curr_memory_buf;
    uint8_t *prev_memory_buf;
    uint8_t *matches;
+   /* Sorted offsets of the items that still match,
+    * once few enough are left; NULL until then */
+   unsigned *candidates;
    uint8_t **memory_buf_list;
    unsigned *memory_size_list;
    unsigned int delete_state;
@@ -180,6 +183,8 @@ struct cheat_manager
    unsigned search_eqplus_value;
    unsigned search_eqminus_value;
    unsigned num_matches;
+   unsigned num_candidates;
+   unsigned candidates_bit_size;
    unsigned browse_address;
    char working_desc[CHEAT_DESC_SCRATCH_SIZE];
    char working_code[CHEAT_CODE_SCRATCH_SIZE];
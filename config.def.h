@@ -1306,6 +1306,14 @@
 #define DEFAULT_REWIND_GRANULARITY 1
 #endif
 
+/* Delta-encode rewind states on a separate thread
+ * instead of the main runloop. */
+#define DEFAULT_REWIND_THREADED false
+
+/* Compress rewind states a second time (zstd, or zlib
+ * if unavailable) to fit more history in the buffer. */
+#define DEFAULT_REWIND_COMPRESSION false
+
 /* Pause gameplay when window loses focus. */
 #define DEFAULT_PAUSE_NONACTIVE true
 
@@ -1440,6 +1448,12 @@
 #define DEFAULT_SAVESTATE_FILE_COMPRESSION true
 #endif
 
+/* When compressing save, save state and other
+ * archived files, use Zstandard instead of zlib.
+ * Off by default, since older builds cannot
+ * read the result */
+#define DEFAULT_SAVE_COMPRESSION_ZSTD false
+
 /* Slowmotion ratio. */
 #define DEFAULT_SLOWMOTION_RATIO 3.0f
 
@@ -1459,9 +1473,16 @@
 /* When using the Run Ahead feature, use a secondary instance of the core. */
 #define DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE true
 
+/* Run the secondary instance on its own thread, ahead of the main core. */
+#define DEFAULT_RUN_AHEAD_SECONDARY_THREAD false
+
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
 
+/* When using single instance Run Ahead, only reload the state when
+ * input changes and otherwise keep the core running ahead. */
+#define DEFAULT_RUN_AHEAD_STATE_CACHE false
+
 /* Enable stdin/network command interface. */
 #define DEFAULT_NETWORK_CMD_ENABLE false
 #define DEFAULT_NETWORK_CMD_PORT 55355
@@ -1662,6 +1683,10 @@
 
 #define DEFAULT_GFX_THUMBNAIL_UPSCALE_THRESHOLD 0
 
+/* Keep decoded thumbnails on disk, and recently
+ * shown ones on the GPU, so they reload faster */
+#define DEFAULT_MENU_THUMBNAIL_CACHE_ENABLE false
+
 #ifdef HAVE_MENU
 #if defined(RS90) || defined(MIYOO)
 /* The RS-90 has a hardware clock that is neither
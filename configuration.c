@@ -26,6 +26,9 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
+#if defined(HAVE_ZLIB)
+#include <streams/rzip_stream.h>
+#endif
 #include <array/rhmap.h>
 
 #ifdef HAVE_CONFIG_H
@@ -1774,12 +1777,20 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("apply_cheats_after_toggle",     &settings->bools.apply_cheats_after_toggle, true, DEFAULT_APPLY_CHEATS_AFTER_TOGGLE, false);
    SETTING_BOOL("apply_cheats_after_load",       &settings->bools.apply_cheats_after_load, true, DEFAULT_APPLY_CHEATS_AFTER_LOAD, false);
    SETTING_BOOL("rewind_enable",                 &settings->bools.rewind_enable, true, DEFAULT_REWIND_ENABLE, false);
+#ifdef HAVE_THREADS
+   SETTING_BOOL("rewind_threaded",               &settings->bools.rewind_threaded, true, DEFAULT_REWIND_THREADED, false);
+#endif
+   SETTING_BOOL("rewind_compression",            &settings->bools.rewind_compression, true, DEFAULT_REWIND_COMPRESSION, false);
    SETTING_BOOL("fastforward_frameskip",         &settings->bools.fastforward_frameskip, true, DEFAULT_FASTFORWARD_FRAMESKIP, false);
    SETTING_BOOL("vrr_runloop_enable",            &settings->bools.vrr_runloop_enable, true, DEFAULT_VRR_RUNLOOP_ENABLE, false);
    SETTING_BOOL("menu_throttle_framerate",       &settings->bools.menu_throttle_framerate, true, true, false);
    SETTING_BOOL("run_ahead_enabled",             &settings->bools.run_ahead_enabled, true, false, false);
    SETTING_BOOL("run_ahead_secondary_instance",  &settings->bools.run_ahead_secondary_instance, true, DEFAULT_RUN_AHEAD_SECONDARY_INSTANCE, false);
+#ifdef HAVE_THREADS
+   SETTING_BOOL("run_ahead_secondary_thread",    &settings->bools.run_ahead_secondary_thread, true, DEFAULT_RUN_AHEAD_SECONDARY_THREAD, false);
+#endif
    SETTING_BOOL("run_ahead_hide_warnings",       &settings->bools.run_ahead_hide_warnings, true, DEFAULT_RUN_AHEAD_HIDE_WARNINGS, false);
+   SETTING_BOOL("run_ahead_state_cache",         &settings->bools.run_ahead_state_cache, true, DEFAULT_RUN_AHEAD_STATE_CACHE, false);
    SETTING_BOOL("preemptive_frames_enable",      &settings->bools.preemptive_frames_enable, true, false, false);
 #if HAVE_MENU
    SETTING_BOOL("kiosk_mode_enable",             &settings->bools.kiosk_mode_enable, true, DEFAULT_KIOSK_MODE_ENABLE, false);
@@ -1792,6 +1803,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("savestate_thumbnail_enable",    &settings->bools.savestate_thumbnail_enable, true, DEFAULT_SAVESTATE_THUMBNAIL_ENABLE, false);
    SETTING_BOOL("save_file_compression",         &settings->bools.save_file_compression, true, DEFAULT_SAVE_FILE_COMPRESSION, false);
    SETTING_BOOL("savestate_file_compression",    &settings->bools.savestate_file_compression, true, DEFAULT_SAVESTATE_FILE_COMPRESSION, false);
+   SETTING_BOOL("save_compression_zstd",         &settings->bools.save_compression_zstd, true, DEFAULT_SAVE_COMPRESSION_ZSTD, false);
    SETTING_BOOL("game_specific_options",         &settings->bools.game_specific_options, true, DEFAULT_GAME_SPECIFIC_OPTIONS, false);
    SETTING_BOOL("auto_overrides_enable",         &settings->bools.auto_overrides_enable, true, DEFAULT_AUTO_OVERRIDES_ENABLE, false);
    SETTING_BOOL("auto_remaps_enable",            &settings->bools.auto_remaps_enable, true, DEFAULT_AUTO_REMAPS_ENABLE, false);
@@ -2081,6 +2093,7 @@ static struct config_bool_setting *populate_settings_bool(
    SETTING_BOOL("menu_navigation_browser_filter_supported_extensions_enable", &settings->bools.menu_navigation_browser_filter_supported_extensions_enable, true, true, false);
    SETTING_BOOL("menu_show_advanced_settings",   &settings->bools.menu_show_advanced_settings, true, DEFAULT_SHOW_ADVANCED_SETTINGS, false);
    SETTING_BOOL("menu_thumbnail_background_enable", &settings->bools.menu_thumbnail_background_enable, true, DEFAULT_MENU_THUMBNAIL_BACKGROUND_ENABLE, false);
+   SETTING_BOOL("menu_thumbnail_cache_enable",   &settings->bools.menu_thumbnail_cache_enable, true, DEFAULT_MENU_THUMBNAIL_CACHE_ENABLE, false);
 #ifdef HAVE_MATERIALUI
    SETTING_BOOL("materialui_icons_enable",                    &settings->bools.menu_materialui_icons_enable, true, DEFAULT_MATERIALUI_ICONS_ENABLE, false);
    SETTING_BOOL("materialui_switch_icons",                    &settings->bools.menu_materialui_switch_icons, true, DEFAULT_MATERIALUI_SWITCH_ICONS, false);
@@ -4497,6 +4510,10 @@ static bool config_load_file(global_t *global,
 #endif
 
    frontend_driver_set_sustained_performance_mode(settings->bools.sustained_performance_mode);
+#if defined(HAVE_ZLIB) && defined(HAVE_ZSTD)
+   rzipstream_set_default_codec(settings->bools.save_compression_zstd
+         ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB);
+#endif
    recording_driver_update_streaming_url();
 
    if (!(bool)RHMAP_HAS_STR(conf->entries_map, "user_language"))
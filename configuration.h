@@ -822,6 +822,7 @@ typedef struct settings
       bool menu_materialui_dual_thumbnail_list_view_enable;
       bool menu_materialui_thumbnail_background_enable;
       bool menu_thumbnail_background_enable;
+      bool menu_thumbnail_cache_enable;
       bool menu_rgui_background_filler_thickness_enable;
       bool menu_rgui_border_filler_thickness_enable;
       bool menu_rgui_border_filler_enable;
@@ -1008,6 +1009,8 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_threaded;
+      bool rewind_compression;
       bool fastforward_frameskip;
       bool vrr_runloop_enable;
       bool menu_throttle_framerate;
@@ -1015,7 +1018,9 @@ typedef struct settings
       bool apply_cheats_after_load;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_secondary_thread;
       bool run_ahead_hide_warnings;
+      bool run_ahead_state_cache;
       bool preemptive_frames_enable;
       bool pause_nonactive;
       bool pause_on_disconnect;
@@ -1027,6 +1032,7 @@ typedef struct settings
       bool savestate_thumbnail_enable;
       bool save_file_compression;
       bool savestate_file_compression;
+      bool save_compression_zstd;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
       bool keymapper_enable;
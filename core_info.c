@@ -24,6 +24,11 @@
 #include <formats/rjson.h>
 #include <lists/dir_list.h>
 #include <file/archive_file.h>
+#include <array/rhmap.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -55,13 +60,21 @@
 #define CORE_INFO_CACHE_COMPRESS
 #endif
 
+/* Uncached .info files are parsed on a thread pool
+ * once there are at least this many of them */
+#define CORE_INFO_PARALLEL_PARSE_MIN 8
+
 typedef struct
 {
    core_info_t *items;
+   /* core_file_id.hash -> index in items + 1,
+    * see core_info_cache_find() */
+   size_t *index;
    size_t length;
    size_t capacity;
    char *version;
    bool refresh;
+   bool index_collision;
 } core_info_cache_list_t;
 
 typedef struct
@@ -613,6 +626,9 @@ static void core_info_cache_list_free(
    }
    core_info_cache_list->items = NULL;
 
+   RHMAP_FREE(core_info_cache_list->index);
+   core_info_cache_list->index_collision = false;
+
    if (core_info_cache_list->version)
       free(core_info_cache_list->version);
    core_info_cache_list->version = NULL;
@@ -630,6 +646,23 @@ static core_info_t *core_info_cache_find(
 
    hash = core_info_hash_string(core_file_id);
 
+   if (list->index && (i = RHMAP_GET(list->index, hash)))
+   {
+      core_info_t *info = (core_info_t*)&list->items[i - 1];
+
+      if (string_is_equal(info->core_file_id.str, core_file_id))
+      {
+         info->is_installed = true;
+         return info;
+      }
+   }
+
+   /* The index only holds the first entry of each
+    * hash, so fall back to a full search if any
+    * two entries ever shared one */
+   if (!list->index_collision)
+      return NULL;
+
    for (i = 0; i < list->length; i++)
    {
       core_info_t *info = (core_info_t*)&list->items[i];
@@ -683,6 +716,12 @@ static void core_info_cache_add(
    else
       core_info_copy(info, info_cache);
 
+   if (RHMAP_HAS(list->index, info_cache->core_file_id.hash))
+      list->index_collision = true;
+   else
+      RHMAP_SET(list->index, info_cache->core_file_id.hash,
+            list->length + 1);
+
    list->length++;
 }
 
@@ -697,10 +736,12 @@ static core_info_cache_list_t *core_info_cache_list_new(void)
    core_info_cache_list->items    = (core_info_t *)
       calloc(CORE_INFO_CACHE_DEFAULT_CAPACITY,
             sizeof(core_info_t));
-   core_info_cache_list->length   = 0;
-   core_info_cache_list->capacity = 0;
-   core_info_cache_list->version  = NULL;
-   core_info_cache_list->refresh  = false;
+   core_info_cache_list->index           = NULL;
+   core_info_cache_list->length          = 0;
+   core_info_cache_list->capacity        = 0;
+   core_info_cache_list->version         = NULL;
+   core_info_cache_list->refresh         = false;
+   core_info_cache_list->index_collision = false;
 
    if (!core_info_cache_list->items)
    {
@@ -1680,8 +1721,7 @@ static config_file_t *core_info_get_config_file(
    return config_file_new_from_path_to_string(core_file_id);
 }
 
-static void core_info_parse_config_file(
-      core_info_list_t *list, core_info_t *info,
+static void core_info_parse_config_file(core_info_t *info,
       config_file_t *conf)
 {
    bool tmp_bool                   = false;
@@ -1882,7 +1922,66 @@ static void core_info_parse_config_file(
    core_info_resolve_firmware(info, conf);
 
    info->has_info = true;
-   list->info_count++;
+}
+
+typedef struct
+{
+   core_info_t *core_info;
+   core_path_list_t *path_list;
+   const char *info_dir;
+   /* Indices of the cores to parse */
+   const size_t *cores;
+} core_info_parse_state_t;
+
+/* Fills in an uncached core from its .info file.
+ * Only touches *info, so that cores can be parsed
+ * in parallel. */
+static void core_info_parse_core(core_info_t *info,
+      const core_file_path_t *core_file,
+      core_path_list_t *path_list, const char *info_dir)
+{
+   char info_file[256];
+   config_file_t *conf = NULL;
+
+   strlcpy(info_file, info->core_file_id.str, sizeof(info_file));
+   strlcat(info_file, ".info", sizeof(info_file));
+
+   /* Parse core info file */
+   if ((conf = core_info_get_config_file(info_file, info_dir)))
+   {
+      core_info_parse_config_file(info, conf);
+      config_file_free(conf);
+   }
+   /* Start with 'full' savestate support when info is missing */
+   else
+      info->savestate_support_level =
+            CORE_INFO_SAVESTATE_DETERMINISTIC;
+
+   /* Get fallback display name, if required */
+   if (!info->display_name)
+      info->display_name = strdup(core_file->filename);
+
+   /* Get core 'standalone exempt' status */
+   info->is_standalone_exempt = info->supports_no_game &&
+         core_info_path_is_standalone_exempt(
+               path_list->standalone_exempt_list,
+               core_file->filename);
+
+   info->is_installed = true;
+}
+
+static void core_info_parse_cores(size_t begin, size_t end, void *data)
+{
+   size_t i;
+   core_info_parse_state_t *state = (core_info_parse_state_t*)data;
+
+   for (i = begin; i < end; i++)
+   {
+      size_t idx = state->cores[i];
+      core_info_parse_core(&state->core_info[idx],
+            &state->path_list->core_list->list[idx],
+            state->path_list, state->info_dir);
+   }
 }
 
 static size_t core_info_list_resolve_all_extensions(
@@ -2002,12 +2101,23 @@ static core_info_list_t *core_info_list_new(const char *path,
       bool *cache_supported)
 {
    size_t i;
+   core_info_parse_state_t parse_state;
    core_info_t *core_info                       = NULL;
    core_info_list_t *core_info_list             = NULL;
    core_info_cache_list_t *core_info_cache_list = NULL;
+   core_path_list_t *path_list                  = NULL;
+   size_t *uncached                             = NULL;
+   size_t num_uncached                          = 0;
    const char *info_dir                         = libretro_info_dir;
-   core_path_list_t *path_list                  = core_info_path_list_new(
-         path, exts, dir_show_hidden_files);
+   retro_time_t start_time                      = cpu_features_get_time_usec();
+   retro_time_t scan_time                       = 0;
+   retro_time_t cache_read_time                 = 0;
+   retro_time_t parse_time                      = 0;
+   retro_time_t cache_write_time                = 0;
+   retro_time_t stage_start                     = start_time;
+
+   path_list = core_info_path_list_new(path, exts, dir_show_hidden_files);
+   scan_time = cpu_features_get_time_usec() - stage_start;
    if (!path_list)
       return NULL;
 
@@ -2022,9 +2132,12 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->info_count = 0;
    core_info_list->all_ext    = NULL;
 
-   if (!(core_info = (core_info_t*)calloc(path_list->core_list->size,
-         sizeof(*core_info))))
+   if (     !(core_info = (core_info_t*)calloc(path_list->core_list->size,
+               sizeof(*core_info)))
+         || !(uncached  = (size_t*)malloc((path_list->core_list->size + 1)
+               * sizeof(*uncached))))
    {
+      free(core_info);
       core_info_list_free(core_info_list);
       core_info_path_list_free(path_list);
       free(core_info_list);
@@ -2038,21 +2151,28 @@ static core_info_list_t *core_info_list_new(const char *path,
 
 #ifdef HAVE_CORE_INFO_CACHE
    /* Read core info cache, if enabled */
-   if (enable_cache && !(core_info_cache_list = core_info_cache_read(info_dir)))
+   if (enable_cache)
    {
-      core_info_list_free(core_info_list);
-      core_info_path_list_free(path_list);
-      free(core_info_list);
-      core_info_list = NULL;
-      path_list      = NULL;
-      return NULL;
+      stage_start          = cpu_features_get_time_usec();
+      core_info_cache_list = core_info_cache_read(info_dir);
+      cache_read_time      = cpu_features_get_time_usec() - stage_start;
+
+      if (!core_info_cache_list)
+      {
+         free(uncached);
+         core_info_list_free(core_info_list);
+         core_info_path_list_free(path_list);
+         free(core_info_list);
+         core_info_list = NULL;
+         path_list      = NULL;
+         return NULL;
+      }
    }
 #endif
 
    for (i = 0; i < path_list->core_list->size; i++)
    {
       char core_file_id[256];
-      config_file_t *conf         = NULL;
       core_info_t *info           = &core_info[i];
       core_file_path_t *core_file = &path_list->core_list->list[i];
       const char *base_path       = core_file->path;
@@ -2094,10 +2214,10 @@ static core_info_list_t *core_info_list_new(const char *path,
                         path_list->standalone_exempt_list,
                         core_filename);
 
-            /* 'info_count' is normally incremented inside
-             * core_info_parse_config_file(). If core entry
-             * is cached, must instead increment the value
-             * here */
+            /* 'info_count' is normally incremented once
+             * the core info file has been parsed. If core
+             * entry is cached, must instead increment the
+             * value here */
             if (info->has_info)
                core_info_list->info_count++;
 
@@ -2116,31 +2236,43 @@ static core_info_list_t *core_info_list_new(const char *path,
       info->core_file_id.str  = strdup(core_file_id);
       info->core_file_id.hash = core_info_hash_string(core_file_id);
 
-      strlcpy(core_file_id + _len, ".info", sizeof(core_file_id) - _len);
+      uncached[num_uncached++] = i;
+   }
 
-      /* Parse core info file */
-      if ((conf = core_info_get_config_file(core_file_id, info_dir)))
-      {
-         core_info_parse_config_file(core_info_list, info, conf);
-         config_file_free(conf);
-      }
+   /* Parse the info files of all uncached cores
+    * > With many of them (first run, or the cache
+    *   was refreshed) this is most of the startup
+    *   time, so spread them over all CPU cores */
+   stage_start           = cpu_features_get_time_usec();
+   parse_state.core_info = core_info;
+   parse_state.path_list = path_list;
+   parse_state.info_dir  = info_dir;
+   parse_state.cores     = uncached;
+#ifdef HAVE_THREADS
+   {
+      tpool_t *pool  = NULL;
+      unsigned cores = cpu_features_get_core_amount();
 
-      /* Start with 'full' savestate support when info is missing */
-      if (!conf)
-         info->savestate_support_level =
-               CORE_INFO_SAVESTATE_DETERMINISTIC;
+      if (num_uncached >= CORE_INFO_PARALLEL_PARSE_MIN && cores > 1)
+         pool = tpool_create(cores - 1);
 
-      /* Get fallback display name, if required */
-      if (!info->display_name)
-         info->display_name = strdup(core_filename);
+      tpool_parallel_for(pool, 0, num_uncached, 1,
+            core_info_parse_cores, &parse_state);
 
-      /* Get core 'standalone exempt' status */
-      info->is_standalone_exempt = info->supports_no_game &&
-            core_info_path_is_standalone_exempt(
-                  path_list->standalone_exempt_list,
-                  core_filename);
+      if (pool)
+         tpool_destroy(pool);
+   }
+#else
+   core_info_parse_cores(0, num_uncached, &parse_state);
+#endif
+   parse_time            = cpu_features_get_time_usec() - stage_start;
+
+   for (i = 0; i < num_uncached; i++)
+   {
+      core_info_t *info = &core_info[uncached[i]];
 
-      info->is_installed = true;
+      if (info->has_info)
+         core_info_list->info_count++;
 
       /* If info cache is enabled and we reach this
        * point, current core is uncached
@@ -2153,6 +2285,8 @@ static core_info_list_t *core_info_list_new(const char *path,
       }
    }
 
+   free(uncached);
+
    core_info_list_resolve_all_extensions(core_info_list);
 
    /* If info cache is enabled
@@ -2167,14 +2301,28 @@ static core_info_list_t *core_info_list_new(const char *path,
       core_info_check_uninstalled(core_info_cache_list);
 
       if (core_info_cache_list->refresh)
+      {
+         stage_start      = cpu_features_get_time_usec();
          *cache_supported = core_info_cache_write(
                core_info_cache_list, info_dir);
+         cache_write_time = cpu_features_get_time_usec() - stage_start;
+      }
 
       core_info_cache_list_free(core_info_cache_list);
       free(core_info_cache_list);
       core_info_cache_list = NULL;
    }
 
+   RARCH_LOG("[Core info] Loaded %u cores (%u info files parsed) in %.1f ms:"
+         " directory scan %.1f ms, cache read %.1f ms, info parse %.1f ms,"
+         " cache write %.1f ms.\n",
+         (unsigned)core_info_list->count, (unsigned)num_uncached,
+         (cpu_features_get_time_usec() - start_time) / 1000.0,
+         scan_time        / 1000.0,
+         cache_read_time  / 1000.0,
+         parse_time       / 1000.0,
+         cache_write_time / 1000.0);
+
    core_info_path_list_free(path_list);
    return core_info_list;
 }
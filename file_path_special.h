@@ -48,6 +48,7 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_STATE_EXTENSION ".state"
 #define FILE_PATH_LPL_EXTENSION ".lpl"
 #define FILE_PATH_LPL_EXTENSION_NO_DOT "lpl"
+#define FILE_PATH_LPL_CACHE_EXTENSION ".lplc"
 #define FILE_PATH_PNG_EXTENSION ".png"
 #define FILE_PATH_MP3_EXTENSION ".mp3"
 #define FILE_PATH_FLAC_EXTENSION ".flac"
@@ -111,6 +112,10 @@ RETRO_BEGIN_DECLS
 #endif
 #define FILE_PATH_CORE_INFO_CACHE "core_info.cache"
 #define FILE_PATH_CORE_INFO_CACHE_REFRESH "core_info.refresh"
+#define FILE_PATH_EXPLORE_CACHE "explore.cache"
+#define FILE_PATH_THUMBNAIL_CACHE_DIR ".cache"
+#define FILE_PATH_THUMBNAIL_CACHE_EXTENSION ".ltc"
+#define FILE_PATH_THUMBNAIL_CACHE_EXTENSION_NO_DOT "ltc"
 
 #ifdef HAVE_LAKKA
  #ifdef HAVE_LAKKA_SERVER
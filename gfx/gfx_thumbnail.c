@@ -33,6 +33,8 @@
 
 #include "gfx_thumbnail.h"
 
+#include "../configuration.h"
+#include "../file_path_special.h"
 #include "../tasks/tasks_internal.h"
 
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  16.66667f * 3
@@ -43,6 +45,7 @@
 typedef struct
 {
    uint64_t list_id;
+   uint64_t cache_key;
    gfx_thumbnail_t *thumbnail;
 } gfx_thumbnail_tag_t;
 
@@ -188,8 +191,9 @@ static void gfx_thumbnail_handle_upload(
       goto end;
 
    /* Cache dimensions */
-   thumbnail_tag->thumbnail->width  = img->width;
-   thumbnail_tag->thumbnail->height = img->height;
+   thumbnail_tag->thumbnail->width     = img->width;
+   thumbnail_tag->thumbnail->height    = img->height;
+   thumbnail_tag->thumbnail->cache_key = thumbnail_tag->cache_key;
 
    /* Update thumbnail status */
    thumbnail_tag->thumbnail->status = GFX_THUMBNAIL_STATUS_AVAILABLE;
@@ -213,6 +217,112 @@ end:
    }
 }
 
+/* Texture cache */
+
+/* Identifies a thumbnail image by path, file size,
+ * modification time and upscale threshold, so that
+ * a replaced image is loaded again. Never returns 0. */
+static uint64_t gfx_thumbnail_get_cache_key(const char *path,
+      int32_t size, int64_t mtime, unsigned upscale_threshold)
+{
+   /* FNV-1a */
+   const uint8_t *p = (const uint8_t*)path;
+   uint64_t h       = 0xcbf29ce484222325ULL;
+
+   while (*p)
+   {
+      h ^= *p++;
+      h *= 0x100000001b3ULL;
+   }
+   h ^= (uint64_t)(uint32_t)size | ((uint64_t)upscale_threshold << 32);
+   h *= 0x100000001b3ULL;
+   h ^= (uint64_t)mtime;
+   h *= 0x100000001b3ULL;
+
+   return h ? h : 1;
+}
+
+/* Moves the cached texture for 'key', if any, to 'thumbnail' */
+static bool gfx_thumbnail_cache_take(
+      gfx_thumbnail_state_t *p_gfx_thumb, uint64_t key,
+      gfx_thumbnail_t *thumbnail)
+{
+   unsigned i;
+
+   for (i = 0; i < GFX_THUMBNAIL_TEXTURE_CACHE_SIZE; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->textures[i];
+
+      if (entry->texture && entry->key == key)
+      {
+         thumbnail->texture   = entry->texture;
+         thumbnail->width     = entry->width;
+         thumbnail->height    = entry->height;
+         thumbnail->cache_key = key;
+         thumbnail->status    = GFX_THUMBNAIL_STATUS_AVAILABLE;
+         entry->texture       = 0;
+         entry->key           = 0;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/* Takes over the texture of 'thumbnail', unloading the
+ * least recently used cached texture if there is no room */
+static void gfx_thumbnail_cache_put(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_t *thumbnail)
+{
+   unsigned i;
+   gfx_thumbnail_cache_entry_t *slot = &p_gfx_thumb->textures[0];
+
+   for (i = 0; i < GFX_THUMBNAIL_TEXTURE_CACHE_SIZE; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->textures[i];
+
+      /* Same image shown twice, keep one copy */
+      if (entry->texture && entry->key == thumbnail->cache_key)
+      {
+         video_driver_texture_unload(&thumbnail->texture);
+         entry->last_used = ++p_gfx_thumb->texture_clock;
+         return;
+      }
+
+      if (!entry->texture)
+         slot = entry;
+      else if (slot->texture && entry->last_used < slot->last_used)
+         slot = entry;
+   }
+
+   if (slot->texture)
+      video_driver_texture_unload(&slot->texture);
+
+   slot->key          = thumbnail->cache_key;
+   slot->last_used    = ++p_gfx_thumb->texture_clock;
+   slot->texture      = thumbnail->texture;
+   slot->width        = thumbnail->width;
+   slot->height       = thumbnail->height;
+   thumbnail->texture = 0;
+}
+
+void gfx_thumbnail_flush_texture_cache(void)
+{
+   unsigned i;
+   gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+
+   for (i = 0; i < GFX_THUMBNAIL_TEXTURE_CACHE_SIZE; i++)
+   {
+      gfx_thumbnail_cache_entry_t *entry = &p_gfx_thumb->textures[i];
+
+      if (entry->texture)
+         video_driver_texture_unload(&entry->texture);
+      entry->texture = 0;
+      entry->key     = 0;
+   }
+}
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -291,6 +401,9 @@ void gfx_thumbnail_request(
       bool network_on_demand_thumbnails)
 {
    gfx_thumbnail_state_t *p_gfx_thumb = &gfx_thumb_st;
+   settings_t *settings               = config_get_ptr();
+   bool thumbnail_cache_enable        = settings->bools.menu_thumbnail_cache_enable;
+   const char *directory_thumbnails   = settings->paths.directory_thumbnails;
 
    if (!path_data || !thumbnail)
       return;
@@ -308,25 +421,59 @@ void gfx_thumbnail_request(
          const char *thumbnail_path = NULL;
          if (gfx_thumbnail_get_path(path_data, thumbnail_id, &thumbnail_path))
          {
+            int32_t thumbnail_size = path_get_size(thumbnail_path);
+
             /* Load thumbnail, if required */
-            if (path_is_valid(thumbnail_path))
+            if (thumbnail_size >= 0)
             {
-               gfx_thumbnail_tag_t *thumbnail_tag =
-                  (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
+               bool pushed                        = false;
+               uint64_t cache_key                 = 0;
+               gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+
+               if (thumbnail_cache_enable)
+               {
+                  cache_key = gfx_thumbnail_get_cache_key(thumbnail_path,
+                        thumbnail_size, path_get_mtime(thumbnail_path),
+                        gfx_thumbnail_upscale_threshold);
+
+                  /* Still on the GPU since it was last shown */
+                  if (gfx_thumbnail_cache_take(p_gfx_thumb, cache_key,
+                           thumbnail))
+                     goto end;
+               }
 
-               if (!thumbnail_tag)
+               if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)
+                        malloc(sizeof(gfx_thumbnail_tag_t))))
                   goto end;
 
                /* Configure user data */
                thumbnail_tag->thumbnail = thumbnail;
                thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+               thumbnail_tag->cache_key = cache_key;
 
                /* Would like to cancel any existing image load tasks
                 * here, but can't see how to do it... */
-               if (task_push_image_load(
+               if (thumbnail_cache_enable && !string_is_empty(directory_thumbnails))
+               {
+                  char cache_dir[PATH_MAX_LENGTH];
+                  fill_pathname_join_special(cache_dir, directory_thumbnails,
+                        FILE_PATH_THUMBNAIL_CACHE_DIR, sizeof(cache_dir));
+                  if (p_gfx_thumb->disk_cache_loads++
+                        % GFX_THUMBNAIL_DISK_CACHE_TRIM_INTERVAL == 0)
+                     task_push_image_cache_trim(cache_dir,
+                           GFX_THUMBNAIL_DISK_CACHE_SIZE);
+                  pushed = task_push_image_load_cached(
+                        thumbnail_path, cache_dir, video_driver_supports_rgba(),
+                        gfx_thumbnail_upscale_threshold,
+                        gfx_thumbnail_handle_upload, thumbnail_tag);
+               }
+               else
+                  pushed = task_push_image_load(
                         thumbnail_path, video_driver_supports_rgba(),
                         gfx_thumbnail_upscale_threshold,
-                        gfx_thumbnail_handle_upload, thumbnail_tag))
+                        gfx_thumbnail_handle_upload, thumbnail_tag);
+
+               if (pushed)
                   thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
             }
 #ifdef HAVE_NETWORKING
@@ -335,7 +482,7 @@ void gfx_thumbnail_request(
             {
                enum playlist_thumbnail_name_flags curr_flag;
                static char last_img_name[PATH_MAX_LENGTH] = {0};
-               bool playlist_use_filename                 = config_get_ptr()->bools.playlist_use_filename;
+               bool playlist_use_filename                 = settings->bools.playlist_use_filename;
                if (!playlist)
                   goto end;
                /* Only trigger a thumbnail download if image
@@ -425,6 +572,7 @@ void gfx_thumbnail_request_file(
    /* Configure user data */
    thumbnail_tag->thumbnail = thumbnail;
    thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+   thumbnail_tag->cache_key = 0;
 
    /* Would like to cancel any existing image load tasks
     * here, but can't see how to do it... */
@@ -442,9 +590,15 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    if (!thumbnail)
       return;
 
-   /* Unload texture */
+   /* Unload texture, or keep it around for
+    * the next request of the same image */
    if (thumbnail->texture)
-      video_driver_texture_unload(&thumbnail->texture);
+   {
+      if (thumbnail->cache_key)
+         gfx_thumbnail_cache_put(&gfx_thumb_st, thumbnail);
+      else
+         video_driver_texture_unload(&thumbnail->texture);
+   }
 
    /* Ensure any 'fade in' animation is killed */
    if (thumbnail->flags & GFX_THUMB_FLAG_FADE_ACTIVE)
@@ -456,6 +610,7 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    /* Reset all parameters */
    thumbnail->status      = GFX_THUMBNAIL_STATUS_UNKNOWN;
    thumbnail->texture     = 0;
+   thumbnail->cache_key   = 0;
    thumbnail->width       = 0;
    thumbnail->height      = 0;
    thumbnail->alpha       = 0.0f;
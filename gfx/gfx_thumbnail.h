@@ -69,11 +69,22 @@ enum gfx_thumbnail_flags
    GFX_THUMB_FLAG_CORE_ASPECT = (1 << 1)
 };
 
+/* Number of recently shown thumbnail textures kept
+ * on the GPU when the thumbnail cache is enabled */
+#define GFX_THUMBNAIL_TEXTURE_CACHE_SIZE 16
+
+/* Size cap of the on-disk thumbnail cache, checked when
+ * the cache is first used and again after every
+ * GFX_THUMBNAIL_DISK_CACHE_TRIM_INTERVAL cached loads */
+#define GFX_THUMBNAIL_DISK_CACHE_SIZE          ((uint64_t)256 << 20)
+#define GFX_THUMBNAIL_DISK_CACHE_TRIM_INTERVAL 256
+
 /* Holds all runtime parameters associated with
  * an entry thumbnail */
 typedef struct
 {
    uintptr_t texture;
+   uint64_t cache_key; /* Texture cache key, 0 if not cacheable */
    unsigned width;
    unsigned height;
    float alpha;
@@ -99,6 +110,17 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+/* A thumbnail texture no longer on screen, kept
+ * for the next request of the same image */
+typedef struct
+{
+   uint64_t key;
+   uint64_t last_used;
+   uintptr_t texture;
+   unsigned width;
+   unsigned height;
+} gfx_thumbnail_cache_entry_t;
+
 /* Structure containing all gfx_thumbnail
  * variables */
 struct gfx_thumbnail_state
@@ -115,6 +137,16 @@ struct gfx_thumbnail_state
     * at the time when the load completes */
    uint64_t list_id;
 
+   /* Textures of thumbnails that were reset, kept
+    * until the least recently used one has to make
+    * room for another */
+   gfx_thumbnail_cache_entry_t textures[GFX_THUMBNAIL_TEXTURE_CACHE_SIZE];
+   uint64_t texture_clock;
+
+   /* Cached image loads pushed so far, paces the
+    * trimming of the on-disk cache */
+   unsigned disk_cache_loads;
+
    /* When streaming thumbnails, to minimise the processing
     * of unnecessary images (i.e. when scrolling rapidly through
     * playlists), we delay loading until an entry has been on screen
@@ -195,6 +227,11 @@ void gfx_thumbnail_request_file(
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
 
+/* Unloads all textures held by the thumbnail cache
+ * >> **MUST** be called when destroying the menu
+ *    context, after resetting all thumbnails */
+void gfx_thumbnail_flush_texture_cache(void);
+
 /* Stream processing */
 
 /* Requests loading of the specified thumbnail via
@@ -4258,6 +4258,62 @@ void video_driver_frame(const void *data, unsigned width,
                audio_stats.samples
                );
 
+#ifdef HAVE_THREADS
+         /* TODO/FIXME - localize */
+         if (VIDEO_DRIVER_IS_THREADED_INTERNAL(video_st) && video_st->data)
+         {
+            /* Counters are only ever written by this thread,
+             * reading them unlocked is fine. */
+            const thread_video_t *thr = (const thread_video_t*)video_st->data;
+            unsigned pushed           = thr->hit_count + thr->miss_count;
+            __len += snprintf(video_info.stat_text + __len, sizeof(video_info.stat_text) - __len,
+                  "THREADED VIDEO\n"
+                  " Frames:   %8u\n"
+                  " - Replaced:  %5u\n"
+                  " Copy Time:  %6.2f ms\n",
+                  pushed,
+                  thr->miss_count,
+                  pushed ? thr->copy_time / (1000.0f * pushed) : 0.0f);
+         }
+#endif
+
+#ifdef HAVE_THREADS
+         /* TODO/FIXME - localize */
+         if (task_queue_get_worker_count() > 0)
+         {
+            static const char *class_names[TASK_CLASS_LAST] = {
+               "Interactive",
+               "Savestate",
+               "Thumbnail",
+               "Background"
+            };
+            unsigned i;
+
+            __len += strlcpy(video_info.stat_text + __len, "TASKS\n",
+                  sizeof(video_info.stat_text) - __len);
+
+            for (i = 0; i < TASK_CLASS_LAST; i++)
+            {
+               task_class_stats_t stats;
+
+               if (     !task_queue_get_class_stats((enum task_class)i, &stats)
+                     || !stats.started)
+                  continue;
+
+               __len += snprintf(video_info.stat_text + __len, sizeof(video_info.stat_text) - __len,
+                     " %-12s %u/%u, %u queued, peak %u\n"
+                     " - Wait/Run: %5.2f / %5.2f ms\n",
+                     class_names[i],
+                     stats.running,
+                     stats.limit,
+                     stats.queued,
+                     stats.peak_queued,
+                     stats.wait_time / (1000.0f * stats.started),
+                     stats.run_time  / (1000.0f * stats.started));
+            }
+         }
+#endif
+
          /* TODO/FIXME - localize */
          if (     (video_st->frame_delay_target > 0)
                || (video_info.runahead)
@@ -4294,6 +4350,15 @@ void video_driver_frame(const void *data, unsigned width,
                   " Run-Ahead:   %2u frames\n"
                   " - Preemptive Frames\n",
                   video_info.runahead_frames);
+
+#ifdef HAVE_RUNAHEAD
+         if (video_info.runahead)
+            __len += snprintf(video_info.stat_text + __len, sizeof(video_info.stat_text) - __len,
+                  " - Reloads: %8" PRIu64"\n"
+                  " - Skipped: %8" PRIu64"\n",
+                  runloop_st->runahead_reload_count,
+                  runloop_st->runahead_skip_count);
+#endif
       }
    }
 
@@ -466,7 +466,7 @@ typedef struct video_frame_info
 
    uint16_t frame_time_target;
 
-   char stat_text[1024];
+   char stat_text[2048];
 
    bool widgets_active;
    bool notifications_hidden;
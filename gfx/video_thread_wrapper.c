@@ -428,6 +428,35 @@ static void video_thread_loop(void *data)
 
       updated = thr->frame.updated;
 
+      /* Take the most recently published frame and hand
+       * the slot we rendered last back to the main thread,
+       * which can start filling its next frame right away. */
+      if (updated)
+      {
+         thread_frame_slot_t *ready =
+            &thr->frame.slots[thr->frame.ready_index];
+
+         /* A repeat carries no pixels, render the slot we
+          * already hold again with the repeat's frame count
+          * and message. */
+         if (ready->repeat)
+         {
+            thread_frame_slot_t *read =
+               &thr->frame.slots[thr->frame.read_index];
+            read->count              = ready->count;
+            read->seq                = ready->seq;
+            strlcpy(read->msg, ready->msg, sizeof(read->msg));
+         }
+         else
+         {
+            unsigned tmp             = thr->frame.read_index;
+            thr->frame.read_index    = thr->frame.ready_index;
+            thr->frame.ready_index   = tmp;
+         }
+         thr->frame.updated       = false;
+         scond_signal(thr->cond_cmd);
+      }
+
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
       pkt     = thr->cmd_data;
@@ -440,6 +469,8 @@ static void video_thread_loop(void *data)
       if (updated)
       {
          struct video_viewport vp;
+         const thread_frame_slot_t *slot =
+            &thr->frame.slots[thr->frame.read_index];
          bool               alive = false;
          bool               focus = false;
          bool        has_windowed = false;
@@ -467,9 +498,9 @@ static void video_thread_loop(void *data)
                video_driver_build_info(&video_info);
 
                ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count, thr->frame.pitch,
-                  *thr->frame.msg ? thr->frame.msg : NULL,
+                  slot->buffer, slot->width, slot->height,
+                  slot->count, slot->pitch,
+                  *slot->msg ? slot->msg : NULL,
                   &video_info);
 
                slock_unlock(thr->frame.lock);
@@ -494,11 +525,11 @@ static void video_thread_loop(void *data)
             slock_unlock(thr->frame.lock);
 
          slock_lock(thr->lock);
-         thr->alive         = alive;
-         thr->focus         = focus;
-         thr->has_windowed  = has_windowed;
-         thr->vp            = vp;
-         thr->frame.updated = false;
+         thr->alive                   = alive;
+         thr->focus                   = focus;
+         thr->has_windowed            = has_windowed;
+         thr->vp                      = vp;
+         thr->frame.rendered_seq      = slot->seq;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -622,50 +653,81 @@ static bool video_thread_frame(void *data, const void *frame_,
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   slock_unlock(thr->lock);
+
+   /* The write slot belongs to this thread until it is
+    * published, so the copy runs without holding any lock
+    * and never stalls the video thread. */
    {
-      const uint8_t *src   = (const uint8_t*)frame_;
-      uint8_t       *dst   = thr->frame.buffer;
-      unsigned copy_stride = width *
+      thread_frame_slot_t *slot = &thr->frame.slots[thr->frame.write_index];
+      unsigned copy_stride      = width *
          (thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t));
+      bool queued;
 
-      if (src)
+      if (frame_)
       {
-         int i; /* TODO/FIXME - increment counter never meaningfully used */
-         for (i = 0; i < (int)height; i++, src += pitch, dst += copy_stride)
+         unsigned i;
+         const uint8_t *src      = (const uint8_t*)frame_;
+         uint8_t *dst            = slot->buffer;
+         retro_time_t copy_start = cpu_features_get_time_usec();
+
+         for (i = 0; i < height; i++, src += pitch, dst += copy_stride)
             memcpy(dst, src, copy_stride);
+
+         thr->copy_time += cpu_features_get_time_usec() - copy_start;
+      }
+
+      slock_lock(thr->lock);
+
+      /* A frame still queued at this point was never picked up
+       * by the video thread and is replaced by this newer one. */
+      queued = thr->frame.updated;
+
+      /* Duplicate frames have no pixels of their own, so nothing
+       * is copied for them. One that follows a queued frame just
+       * takes over that slot; otherwise it goes out as a repeat
+       * and the video thread keeps rendering the pixels it has. */
+      if (!frame_ && queued)
+         slot = &thr->frame.slots[thr->frame.ready_index];
+      else
+      {
+         unsigned tmp           = thr->frame.write_index;
+         slot->repeat           = !frame_;
+         slot->width            = width;
+         slot->height           = height;
+         slot->pitch            = copy_stride;
+
+         /* Publish. */
+         thr->frame.write_index = thr->frame.ready_index;
+         thr->frame.ready_index = tmp;
       }
 
-      thr->frame.updated = true;
-      thr->frame.width   = width;
-      thr->frame.height  = height;
-      thr->frame.count   = frame_count;
-      thr->frame.pitch   = copy_stride;
+      slot->count            = frame_count;
+      slot->seq              = ++thr->frame.seq;
 
       if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
+         strlcpy(slot->msg, msg, sizeof(slot->msg));
       else
-         *thr->frame.msg = '\0';
+         *slot->msg          = '\0';
 
+      if (queued)
+         thr->miss_count++;
+      else
+         thr->hit_count++;
+
+      thr->frame.updated     = true;
       scond_signal(thr->cond_thread);
 
 #ifdef HAVE_MENU
       if (thr->texture.enable)
       {
-         do
-         {
+         while (thr->frame.rendered_seq < slot->seq)
             scond_wait(thr->cond_cmd, thr->lock);
-         } while (thr->frame.updated);
       }
 #endif
-      thr->hit_count++;
-   }
-   else
-      thr->miss_count++;
 
-   slock_unlock(thr->lock);
+      slock_unlock(thr->lock);
+   }
 
    thr->last_time = cpu_features_get_time_usec();
 
@@ -700,20 +762,28 @@ static bool video_thread_init(thread_video_t *thr,
       return false;
 
    {
+      unsigned i;
       size_t max_size        = info.input_scale * RARCH_SCALE_BASE;
       max_size              *= max_size;
       max_size              *= info.rgb32 ?
          sizeof(uint32_t) : sizeof(uint16_t);
 
+      for (i = 0; i < THREAD_VIDEO_FRAME_SLOTS; i++)
+      {
 #ifdef _3DS
-      thr->frame.buffer      = linearMemAlign(max_size, 0x80);
+         thr->frame.slots[i].buffer = linearMemAlign(max_size, 0x80);
 #else
-      thr->frame.buffer      = (uint8_t*)malloc(max_size);
+         thr->frame.slots[i].buffer = (uint8_t*)malloc(max_size);
 #endif
-      if (!thr->frame.buffer)
-         return false;
+         if (!thr->frame.slots[i].buffer)
+            return false;
 
-      memset(thr->frame.buffer, 0x80, max_size);
+         memset(thr->frame.slots[i].buffer, 0x80, max_size);
+      }
+
+      thr->frame.write_index = 0;
+      thr->frame.ready_index = 1;
+      thr->frame.read_index  = 2;
    }
 
    thr->input                = input;
@@ -827,6 +897,8 @@ static void video_thread_free(void *data)
 
    if (thr)
    {
+      unsigned i;
+
       if (thr->thread)
       {
          thread_packet_t pkt;
@@ -845,11 +917,14 @@ static void video_thread_free(void *data)
       }
 
       free(thr->texture.frame);
+      for (i = 0; i < THREAD_VIDEO_FRAME_SLOTS; i++)
+      {
 #ifdef _3DS
-      linearFree(thr->frame.buffer);
+         linearFree(thr->frame.slots[i].buffer);
 #else
-      free(thr->frame.buffer);
+         free(thr->frame.slots[i].buffer);
 #endif
+      }
       free(thr->alpha_mod);
 
       slock_free(thr->frame.lock);
@@ -859,8 +934,12 @@ static void video_thread_free(void *data)
       scond_free(thr->cond_thread);
 
       RARCH_LOG(
-         "Threaded video stats: Frames pushed: %u, Frames dropped: %u.\n",
-         thr->hit_count, thr->miss_count);
+         "Threaded video stats: Frames pushed: %u, Frames replaced: %u, "
+         "Copy time: %.2f ms/frame.\n",
+         thr->hit_count, thr->miss_count,
+         (thr->hit_count + thr->miss_count)
+         ? thr->copy_time / (1000.0f * (thr->hit_count + thr->miss_count))
+         : 0.0f);
 
       free(thr);
    }
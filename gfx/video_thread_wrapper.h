@@ -28,6 +28,12 @@
 
 RETRO_BEGIN_DECLS
 
+/* Frames handed from the main thread to the video thread
+ * rotate through this many buffers: one being filled by the
+ * main thread, one being rendered by the video thread and
+ * the most recently published one in between. */
+#define THREAD_VIDEO_FRAME_SLOTS 3
+
 enum thread_cmd
 {
    CMD_VIDEO_NONE = 0,
@@ -166,6 +172,18 @@ typedef struct thread_packet
    enum thread_cmd type;
 } thread_packet_t;
 
+typedef struct thread_frame_slot
+{
+   uint64_t count;
+   uint64_t seq;
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   char msg[NAME_MAX_LENGTH];
+   bool repeat; /* Duplicate frame, reuses the pixels rendered last. */
+} thread_frame_slot_t;
+
 typedef struct thread_video
 {
    retro_time_t last_time;
@@ -203,6 +221,8 @@ typedef struct thread_video
       bool full_screen;
    } texture;
 
+   retro_time_t copy_time; /* Total time spent copying frames (usec). */
+
    unsigned hit_count;
    unsigned miss_count;
    unsigned alpha_mods;
@@ -220,14 +240,14 @@ typedef struct thread_video
 
    struct
    {
-      uint64_t count;
+      thread_frame_slot_t slots[THREAD_VIDEO_FRAME_SLOTS];
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[NAME_MAX_LENGTH];
-      bool updated;
+      uint64_t seq;               /* Sequence number of the last publish. */
+      uint64_t rendered_seq;      /* Sequence number of the last render. */
+      unsigned write_index;       /* Owned by the main thread. */
+      unsigned ready_index;       /* Protected by thr->lock. */
+      unsigned read_index;        /* Owned by the video thread. */
+      bool updated;               /* ready_index holds an unrendered frame. */
       bool within_thread;
    } frame;
 
@@ -1241,6 +1241,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1509,6 +1510,7 @@ DEPENDENCIES
 #include "../deps/zstd/lib/decompress/zstd_ddict.c"
 #include "../deps/zstd/lib/decompress/zstd_decompress.c"
 #include "../deps/zstd/lib/decompress/zstd_decompress_block.c"
+#include "../libretro-common/streams/trans_stream_zstd.c"
 #endif
 
 #ifdef WANT_LIBFAT
@@ -1542,6 +1544,7 @@ XML
 ============================================================ */
 #include "../libretro-common/audio/conversion/s16_to_float.c"
 #include "../libretro-common/audio/conversion/float_to_s16.c"
+#include "../libretro-common/audio/conversion/s16_resample.c"
 #include "../libretro-common/audio/conversion/stereo_to_mono_float.c"
 #include "../libretro-common/audio/conversion/mono_to_stereo_float.c"
 #ifdef HAVE_AUDIOMIXER
@@ -1686,7 +1689,6 @@ FFMPEG
 #ifdef HAVE_FFMPEG
 #include "../cores/libretro-ffmpeg/packet_buffer.c"
 #include "../cores/libretro-ffmpeg/video_buffer.c"
-#include "../libretro-common/rthreads/tpool.c"
 #endif
 
 /*============================================================
@@ -12,6 +12,7 @@
 #endif
 #include "libretro.h"
 #include "streams/interface_stream.h"
+#include <array/rbuf.h>
 #ifdef HAVE_CHEEVOS
 #include "../../cheevos/cheevos.h"
 #endif
@@ -24,6 +25,10 @@
 #include <zstd.h>
 #endif
 
+#if defined(HAVE_STATESTREAM) && defined(HAVE_THREADS)
+#include <rthreads/tpool.h>
+#endif
+
 #define BSV_IFRAME_START_TOKEN 0x00
 /* after START:
    frame counter uint
@@ -59,6 +64,253 @@ bool bsv_movie_read_deduped_state(bsv_movie_t *movie, uint8_t *encoded, size_t e
 bool bsv_movie_skip_to_next_checkpoint_impl(bsv_movie_t *movie);
 bool bsv_movie_skip_to_prev_checkpoint_impl(bsv_movie_t *movie);
 bool bsv_movie_seek_to_pos_impl(bsv_movie_t *movie, int64_t pos);
+bool bsv_movie_peek_frame_info(bsv_movie_t *movie, uint8_t *token, uint64_t *len);
+
+/* Checkpoint index */
+
+/* First checkpoint at or after pos */
+static size_t bsv_movie_index_find_pos(bsv_movie_t *movie, int64_t pos)
+{
+   size_t lo = 0, hi = RBUF_LEN(movie->checkpoints);
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (movie->checkpoints[mid].pos < pos)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+/* Number of checkpoints at or before frame */
+static size_t bsv_movie_index_count_to_frame(bsv_movie_t *movie, int64_t frame)
+{
+   size_t lo = 0, hi = RBUF_LEN(movie->checkpoints);
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (movie->checkpoints[mid].frame <= frame)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+static void bsv_movie_index_add(bsv_movie_t *movie, int64_t frame, int64_t pos)
+{
+   struct bsv_checkpoint_ref ref;
+   size_t len = RBUF_LEN(movie->checkpoints);
+   /* Entries only ever come in file order */
+   if (len && movie->checkpoints[len - 1].pos >= pos)
+      return;
+   ref.frame = frame;
+   ref.pos   = pos;
+   RBUF_PUSH(movie->checkpoints, ref);
+}
+
+/* Forgets everything at or after pos (the start of frame), for when
+ * the file is truncated or rewritten from there on. */
+static void bsv_movie_index_truncate(bsv_movie_t *movie, int64_t pos, int64_t frame)
+{
+   RBUF_RESIZE(movie->checkpoints, bsv_movie_index_find_pos(movie, pos));
+   if (movie->checkpoint_scan_pos > pos)
+   {
+      movie->checkpoint_scan_pos   = pos;
+      movie->checkpoint_scan_frame = frame;
+   }
+}
+
+static void bsv_movie_index_reset(bsv_movie_t *movie)
+{
+   RBUF_CLEAR(movie->checkpoints);
+   movie->checkpoint_scan_pos   = movie->min_file_pos;
+   movie->checkpoint_scan_frame = 0;
+}
+
+/* Extends the index by scanning frame headers until it covers
+ * every frame before the given one, or the file runs out. */
+static void bsv_movie_index_scan_to_frame(bsv_movie_t *movie, int64_t frame)
+{
+   uint8_t tok;
+   uint64_t frame_len;
+   int64_t initial_pos;
+   if (movie->checkpoint_scan_frame >= frame)
+      return;
+   initial_pos = intfstream_tell(movie->file);
+   intfstream_seek(movie->file, movie->checkpoint_scan_pos, SEEK_SET);
+   while (movie->checkpoint_scan_frame < frame
+         && bsv_movie_peek_frame_info(movie, &tok, &frame_len))
+   {
+      if (tok == REPLAY_TOKEN_INVALID)
+         break;
+      if (tok == REPLAY_TOKEN_CHECKPOINT_FRAME || tok == REPLAY_TOKEN_CHECKPOINT2_FRAME)
+         bsv_movie_index_add(movie, movie->checkpoint_scan_frame,
+               movie->checkpoint_scan_pos);
+      movie->checkpoint_scan_frame += 1;
+      movie->checkpoint_scan_pos   += frame_len;
+      intfstream_seek(movie->file, frame_len, SEEK_CUR);
+   }
+   intfstream_seek(movie->file, initial_pos, SEEK_SET);
+}
+
+/* Recovers frame_pos entries down to frame by following backrefs from
+ * the oldest one known to be good. Needed after jumping straight to a
+ * checkpoint, since the frames before it were never read. */
+static void bsv_movie_fill_frame_pos(bsv_movie_t *movie, uint64_t frame)
+{
+   int64_t initial_pos;
+   if (movie->version < 2 || movie->frame_pos_floor <= frame)
+      return;
+   initial_pos = intfstream_tell(movie->file);
+   while (movie->frame_pos_floor > frame)
+   {
+      uint32_t backref;
+      size_t pos = movie->frame_pos[movie->frame_pos_floor & movie->frame_mask];
+      if (     intfstream_seek(movie->file, pos, SEEK_SET) < 0
+            || intfstream_read(movie->file, &backref, sizeof(backref)) != sizeof(backref))
+         break;
+      movie->frame_pos_floor--;
+      movie->frame_pos[movie->frame_pos_floor & movie->frame_mask] = pos - swap_if_big32(backref);
+   }
+   intfstream_seek(movie->file, initial_pos, SEEK_SET);
+}
+
+bool bsv_movie_read_index(bsv_movie_t *movie)
+{
+   uint32_t trailer[3];
+   uint32_t count, i;
+   uint64_t *entries;
+   int64_t size, footer_pos, initial_pos;
+   bool ret = false;
+
+   bsv_movie_index_reset(movie);
+   movie->footer_pos = 0;
+   if (movie->version < 2)
+      return false;
+
+   initial_pos = intfstream_tell(movie->file);
+   size        = intfstream_get_size(movie->file);
+   if (size < (int64_t)movie->min_file_pos + REPLAY_INDEX_FRAME_PREFIX_BYTES
+         + 4 + REPLAY_INDEX_TRAILER_LEN_BYTES)
+      goto end;
+   if (     intfstream_seek(movie->file, size - REPLAY_INDEX_TRAILER_LEN_BYTES, SEEK_SET) < 0
+         || intfstream_read(movie->file, trailer, sizeof(trailer)) != sizeof(trailer))
+      goto end;
+   for (i = 0; i < 3; i++)
+      trailer[i] = swap_if_big32(trailer[i]);
+   if (trailer[2] != REPLAY_INDEX_MAGIC)
+      goto end;
+
+   footer_pos = size - trailer[1];
+   if (     trailer[1] < REPLAY_INDEX_FRAME_PREFIX_BYTES + 4 + REPLAY_INDEX_TRAILER_LEN_BYTES
+         || footer_pos < (int64_t)movie->min_file_pos
+         || intfstream_seek(movie->file, footer_pos + REPLAY_INDEX_FRAME_PREFIX_BYTES, SEEK_SET) < 0
+         || intfstream_read(movie->file, &count, sizeof(count)) != sizeof(count))
+      goto end;
+   count = swap_if_big32(count);
+   if ((uint64_t)count * 16 + REPLAY_INDEX_FRAME_PREFIX_BYTES + 4
+         + REPLAY_INDEX_TRAILER_LEN_BYTES != trailer[1])
+      goto end;
+
+   if (!(entries = (uint64_t*)malloc(count * 16 + 1)))
+      goto end;
+   if (intfstream_read(movie->file, entries, count * 16) == (int64_t)count * 16)
+   {
+      for (i = 0; i < count; i++)
+      {
+         int64_t frame = (int64_t)swap_if_big64(entries[2 * i]);
+         int64_t pos   = (int64_t)swap_if_big64(entries[2 * i + 1]);
+         size_t len    = RBUF_LEN(movie->checkpoints);
+         if (     pos < (int64_t)movie->min_file_pos || pos >= footer_pos
+               || (len && (movie->checkpoints[len - 1].pos   >= pos
+                        || movie->checkpoints[len - 1].frame >= frame)))
+            break;
+         bsv_movie_index_add(movie, frame, pos);
+      }
+      ret = (i == count);
+   }
+   free(entries);
+
+   if (ret)
+   {
+      movie->footer_pos            = footer_pos;
+      movie->checkpoint_scan_pos   = footer_pos;
+      movie->checkpoint_scan_frame = trailer[0];
+   }
+   else
+      bsv_movie_index_reset(movie);
+
+end:
+   intfstream_seek(movie->file, initial_pos, SEEK_SET);
+   return ret;
+}
+
+static bool bsv_movie_write_le32(intfstream_t *file, uint32_t val)
+{
+   val = swap_if_big32(val);
+   return intfstream_write(file, &val, sizeof(val)) == sizeof(val);
+}
+
+static bool bsv_movie_write_le64(intfstream_t *file, uint64_t val)
+{
+   val = swap_if_big64(val);
+   return intfstream_write(file, &val, sizeof(val)) == sizeof(val);
+}
+
+bool bsv_movie_write_index(bsv_movie_t *movie)
+{
+   size_t i, count;
+   uint8_t frame_tok   = REPLAY_TOKEN_CHECKPOINT2_FRAME;
+   uint8_t compression = REPLAY_CHECKPOINT2_COMPRESSION_NONE;
+   uint8_t encoding    = REPLAY_CHECKPOINT2_ENCODING_INDEX;
+   uint8_t key_count   = 0;
+   uint16_t evt_count  = 0;
+   uint32_t payload_len;
+   int64_t footer_pos, last_pos;
+   bool ok;
+
+   if (!movie || movie->playback || movie->version < 2)
+      return false;
+
+   /* Anything rewinding or loading a state didn't account for
+    * gets picked up here */
+   footer_pos = intfstream_get_size(movie->file);
+   bsv_movie_index_scan_to_frame(movie, INT64_MAX);
+
+   count       = RBUF_LEN(movie->checkpoints);
+   payload_len = 4 + count * 16 + REPLAY_INDEX_TRAILER_LEN_BYTES;
+   last_pos    = movie->frame_pos[(MAX(movie->frame_counter, 1) - 1) & movie->frame_mask];
+
+   intfstream_seek(movie->file, footer_pos, SEEK_SET);
+   ok = bsv_movie_write_le32(movie->file, (uint32_t)(footer_pos - MIN(last_pos, footer_pos)))
+      && intfstream_write(movie->file, &key_count, 1) == 1
+      && intfstream_write(movie->file, &evt_count, 2) == 2
+      && intfstream_write(movie->file, &frame_tok, 1) == 1
+      && intfstream_write(movie->file, &compression, 1) == 1
+      && intfstream_write(movie->file, &encoding, 1) == 1
+      /* Readers that don't know the index take it for a checkpoint
+       * they can't decode, so keep the state size plausible */
+      && bsv_movie_write_le32(movie->file, (uint32_t)movie->last_save_size)
+      && bsv_movie_write_le32(movie->file, payload_len)
+      && bsv_movie_write_le32(movie->file, payload_len)
+      && bsv_movie_write_le32(movie->file, (uint32_t)count);
+   for (i = 0; ok && i < count; i++)
+      ok = bsv_movie_write_le64(movie->file, movie->checkpoints[i].frame)
+         && bsv_movie_write_le64(movie->file, movie->checkpoints[i].pos);
+   ok = ok
+      && bsv_movie_write_le32(movie->file, (uint32_t)movie->checkpoint_scan_frame)
+      && bsv_movie_write_le32(movie->file, REPLAY_INDEX_FRAME_PREFIX_BYTES + payload_len)
+      && bsv_movie_write_le32(movie->file, REPLAY_INDEX_MAGIC);
+
+   if (!ok)
+   {
+      RARCH_WARN("[Replay] Failed to write checkpoint index\n");
+      intfstream_truncate(movie->file, footer_pos);
+   }
+   return ok;
+}
 
 bool bsv_movie_reset_playback(bsv_movie_t *handle)
 {
@@ -72,6 +324,7 @@ bool bsv_movie_reset_playback(bsv_movie_t *handle)
    if (intfstream_read(handle->file, header, REPLAY_HEADER_LEN_BYTES) < REPLAY_HEADER_LEN_BYTES)
       return false;
    handle->frame_counter = 0;
+   handle->frame_pos_floor = 0;
    handle->cur_save_valid = false;
 
    state_size = swap_if_big32(header[REPLAY_HEADER_STATE_SIZE_INDEX]);
@@ -155,6 +408,8 @@ bool bsv_movie_reset_recording(bsv_movie_t *handle)
    handle->frame_counter = 0;
    state_size = 2 + bsv_movie_write_checkpoint(handle, compression, encoding);
    handle->min_file_pos = intfstream_tell(handle->file);
+   handle->frame_pos_floor = 0;
+   bsv_movie_index_reset(handle);
    /* Have to write initial state size header too */
    state_size_ = swap_if_big32(state_size);
    intfstream_seek(handle->file, 3*sizeof(uint32_t), SEEK_SET);
@@ -214,7 +469,10 @@ void bsv_movie_frame_rewind()
          uint32s_index_remove_after(handle->blocks, 0);
 #endif
       if (recording)
+      {
          intfstream_truncate(handle->file, (int)handle->min_file_pos);
+         bsv_movie_index_truncate(handle, handle->min_file_pos, 0);
+      }
       else
          bsv_movie_read_next_events(handle, REPLAY_CPBEHAVIOR_DESERIALIZE, true);
    }
@@ -237,9 +495,14 @@ void bsv_movie_frame_rewind()
       if (handle->blocks)
          uint32s_index_remove_after(handle->blocks, handle->frame_counter);
 #endif
+      bsv_movie_fill_frame_pos(handle, handle->frame_counter);
       intfstream_seek(handle->file, (int)handle->frame_pos[handle->frame_counter & handle->frame_mask], SEEK_SET);
       if (recording)
+      {
          intfstream_truncate(handle->file, intfstream_tell(handle->file));
+         bsv_movie_index_truncate(handle, intfstream_tell(handle->file),
+               handle->frame_counter);
+      }
       else
          bsv_movie_read_next_events(handle, REPLAY_CPBEHAVIOR_DESERIALIZE, true);
    }
@@ -605,6 +868,13 @@ bool bsv_movie_read_next_events(bsv_movie_t *handle, replay_checkpoint_behavior
          return false;
       }
    }
+   if (handle->footer_pos && intfstream_tell(handle->file) >= handle->footer_pos)
+   {
+      RARCH_LOG("[Replay] End of replay\n");
+      if (end_movie)
+         input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
+      return false;
+   }
    /* Skip over backref */
    if (handle->version > 1)
       intfstream_seek(handle->file, sizeof(uint32_t), SEEK_CUR);
@@ -759,6 +1029,7 @@ void bsv_movie_scan_from_start(bsv_movie_t *movie, int32_t len)
    intfstream_seek(movie->file, movie->min_file_pos, SEEK_SET);
    movie->frame_counter = 0;
    movie->frame_pos[0] = intfstream_tell(movie->file);
+   movie->frame_pos_floor = 0;
    movie->cur_save_valid = false;
    bsv_movie_scan_to(movie, len);
 }
@@ -833,6 +1104,8 @@ void bsv_movie_next_frame(input_driver_state_t *input_st)
             RARCH_ERR("[Replay] failed to write checkpoint, exiting record\n");
             input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_END;
          }
+         else if (handle->checkpoint_scan_pos == (int64_t)cur_pos)
+            bsv_movie_index_add(handle, handle->frame_counter - 1, cur_pos);
       }
       else
       {
@@ -845,6 +1118,13 @@ void bsv_movie_next_frame(input_driver_state_t *input_st)
          running a frame to get the updated image, then will pause
          again" state. */
       intfstream_truncate(handle->file, intfstream_tell(handle->file));
+      /* Keep the index current as long as it has seen everything
+       * before this frame; otherwise it catches up when next needed */
+      if (handle->checkpoint_scan_pos == (int64_t)cur_pos)
+      {
+         handle->checkpoint_scan_pos   = intfstream_tell(handle->file);
+         handle->checkpoint_scan_frame = handle->frame_counter;
+      }
    }
    else /* either playback or seeking while recording */
    {
@@ -1194,6 +1474,7 @@ bool replay_set_serialized_data(void* buf)
 #endif
             intfstream_rewind(handle->file);
             intfstream_write(handle->file, header, loaded_len);
+            bsv_movie_index_truncate(handle, handle->min_file_pos, 0);
             /* also need to update/reinit frame_pos,
                frame_counter--rewind won't work properly unless we do. */
             /* TODO: in the future, if same_timeline, don't clear
@@ -1216,7 +1497,10 @@ bool replay_set_serialized_data(void* buf)
             /* TODO use backrefs to help here */
             bsv_movie_scan_from_start(handle, loaded_len);
             if (recording)
+            {
                intfstream_truncate(handle->file, loaded_len);
+               bsv_movie_index_truncate(handle, loaded_len, handle->frame_counter);
+            }
          }
       }
       else
@@ -1285,6 +1569,111 @@ int16_t bsv_movie_read_state(input_driver_state_t *input_st,
 }
 
 #ifdef HAVE_STATESTREAM
+/* States smaller than this are compared and hashed on the calling
+ * thread; below it, waking the pool costs more than it saves. */
+#define BSV_PARALLEL_HASH_MIN_BYTES (256 * 1024)
+#define BSV_PARALLEL_HASH_MAX_JOBS  16
+
+struct bsv_block_hash_job
+{
+   const uint32s_index_t *blocks;
+   const uint8_t *state;
+   const uint8_t *last_save; /* NULL if there is nothing to compare against */
+   uint32_t *hashes;
+   uint8_t *same;
+   size_t block_byte_size;
+   size_t first, last;
+};
+
+/* Compares and hashes blocks [first, last) of a state. Only reads the
+ * block index, so any number of these may run side by side. */
+static void bsv_movie_hash_blocks(void *data)
+{
+   struct bsv_block_hash_job *job = (struct bsv_block_hash_job*)data;
+   size_t i;
+   for (i = job->first; i < job->last; i++)
+   {
+      size_t block_start = i * job->block_byte_size;
+      job->same[i] = job->last_save &&
+            memcmp(job->last_save + block_start,
+                   job->state + block_start,
+                   job->block_byte_size) == 0;
+      if (!job->same[i])
+         job->hashes[i] = uint32s_index_hash(job->blocks,
+               (const uint32_t*)(job->state + block_start));
+   }
+}
+
+/* Fills in movie->block_same and movie->block_hashes for every whole
+ * block of the state, splitting the work across the hash pool when the
+ * state is large enough to benefit. Returns false if the scratch
+ * buffers could not be allocated, in which case the caller has to
+ * compare and hash each block itself. */
+static bool bsv_movie_prepare_blocks(bsv_movie_t *movie, const uint8_t *state,
+      size_t block_count, size_t block_byte_size, bool can_compare_saves)
+{
+   struct bsv_block_hash_job job;
+
+   if (movie->block_scratch_len < block_count)
+   {
+      uint32_t *hashes = (uint32_t*)realloc(movie->block_hashes,
+            block_count * sizeof(uint32_t));
+      uint8_t *same;
+      if (!hashes)
+         return false;
+      movie->block_hashes = hashes;
+      if (!(same = (uint8_t*)realloc(movie->block_same, block_count)))
+         return false;
+      movie->block_same        = same;
+      movie->block_scratch_len = block_count;
+   }
+
+   job.blocks          = movie->blocks;
+   job.state           = state;
+   job.last_save       = can_compare_saves ? movie->last_save : NULL;
+   job.hashes          = movie->block_hashes;
+   job.same            = movie->block_same;
+   job.block_byte_size = block_byte_size;
+   job.first           = 0;
+   job.last            = block_count;
+
+#ifdef HAVE_THREADS
+   if (block_count * block_byte_size >= BSV_PARALLEL_HASH_MIN_BYTES)
+   {
+      if (!movie->hash_pool)
+      {
+         unsigned cores = cpu_features_get_core_amount();
+         if (cores > 1 && (movie->hash_pool = tpool_create(cores)))
+            movie->hash_pool_threads = cores;
+      }
+      if (movie->hash_pool)
+      {
+         struct bsv_block_hash_job jobs[BSV_PARALLEL_HASH_MAX_JOBS];
+         size_t i;
+         size_t job_count = MIN(movie->hash_pool_threads,
+               BSV_PARALLEL_HASH_MAX_JOBS);
+         size_t per_job   = (block_count + job_count - 1) / job_count;
+
+         for (i = 0; i < job_count; i++)
+         {
+            jobs[i]       = job;
+            jobs[i].first = i * per_job;
+            jobs[i].last  = MIN(jobs[i].first + per_job, block_count);
+            if (jobs[i].first >= jobs[i].last)
+               break;
+            if (!tpool_add_work(movie->hash_pool, bsv_movie_hash_blocks, &jobs[i]))
+               bsv_movie_hash_blocks(&jobs[i]);
+         }
+         tpool_wait(movie->hash_pool);
+         return true;
+      }
+   }
+#endif
+
+   bsv_movie_hash_blocks(&job);
+   return true;
+}
+
 int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state, size_t state_size, uint8_t *output, size_t output_capacity)
 {
    static uint32_t skipped_blocks = 0;
@@ -1308,6 +1697,7 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state, size_t
    int64_t encoded_size;
    size_t superblock, block;
    uint32_t i;
+   bool prepared;
    bool can_compare_saves = movie->cur_save_valid && movie->last_save && movie->last_save_size >= state_size;
    if (movie->last_save_size < state_size)
    {
@@ -1319,6 +1709,11 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state, size_t
       movie->cur_save_valid = false;
       movie->superblock_seq = calloc(superblock_count, sizeof(uint32_t));
    }
+   /* Do the expensive part (comparing and hashing every whole block)
+    * up front, possibly in parallel; the index itself is only touched
+    * from this thread below. */
+   prepared = bsv_movie_prepare_blocks(movie, state,
+         state_size / block_byte_size, block_byte_size, can_compare_saves);
    rmsgpack_write_int(out_stream, BSV_IFRAME_START_TOKEN);
    rmsgpack_write_int(out_stream, movie->frame_counter);
    for(superblock = 0; superblock < superblock_count; superblock++)
@@ -1335,47 +1730,65 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state, size_t
             found_block.index = 0;
             found_block.is_new = false;
          }
-         else if (can_compare_saves &&
-                  (++memcmps) &&
+         else
+         {
+            bool is_tail = block_start + block_byte_size > state_size;
+            bool same;
+            if (can_compare_saves)
+               memcmps++;
+            if (prepared && !is_tail)
+               same = movie->block_same[block_start / block_byte_size];
+            else
+               same = can_compare_saves &&
                   memcmp(movie->last_save + block_start,
                          state + block_start,
-                         block_end-block_start) == 0)
-         {
-            skipped_blocks++;
-            found_block.index = uint32s_index_get(movie->superblocks,
-                                                  movie->superblock_seq[superblock])[block];
-            found_block.is_new = false;
-            /* bump usage count */
-            uint32s_index_bump_count(movie->blocks, found_block.index);
-         }
-         else if(block_start + block_byte_size > state_size)
-         {
-            if(!padded_block)
-               padded_block = calloc(block_byte_size, sizeof(uint8_t));
+                         block_end-block_start) == 0;
+            if (same)
+            {
+               skipped_blocks++;
+               found_block.index = uint32s_index_get(movie->superblocks,
+                                                     movie->superblock_seq[superblock])[block];
+               found_block.is_new = false;
+               /* bump usage count */
+               uint32s_index_bump_count(movie->blocks, found_block.index);
+            }
+            else if (is_tail)
+            {
+               if(!padded_block)
+                  padded_block = calloc(block_byte_size, sizeof(uint8_t));
+               else
+                  memset(padded_block+(state_size-block_start),
+                        0,
+                        block_byte_size-(state_size-block_start));
+               memcpy(padded_block, state+block_start, state_size - block_start);
+               found_block = uint32s_index_insert(movie->blocks,
+                                                  (uint32_t*)padded_block,
+                                                  movie->frame_counter);
+               hashes++;
+            }
             else
-               memset(padded_block+(state_size-block_start),
-                     0,
-                     block_byte_size-(state_size-block_start));
-            memcpy(padded_block, state+block_start, state_size - block_start);
-            found_block = uint32s_index_insert(movie->blocks,
-                                               (uint32_t*)padded_block,
-                                               movie->frame_counter);
-            hashes++;
-         }
-         else
-         {
-            hashes++;
-            found_block = uint32s_index_insert(movie->blocks,
-                                               (uint32_t*)(state+block_start),
-                                               movie->frame_counter);
+            {
+               uint32_t *object = (uint32_t*)(state+block_start);
+               hashes++;
+               found_block = uint32s_index_insert_hashed(movie->blocks, object,
+                     prepared
+                     ? movie->block_hashes[block_start / block_byte_size]
+                     : uint32s_index_hash(movie->blocks, object),
+                     movie->frame_counter);
+            }
          }
          total_blocks++;
          if(found_block.is_new)
          {
-            /* write "here is a new block" and new block to file */
+            /* write "here is a new block" and new block to file;
+             * the tail block must come from the padded copy so we
+             * never read past the end of the state */
             rmsgpack_write_int(out_stream, BSV_IFRAME_NEW_BLOCK_TOKEN);
             rmsgpack_write_int(out_stream, found_block.index);
-            rmsgpack_write_bin(out_stream, state+block_start, block_byte_size);
+            rmsgpack_write_bin(out_stream,
+                  (block_start + block_byte_size > state_size)
+                  ? padded_block : state+block_start,
+                  block_byte_size);
          }
          else
             reused_blocks++;
@@ -1415,6 +1828,7 @@ int64_t bsv_movie_write_deduped_state(bsv_movie_t *movie, uint8_t *state, size_t
    RARCH_DBG("[STATESTREAM] Encode stats at checkpoint %d: %d blocks (%d reused, %d skipped [%d checks], %d distinct [%d hashes])\n", total_checkpoints, total_blocks, reused_blocks, skipped_blocks, memcmps, uint32s_index_count(movie->blocks), hashes);
    RARCH_DBG("[STATESTREAM] %d superblocks (%d reused, %d distinct); unencoded size (KB) %d, encoded size (KB) %d; net time (secs) %f\n", total_superblocks, reused_superblocks, uint32s_index_count(movie->superblocks), total_kbs_input, total_kbs_written, ((float)total_encode_micros) / (float)1000000.0);
    intfstream_close(out_stream);
+   free(out_stream);
    return encoded_size;
 }
 
@@ -1593,6 +2007,7 @@ exit:
    /* uint32s_index_commit(movie->superblocks); */
    rmsgpack_dom_reader_state_free(reader_state);
    intfstream_close(read_mem);
+   free(read_mem);
    if(!ret)
    {
       RARCH_ERR("[STATESTREAM] made it to end without superblock seq\n");
@@ -1621,6 +2036,8 @@ bool bsv_movie_peek_frame_info(bsv_movie_t *movie, uint8_t *token, uint64_t *len
    if (!movie || movie->version == 0)
       return ret;
    pos = intfstream_tell(movie->file);
+   if (movie->footer_pos && pos >= movie->footer_pos)
+      goto end;
    if (movie->version > 1 &&
          intfstream_seek(movie->file, sizeof(uint32_t), SEEK_CUR) < 0)
       goto end;
@@ -1684,37 +2101,26 @@ bool movie_find_checkpoint_before(bsv_movie_t *movie, int64_t frame, bool consid
    runloop_state_t *runloop_st = runloop_state_get_ptr();
    bool paused = !!(runloop_st->flags & RUNLOOP_FLAG_PAUSED) || consider_paused;
    const int64_t prev_skip_min_distance = 60;
-   int64_t target_frame = frame, cur_frame = 0;
-   bool ret = false;
-   int64_t initial_pos, cp_pos=-1, cp_frame=-1;
-   uint64_t frame_len;
-   uint8_t tok;
+   int64_t target_frame = frame;
+   int64_t cp_pos=-1, cp_frame=-1;
+   size_t found;
    if (!movie || movie->version == 0)
       return false;
-   initial_pos = intfstream_tell(movie->file);
-   /* Find the right checkpoint to jump to.
-      In the future, backrefs could be used to make this faster */
-   intfstream_seek(movie->file, movie->min_file_pos, SEEK_SET);
-   while (cur_frame < target_frame && bsv_movie_peek_frame_info(movie, &tok, &frame_len))
+   /* Find the right checkpoint to jump to. The index only has to be
+      extended over the part of the file nobody has looked at yet,
+      and not at all for a finished replay with an index footer. */
+   bsv_movie_index_scan_to_frame(movie, target_frame);
+   found = bsv_movie_index_count_to_frame(movie,
+         paused ? target_frame - 1 : target_frame - prev_skip_min_distance);
+   if (found > 0)
    {
-      if (tok == REPLAY_TOKEN_INVALID)
-         break;
-      if (tok == REPLAY_TOKEN_CHECKPOINT_FRAME || tok == REPLAY_TOKEN_CHECKPOINT2_FRAME)
-      {
-         if (target_frame - cur_frame >= prev_skip_min_distance || paused)
-         {
-            cp_pos = intfstream_tell(movie->file);
-            cp_frame = cur_frame;
-         }
-      }
-      cur_frame += 1;
-      intfstream_seek(movie->file, frame_len, SEEK_CUR);
+      cp_pos   = movie->checkpoints[found - 1].pos;
+      cp_frame = movie->checkpoints[found - 1].frame;
    }
    if (cp_pos_out)
       *cp_pos_out = cp_pos;
    if (cp_frame_out)
       *cp_frame_out = cp_frame;
-   intfstream_seek(movie->file, initial_pos, SEEK_SET);
    return cp_frame;
 }
 
@@ -1733,6 +2139,41 @@ bool movie_seek_to_frame(input_driver_state_t *input_st, int64_t frame)
    input_st->bsv_movie_state.flags |= BSV_FLAG_MOVIE_SEEK_TO_FRAME;
    return true;
 }
+/* Jumps straight to an indexed checkpoint instead of reading every
+ * frame on the way. Incremental checkpoints only decode on top of the
+ * ones before them, so any in between are still loaded into the block
+ * index (and nothing else is read); going backwards has to start over
+ * for the same reason. */
+static bool bsv_movie_seek_to_checkpoint(bsv_movie_t *movie, size_t which)
+{
+   struct bsv_checkpoint_ref target = movie->checkpoints[which];
+   size_t i;
+   if (target.pos < intfstream_tell(movie->file))
+   {
+      if (!bsv_movie_reset_playback(movie))
+         return false;
+      /* Only a checkpoint on the very first frame can still be behind
+       * us, and resetting has just loaded it */
+      if (target.pos < intfstream_tell(movie->file))
+         return true;
+   }
+   for (i = bsv_movie_index_find_pos(movie, intfstream_tell(movie->file));
+         i < which; i++)
+   {
+      intfstream_seek(movie->file, movie->checkpoints[i].pos, SEEK_SET);
+      movie->frame_counter = movie->checkpoints[i].frame;
+      if (!bsv_movie_read_next_events(movie, REPLAY_CPBEHAVIOR_UPDATE, false))
+         return false;
+   }
+   movie->frame_counter   = target.frame;
+   movie->frame_pos_floor = target.frame;
+   movie->frame_pos[target.frame & movie->frame_mask] = target.pos;
+   if (target.frame > 0)
+      bsv_movie_fill_frame_pos(movie, target.frame - 1);
+   intfstream_seek(movie->file, target.pos, SEEK_SET);
+   return bsv_movie_read_next_events(movie, REPLAY_CPBEHAVIOR_DESERIALIZE, false);
+}
+
 bool bsv_movie_seek_to_pos_impl(bsv_movie_t *movie, int64_t pos)
 {
    /* TODO:
@@ -1746,6 +2187,13 @@ bool bsv_movie_seek_to_pos_impl(bsv_movie_t *movie, int64_t pos)
    movie_pos = intfstream_tell(movie->file);
    if (pos == movie_pos)
       return true;
+   if (movie->version > 1)
+   {
+      size_t which = bsv_movie_index_find_pos(movie, pos);
+      if (     which < RBUF_LEN(movie->checkpoints)
+            && movie->checkpoints[which].pos == pos)
+         return bsv_movie_seek_to_checkpoint(movie, which);
+   }
    /* assume file is at a frame boundary and frame is at a checkpoint boundary. */
    if (pos < movie_pos)
       /* TODO: this could be made more efficient with backrefs if we
@@ -24,6 +24,20 @@
 #define REPLAY_FORMAT_VERSION            2
 #define REPLAY_MAGIC                     0x42535632
 
+/* A finished recording ends with a checkpoint index, stored as the
+   payload of a CHECKPOINT2 frame with REPLAY_CHECKPOINT2_ENCODING_INDEX:
+     uint32 entry count
+     entries: uint64 frame, uint64 file offset of the frame
+     uint32 frame count
+     uint32 footer length (from the start of the frame to end of file)
+     uint32 REPLAY_INDEX_MAGIC
+   all little-endian, so the last 12 bytes of the file locate it. */
+#define REPLAY_INDEX_MAGIC               0x42535649
+#define REPLAY_INDEX_TRAILER_LEN_BYTES   (3*4)
+/* backref, key event count, input event count, frame token,
+   compression, encoding, then the three checkpoint sizes */
+#define REPLAY_INDEX_FRAME_PREFIX_BYTES  (4+1+2+1+1+1+3*4)
+
 
 RETRO_BEGIN_DECLS
 
@@ -42,6 +56,9 @@ bool bsv_movie_load_checkpoint(bsv_movie_t *movie,
 int64_t bsv_movie_write_checkpoint(bsv_movie_t *movie,
       uint8_t compression, uint8_t encoding);
 
+bool bsv_movie_read_index(bsv_movie_t *movie);
+bool bsv_movie_write_index(bsv_movie_t *movie);
+
 RETRO_END_DECLS
 
 #endif /* __BSV_MOVIE__H */
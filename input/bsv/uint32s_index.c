@@ -9,7 +9,10 @@
 #include <xxHash/xxhash.h>
 
 #define HASHMAP_CAP (1<<16)
-#define uint32s_hash_bytes(bytes, len) XXH32(bytes,len,0)
+/* XXH3 vectorizes well on every target we care about and is much
+ * faster than XXH32 on block-sized inputs. Hashes are never written
+ * to replay files, so the choice of function is not part of the format. */
+#define uint32s_hash_bytes(bytes, len) ((uint32_t)XXH3_64bits(bytes,len))
 
 uint32s_index_t *uint32s_index_new(size_t object_size, uint8_t commit_interval, uint8_t commit_threshold)
 {
@@ -108,12 +111,23 @@ bool uint32s_bucket_remove(struct uint32s_bucket *bucket, uint32_t idx)
    return false;
 }
 
+uint32_t uint32s_index_hash(const uint32s_index_t *index, const uint32_t *object)
+{
+   return uint32s_hash_bytes((const uint8_t *)object,
+         index->object_size * sizeof(uint32_t));
+}
+
 uint32s_insert_result_t uint32s_index_insert(uint32s_index_t *index, uint32_t *object, uint64_t frame)
+{
+   return uint32s_index_insert_hashed(index, object,
+         uint32s_index_hash(index, object), frame);
+}
+
+uint32s_insert_result_t uint32s_index_insert_hashed(uint32s_index_t *index, uint32_t *object, uint32_t hash, uint64_t frame)
 {
    struct uint32s_bucket *bucket;
    uint32s_insert_result_t result;
    size_t size_bytes = index->object_size * sizeof(uint32_t);
-   uint32_t hash = uint32s_hash_bytes((uint8_t *)object, size_bytes);
    uint32_t idx;
    uint32_t *copy;
    uint32_t additions_len = RBUF_LEN(index->additions);
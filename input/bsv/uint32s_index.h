@@ -47,6 +47,11 @@ RETRO_BEGIN_DECLS
 uint32s_index_t *uint32s_index_new(size_t object_size, uint8_t commit_interval, uint8_t commit_threshold);
 /* Does not take ownership of object */
 uint32s_insert_result_t uint32s_index_insert(uint32s_index_t *index, uint32_t *object, uint64_t frame);
+/* Hash an object the same way uint32s_index_insert() would; safe to call
+ * from several threads at once since it does not touch the index. */
+uint32_t uint32s_index_hash(const uint32s_index_t *index, const uint32_t *object);
+/* As uint32s_index_insert(), with a hash precomputed by uint32s_index_hash() */
+uint32s_insert_result_t uint32s_index_insert_hashed(uint32s_index_t *index, uint32_t *object, uint32_t hash, uint64_t frame);
 /* Does take ownership, requires idx is the exact next index and object not in index */
 bool uint32s_index_insert_exact(uint32s_index_t *index, uint32_t idx, uint32_t *object, uint64_t frame);
 /* Does not grant ownership of return value */
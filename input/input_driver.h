@@ -139,6 +139,10 @@
 */
 #define REPLAY_CHECKPOINT2_ENCODING_RAW 0
 #define REPLAY_CHECKPOINT2_ENCODING_STATESTREAM 1
+/* Not a checkpoint at all: the checkpoint index footer written at the
+   end of a finished recording, disguised as a CHECKPOINT2 frame so
+   that readers which don't know about it skip over it. */
+#define REPLAY_CHECKPOINT2_ENCODING_INDEX 0xFF
 
 /**
  * Takes as input analog key identifiers and converts them to corresponding
@@ -244,6 +248,13 @@ struct bsv_input_data
 };
 typedef struct bsv_input_data bsv_input_data_t;
 
+/* Where a checkpoint frame starts, and which (zero-based) frame it is */
+struct bsv_checkpoint_ref
+{
+   int64_t frame;
+   int64_t pos;
+};
+
 struct bsv_movie
 {
    intfstream_t *file;
@@ -256,6 +267,18 @@ struct bsv_movie
    size_t *frame_pos;
    size_t frame_mask;
    uint64_t frame_counter;
+   /* frame_pos is only known to be right from this frame onwards;
+    * older entries are recovered from backrefs when rewinding. */
+   uint64_t frame_pos_floor;
+
+   /* An rbuf of every checkpoint in the file, sorted by position.
+    * It is complete up to checkpoint_scan_pos (which is the start of
+    * frame checkpoint_scan_frame); past that the file is unscanned. */
+   struct bsv_checkpoint_ref *checkpoints;
+   int64_t checkpoint_scan_pos;
+   int64_t checkpoint_scan_frame;
+   /* Start of the index footer in a finished replay, or 0 */
+   int64_t footer_pos;
 
    /* Staging variables for events */
    uint8_t key_event_count;
@@ -275,6 +298,17 @@ struct bsv_movie
    uint32s_index_t *blocks;
    uint32_t *superblock_seq;
    uint8_t commit_interval, commit_threshold;
+   /* Per-block scratch filled in before blocks are looked up:
+    * whether each block is unchanged since the last checkpoint
+    * and, if not, its hash. */
+   uint32_t *block_hashes;
+   uint8_t *block_same;
+   size_t block_scratch_len;
+#ifdef HAVE_THREADS
+   /* Created on first use to hash large states in parallel */
+   struct tpool *hash_pool;
+   unsigned hash_pool_threads;
+#endif
 #endif
 
    uint8_t checkpoint_compression, checkpoint_encoding;
@@ -380,6 +414,7 @@ typedef struct input_remote_state
 typedef struct input_list_element_t
 {
    int16_t *state;
+   uint32_t *queried; /* Bitmap of the ids the core has requested */
    unsigned port;
    unsigned device;
    unsigned index;
@@ -3456,6 +3456,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_THREADED,
+   "rewind_threaded"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_COMPRESSION,
+   "rewind_compression"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_SETTINGS,
    "rewind_settings"
@@ -3582,6 +3590,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,
    "savestate_file_compression"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SAVE_COMPRESSION_ZSTD,
+   "save_compression_zstd"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,
    "savestate_auto_save"
@@ -3802,6 +3814,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,
    "run_ahead_hide_warnings"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_STATE_CACHE,
+   "run_ahead_state_cache"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD,
+   "run_ahead_secondary_thread"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
    "run_ahead_frames"
@@ -3967,6 +3987,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "menu_thumbnail_upscale_threshold"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_ENABLE,
+   "menu_thumbnail_cache_enable"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,
    "rgui_thumbnail_downscaler"
@@ -4584,6 +4584,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
    "Hide the warning message that appears when using Run-Ahead and the core does not support save states."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_STATE_CACHE,
+   "Reload Only on Input Change"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREAD,
+   "Threaded Second Instance"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREAD,
+   "In Second Instance Mode, run the second instance on its own thread. It runs the next frame while the current one is presented, so run-ahead no longer doubles the time spent in the core per frame. Only used by software rendered cores."
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_STATE_CACHE,
+   "In Single Instance Mode, keep the core running ahead while input does not change and only reload the state when it does. Greatly reduces CPU usage. Not used while rewind or achievements are enabled."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PREEMPT_FRAMES,
    "Number of Preemptive Frames"
@@ -4951,6 +4967,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION,
    "Write save state files in an archived format. Dramatically reduces file size at the expense of increased saving/loading times."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SAVE_COMPRESSION_ZSTD,
+   "Zstandard Compression"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SAVE_COMPRESSION_ZSTD,
+   "Compress SaveRAM, save state and core backup files with Zstandard instead of zlib. Saves much faster at a similar file size, but the files cannot be loaded by older versions of RetroArch."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SORT_SCREENSHOTS_BY_CONTENT_ENABLE,
    "Sort Screenshots into Folders by Content Directory"
@@ -5219,6 +5243,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+   "Threaded Rewind"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_THREADED,
+   "Compress rewind states on a separate thread. Reduces stuttering with large save states at the cost of extra memory."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_COMPRESSION,
+   "Rewind Buffer Compression"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_COMPRESSION,
+   "Compress rewind states further to fit more history into the rewind buffer. Uses some additional CPU time."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -7189,6 +7229,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "Automatically upscale thumbnail images with a width/height smaller than the specified value. Improves picture quality. Has a moderate performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_ENABLE,
+   "Thumbnail Cache"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_ENABLE,
+   "Store decoded and upscaled thumbnails in the '.cache' folder of the Thumbnails directory, and keep recently shown ones in video memory. Thumbnails show up faster when scrolling back through a playlist, at the cost of disk space."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_BACKGROUND_ENABLE,
    "Thumbnail Backgrounds"
@@ -15270,6 +15318,10 @@ MSG_HASH(
    MSG_REWIND_INIT_FAILED_THREADED_AUDIO,
    "Implementation uses threaded audio. Cannot use rewind."
    )
+MSG_HASH(
+   MSG_REWIND_HISTORY,
+   "Current history: %.1f seconds (%u states, %u MB used)"
+   )
 MSG_HASH(
    MSG_REWIND_REACHED_END,
    "Reached end of rewind buffer."
@@ -15914,6 +15966,10 @@ MSG_HASH(
    MSG_RESAMPLER_QUALITY_HIGHEST,
    "Highest"
    )
+MSG_HASH(
+   MSG_RESAMPLER_QUALITY_POLYPHASE,
+   "Normal (Polyphase)"
+   )
 MSG_HASH(
    MSG_MISSING_ASSETS,
    "Warning: Missing assets, use the Online Updater if available."
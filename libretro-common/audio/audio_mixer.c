@@ -206,6 +206,16 @@ static unsigned s_rate = 0;
 
 static void audio_mixer_release(audio_mixer_voice_t* voice);
 
+/* Voices come and go on the main thread, so don't have
+ * each of them build a polyphase table for itself */
+static enum resampler_quality audio_mixer_resampler_quality(
+      enum resampler_quality quality)
+{
+   if (quality == RESAMPLER_QUALITY_POLYPHASE)
+      return RESAMPLER_QUALITY_NORMAL;
+   return quality;
+}
+
 #ifdef HAVE_RWAV
 static bool wav_to_float(const rwav_t* wav, float** pcm, size_t len)
 {
@@ -292,7 +302,8 @@ static bool one_shot_resample(const float* in, size_t samples_in,
    float ratio                        = (double)s_rate / (double)rate;
 
    if (!retro_resampler_realloc(&data, &resampler,
-         resampler_ident, quality, ratio))
+         resampler_ident,
+         audio_mixer_resampler_quality(quality), ratio))
       return false;
 
    /* Allocate on a 16-byte boundary, and pad to a multiple of 16 bytes. We
@@ -574,8 +585,8 @@ static bool audio_mixer_play_ogg(
       ratio = (double)s_rate / (double)info.sample_rate;
 
       if (!retro_resampler_realloc(&resampler_data,
-               &resamp, resampler_ident, quality,
-               ratio))
+               &resamp, resampler_ident,
+               audio_mixer_resampler_quality(quality), ratio))
          goto error;
    }
 
@@ -728,8 +739,8 @@ static bool audio_mixer_play_flac(
       ratio = (double)s_rate / (double)(dr_flac->sampleRate);
 
       if (!retro_resampler_realloc(&resampler_data,
-               &resamp, resampler_ident, quality,
-               ratio))
+               &resamp, resampler_ident,
+               audio_mixer_resampler_quality(quality), ratio))
          goto error;
    }
 
@@ -803,8 +814,8 @@ static bool audio_mixer_play_mp3(
       ratio = (double)s_rate / (double)(voice->types.mp3.stream.sampleRate);
 
       if (!retro_resampler_realloc(&resampler_data,
-               &resamp, resampler_ident, quality,
-               ratio))
+               &resamp, resampler_ident,
+               audio_mixer_resampler_quality(quality), ratio))
          goto error;
    }
 
@@ -0,0 +1,82 @@
+/* Copyright  (C) 2010-2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (s16_resample.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_miscellaneous.h>
+#include <audio/conversion/s16_to_float.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_resample.h>
+
+size_t convert_s16_resample(
+      const retro_resampler_t *resampler, void *resampler_data,
+      const int16_t *in, size_t frames, float gain, double ratio,
+      float *scratch, float *out, int16_t *out_s16,
+      s16_resample_mix_t mix, void *mix_data)
+{
+   struct resampler_data src_data;
+   size_t out_frames      = 0;
+   /* Frames of out already converted to out_s16. Kept at a
+    * multiple of 4 so that every conversion starts on the same
+    * 16-byte alignment as the buffers themselves, which some
+    * SIMD paths (PSP) require. */
+   size_t s16_frames      = 0;
+
+   src_data.data_in       = scratch;
+   src_data.ratio         = ratio;
+
+   while (frames)
+   {
+      size_t chunk        = MIN(frames, S16_RESAMPLE_CHUNK_FRAMES);
+      float *dst          = out + out_frames * 2;
+
+      convert_s16_to_float(scratch, in, chunk * 2, gain);
+
+      src_data.data_out      = dst;
+      src_data.input_frames  = chunk;
+      src_data.output_frames = 0;
+      resampler->process(resampler_data, &src_data);
+
+      if (src_data.output_frames && mix)
+         mix(dst, src_data.output_frames, mix_data);
+
+      out_frames         += src_data.output_frames;
+      in                 += chunk * 2;
+      frames             -= chunk;
+
+      if (out_s16 && (out_frames & ~(size_t)3) > s16_frames)
+      {
+         size_t ready     = out_frames & ~(size_t)3;
+         convert_float_to_s16(out_s16 + s16_frames * 2,
+               out + s16_frames * 2, (ready - s16_frames) * 2);
+         s16_frames       = ready;
+      }
+   }
+
+   /* The last few frames, if any */
+   if (out_s16 && out_frames > s16_frames)
+      convert_float_to_s16(out_s16 + s16_frames * 2,
+            out + s16_frames * 2, (out_frames - s16_frames) * 2);
+
+   return out_frames;
+}
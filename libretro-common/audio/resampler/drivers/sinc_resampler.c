@@ -28,12 +28,14 @@
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
 #include <retro_environment.h>
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <filters.h>
 #include <memalign.h>
 
@@ -44,7 +46,20 @@
 #include <xmmintrin.h>
 #endif
 
-#if defined(__AVX__)
+/* The AVX2/FMA polyphase kernel is built with a target attribute,
+ * so it is compiled in regardless of -march and only picked when
+ * the CPU reports AVX2 and FMA at runtime. */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SINC_AVX2_FMA
+#define SINC_AVX2_FMA_TARGET __attribute__((target("avx2,fma")))
+#include <cpuid.h>
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) && _MSC_VER >= 1910
+#define SINC_AVX2_FMA
+#define SINC_AVX2_FMA_TARGET
+#include <intrin.h>
+#endif
+
+#if defined(__AVX__) || defined(SINC_AVX2_FMA)
 #include <immintrin.h>
 #endif
 
@@ -58,6 +73,25 @@
 
 /* TODO, make all this more configurable. */
 
+/* Polyphase mode.
+ *
+ * For POLYPHASE quality NORMAL's interpolated Kaiser table is replaced
+ * by one dense enough to be used without interpolation: every
+ * output sample is a single dot product against a precomputed
+ * phase filter. The phase count is a multiple of the numerator
+ * of the reduced out/in rate ratio (e.g. 160 for 44100 -> 48000 Hz),
+ * so at that ratio every output lands exactly on a phase. Dynamic
+ * rate control then only nudges the step, and picks the nearest
+ * of at least SINC_POLYPHASE_MIN_PHASES phases. */
+#define SINC_POLYPHASE_MIN_PHASES     8192
+#define SINC_POLYPHASE_MAX_NUMERATOR  4096
+/* Input rates are floats, ratios within this are the same fraction */
+#define SINC_POLYPHASE_RATIO_EPSILON  1e-7
+#define SINC_POLYPHASE_SUBPHASE_BITS  12
+#define SINC_POLYPHASE_MAX_TABLE_SIZE (1 << 20)
+/* Input frames laid out per pass, see resampler_sinc_process_polyphase() */
+#define SINC_POLYPHASE_BLOCK          256
+
 enum sinc_window
 {
    SINC_WINDOW_NONE   = 0,
@@ -80,16 +114,35 @@ typedef struct rarch_sinc_resampler
    float *phase_table;
    float *buffer_l;
    float *buffer_r;
+   resampler_process_t process;
+   double poly_ratio;
    unsigned phase_bits;
    unsigned subphase_bits;
    unsigned subphase_mask;
    unsigned taps;
    unsigned ptr;
+   /* Time units per input sample */
+   uint32_t phases;
+   /* Exact step at poly_ratio, 0 unless in polyphase mode */
+   uint32_t poly_step;
    uint32_t time;
    float subphase_mod;
    float kaiser_beta;
 } rarch_sinc_resampler_t;
 
+static INLINE uint32_t resampler_sinc_step(
+      const rarch_sinc_resampler_t *resamp, double ratio)
+{
+   if (resamp->poly_step)
+   {
+      if (fabs(ratio - resamp->poly_ratio)
+            <= resamp->poly_ratio * SINC_POLYPHASE_RATIO_EPSILON)
+         return resamp->poly_step;
+      return (uint32_t)(resamp->phases / ratio + 0.5);
+   }
+   return resamp->phases / ratio;
+}
+
 #if (defined(__ARM_NEON__) || defined(HAVE_NEON))
 
 #ifdef HAVE_ARM_NEON_ASM_OPTIMIZATIONS
@@ -104,8 +157,8 @@ void process_sinc_neon_asm(float *out, const float *left,
 static void resampler_sinc_process_neon_kaiser(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
-   uint32_t ratio                 = phases / data->ratio;
+   unsigned phases                = resamp->phases;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -178,8 +231,8 @@ static void resampler_sinc_process_neon_kaiser(void *re_, struct resampler_data
 static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
-   uint32_t ratio                 = phases / data->ratio;
+   unsigned phases                = resamp->phases;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -250,9 +303,9 @@ static void resampler_sinc_process_neon(void *re_, struct resampler_data *data)
 static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   unsigned phases                = resamp->phases;
 
-   uint32_t ratio                 = phases / data->ratio;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -332,9 +385,9 @@ static void resampler_sinc_process_avx_kaiser(void *re_, struct resampler_data *
 static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases    = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   unsigned phases    = resamp->phases;
 
-   uint32_t ratio     = phases / data->ratio;
+   uint32_t ratio     = resampler_sinc_step(resamp, data->ratio);
    const float *input = data->data_in;
    float *output      = data->data_out;
    size_t frames      = data->input_frames;
@@ -412,9 +465,9 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   unsigned phases                = resamp->phases;
 
-   uint32_t ratio                 = phases / data->ratio;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -505,9 +558,9 @@ static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *
 static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   unsigned phases                = resamp->phases;
 
-   uint32_t ratio                 = phases / data->ratio;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -594,9 +647,9 @@ static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
 static void resampler_sinc_process_c_kaiser(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   unsigned phases                = resamp->phases;
 
-   uint32_t ratio                 = phases / data->ratio;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -660,9 +713,9 @@ static void resampler_sinc_process_c_kaiser(void *re_, struct resampler_data *da
 static void resampler_sinc_process_c(void *re_, struct resampler_data *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
-   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+   unsigned phases                = resamp->phases;
 
-   uint32_t ratio                 = phases / data->ratio;
+   uint32_t ratio                 = resampler_sinc_step(resamp, data->ratio);
    const float *input             = data->data_in;
    float *output                  = data->data_out;
    size_t frames                  = data->input_frames;
@@ -720,6 +773,240 @@ static void resampler_sinc_process_c(void *re_, struct resampler_data *data)
    data->output_frames = out_frames;
 }
 
+/* Polyphase kernels.
+ *
+ * Instead of pushing every input sample into the ring buffer right
+ * before it is read back (which stalls on store forwarding once the
+ * dot product is vectorized), a block of input is laid out newest
+ * first below the history in one go, and every output is a plain
+ * dot product against it. */
+
+typedef void (*sinc_dot_t)(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps);
+
+static INLINE void resampler_sinc_process_polyphase(
+      rarch_sinc_resampler_t *resamp, struct resampler_data *data,
+      sinc_dot_t dot)
+{
+   unsigned phases    = resamp->phases;
+   uint32_t ratio     = resampler_sinc_step(resamp, data->ratio);
+   uint32_t time      = resamp->time;
+   const float *input = data->data_in;
+   float *output      = data->data_out;
+   size_t frames      = data->input_frames;
+   size_t out_frames  = 0;
+   unsigned taps      = resamp->taps;
+   /* History, newest first, lives right above the block */
+   float *hist_l      = resamp->buffer_l + SINC_POLYPHASE_BLOCK;
+   float *hist_r      = resamp->buffer_r + SINC_POLYPHASE_BLOCK;
+
+   while (frames)
+   {
+      size_t i;
+      size_t n       = MIN(frames, SINC_POLYPHASE_BLOCK);
+      const float *l = hist_l;
+      const float *r = hist_r;
+
+      for (i = 0; i < n; i++)
+      {
+         hist_l[-1 - (ptrdiff_t)i] = input[0];
+         hist_r[-1 - (ptrdiff_t)i] = input[1];
+         input                    += 2;
+      }
+      frames        -= n;
+
+      for (;;)
+      {
+         while (time >= phases)
+         {
+            if (!n)
+               goto next_block;
+            l--;
+            r--;
+            n--;
+            time    -= phases;
+         }
+
+         dot(output, l, r,
+               resamp->phase_table + (time >> resamp->subphase_bits) * taps,
+               taps);
+         output     += 2;
+         out_frames++;
+         time       += ratio;
+      }
+
+next_block:
+      memmove(hist_l, l, taps * sizeof(float));
+      memmove(hist_r, r, taps * sizeof(float));
+   }
+
+   resamp->time        = time;
+   data->output_frames = out_frames;
+}
+
+static INLINE void sinc_dot_c(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   float sum_l = 0.0f;
+   float sum_r = 0.0f;
+
+   for (i = 0; i < taps; i++)
+   {
+      sum_l += left[i]  * coeff[i];
+      sum_r += right[i] * coeff[i];
+   }
+
+   out[0] = sum_l;
+   out[1] = sum_r;
+}
+
+static void resampler_sinc_process_polyphase_c(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_c);
+}
+
+#if defined(__SSE__)
+/* Assumes that taps is a multiple of 4. */
+static INLINE void sinc_dot_sse(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   __m128 sum;
+   __m128 sum_l = _mm_setzero_ps();
+   __m128 sum_r = _mm_setzero_ps();
+
+   for (i = 0; i < taps; i += 4)
+   {
+      __m128 _sinc = _mm_load_ps(coeff + i);
+      sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(_mm_loadu_ps(left  + i), _sinc));
+      sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(_mm_loadu_ps(right + i), _sinc));
+   }
+
+   /* { l0 + l2, l1 + l3, r0 + r2, r1 + r3 } */
+   sum = _mm_add_ps(_mm_movelh_ps(sum_l, sum_r), _mm_movehl_ps(sum_r, sum_l));
+   /* { L, X, R, X } */
+   sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+   _mm_store_ss(out + 0, sum);
+   _mm_store_ss(out + 1, _mm_movehl_ps(sum, sum));
+}
+
+static void resampler_sinc_process_polyphase_sse(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_sse);
+}
+#endif
+
+#if defined(SINC_AVX2_FMA)
+/* Assumes that taps is a multiple of 8. */
+static INLINE SINC_AVX2_FMA_TARGET void sinc_dot_avx2_fma(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   __m128 sum;
+   __m256 sum_l = _mm256_setzero_ps();
+   __m256 sum_r = _mm256_setzero_ps();
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 sinc = _mm256_load_ps(coeff + i);
+      sum_l       = _mm256_fmadd_ps(_mm256_loadu_ps(left  + i), sinc, sum_l);
+      sum_r       = _mm256_fmadd_ps(_mm256_loadu_ps(right + i), sinc, sum_r);
+   }
+
+   /* { l01, l23, r01, r23 | l45, l67, r45, r67 } */
+   sum_l = _mm256_hadd_ps(sum_l, sum_r);
+   /* { l0145, l2367, r0145, r2367 } */
+   sum   = _mm_add_ps(_mm256_castps256_ps128(sum_l),
+         _mm256_extractf128_ps(sum_l, 1));
+   /* { L, R, L, R } */
+   sum   = _mm_hadd_ps(sum, sum);
+   _mm_storel_pi((__m64*)out, sum);
+}
+
+static SINC_AVX2_FMA_TARGET void resampler_sinc_process_polyphase_avx2_fma(
+      void *re_, struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_avx2_fma);
+}
+
+/* The SIMD mask has no FMA bit; AVX2 and the OS side of
+ * AVX come from it, FMA is read from CPUID leaf 1. */
+static bool sinc_cpu_has_avx2_fma(resampler_simd_mask_t mask)
+{
+   unsigned ecx = 0;
+#ifdef _MSC_VER
+   int regs[4];
+#else
+   unsigned eax = 0, ebx = 0, edx = 0;
+#endif
+
+   if (     !(mask & RESAMPLER_SIMD_AVX)
+         || !(mask & RESAMPLER_SIMD_AVX2))
+      return false;
+
+#ifdef _MSC_VER
+   __cpuid(regs, 1);
+   ecx = (unsigned)regs[2];
+#else
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+#endif
+
+   return (ecx & (1 << 12)) != 0;
+}
+#endif
+
+#if (defined(__ARM_NEON__) || defined(HAVE_NEON))
+#ifdef HAVE_ARM_NEON_ASM_OPTIMIZATIONS
+#define sinc_dot_neon process_sinc_neon_asm
+#else
+/* Assumes that taps is a multiple of 8. */
+static INLINE void sinc_dot_neon(float *out, const float *left,
+      const float *right, const float *coeff, unsigned taps)
+{
+   unsigned i;
+   float32x4_t p1 = {0, 0, 0, 0}, p2 = {0, 0, 0, 0};
+   float32x2_t p3, p4;
+
+   for (i = 0; i < taps; i += 8)
+   {
+      float32x4x2_t coeff8  = vld2q_f32(&coeff[i]);
+      float32x4x2_t left8   = vld2q_f32(&left[i]);
+      float32x4x2_t right8  = vld2q_f32(&right[i]);
+
+      p1 = vmlaq_f32(p1,  left8.val[0], coeff8.val[0]);
+      p2 = vmlaq_f32(p2, right8.val[0], coeff8.val[0]);
+      p1 = vmlaq_f32(p1,  left8.val[1], coeff8.val[1]);
+      p2 = vmlaq_f32(p2, right8.val[1], coeff8.val[1]);
+   }
+
+   p3 = vadd_f32(vget_low_f32(p1), vget_high_f32(p1));
+   p4 = vadd_f32(vget_low_f32(p2), vget_high_f32(p2));
+   vst1_f32(out, vpadd_f32(p3, p4));
+}
+#endif
+
+static void resampler_sinc_process_polyphase_neon(void *re_,
+      struct resampler_data *data)
+{
+   resampler_sinc_process_polyphase((rarch_sinc_resampler_t*)re_,
+         data, sinc_dot_neon);
+}
+#endif
+
+static void resampler_sinc_process(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   resamp->process(re_, data);
+}
+
 static void resampler_sinc_free(void *data)
 {
    rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)data;
@@ -848,6 +1135,71 @@ static void sinc_init_table_lanczos(
    }
 }
 
+/* Kaiser table without delta table, sampled at the centre of each
+ * of the phases, so picking the phase below the current time
+ * picks the nearest one. */
+static void sinc_init_table_polyphase(rarch_sinc_resampler_t *resamp,
+      double cutoff, float *phase_table, unsigned phases, unsigned taps)
+{
+   unsigned i, j;
+   double window_mod = besseli0(resamp->kaiser_beta);
+   double sidelobes  = taps / 2.0;
+
+   for (i = 0; i < phases; i++)
+   {
+      for (j = 0; j < taps; j++)
+      {
+         double n            = (double)j * phases + i + 0.5;
+         double window_phase = 2.0 * n / ((double)phases * taps) - 1.0;
+         double sinc_phase   = sidelobes * window_phase;
+         phase_table[i * taps + j] = cutoff
+            * sinc(M_PI * sinc_phase * cutoff)
+            * besseli0(resamp->kaiser_beta
+                  * sqrt(1.0 - window_phase * window_phase))
+            / window_mod;
+      }
+   }
+}
+
+/* Reduces ratio to the in/out sample rate fraction num / den it
+ * was computed from. Frontends keep the input rate in a float,
+ * so the fraction only has to match to single precision.
+ * Returns false if num is larger than SINC_POLYPHASE_MAX_NUMERATOR. */
+static bool sinc_rate_ratio(double ratio, unsigned *num, unsigned *den)
+{
+   /* Continued fraction convergents h/k of ratio */
+   double x     = ratio;
+   double h0    = 1.0, h1 = 0.0;
+   double k0    = 0.0, k1 = 1.0;
+   unsigned i;
+
+   for (i = 0; i < 32; i++)
+   {
+      double a = floor(x);
+      double h = a * h0 + h1;
+      double k = a * k0 + k1;
+
+      if (h > SINC_POLYPHASE_MAX_NUMERATOR)
+         break;
+      if (fabs(h / k - ratio) <= ratio * SINC_POLYPHASE_RATIO_EPSILON)
+      {
+         *num = (unsigned)h;
+         *den = (unsigned)k;
+         return true;
+      }
+      if (x - a < 1e-12)
+         break;
+
+      h1 = h0;
+      h0 = h;
+      k1 = k0;
+      k0 = k;
+      x  = 1.0 / (x - a);
+   }
+
+   return false;
+}
+
 static void *resampler_sinc_new(const struct resampler_config *config,
       double bandwidth_mod, enum resampler_quality quality,
       resampler_simd_mask_t mask)
@@ -855,8 +1207,10 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    double cutoff                  = 0.0;
    size_t phase_elems             = 0;
    size_t elems                   = 0;
+   size_t buffer_elems            = 0;
    unsigned enable_avx            = 0;
    unsigned sidelobes             = 0;
+   unsigned poly_phases           = 0;
    enum sinc_window window_type   = SINC_WINDOW_NONE;
    rarch_sinc_resampler_t *re     = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
@@ -900,6 +1254,7 @@ static void *resampler_sinc_new(const struct resampler_config *config,
          break;
       case RESAMPLER_QUALITY_NORMAL:
       case RESAMPLER_QUALITY_DONTCARE:
+      case RESAMPLER_QUALITY_POLYPHASE:
          cutoff            = 0.825;
          sidelobes         = 8;
          re->phase_bits    = 8;
@@ -935,10 +1290,63 @@ static void *resampler_sinc_new(const struct resampler_config *config,
 #endif
    }
 
-   phase_elems = ((1 << re->phase_bits) * re->taps);
-   if (window_type == SINC_WINDOW_KAISER)
-      phase_elems  = phase_elems * 2;
-   elems       = phase_elems + 4 * re->taps;
+   re->phases = 1 << (re->phase_bits + re->subphase_bits);
+
+   /* Only on request: building the table takes milliseconds,
+    * where the interpolated one takes a fraction of one. Falls
+    * back to NORMAL if the table would exceed
+    * SINC_POLYPHASE_MAX_TABLE_SIZE bytes. */
+   if (quality == RESAMPLER_QUALITY_POLYPHASE)
+   {
+      unsigned num  = 1;
+      unsigned den  = 0;
+      unsigned taps = (re->taps + 7) & ~7;
+
+      if (!sinc_rate_ratio(bandwidth_mod, &num, &den))
+      {
+         num        = 1;
+         den        = 0;
+      }
+      poly_phases   = num * ((SINC_POLYPHASE_MIN_PHASES + num - 1) / num);
+
+      if ((size_t)poly_phases * taps * sizeof(float)
+            <= SINC_POLYPHASE_MAX_TABLE_SIZE)
+      {
+         re->taps          = taps;
+         re->subphase_bits = SINC_POLYPHASE_SUBPHASE_BITS;
+         re->subphase_mask = (1 << re->subphase_bits) - 1;
+         re->subphase_mod  = 1.0f / (1 << re->subphase_bits);
+         re->phases        = poly_phases << re->subphase_bits;
+         if (den)
+         {
+            /* Whole phases per output, so every output at the
+             * nominal rate lands exactly on a table entry. */
+            re->poly_ratio = (double)num / den;
+            re->poly_step  = ((poly_phases / num) * den)
+               << re->subphase_bits;
+         }
+         else
+         {
+            re->poly_ratio = bandwidth_mod;
+            re->poly_step  = (uint32_t)(re->phases / bandwidth_mod + 0.5);
+         }
+      }
+      else
+         poly_phases       = 0;
+   }
+
+   if (poly_phases)
+      phase_elems = (size_t)poly_phases * re->taps;
+   else
+   {
+      phase_elems = ((1 << re->phase_bits) * re->taps);
+      if (window_type == SINC_WINDOW_KAISER)
+         phase_elems  = phase_elems * 2;
+   }
+   buffer_elems = poly_phases
+      ? SINC_POLYPHASE_BLOCK + re->taps
+      : 2 * re->taps;
+   elems       = phase_elems + 2 * buffer_elems;
 
    re->main_buffer = (float*)memalign_alloc(128, sizeof(float) * elems);
    if (!re->main_buffer)
@@ -948,7 +1356,7 @@ static void *resampler_sinc_new(const struct resampler_config *config,
 
    re->phase_table = re->main_buffer;
    re->buffer_l    = re->main_buffer + phase_elems;
-   re->buffer_r    = re->buffer_l + 2 * re->taps;
+   re->buffer_r    = re->buffer_l + buffer_elems;
 
    switch (window_type)
    {
@@ -957,31 +1365,54 @@ static void *resampler_sinc_new(const struct resampler_config *config,
                1 << re->phase_bits, re->taps, false);
          break;
       case SINC_WINDOW_KAISER:
-         sinc_init_table_kaiser(re, cutoff, re->phase_table,
-               1 << re->phase_bits, re->taps, true);
+         if (poly_phases)
+            sinc_init_table_polyphase(re, cutoff, re->phase_table,
+                  poly_phases, re->taps);
+         else
+            sinc_init_table_kaiser(re, cutoff, re->phase_table,
+                  1 << re->phase_bits, re->taps, true);
          break;
       case SINC_WINDOW_NONE:
          goto error;
    }
 
-   sinc_resampler.process = resampler_sinc_process_c;
+   if (poly_phases)
+   {
+      re->process = resampler_sinc_process_polyphase_c;
+#if defined(SINC_AVX2_FMA)
+      if (sinc_cpu_has_avx2_fma(mask))
+         re->process = resampler_sinc_process_polyphase_avx2_fma;
+      else
+#endif
+#if defined(__SSE__)
+      if (mask & RESAMPLER_SIMD_SSE)
+         re->process = resampler_sinc_process_polyphase_sse;
+#endif
+#if (defined(__ARM_NEON__) || defined(HAVE_NEON))
+      if (mask & RESAMPLER_SIMD_NEON)
+         re->process = resampler_sinc_process_polyphase_neon;
+#endif
+      return re;
+   }
+
+   re->process = resampler_sinc_process_c;
    if (window_type == SINC_WINDOW_KAISER)
-      sinc_resampler.process    = resampler_sinc_process_c_kaiser;
+      re->process    = resampler_sinc_process_c_kaiser;
 
    if (mask & RESAMPLER_SIMD_AVX && enable_avx)
    {
 #if defined(__AVX__)
-      sinc_resampler.process    = resampler_sinc_process_avx;
+      re->process    = resampler_sinc_process_avx;
       if (window_type == SINC_WINDOW_KAISER)
-         sinc_resampler.process = resampler_sinc_process_avx_kaiser;
+         re->process = resampler_sinc_process_avx_kaiser;
 #endif
    }
    else if (mask & RESAMPLER_SIMD_SSE)
    {
 #if defined(__SSE__)
-      sinc_resampler.process = resampler_sinc_process_sse;
+      re->process = resampler_sinc_process_sse;
       if (window_type == SINC_WINDOW_KAISER)
-         sinc_resampler.process = resampler_sinc_process_sse_kaiser;
+         re->process = resampler_sinc_process_sse_kaiser;
 #endif
    }
    else if (mask & RESAMPLER_SIMD_NEON)
@@ -989,11 +1420,11 @@ static void *resampler_sinc_new(const struct resampler_config *config,
 #if (defined(__ARM_NEON__) || defined(HAVE_NEON))
 #ifdef HAVE_ARM_NEON_ASM_OPTIMIZATIONS
       if (window_type != SINC_WINDOW_KAISER)
-         sinc_resampler.process = resampler_sinc_process_neon;
+         re->process = resampler_sinc_process_neon;
 #else
-      sinc_resampler.process = resampler_sinc_process_neon;
+      re->process = resampler_sinc_process_neon;
       if (window_type == SINC_WINDOW_KAISER)
-         sinc_resampler.process = resampler_sinc_process_neon_kaiser;
+         re->process = resampler_sinc_process_neon_kaiser;
 #endif
 #endif
    }
@@ -1007,7 +1438,7 @@ error:
 
 retro_resampler_t sinc_resampler = {
    resampler_sinc_new,
-   resampler_sinc_process_c,
+   resampler_sinc_process,
    resampler_sinc_free,
    RESAMPLER_API_VERSION,
    "sinc",
@@ -38,6 +38,7 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#include <encodings/utf.h>
 #else
 #include <unistd.h> /* stat() is defined here */
 #endif
@@ -98,6 +99,47 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the last modification time of a file. The VFS
+ * interface has no way to report it, so this always
+ * asks the OS.
+ *
+ * @return seconds since the epoch, or -1 if unknown.
+ */
+int64_t path_get_mtime(const char *path)
+{
+   if (!path || !*path)
+      return -1;
+   {
+#if defined(VITA) || defined(__PSL1GHT__) || defined(__PS3__)
+      return -1;
+#elif defined(_WIN32)
+      struct _stat stat_buf;
+      int ret;
+#if defined(LEGACY_WIN32)
+      char *path_local    = utf8_to_local_string_alloc(path);
+      ret                 = path_local ? _stat(path_local, &stat_buf) : -1;
+      free(path_local);
+#else
+      wchar_t *path_wide  = utf8_to_utf16_string_alloc(path);
+      ret                 = path_wide ? _wstat(path_wide, &stat_buf) : -1;
+      free(path_wide);
+#endif
+      if (ret != 0)
+         return -1;
+      return (int64_t)stat_buf.st_mtime;
+#else
+      struct stat stat_buf;
+      if (stat(path, &stat_buf) != 0)
+         return -1;
+      return (int64_t)stat_buf.st_mtime;
+#endif
+   }
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
@@ -54,7 +54,10 @@ enum resampler_quality
    RESAMPLER_QUALITY_LOWER,
    RESAMPLER_QUALITY_NORMAL,
    RESAMPLER_QUALITY_HIGHER,
-   RESAMPLER_QUALITY_HIGHEST
+   RESAMPLER_QUALITY_HIGHEST,
+   /* NORMAL, but sampled from a phase table precomputed for the
+    * ratio. Cheaper to run, much more expensive to create. */
+   RESAMPLER_QUALITY_POLYPHASE
 };
 
 /* A bit-mask of all supported SIMD instruction sets.
@@ -0,0 +1,78 @@
+/* Copyright  (C) 2010-2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (s16_resample.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __LIBRETRO_SDK_CONVERSION_S16_RESAMPLE_H__
+#define __LIBRETRO_SDK_CONVERSION_S16_RESAMPLE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+
+#include <audio/audio_resampler.h>
+
+RETRO_BEGIN_DECLS
+
+/* Number of stereo frames convert_s16_resample() carries through
+ * all of its stages at once. Small enough that the float scratch
+ * and the freshly resampled output stay in L1. */
+#define S16_RESAMPLE_CHUNK_FRAMES 256
+
+typedef void (*s16_resample_mix_t)(float *buf,
+      size_t frames, void *userdata);
+
+/**
+ * Converts interleaved stereo s16 samples to float, resamples them,
+ * optionally mixes into the result and converts it back to s16,
+ * in a single pass.
+ *
+ * Equivalent to running convert_s16_to_float(), the resampler,
+ * \c mix and convert_float_to_s16() one after another over the whole
+ * batch, but the batch is walked in chunks of
+ * \c S16_RESAMPLE_CHUNK_FRAMES so that every stage reads data the
+ * previous stage has just written.
+ *
+ * @param resampler The resampler backend.
+ * @param resampler_data The resampler instance.
+ * @param in Interleaved stereo input.
+ * @param frames The length of \c in in frames, \em not samples.
+ * @param gain The gain (audio volume) to apply while converting.
+ * @param ratio The resampling ratio (output rate / input rate).
+ * @param scratch At least <tt>S16_RESAMPLE_CHUNK_FRAMES * 2</tt> floats.
+ * @param out Float output, large enough for the whole resampled batch.
+ * @param out_s16 Optional s16 output, same length as \c out.
+ * May be NULL if only float output is needed.
+ * @param mix Optional callback run on each resampled chunk
+ * before it is converted back to s16. May be NULL.
+ * @param mix_data Userdata passed to \c mix.
+ * @return The number of frames written to \c out (and \c out_s16).
+ * @see convert_s16_to_float
+ * @see convert_float_to_s16
+ **/
+size_t convert_s16_resample(
+      const retro_resampler_t *resampler, void *resampler_data,
+      const int16_t *in, size_t frames, float gain, double ratio,
+      float *scratch, float *out, int16_t *out_s16,
+      s16_resample_mix_t mix, void *mix_data);
+
+RETRO_END_DECLS
+
+#endif
@@ -46,6 +46,50 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/**
+ * Scheduling class of a task, in decreasing order of priority.
+ *
+ * When the task queue is threaded, a free worker always picks the
+ * highest priority class that has a task ready to run, and each
+ * class can only occupy as many workers at once as its limit allows,
+ * so that e.g. a long background scan can not hold up thumbnails.
+ *
+ * @see task_queue_get_class_stats
+ */
+enum task_class
+{
+   /**
+    * User-facing work the user is actively waiting on.
+    * This is the default, and runs one task at a time,
+    * so tasks that do not pick a class keep the ordering
+    * guarantees of the old single worker.
+    */
+   TASK_CLASS_INTERACTIVE = 0,
+
+   /**
+    * Savestate and SRAM reads and writes, and anything
+    * else that touches save files (e.g. cloud sync).
+    */
+   TASK_CLASS_SAVESTATE,
+
+   /**
+    * Thumbnail and other image decodes. These share no
+    * state, so this is the only class that defaults to
+    * more than one task at a time.
+    */
+   TASK_CLASS_THUMBNAIL,
+
+   /**
+    * Long running work like database scans and bulk
+    * downloads, and every task that reads or writes
+    * playlists or databases, so that those never run
+    * concurrently with each other.
+    */
+   TASK_CLASS_BACKGROUND,
+
+   TASK_CLASS_LAST
+};
+
 enum task_style
 {
    TASK_STYLE_NONE,
@@ -143,6 +187,14 @@ struct retro_task
     */
    retro_time_t when;
 
+   /**
+    * @private The time (in microseconds) when the task was pushed,
+    * or 0 once it has started running.
+    * Used for the per-class wait time statistics.
+    * Do not touch this; it is managed by the task system.
+    */
+   retro_time_t queued_time;
+
    /**
     * The main body of work for a task.
     * Should be as fast as possible,
@@ -275,9 +327,54 @@ struct retro_task
    enum task_type type;
    enum task_style style;
 
+   /**
+    * The scheduling class of this task.
+    * Set by the caller, defaults to \c TASK_CLASS_INTERACTIVE.
+    * @see task_class
+    */
+   enum task_class task_class;
+
    uint8_t flags;
+
+   /**
+    * @private Set while a worker thread is running \c handler.
+    * Do not touch this; it is managed by the task system.
+    */
+   bool busy;
 };
 
+/**
+ * Per-class task queue statistics.
+ *
+ * @see task_queue_get_class_stats
+ */
+typedef struct task_class_stats
+{
+   /** Total time tasks spent queued before their first run, in microseconds. */
+   retro_time_t wait_time;
+
+   /** Total time spent in \c retro_task::handler, in microseconds. */
+   retro_time_t run_time;
+
+   /** Number of tasks that have started running. */
+   uint64_t started;
+
+   /** Number of tasks that have finished. */
+   uint64_t completed;
+
+   /** Number of tasks pushed but not yet finished. */
+   unsigned queued;
+
+   /** Highest value \c queued has reached. */
+   unsigned peak_queued;
+
+   /** Number of handlers of this class running right now. */
+   unsigned running;
+
+   /** Maximum number of handlers of this class that may run at once. */
+   unsigned limit;
+} task_class_stats_t;
+
 /**
  * Parameters for \c task_queue_find.
  *
@@ -548,6 +645,25 @@ void task_queue_unset_threaded(void);
  */
 bool task_queue_is_threaded(void);
 
+/**
+ * Returns a snapshot of the statistics for the given class.
+ * Statistics are not tracked when the queue runs on Grand Central Dispatch.
+ *
+ * @param task_class The class to query.
+ * @param stats Filled with the current statistics.
+ * Behavior is undefined if \c NULL.
+ * @return \c false if \c task_class is out of range.
+ */
+bool task_queue_get_class_stats(enum task_class task_class,
+      task_class_stats_t *stats);
+
+/**
+ * Returns the number of worker threads running tasks.
+ *
+ * @return 0 if the task queue is not threaded.
+ */
+unsigned task_queue_get_worker_count(void);
+
 /**
  * Calls the function given in \c find_data for each task
  * until it returns \c true for one of them,
@@ -655,11 +771,12 @@ void task_queue_deinit(void);
  * Must be called before any other task_queue_* function,
  * and must only be called from the main thread.
  *
- * @param threaded \c true if tasks should run on a separate thread,
+ * @param threaded \c true if tasks should run on separate threads,
  * \c false if they should remain on the calling thread.
- * All tasks run in sequence on a single thread.
- * If you want to scale a task to multiple threads,
- * you must do so within the task itself.
+ * Threaded tasks are spread over a pool of workers sized
+ * after the number of CPU cores; how many tasks of one class may
+ * run at the same time is bounded by that class's limit.
+ * @see task_class
  * @param msg_push The task system will call this function to output messages.
  * If \c NULL, no messages will be output.
  * @note Calling this function while the task system is already initialized
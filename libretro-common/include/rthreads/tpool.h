@@ -48,6 +48,17 @@ typedef struct tpool tpool_t;
  **/
 typedef void (*thread_func_t)(void *arg);
 
+/**
+ * (*tpool_range_func_t):
+ * @begin         : First index of the range.
+ * @end           : One past the last index of the range.
+ * @arg           : Argument.
+ *
+ * Callback function that tpool_parallel_for will call
+ * for each sub-range of the loop.
+ **/
+typedef void (*tpool_range_func_t)(size_t begin, size_t end, void *arg);
+
 /**
  * tpool_create:
  * @num           : Number of threads the pool should have.
@@ -77,12 +88,36 @@ void tpool_destroy(tpool_t *tp);
  * @func       : Function the pool should call.
  * @arg        : Argument to pass to func.
  *
- * Add work to a thread pool.
+ * Add work to a thread pool. Work added from outside the pool
+ * is started in the order it was added; work added by one of
+ * the pool's own threads is preferably run by that thread.
  *
  * Returns: true if work was added, otherwise false.
  **/
 bool tpool_add_work(tpool_t *tp, thread_func_t func, void *arg);
 
+/**
+ * tpool_parallel_for:
+ * @tp         : Thread pool. If NULL, @func is called once
+ *               for the whole range on the calling thread.
+ * @begin      : First index.
+ * @end        : One past the last index.
+ * @grain      : Largest number of indices passed to @func at once,
+ *               and the smallest range worth handing to another
+ *               thread. If 0 a few ranges per thread are used.
+ * @func       : Function the pool should call.
+ * @arg        : Argument to pass to func.
+ *
+ * Calls @func over disjoint sub-ranges that together cover
+ * [@begin, @end), spread over the pool and the calling thread,
+ * and returns once all of them have been processed.
+ * Idle threads steal the largest remaining ranges, so uneven
+ * iterations balance out. May be called from work running
+ * in the pool.
+ **/
+void tpool_parallel_for(tpool_t *tp, size_t begin, size_t end, size_t grain,
+      tpool_range_func_t func, void *arg);
+
 /**
  * tpool_wait:
  * @tp Thread pool.
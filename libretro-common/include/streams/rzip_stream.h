@@ -33,7 +33,7 @@
 RETRO_BEGIN_DECLS
 
 /* Rudimentary interface for streaming data to/from a
- * zlib-compressed chunk-based RZIP archive file.
+ * zlib- or zstd-compressed chunk-based RZIP archive file.
  * 
  * This is somewhat less efficient than using regular
  * gzip code, but this is by design - the intention here
@@ -49,20 +49,28 @@ RETRO_BEGIN_DECLS
  * 
  * When reading existing files, uncompressed content
  * is handled automatically. File type (compressed/
- * uncompressed) is detected via the RZIP header.
+ * uncompressed) and codec are detected via the RZIP
+ * header.
+ * 
+ * Chunks are independent of each other, so when
+ * threads are available several of them are
+ * compressed/decompressed at once.
  * 
  * ## RZIP file format:
  * 
  * <file id header>:                8 bytes
  *                                  - [#][R][Z][I][P][v][file format version][#]
+ *                                  - version 1: zlib, version 2: see codec
  * <uncompressed chunk size>:       4 bytes, little endian order
  *                                  - nominal (maximum) size of each uncompressed
  *                                    chunk, in bytes
  * <total uncompressed data size>:  8 bytes, little endian order
+ * <codec>:                         4 bytes, version 2 only
+ *                                  - [enum rzip_codec][0][0][0]
  * <size of next compressed chunk>: 4 bytes, little endian order
  *                                  - size on-disk of next compressed data
  *                                    chunk, in bytes
- * <next compressed chunk>:         n bytes of zlib compressed data
+ * <next compressed chunk>:         n bytes of zlib/zstd compressed data
  * ...
  * <size of next compressed chunk> : repeated until end of file
  * <next compressed chunk>         :
@@ -72,6 +80,42 @@ RETRO_BEGIN_DECLS
 /* Prevent direct access to rzipstream_t members */
 typedef struct rzipstream rzipstream_t;
 
+/* Compression codecs. Values are stored in
+ * file headers, and must not change */
+enum rzip_codec
+{
+   RZIP_CODEC_ZLIB = 0,
+   RZIP_CODEC_ZSTD = 1
+};
+
+/* Codec Selection */
+
+/* Sets the codec used for files subsequently
+ * opened for writing (default: RZIP_CODEC_ZLIB).
+ * Files written with zlib can be read by all
+ * versions of this interface; files written with
+ * any other codec need a version that supports it.
+ * Returns false if 'codec' is unsupported,
+ * in which case the default is unchanged */
+bool rzipstream_set_default_codec(enum rzip_codec codec);
+
+/* Threading */
+
+/* Creates the thread pool that streams opened
+ * afterwards use to compress and decompress
+ * several chunks at once, with one thread per
+ * core. Does nothing on single core systems,
+ * or if the pool already exists.
+ * Must not be called while any stream is open.
+ * Returns false if the pool can not be created,
+ * in which case streams run on the calling thread */
+bool rzipstream_init_threads(void);
+
+/* Destroys the thread pool created by
+ * rzipstream_init_threads().
+ * Must not be called while any stream is open */
+void rzipstream_deinit_threads(void);
+
 /* File Open */
 
 /* Opens a new or existing RZIP file
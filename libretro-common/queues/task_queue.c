@@ -42,6 +42,14 @@
 #include <dispatch/dispatch.h>
 #endif
 
+#define TASK_QUEUE_MAX_WORKERS  8
+
+/* A class passed over this many times in a row while it had
+ * a task ready to run gets the next free worker regardless of
+ * priority, so that a busy high priority class can not starve
+ * the others completely. */
+#define TASK_QUEUE_STARVE_LIMIT 8
+
 typedef struct
 {
    retro_task_t *front;
@@ -70,6 +78,15 @@ static task_queue_t tasks_finished          = {NULL, NULL};
 static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
 
+/* use running_lock when touching these */
+static task_class_stats_t task_class_stats[TASK_CLASS_LAST];
+static unsigned task_class_limit[TASK_CLASS_LAST] = {
+   1, /* TASK_CLASS_INTERACTIVE */
+   1, /* TASK_CLASS_SAVESTATE   */
+   2, /* TASK_CLASS_THUMBNAIL   */
+   1  /* TASK_CLASS_BACKGROUND  */
+};
+
 #ifdef HAVE_THREADS
 static uintptr_t main_thread_id             = 0;
 static slock_t *running_lock                = NULL;
@@ -77,7 +94,9 @@ static slock_t *finished_lock               = NULL;
 static slock_t *property_lock               = NULL;
 static slock_t *queue_lock                  = NULL;
 static scond_t *worker_cond                 = NULL;
-static sthread_t *worker_thread             = NULL;
+static sthread_t *worker_threads[TASK_QUEUE_MAX_WORKERS];
+static unsigned worker_count                = 0;
+static unsigned task_class_skipped[TASK_CLASS_LAST];
 static bool worker_continue                 = true;
 /* use running_lock when touching it */
 #endif
@@ -188,6 +207,48 @@ static retro_task_t *task_queue_get(task_queue_t *queue)
    return task;
 }
 
+static void task_queue_stats_push(retro_task_t *task)
+{
+   task_class_stats_t *stats;
+
+   if ((unsigned)task->task_class >= TASK_CLASS_LAST)
+      task->task_class = TASK_CLASS_INTERACTIVE;
+
+   stats             = &task_class_stats[task->task_class];
+   task->queued_time = cpu_features_get_time_usec();
+   task->busy        = false;
+
+   if (++stats->queued > stats->peak_queued)
+      stats->peak_queued = stats->queued;
+}
+
+static void task_queue_stats_start(retro_task_t *task, retro_time_t now)
+{
+   task_class_stats_t *stats = &task_class_stats[task->task_class];
+   retro_time_t since        = task->queued_time;
+
+   if (!since)
+      return;
+
+   /* Don't count the time a task spent waiting for its 'when' */
+   if (task->when > since)
+      since = task->when;
+   if (now > since)
+      stats->wait_time += now - since;
+
+   stats->started++;
+   task->queued_time = 0;
+}
+
+static void task_queue_stats_finish(retro_task_t *task)
+{
+   task_class_stats_t *stats = &task_class_stats[task->task_class];
+
+   if (stats->queued)
+      stats->queued--;
+   stats->completed++;
+}
+
 static void retro_task_internal_gather(void)
 {
    retro_task_t *task = NULL;
@@ -213,6 +274,7 @@ static void retro_task_internal_gather(void)
 
 static void retro_task_regular_push_running(retro_task_t *task)
 {
+   task_queue_stats_push(task);
    task_queue_put(&tasks_running, task);
 }
 
@@ -236,17 +298,25 @@ static void retro_task_regular_gather(void)
 
    for (task = queue; task; task = next)
    {
+      retro_time_t now = cpu_features_get_time_usec();
+
       next = task->next;
 
-      if (!task->when || task->when < cpu_features_get_time_usec())
+      if (!task->when || task->when < now)
       {
+         task_queue_stats_start(task, now);
          task->handler(task);
+         task_class_stats[task->task_class].run_time +=
+            cpu_features_get_time_usec() - now;
 
          task_queue_push_progress(task);
       }
 
       if ((task->flags & RETRO_TASK_FLG_FINISHED) > 0)
+      {
+         task_queue_stats_finish(task);
          task_queue_put(&tasks_finished, task);
+      }
       else
          task_queue_put(&tasks_running, task);
    }
@@ -389,6 +459,7 @@ static void retro_task_threaded_push_running(retro_task_t *task)
 {
    slock_lock(running_lock);
    slock_lock(queue_lock);
+   task_queue_stats_push(task);
    task_queue_put(&tasks_running, task);
    scond_signal(worker_cond);
    slock_unlock(queue_lock);
@@ -488,12 +559,81 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
    slock_unlock(running_lock);
 }
 
+/* Picks the next task for a free worker: the first task ready to
+ * run in the highest priority class that is below its limit. Tasks
+ * that were run are moved to the back of the queue, so tasks within
+ * a class take turns. If nothing is ready, '*delay' is set to the
+ * time until the earliest scheduled task becomes ready, or -1.
+ *
+ * 'running_lock' must be held for the duration of this function */
+static retro_task_t *task_queue_pick(retro_time_t now, retro_time_t *delay)
+{
+   unsigned i;
+   retro_task_t *task                     = NULL;
+   retro_task_t *ready[TASK_CLASS_LAST]   = {NULL};
+   int picked                             = -1;
+
+   *delay                                 = -1;
+
+   for (task = tasks_running.front; task; task = task->next)
+   {
+      unsigned c = task->task_class;
+
+      if (     task->busy
+            || ready[c]
+            || task_class_stats[c].running >= task_class_limit[c])
+         continue;
+
+      if (task->when)
+      {
+         /* allow half a millisecond for context switching */
+         retro_time_t wait = task->when - now - 500;
+         if (wait > 0)
+         {
+            if (*delay < 0 || wait < *delay)
+               *delay = wait;
+            continue;
+         }
+      }
+
+      ready[c] = task;
+   }
+
+   for (i = 0; i < TASK_CLASS_LAST; i++)
+   {
+      if (!ready[i])
+         continue;
+      if (picked < 0)
+         picked = i;
+      if (task_class_skipped[i] >= TASK_QUEUE_STARVE_LIMIT)
+      {
+         picked = i;
+         break;
+      }
+   }
+
+   if (picked < 0)
+      return NULL;
+
+   for (i = 0; i < TASK_CLASS_LAST; i++)
+   {
+      if ((int)i == picked)
+         task_class_skipped[i] = 0;
+      else if (ready[i])
+         task_class_skipped[i]++;
+   }
+
+   return ready[picked];
+}
+
 static void threaded_worker(void *userdata)
 {
    for (;;)
    {
-      retro_task_t *task  = NULL;
-      bool       finished = false;
+      retro_task_t *task        = NULL;
+      task_class_stats_t *stats = NULL;
+      bool       finished       = false;
+      retro_time_t delay, start;
 
       slock_lock(running_lock);
 
@@ -503,26 +643,24 @@ static void threaded_worker(void *userdata)
          break; /* should we keep running until all tasks finished? */
       }
 
-      /* Get first task to run */
-      if (!(task = tasks_running.front))
-      {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
-         continue;
-      }
+      start = cpu_features_get_time_usec();
 
-      if (task->when)
+      /* Get the next task to run */
+      if (!(task = task_queue_pick(start, &delay)))
       {
-         retro_time_t now   = cpu_features_get_time_usec();
-         retro_time_t delay = task->when - now - 500; /* allow half a millisecond for context switching */
          if (delay > 0)
-         {
             scond_wait_timeout(worker_cond, running_lock, delay);
-            slock_unlock(running_lock);
-            continue;
-         }
+         else
+            scond_wait(worker_cond, running_lock);
+         slock_unlock(running_lock);
+         continue;
       }
 
+      stats      = &task_class_stats[task->task_class];
+      task->busy = true;
+      stats->running++;
+      task_queue_stats_start(task, start);
+
       slock_unlock(running_lock);
       task->handler(task);
 #if defined(EMSCRIPTEN) || defined(_3DS)
@@ -537,34 +675,23 @@ static void threaded_worker(void *userdata)
       finished = ((task->flags & RETRO_TASK_FLG_FINISHED) > 0) ? true : false;
       slock_unlock(property_lock);
 
-      /* Update queue */
-      if (!finished)
-      {
-         /* Move the task to the back of the queue */
-         /* mimics retro_task_threaded_push_running,
-          * but also includes a task_queue_remove */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-
-         /* do nothing if only item in queue */
-         if (task->next)
-         {
-            task_queue_remove(&tasks_running, task);
-            task_queue_put(&tasks_running, task);
-            scond_signal(worker_cond);
-         }
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
-      }
+      /* Update queue; an unfinished task is moved to the back,
+       * the finished one is removed from the running queue */
+      slock_lock(running_lock);
+      slock_lock(queue_lock);
+      task->busy       = false;
+      stats->running--;
+      stats->run_time += cpu_features_get_time_usec() - start;
+      task_queue_remove(&tasks_running, task);
+      if (finished)
+         task_queue_stats_finish(task);
       else
-      {
-         /* Remove task from running queue */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-         task_queue_remove(&tasks_running, task);
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
+         task_queue_put(&tasks_running, task);
+      slock_unlock(queue_lock);
+      slock_unlock(running_lock);
 
+      if (finished)
+      {
          /* Add task to finished queue */
          slock_lock(finished_lock);
          task_queue_put(&tasks_finished, task);
@@ -573,8 +700,35 @@ static void threaded_worker(void *userdata)
    }
 }
 
+static unsigned task_queue_worker_amount(void)
+{
+#if defined(EMSCRIPTEN) || defined(_3DS)
+   return 1;
+#else
+   unsigned i;
+   unsigned limits = 0;
+   unsigned cores  = cpu_features_get_core_amount();
+
+   for (i = 0; i < TASK_CLASS_LAST; i++)
+      limits += task_class_limit[i];
+
+   if (cores > limits)
+      cores = limits;
+   if (cores > TASK_QUEUE_MAX_WORKERS)
+      cores = TASK_QUEUE_MAX_WORKERS;
+   if (cores < 1)
+      cores = 1;
+
+   return cores;
+#endif
+}
+
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   unsigned amount;
+   retro_task_t *task = NULL;
+
    running_lock    = slock_new();
    finished_lock   = slock_new();
    property_lock   = slock_new();
@@ -583,19 +737,43 @@ static void retro_task_threaded_init(void)
 
    slock_lock(running_lock);
    worker_continue = true;
+   /* Tasks left over from a previous queue are not running anymore */
+   for (task = tasks_running.front; task; task = task->next)
+      task->busy   = false;
+   for (i = 0; i < TASK_CLASS_LAST; i++)
+   {
+      task_class_stats[i].running = 0;
+      task_class_skipped[i]       = 0;
+   }
    slock_unlock(running_lock);
 
-   worker_thread   = sthread_create(threaded_worker, NULL);
+   amount          = task_queue_worker_amount();
+   worker_count    = 0;
+
+   for (i = 0; i < amount; i++)
+   {
+      if (!(worker_threads[worker_count] =
+               sthread_create(threaded_worker, NULL)))
+         break;
+      worker_count++;
+   }
 }
 
 static void retro_task_threaded_deinit(void)
 {
+   unsigned i;
+
    slock_lock(running_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
+   scond_broadcast(worker_cond);
    slock_unlock(running_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < worker_count; i++)
+   {
+      sthread_join(worker_threads[i]);
+      worker_threads[i] = NULL;
+   }
+   worker_count    = 0;
 
    scond_free(worker_cond);
    slock_free(running_lock);
@@ -603,7 +781,6 @@ static void retro_task_threaded_deinit(void)
    slock_free(property_lock);
    slock_free(queue_lock);
 
-   worker_thread   = NULL;
    worker_cond     = NULL;
    running_lock    = NULL;
    finished_lock   = NULL;
@@ -827,6 +1004,33 @@ bool task_queue_is_threaded(void)
    return task_threaded_enable;
 }
 
+bool task_queue_get_class_stats(enum task_class task_class,
+      task_class_stats_t *stats)
+{
+   if ((unsigned)task_class >= TASK_CLASS_LAST)
+      return false;
+
+#ifdef HAVE_THREADS
+   slock_lock(running_lock);
+#endif
+   *stats       = task_class_stats[task_class];
+   stats->limit = task_class_limit[task_class];
+#ifdef HAVE_THREADS
+   slock_unlock(running_lock);
+#endif
+
+   return true;
+}
+
+unsigned task_queue_get_worker_count(void)
+{
+#ifdef HAVE_THREADS
+   if (impl_current == &impl_threaded)
+      return worker_count;
+#endif
+   return 0;
+}
+
 bool task_queue_find(task_finder_data_t *find_data)
 {
    return impl_current->find(find_data->func, find_data->userdata);
@@ -1111,6 +1315,9 @@ retro_task_t *task_init(void)
    task->frontend_userdata = NULL;
    task->next              = NULL;
    task->when              = 0;
+   task->queued_time       = 0;
+   task->task_class        = TASK_CLASS_INTERACTIVE;
+   task->busy              = false;
 
    return task;
 }
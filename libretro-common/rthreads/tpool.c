@@ -31,178 +31,469 @@
 #include <rthreads/rthreads.h>
 #include <rthreads/tpool.h>
 
-/* Work object which will sit in a queue
+/* Work object which will sit in a deque
  * waiting for the pool to process it.
  *
- * It is a singly linked list acting as a FIFO queue. */
+ * Either a plain function call, or a sub-range of a
+ * tpool_parallel_for() loop when 'loop' is set. Finished
+ * items go back on the free list of the deque they were
+ * pushed to and are reused from there. */
 struct tpool_work
 {
-   thread_func_t      func;  /* Function to be called. */
-   void              *arg;   /* Data to be passed to func. */
-   struct tpool_work *next;  /* Next work item in the queue. */
+   thread_func_t       func;  /* Function to be called. */
+   void               *arg;   /* Data to be passed to func. */
+   struct tpool_loop  *loop;  /* Loop this range belongs to, or NULL. */
+   struct tpool_deque *dq;    /* Deque the item was pushed to. */
+   size_t              begin; /* First index of the range. */
+   size_t              end;   /* One past the last index of the range. */
+   struct tpool_work  *prev;  /* Towards the head (steal end) of the deque. */
+   struct tpool_work  *next;  /* Towards the tail (owner end) of the deque,
+                                 or the next free item. */
 };
 typedef struct tpool_work tpool_work_t;
 
+struct tpool_loop
+{
+   tpool_range_func_t func;
+   void              *arg;
+   slock_t           *lock;    /* Protects pending. */
+   size_t             grain;
+   size_t             pending; /* Ranges pushed but not finished yet. */
+};
+typedef struct tpool_loop tpool_loop_t;
+
+/* Every worker owns a deque, and there is one more shared by
+ * the threads outside of the pool. The owner pushes and pops
+ * at the tail, so it keeps working on what it split off last,
+ * while idle threads steal the oldest, and for loops largest,
+ * item from the head of somebody else's deque. The shared
+ * deque is only ever taken from at the head, so work added
+ * from outside the pool runs in the order it was added.
+ *
+ * Pushing, taking and finishing work only ever takes the lock
+ * of the deque involved. A thread that is about to sleep first
+ * registers with every deque, so that whoever pushes work to
+ * one of them, or finishes the last of its work, knows to take
+ * 'work_mutex' and wake it. */
+struct tpool_deque
+{
+   tpool_t           *tp;
+   slock_t           *lock;        /* Protects everything below. */
+   tpool_work_t      *head;
+   tpool_work_t      *tail;
+   tpool_work_t      *work_free;   /* Work items ready for reuse. */
+   size_t             outstanding; /* Items pushed here but not finished yet. */
+   size_t             watch_cnt;   /* Threads sleeping until something changes. */
+   uintptr_t          owner;       /* Thread id of the owning worker, 0 if shared.
+                                      Set before tpool_create() returns. */
+};
+typedef struct tpool_deque tpool_deque_t;
+
 struct tpool
 {
-   tpool_work_t    *work_first;   /* First work item in the work queue. */
-   tpool_work_t    *work_last;    /* Last work item in the work queue. */
-   slock_t         *work_mutex;   /* Mutex protecting inserting and removing work from the work queue. */
+   tpool_deque_t   *deques;       /* One per worker, the last one is shared. */
+   slock_t         *work_mutex;   /* Mutex protecting the counters below,
+                                     only taken to sleep and to wake sleepers. */
    scond_t         *work_cond;    /* Conditional to signal when there is work to process. */
-   scond_t         *working_cond; /* Conditional to signal when there is no work processing.
-                                       This will also signal when there are no threads running. */
-   size_t           working_cnt;  /* The number of threads processing work (Not waiting for work). */
+   scond_t         *working_cond; /* Conditional to signal when there is no work processing,
+                                     when a loop finished or when work was added while
+                                     a loop is waiting. This will also signal when there
+                                     are no threads running, or all of them started. */
+   size_t           idle_cnt;     /* The number of threads waiting for work. */
+   size_t           wake_cnt;     /* The number of those already signalled. */
+   size_t           helper_cnt;   /* The number of loops waiting for their ranges. */
+   size_t           wait_cnt;     /* The number of threads in tpool_wait(). */
+   size_t           deque_cnt;    /* Total number of deques, workers plus shared. */
    size_t           thread_cnt;   /* Total number of threads within the pool. */
+   size_t           claim_cnt;    /* The number of threads that claimed their deque. */
    bool             stop;         /* Marker to tell the work threads to exit. */
 };
 
-static tpool_work_t *tpool_work_create(thread_func_t func, void *arg)
+/* Wakes whoever sleeps on the pool: one idle worker if there is
+ * new work, and everybody waiting on a loop or in tpool_wait(). */
+static void tpool_wake(tpool_t *tp, bool added)
 {
+   slock_lock(tp->work_mutex);
+   /* Only wake as many threads as there is new work */
+   if (added && tp->idle_cnt > tp->wake_cnt)
+   {
+      tp->wake_cnt++;
+      scond_signal(tp->work_cond);
+   }
+   if (tp->helper_cnt || tp->wait_cnt)
+      scond_broadcast(tp->working_cond);
+   slock_unlock(tp->work_mutex);
+}
+
+/* Registers with (@delta 1) or unregisters from (@delta -1)
+ * every deque, and counts what is queued and outstanding.
+ * Work pushed or finished after a deque was looked at wakes
+ * the caller. 'work_mutex' must be held. */
+static void tpool_deques_watch(tpool_t *tp, int delta,
+      size_t *queued, size_t *outstanding)
+{
+   size_t i;
+
+   for (i = 0; i < tp->deque_cnt; i++)
+   {
+      tpool_deque_t *dq = &tp->deques[i];
+
+      slock_lock(dq->lock);
+      dq->watch_cnt += delta;
+      if (queued && dq->head)
+         (*queued)++;
+      if (outstanding)
+         *outstanding += dq->outstanding;
+      slock_unlock(dq->lock);
+   }
+}
+
+/* Queues up a new work item at the tail of the deque. */
+static tpool_work_t *tpool_deque_push(tpool_deque_t *dq, thread_func_t func,
+      void *arg, tpool_loop_t *loop, size_t begin, size_t end)
+{
+   bool wake;
    tpool_work_t *work;
 
-   if (!func)
-      return NULL;
+   slock_lock(dq->lock);
+   if ((work = dq->work_free))
+      dq->work_free = work->next;
+   else
+   {
+      slock_unlock(dq->lock);
+      if (!(work = (tpool_work_t*)malloc(sizeof(*work))))
+         return NULL;
+      slock_lock(dq->lock);
+   }
+
+   work->func     = func;
+   work->arg      = arg;
+   work->loop     = loop;
+   work->dq       = dq;
+   work->begin    = begin;
+   work->end      = end;
+   work->next     = NULL;
+   work->prev     = dq->tail;
+   if (dq->tail)
+      dq->tail->next = work;
+   else
+      dq->head       = work;
+   dq->tail       = work;
+   dq->outstanding++;
+   wake           = dq->watch_cnt != 0;
+   slock_unlock(dq->lock);
+
+   if (wake)
+      tpool_wake(dq->tp, true);
 
-   work       = (tpool_work_t*)calloc(1, sizeof(*work));
-   work->func = func;
-   work->arg  = arg;
-   work->next = NULL;
    return work;
 }
 
-static void tpool_work_destroy(tpool_work_t *work)
+/* Returns a finished, or never run, work item to the
+ * deque it came from. */
+static void tpool_deque_finish(tpool_work_t *work)
 {
-   if (work)
-      free(work);
+   bool wake;
+   tpool_deque_t *dq = work->dq;
+
+   slock_lock(dq->lock);
+   work->next    = dq->work_free;
+   dq->work_free = work;
+   wake          = (--dq->outstanding == 0) && dq->watch_cnt;
+   slock_unlock(dq->lock);
+
+   if (wake)
+      tpool_wake(dq->tp, false);
 }
 
-/* Pull the first work item out of the queue. */
-static tpool_work_t *tpool_work_get(tpool_t *tp)
+/* Pull the newest work item out of our own deque. */
+static tpool_work_t *tpool_deque_pop(tpool_deque_t *dq)
 {
    tpool_work_t *work;
 
-   if (!tp)
-      return NULL;
+   slock_lock(dq->lock);
+   if ((work = dq->tail))
+   {
+      dq->tail = work->prev;
+      if (dq->tail)
+         dq->tail->next = NULL;
+      else
+         dq->head       = NULL;
+   }
+   slock_unlock(dq->lock);
 
-   work = tp->work_first;
-   if (!work)
-      return NULL;
+   return work;
+}
+
+/* Pull the oldest work item out of somebody else's deque. */
+static tpool_work_t *tpool_deque_steal(tpool_deque_t *dq)
+{
+   tpool_work_t *work;
 
-   if (!work->next)
+   slock_lock(dq->lock);
+   if ((work = dq->head))
    {
-      tp->work_first = NULL;
-      tp->work_last  = NULL;
+      dq->head = work->next;
+      if (dq->head)
+         dq->head->prev = NULL;
+      else
+         dq->tail       = NULL;
    }
-   else
-      tp->work_first = work->next;
+   slock_unlock(dq->lock);
+
+   return work;
+}
+
+static bool tpool_deque_empty(tpool_deque_t *dq)
+{
+   bool empty;
+   slock_lock(dq->lock);
+   empty = !dq->head;
+   slock_unlock(dq->lock);
+   return empty;
+}
+
+/* The deque of the calling worker, or the shared one
+ * if the caller is not part of the pool. */
+static tpool_deque_t *tpool_deque_current(tpool_t *tp)
+{
+   size_t i;
+   uintptr_t self = sthread_get_current_thread_id();
+
+   for (i = 0; i < tp->deque_cnt - 1; i++)
+      if (tp->deques[i].owner == self)
+         return &tp->deques[i];
+
+   return &tp->deques[tp->deque_cnt - 1];
+}
+
+/* Take work from our own deque, or steal some. */
+static tpool_work_t *tpool_work_get(tpool_t *tp, tpool_deque_t *own)
+{
+   size_t i;
+   size_t start       = own - tp->deques;
+   tpool_work_t *work = own->owner
+      ? tpool_deque_pop(own)
+      : tpool_deque_steal(own);
+
+   for (i = 1; !work && i < tp->deque_cnt; i++)
+      work = tpool_deque_steal(&tp->deques[(start + i) % tp->deque_cnt]);
 
    return work;
 }
 
+static bool tpool_loop_done(tpool_loop_t *loop)
+{
+   bool done;
+   slock_lock(loop->lock);
+   done = !loop->pending;
+   slock_unlock(loop->lock);
+   return done;
+}
+
+/* Hands the upper part of a loop range to whoever is idle. */
+static bool tpool_loop_split(tpool_deque_t *own,
+      tpool_loop_t *loop, size_t begin, size_t end)
+{
+   slock_lock(loop->lock);
+   loop->pending++;
+   slock_unlock(loop->lock);
+
+   if (tpool_deque_push(own, NULL, NULL, loop, begin, end))
+      return true;
+
+   slock_lock(loop->lock);
+   loop->pending--;
+   slock_unlock(loop->lock);
+
+   return false;
+}
+
+static void tpool_loop_run(tpool_deque_t *own,
+      tpool_loop_t *loop, size_t begin, size_t end)
+{
+   while (begin < end)
+   {
+      size_t step = end - begin;
+
+      /* Whenever our deque has run dry, nobody can steal from
+       * us anymore, so offer up the upper half of what is left.
+       * Splitting lazily like this keeps the number of work
+       * items proportional to the number of steals instead of
+       * the number of grains. */
+      if (step >= 2 * loop->grain && tpool_deque_empty(own))
+      {
+         size_t mid = begin + step / 2;
+         if (tpool_loop_split(own, loop, mid, end))
+            end     = mid;
+      }
+
+      if (step > loop->grain)
+         step = loop->grain;
+
+      loop->func(begin, begin + step, loop->arg);
+      begin += step;
+   }
+}
+
+static void tpool_work_run(tpool_t *tp, tpool_deque_t *own, tpool_work_t *work)
+{
+   tpool_loop_t *loop = work->loop;
+
+   if (loop)
+      tpool_loop_run(own, loop, work->begin, work->end);
+   else
+      work->func(work->arg);
+
+   tpool_deque_finish(work);
+
+   if (loop)
+   {
+      bool done;
+
+      slock_lock(loop->lock);
+      done = (--loop->pending == 0);
+      slock_unlock(loop->lock);
+
+      /* The loop's caller holds 'work_mutex' from looking
+       * at pending until it sleeps, so this can't be missed. */
+      if (done)
+      {
+         slock_lock(tp->work_mutex);
+         if (tp->helper_cnt)
+            scond_broadcast(tp->working_cond);
+         slock_unlock(tp->work_mutex);
+      }
+   }
+}
+
 static void tpool_worker(void *arg)
 {
-   tpool_work_t *work = NULL;
-   tpool_t      *tp   = (tpool_t*)arg;
+   tpool_deque_t *own = (tpool_deque_t*)arg;
+   tpool_t       *tp  = own->tp;
+
+   /* Claim the deque before taking any work, so that
+    * work this thread adds ends up in it. */
+   slock_lock(tp->work_mutex);
+   own->owner         = sthread_get_current_thread_id();
+   tp->claim_cnt++;
+   scond_broadcast(tp->working_cond);
+   slock_unlock(tp->work_mutex);
 
    for (;;)
    {
+      size_t queued      = 0;
+      tpool_work_t *work = tpool_work_get(tp, own);
+
+      if (work)
+      {
+         tpool_work_run(tp, own, work);
+         continue;
+      }
+
       slock_lock(tp->work_mutex);
       /* Keep running until told to stop. */
       if (tp->stop)
          break;
 
-      /* If there is no work in the queue wait in the conditional until
-       * there is work to take. */
-      if (!tp->work_first)
-         scond_wait(tp->work_cond, tp->work_mutex);
-
-      /* Try to pull work from the queue. */
-      work = tpool_work_get(tp);
-      tp->working_cnt++;
-      slock_unlock(tp->work_mutex);
-
-      /* Call the work function and let it process.
-       *
-       * work can legitimately be NULL. Since multiple threads from the pool
-       * will wake when there is work, a thread might not get any work. 1
-       * piece of work and 2 threads, both will wake but with 1 only work 1
-       * will get the work and the other won't.
-       *
-       * working_cnt has been increment and work could be NULL. While it's
-       * not true there is work processing the thread is considered working
-       * because it's not waiting in the conditional. Pedantic but...
-       */
-      if (work)
+      /* If there is no work in any deque wait in the conditional
+       * until there is work to take. Work that is queued by now
+       * was pushed after we looked, so just look again. */
+      tpool_deques_watch(tp, 1, &queued, NULL);
+      if (!queued)
       {
-         work->func(work->arg);
-         tpool_work_destroy(work);
+         tp->idle_cnt++;
+         scond_wait(tp->work_cond, tp->work_mutex);
+         tp->idle_cnt--;
+         if (tp->wake_cnt)
+            tp->wake_cnt--;
       }
-
-      slock_lock(tp->work_mutex);
-      tp->working_cnt--;
-      /* Since we're in a lock no work can be added or removed form the queue.
-       * Also, the working_cnt can't be changed (except the thread holding the lock).
-       * At this point if there isn't any work processing and if there is no work
-       * signal this is the case. */
-      if (!tp->stop && tp->working_cnt == 0 && !tp->work_first)
-         scond_signal(tp->working_cond);
+      tpool_deques_watch(tp, -1, NULL, NULL);
       slock_unlock(tp->work_mutex);
    }
 
    tp->thread_cnt--;
    if (tp->thread_cnt == 0)
-      scond_signal(tp->working_cond);
+      scond_broadcast(tp->working_cond);
    slock_unlock(tp->work_mutex);
 }
 
 tpool_t *tpool_create(size_t num)
 {
    tpool_t   *tp;
-   sthread_t *thread;
    size_t     i;
 
    if (num == 0)
       num = 2;
 
-   tp               = (tpool_t*)calloc(1, sizeof(*tp));
-   tp->thread_cnt   = num;
+   if (!(tp = (tpool_t*)calloc(1, sizeof(*tp))))
+      return NULL;
+
+   if (!(tp->deques = (tpool_deque_t*)calloc(num + 1, sizeof(*tp->deques))))
+   {
+      free(tp);
+      return NULL;
+   }
 
+   tp->deque_cnt    = num + 1;
    tp->work_mutex   = slock_new();
    tp->work_cond    = scond_new();
    tp->working_cond = scond_new();
 
-   tp->work_first   = NULL;
-   tp->work_last    = NULL;
+   for (i = 0; i < tp->deque_cnt; i++)
+   {
+      tp->deques[i].tp   = tp;
+      tp->deques[i].lock = slock_new();
+   }
 
-   /* Create the requested number of thread and detach them. */
+   /* Create the requested number of threads and detach them.
+    * A deque whose thread could not be created is simply left
+    * for the others to steal from. */
    for (i = 0; i < num; i++)
    {
-      thread = sthread_create(tpool_worker, tp);
+      sthread_t *thread;
+
+      slock_lock(tp->work_mutex);
+      tp->thread_cnt++;
+      slock_unlock(tp->work_mutex);
+
+      if (!(thread = sthread_create(tpool_worker, &tp->deques[i])))
+      {
+         slock_lock(tp->work_mutex);
+         tp->thread_cnt--;
+         slock_unlock(tp->work_mutex);
+         continue;
+      }
+
       sthread_detach(thread);
    }
 
+   /* Have every worker claim its deque before anybody
+    * goes looking for their own, so owners never change
+    * while the pool is in use. */
+   slock_lock(tp->work_mutex);
+   while (tp->claim_cnt < tp->thread_cnt)
+      scond_wait(tp->working_cond, tp->work_mutex);
+   slock_unlock(tp->work_mutex);
+
    return tp;
 }
 
 void tpool_destroy(tpool_t *tp)
 {
+   size_t i;
    tpool_work_t *work;
-   tpool_work_t *work2;
 
    if (!tp)
       return;
 
-   /* Take all work out of the queue and destroy it. */
-   slock_lock(tp->work_mutex);
-   work = tp->work_first;
-   while (work)
-   {
-      work2 = work->next;
-      tpool_work_destroy(work);
-      work = work2;
-   }
+   /* Take all work out of the deques and destroy it. */
+   for (i = 0; i < tp->deque_cnt; i++)
+      while ((work = tpool_deque_steal(&tp->deques[i])))
+         tpool_deque_finish(work);
 
    /* Tell the worker threads to stop. */
+   slock_lock(tp->work_mutex);
    tp->stop = true;
    scond_broadcast(tp->work_cond);
    slock_unlock(tp->work_mutex);
@@ -210,6 +501,17 @@ void tpool_destroy(tpool_t *tp)
    /* Wait for all threads to stop. */
    tpool_wait(tp);
 
+   for (i = 0; i < tp->deque_cnt; i++)
+   {
+      while ((work = tp->deques[i].work_free))
+      {
+         tp->deques[i].work_free = work->next;
+         free(work);
+      }
+      slock_free(tp->deques[i].lock);
+   }
+   free(tp->deques);
+
    slock_free(tp->work_mutex);
    scond_free(tp->work_cond);
    scond_free(tp->working_cond);
@@ -219,31 +521,73 @@ void tpool_destroy(tpool_t *tp)
 
 bool tpool_add_work(tpool_t *tp, thread_func_t func, void *arg)
 {
-   tpool_work_t *work;
-
-   if (!tp)
+   if (!tp || !func)
       return false;
 
-   work = tpool_work_create(func, arg);
-   if (!work)
-      return false;
+   /* Work added by a worker stays with it until stolen, work
+    * coming from outside the pool queues up in the shared deque. */
+   return tpool_deque_push(tpool_deque_current(tp), func, arg,
+         NULL, 0, 0) != NULL;
+}
 
-   slock_lock(tp->work_mutex);
-   if (!tp->work_first)
+void tpool_parallel_for(tpool_t *tp, size_t begin, size_t end, size_t grain,
+      tpool_range_func_t func, void *arg)
+{
+   tpool_loop_t   loop;
+   tpool_deque_t *own;
+
+   if (!func || begin >= end)
+      return;
+
+   /* Without a pool, or a lock to track the ranges
+    * with, the whole loop runs right here. */
+   if (!tp || !(loop.lock = slock_new()))
    {
-      tp->work_first      = work;
-      tp->work_last       = tp->work_first;
+      func(begin, end, arg);
+      return;
    }
-   else
+
+   /* Default to a few grains per thread, so stealing has
+    * something to balance with. */
+   if (!grain)
+      grain = (end - begin) / (8 * tp->deque_cnt);
+   if (!grain)
+      grain = 1;
+
+   loop.func    = func;
+   loop.arg     = arg;
+   loop.grain   = grain;
+   loop.pending = 0;
+   own          = tpool_deque_current(tp);
+
+   tpool_loop_run(own, &loop, begin, end);
+
+   /* Our share is done; help out with whatever is queued
+    * until every range that was split off has finished. */
+   while (!tpool_loop_done(&loop))
    {
-      tp->work_last->next = work;
-      tp->work_last       = work;
-   }
+      size_t queued      = 0;
+      tpool_work_t *work = tpool_work_get(tp, own);
 
-   scond_broadcast(tp->work_cond);
-   slock_unlock(tp->work_mutex);
+      if (work)
+      {
+         tpool_work_run(tp, own, work);
+         continue;
+      }
+
+      slock_lock(tp->work_mutex);
+      tpool_deques_watch(tp, 1, &queued, NULL);
+      if (!queued && !tpool_loop_done(&loop))
+      {
+         tp->helper_cnt++;
+         scond_wait(tp->working_cond, tp->work_mutex);
+         tp->helper_cnt--;
+      }
+      tpool_deques_watch(tp, -1, NULL, NULL);
+      slock_unlock(tp->work_mutex);
+   }
 
-   return true;
+   slock_free(loop.lock);
 }
 
 void tpool_wait(tpool_t *tp)
@@ -255,12 +599,30 @@ void tpool_wait(tpool_t *tp)
 
    for (;;)
    {
-      /* working_cond is dual use. It signals when we're not stopping but the
-       * working_cnt is 0 indicating there isn't any work processing. If we
-       * are stopping it will trigger when there aren't any threads running. */
-      if ((!tp->stop && tp->working_cnt != 0) || (tp->stop && tp->thread_cnt != 0))
+      size_t outstanding = 0;
+
+      /* working_cond is dual use. It signals when we're not stopping but
+       * a deque we watch has no work processing or sitting in it anymore.
+       * If we are stopping it will trigger when there aren't any threads
+       * running. */
+      if (tp->stop)
+      {
+         if (tp->thread_cnt == 0)
+            break;
          scond_wait(tp->working_cond, tp->work_mutex);
-      else
+         continue;
+      }
+
+      tpool_deques_watch(tp, 1, NULL, &outstanding);
+      if (outstanding)
+      {
+         tp->wait_cnt++;
+         scond_wait(tp->working_cond, tp->work_mutex);
+         tp->wait_cnt--;
+      }
+      tpool_deques_watch(tp, -1, NULL, NULL);
+
+      if (!outstanding)
          break;
    }
 
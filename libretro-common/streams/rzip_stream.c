@@ -26,10 +26,18 @@
 #include <streams/file_stream.h>
 #include <streams/trans_stream.h>
 
+#ifdef HAVE_THREADS
+#include <features/features_cpu.h>
+#include <rthreads/tpool.h>
+#endif
+
 #include <streams/rzip_stream.h>
 
-/* Current RZIP file format version */
-#define RZIP_VERSION 1
+/* RZIP file format versions
+ * > Version 1 files are always zlib compressed
+ * > Version 2 adds a codec ID to the header */
+#define RZIP_VERSION_ZLIB  1
+#define RZIP_VERSION_CODEC 2
 
 /* Compression level
  * > zlib default of 6 provides the best
@@ -37,11 +45,20 @@
  *   compression speed */
 #define RZIP_COMPRESSION_LEVEL 6
 
+/* zstd default level: compresses about as
+ * well as zlib level 6, several times faster */
+#define RZIP_ZSTD_COMPRESSION_LEVEL 3
+
 /* Default chunk size: 128kb */
 #define RZIP_DEFAULT_CHUNK_SIZE 131072
 
+/* Maximum number of chunks (de)compressed
+ * together, one per thread */
+#define RZIP_MAX_BATCH_CHUNKS 8
+
 /* Header sizes (in bytes) */
 #define RZIP_HEADER_SIZE 20
+#define RZIP_CODEC_HEADER_SIZE 24
 #define RZIP_CHUNK_HEADER_SIZE 4
 
 /* Holds all metadata for an RZIP file stream */
@@ -51,11 +68,15 @@ struct rzipstream
    /* virtual_ptr: Used to track how much
     * uncompressed data has been read */
    uint64_t virtual_ptr;
+   /* decoded: Used to track how much
+    * uncompressed data has been read from
+    * disk (rather than out of out_buf) */
+   uint64_t decoded;
    RFILE* file;
-   const struct trans_stream_backend *deflate_backend;
-   void *deflate_stream;
-   const struct trans_stream_backend *inflate_backend;
-   void *inflate_stream;
+   /* One transform stream per chunk in a batch,
+    * so that chunks can be processed concurrently */
+   const struct trans_stream_backend *backend;
+   void *trans_stream[RZIP_MAX_BATCH_CHUNKS];
    uint8_t *in_buf;
    uint8_t *out_buf;
    uint32_t in_buf_size;
@@ -64,32 +85,75 @@ struct rzipstream
    uint32_t out_buf_ptr;
    uint32_t out_buf_occupancy;
    uint32_t chunk_size;
+   /* Size of each chunk's region in out_buf */
+   uint32_t out_chunk_size;
+   uint32_t header_size;
+   /* Per chunk of the current batch:
+    * > When reading: offset and size of the
+    *   compressed data in in_buf, and size
+    *   of the decompressed data in out_buf
+    * > When writing: size of the compressed
+    *   data in out_buf */
+   uint32_t chunk_offset[RZIP_MAX_BATCH_CHUNKS];
+   uint32_t chunk_in_size[RZIP_MAX_BATCH_CHUNKS];
+   uint32_t chunk_out_size[RZIP_MAX_BATCH_CHUNKS];
+   unsigned batch_chunks;
+   /* When reading: number of chunks in the
+    * current batch, and the one being read out */
+   unsigned chunk_count;
+   unsigned chunk_index;
+   enum rzip_codec codec;
    bool is_compressed;
    bool is_writing;
 };
 
+/* Codec used for new files */
+static enum rzip_codec rzip_default_codec = RZIP_CODEC_ZLIB;
+
+/* Returns the transform stream backend for the
+ * specified codec, or NULL if it is unsupported */
+static const struct trans_stream_backend *rzipstream_get_backend(
+      enum rzip_codec codec, bool is_writing)
+{
+   switch (codec)
+   {
+      case RZIP_CODEC_ZLIB:
+         return is_writing
+            ? trans_stream_get_zlib_deflate_backend()
+            : trans_stream_get_zlib_inflate_backend();
+      case RZIP_CODEC_ZSTD:
+         return is_writing
+            ? trans_stream_get_zstd_compress_backend()
+            : trans_stream_get_zstd_decompress_backend();
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
 /* Header Functions */
 
 /* Reads header information from RZIP file
  * > Detects whether file is compressed or
  *   uncompressed data
  * > If compressed, extracts uncompressed
- *   file/chunk sizes */
+ *   file/chunk sizes and codec */
 static bool rzipstream_read_file_header(rzipstream_t *stream)
 {
    unsigned i;
    int64_t length;
-   uint8_t header_bytes[RZIP_HEADER_SIZE];
+   uint8_t header_bytes[RZIP_CODEC_HEADER_SIZE];
 
    if (!stream)
       return false;
 
-   for (i = 0; i < RZIP_HEADER_SIZE; i++)
+   for (i = 0; i < RZIP_CODEC_HEADER_SIZE; i++)
       header_bytes[i] = 0;
 
    /* Attempt to read header bytes */
    if ((length = filestream_read(stream->file,
-        header_bytes, sizeof(header_bytes))) <= 0)
+        header_bytes, RZIP_HEADER_SIZE)) <= 0)
       return false;
 
    /* If file length is less than header size
@@ -105,7 +169,8 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
        || (header_bytes[3] !=           73)  /* I */
        || (header_bytes[4] !=           80)  /* P */
        || (header_bytes[5] !=          118)  /* v */
-       || (header_bytes[6] != RZIP_VERSION)  /* file format version number */
+       || (   (header_bytes[6] != RZIP_VERSION_ZLIB)
+           && (header_bytes[6] != RZIP_VERSION_CODEC)) /* file format version number */
        || (header_bytes[7] !=           35)) /* # */
    {
       /* Reset file to start */
@@ -136,23 +201,42 @@ static bool rzipstream_read_file_header(rzipstream_t *stream)
                    | (uint64_t)header_bytes[12]) == 0)
       return false;
 
+   /* Get codec - next 4 bytes, version 2 only */
+   if (header_bytes[6] == RZIP_VERSION_CODEC)
+   {
+      if (filestream_read(stream->file, header_bytes + RZIP_HEADER_SIZE,
+            RZIP_CODEC_HEADER_SIZE - RZIP_HEADER_SIZE) !=
+            RZIP_CODEC_HEADER_SIZE - RZIP_HEADER_SIZE)
+         return false;
+
+      stream->codec       = (enum rzip_codec)header_bytes[20];
+      stream->header_size = RZIP_CODEC_HEADER_SIZE;
+   }
+   else
+   {
+      stream->codec       = RZIP_CODEC_ZLIB;
+      stream->header_size = RZIP_HEADER_SIZE;
+   }
+
    stream->is_compressed = true;
    return true;
 }
 
 /* Writes header information to RZIP file
  * > ID 'magic numbers' + uncompressed
- *   file/chunk sizes */
+ *   file/chunk sizes
+ * > zlib files keep the version 1 layout,
+ *   so that older readers can open them */
 static bool rzipstream_write_file_header(rzipstream_t *stream)
 {
    unsigned i;
-   uint8_t header_bytes[RZIP_HEADER_SIZE];
+   uint8_t header_bytes[RZIP_CODEC_HEADER_SIZE];
 
    if (!stream)
       return false;
 
    /* Populate header array */
-   for (i = 0; i < RZIP_HEADER_SIZE; i++)
+   for (i = 0; i < RZIP_CODEC_HEADER_SIZE; i++)
       header_bytes[i] = 0;
 
    /* > 'Magic numbers' - first 8 bytes */
@@ -162,7 +246,9 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
    header_bytes[3]    =        73;    /* I */
    header_bytes[4]    =        80;    /* P */
    header_bytes[5]    =       118;    /* v */
-   header_bytes[6]    = RZIP_VERSION; /* file format version number */
+   header_bytes[6]    = (stream->codec == RZIP_CODEC_ZLIB)
+         ? RZIP_VERSION_ZLIB
+         : RZIP_VERSION_CODEC;        /* file format version number */
    header_bytes[7]    =        35;    /* # */
 
    /* > Uncompressed chunk size - next 4 bytes */
@@ -181,21 +267,45 @@ static bool rzipstream_write_file_header(rzipstream_t *stream)
    header_bytes[13]   = (stream->size >>  8) & 0xFF;
    header_bytes[12]   =  stream->size        & 0xFF;
 
+   /* > Codec - next 4 bytes, version 2 only
+    *   (remaining 3 bytes are reserved) */
+   header_bytes[20]   = (uint8_t)stream->codec;
+
    /* Reset file to start */
    filestream_seek(stream->file, 0, SEEK_SET);
 
    /* Write header bytes */
    return (filestream_write(stream->file,
-         header_bytes, sizeof(header_bytes)) == RZIP_HEADER_SIZE);
+         header_bytes, stream->header_size) == stream->header_size);
 }
 
 /* Stream Initialisation/De-initialisation */
 
+#ifdef HAVE_THREADS
+/* Thread pool shared by all streams,
+ * see rzipstream_init_threads() */
+static tpool_t *rzipstream_pool       = NULL;
+static unsigned rzipstream_pool_cores = 1;
+#endif
+
+/* Returns number of chunks to process together,
+ * which is one per core when there is a thread
+ * pool to spread them over */
+static unsigned rzipstream_get_batch_chunks(void)
+{
+#ifdef HAVE_THREADS
+   if (rzipstream_pool)
+      return rzipstream_pool_cores;
+#endif
+   return 1;
+}
+
 /* Initialises all members of an rzipstream_t struct,
  * reading config from existing file header if available */
 static bool rzipstream_init_stream(
       rzipstream_t *stream, const char *path, bool is_writing)
 {
+   unsigned i;
    unsigned file_mode;
 
    if (!stream)
@@ -203,12 +313,12 @@ static bool rzipstream_init_stream(
 
    /* Ensure stream has valid initial values */
    stream->size              = 0;
+   stream->decoded           = 0;
    stream->chunk_size        = RZIP_DEFAULT_CHUNK_SIZE;
    stream->file              = NULL;
-   stream->deflate_backend   = NULL;
-   stream->deflate_stream    = NULL;
-   stream->inflate_backend   = NULL;
-   stream->inflate_stream    = NULL;
+   stream->backend           = NULL;
+   for (i = 0; i < RZIP_MAX_BATCH_CHUNKS; i++)
+      stream->trans_stream[i] = NULL;
    stream->in_buf            = NULL;
    stream->in_buf_size       = 0;
    stream->in_buf_ptr        = 0;
@@ -216,6 +326,12 @@ static bool rzipstream_init_stream(
    stream->out_buf_size      = 0;
    stream->out_buf_ptr       = 0;
    stream->out_buf_occupancy = 0;
+   stream->out_chunk_size    = 0;
+   stream->header_size       = RZIP_HEADER_SIZE;
+   stream->batch_chunks      = rzipstream_get_batch_chunks();
+   stream->chunk_count       = 0;
+   stream->chunk_index       = 0;
+   stream->codec             = RZIP_CODEC_ZLIB;
 
    /* Check whether this is a read or write stream */
    stream->is_writing = is_writing;
@@ -224,6 +340,13 @@ static bool rzipstream_init_stream(
       /* Written files are always compressed */
       stream->is_compressed = true;
       file_mode             = RETRO_VFS_FILE_ACCESS_WRITE;
+
+      /* Fall back to zlib if the default
+       * codec is unavailable */
+      if (rzipstream_get_backend(rzip_default_codec, true))
+         stream->codec      = rzip_default_codec;
+      if (stream->codec != RZIP_CODEC_ZLIB)
+         stream->header_size = RZIP_CODEC_HEADER_SIZE;
    }
    /* For read files, must get compression status
     * from file itself... */
@@ -251,48 +374,35 @@ static bool rzipstream_init_stream(
    else if (!rzipstream_read_file_header(stream))
       return false;
 
-   /* Initialise appropriate transform stream
-    * and determine associated buffer sizes */
+   /* Determine transform stream backend and
+    * associated buffer sizes. Transform streams
+    * themselves are created on first use */
    if (stream->is_writing)
    {
       /* Compression */
-      if (!(stream->deflate_backend = trans_stream_get_zlib_deflate_backend()))
-         return false;
-
-      if (!(stream->deflate_stream = stream->deflate_backend->stream_new()))
-         return false;
-
-      /* Set compression level */
-      if (!stream->deflate_backend->define(
-            stream->deflate_stream, "level", RZIP_COMPRESSION_LEVEL))
+      if (!(stream->backend = rzipstream_get_backend(stream->codec, true)))
          return false;
 
       /* Buffers
        * > Input: uncompressed
        * > Output: compressed */
-      stream->in_buf_size  = stream->chunk_size;
-      stream->out_buf_size = stream->chunk_size * 2;
+      stream->in_buf_size    = stream->chunk_size;
+      stream->out_chunk_size = stream->chunk_size * 2;
       /* > Account for minimum zlib overhead
        *   of 11 bytes... */
-      stream->out_buf_size =
-            (stream->out_buf_size < (stream->in_buf_size + 11)) ?
-                  stream->out_buf_size + 11 :
-                  stream->out_buf_size;
-
-      /* Redundant safety check */
-      if (   (stream->in_buf_size  == 0)
-          || (stream->out_buf_size == 0))
-         return false;
+      stream->out_chunk_size =
+            (stream->out_chunk_size < (stream->in_buf_size + 11)) ?
+                  stream->out_chunk_size + 11 :
+                  stream->out_chunk_size;
    }
-   /* When reading, don't need an inflate transform
-    * stream (or buffers) if source file is uncompressed */
+   /* When reading, don't need a transform stream
+    * (or buffers) if source file is uncompressed */
    else if (stream->is_compressed)
    {
-      /* Decompression */
-      if (!(stream->inflate_backend = trans_stream_get_zlib_inflate_backend()))
-         return false;
-
-      if (!(stream->inflate_stream = stream->inflate_backend->stream_new()))
+      /* Decompression
+       * > Files written by a newer version
+       *   may use a codec we do not know */
+      if (!(stream->backend = rzipstream_get_backend(stream->codec, false)))
          return false;
 
       /* Buffers
@@ -305,15 +415,26 @@ static bool rzipstream_init_stream(
        *         should have a size of exactly stream->chunk_size.
        *         Allocate some additional space, just for
        *         redundant safety... */
-      stream->in_buf_size  = stream->chunk_size * 2;
-      stream->out_buf_size = stream->chunk_size + (stream->chunk_size >> 2);
+      stream->in_buf_size    = stream->chunk_size * 2;
+      stream->out_chunk_size = stream->chunk_size + (stream->chunk_size >> 2);
 
-      /* Redundant safety check */
-      if (   (stream->in_buf_size  == 0)
-          || (stream->out_buf_size == 0))
-         return false;
+      /* Only batch as many chunks as the file has */
+      if ((uint64_t)stream->batch_chunks * stream->chunk_size > stream->size)
+         stream->batch_chunks = (unsigned)
+               ((stream->size + stream->chunk_size - 1) / stream->chunk_size);
    }
 
+   /* Each chunk of a batch gets its own
+    * region of the buffers */
+   stream->in_buf_size  *= stream->batch_chunks;
+   stream->out_buf_size  = stream->out_chunk_size * stream->batch_chunks;
+
+   /* Redundant safety check */
+   if (     stream->is_compressed
+         && (   (stream->in_buf_size  == 0)
+             || (stream->out_buf_size == 0)))
+      return false;
+
    /* Allocate buffers */
    if (stream->in_buf_size > 0)
    {
@@ -334,23 +455,21 @@ static bool rzipstream_init_stream(
  * > Also closes associated file, if currently open */
 static int rzipstream_free_stream(rzipstream_t *stream)
 {
+   unsigned i;
    int ret = 0;
 
    if (!stream)
       return -1;
 
    /* Free transform streams */
-   if (stream->deflate_stream && stream->deflate_backend)
-      stream->deflate_backend->stream_free(stream->deflate_stream);
-
-   stream->deflate_stream  = NULL;
-   stream->deflate_backend = NULL;
-
-   if (stream->inflate_stream && stream->inflate_backend)
-      stream->inflate_backend->stream_free(stream->inflate_stream);
+   for (i = 0; i < RZIP_MAX_BATCH_CHUNKS; i++)
+   {
+      if (stream->trans_stream[i] && stream->backend)
+         stream->backend->stream_free(stream->trans_stream[i]);
+      stream->trans_stream[i] = NULL;
+   }
 
-   stream->inflate_stream  = NULL;
-   stream->inflate_backend = NULL;
+   stream->backend = NULL;
 
    /* Free buffers */
    if (stream->in_buf)
@@ -371,6 +490,61 @@ static int rzipstream_free_stream(rzipstream_t *stream)
    return ret;
 }
 
+/* Sets the codec used for files subsequently
+ * opened for writing.
+ * Returns false if 'codec' is unsupported,
+ * in which case the default is unchanged */
+bool rzipstream_set_default_codec(enum rzip_codec codec)
+{
+   if (!rzipstream_get_backend(codec, true))
+      return false;
+   rzip_default_codec = codec;
+   return true;
+}
+
+/* Threading */
+
+/* Creates the thread pool that streams opened
+ * afterwards use to compress and decompress
+ * several chunks at once, with one thread per
+ * core. Does nothing on single core systems,
+ * or if the pool already exists.
+ * Must not be called while any stream is open.
+ * Returns false if the pool can not be created,
+ * in which case streams run on the calling thread */
+bool rzipstream_init_threads(void)
+{
+#ifdef HAVE_THREADS
+   unsigned cores = cpu_features_get_core_amount();
+
+   if (rzipstream_pool || cores < 2)
+      return true;
+
+   if (cores > RZIP_MAX_BATCH_CHUNKS)
+      cores = RZIP_MAX_BATCH_CHUNKS;
+
+   /* The calling thread does its share of
+    * the work, so one thread fewer will do */
+   if (!(rzipstream_pool = tpool_create(cores - 1)))
+      return false;
+   rzipstream_pool_cores = cores;
+#endif
+   return true;
+}
+
+/* Destroys the thread pool created by
+ * rzipstream_init_threads().
+ * Must not be called while any stream is open */
+void rzipstream_deinit_threads(void)
+{
+#ifdef HAVE_THREADS
+   if (rzipstream_pool)
+      tpool_destroy(rzipstream_pool);
+   rzipstream_pool       = NULL;
+   rzipstream_pool_cores = 1;
+#endif
+}
+
 /* File Open */
 
 /* Opens a new or existing RZIP file
@@ -399,27 +573,9 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
       return NULL;
 
    /* Allocate stream object */
-   if (!(stream = (rzipstream_t*)malloc(sizeof(*stream))))
+   if (!(stream = (rzipstream_t*)calloc(1, sizeof(*stream))))
       return NULL;
 
-   stream->is_compressed   = false;
-   stream->is_writing      = false;
-   stream->size            = 0;
-   stream->chunk_size      = 0;
-   stream->virtual_ptr     = 0;
-   stream->file            = NULL;
-   stream->deflate_backend = NULL;
-   stream->deflate_stream  = NULL;
-   stream->inflate_backend = NULL;
-   stream->inflate_stream  = NULL;
-   stream->in_buf          = NULL;
-   stream->in_buf_size     = 0;
-   stream->in_buf_ptr      = 0;
-   stream->out_buf         = NULL;
-   stream->out_buf_size    = 0;
-   stream->out_buf_ptr     = 0;
-   stream->out_buf_occupancy = 0;
-
    /* Initialise stream */
    if (!rzipstream_init_stream(
          stream, path,
@@ -432,95 +588,241 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    return stream;
 }
 
-/* File Read */
+/* Chunk Processing */
 
-/* Reads and decompresses the next chunk of data
- * in the RZIP file */
-static bool rzipstream_read_chunk(rzipstream_t *stream)
+/* Ensures that the first 'count' chunks of a
+ * batch have a transform stream */
+static bool rzipstream_init_trans_streams(rzipstream_t *stream,
+      unsigned count)
 {
    unsigned i;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t compressed_chunk_size;
-   uint32_t inflate_read;
-   uint32_t inflate_written;
-
-   if (!stream || !stream->inflate_backend || !stream->inflate_stream)
-      return false;
-
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
-
-   /* Attempt to read chunk header bytes */
-   if (filestream_read(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
-      return false;
-
-   /* Get size of next compressed chunk */
-   compressed_chunk_size = ( (uint32_t)chunk_header_bytes[3]  << 24)
-                           | ((uint32_t)chunk_header_bytes[2] << 16)
-                           | ((uint32_t)chunk_header_bytes[1] <<  8)
-                           | (uint32_t)chunk_header_bytes[0];
-   if (compressed_chunk_size == 0)
-      return false;
 
-   /* Resize input buffer, if required */
-   if (compressed_chunk_size > stream->in_buf_size)
+   for (i = 0; i < count; i++)
    {
-      free(stream->in_buf);
-      stream->in_buf      = NULL;
+      if (stream->trans_stream[i])
+         continue;
 
-      stream->in_buf_size = compressed_chunk_size;
-      stream->in_buf      = (uint8_t *)calloc(stream->in_buf_size, 1);
-      if (!stream->in_buf)
+      if (!(stream->trans_stream[i] = stream->backend->stream_new()))
          return false;
 
-      /* Note: Uncompressed data size is fixed, and read
-       * from the file header - we therefore don't attempt
-       * to resize the output buffer (if it's too small, then
-       * that's an error condition) */
+      /* Set compression level */
+      if (stream->is_writing)
+      {
+         uint32_t level = (stream->codec == RZIP_CODEC_ZSTD)
+               ? RZIP_ZSTD_COMPRESSION_LEVEL
+               : RZIP_COMPRESSION_LEVEL;
+         if (!stream->backend->define(
+               stream->trans_stream[i], "level", level))
+            return false;
+      }
    }
 
-   /* Read compressed chunk from file */
-   if (filestream_read(
-         stream->file, stream->in_buf, compressed_chunk_size) !=
-         compressed_chunk_size)
-      return false;
+   return true;
+}
 
-   /* Decompress chunk data */
-   stream->inflate_backend->set_in(
-         stream->inflate_stream,
-         stream->in_buf, compressed_chunk_size);
+/* Compresses or decompresses chunk 'i' of the
+ * current batch. Chunks only touch their own
+ * region of the buffers, and their own transform
+ * stream, so any number may run concurrently.
+ * On failure, the chunk's output size is 0 */
+static void rzipstream_trans_chunk(rzipstream_t *stream, unsigned i)
+{
+   uint32_t trans_read;
+   uint32_t trans_written;
+   const uint8_t *in;
+   uint32_t in_size;
+   void *trans_stream = stream->trans_stream[i];
 
-   stream->inflate_backend->set_out(
-         stream->inflate_stream,
-         stream->out_buf, stream->out_buf_size);
+   if (stream->is_writing)
+   {
+      in      = stream->in_buf + i * stream->chunk_size;
+      in_size = stream->chunk_in_size[i];
+   }
+   else
+   {
+      in      = stream->in_buf + stream->chunk_offset[i];
+      in_size = stream->chunk_in_size[i];
+   }
+
+   stream->chunk_out_size[i] = 0;
+
+   stream->backend->set_in(trans_stream, in, in_size);
+   stream->backend->set_out(trans_stream,
+         stream->out_buf + i * stream->out_chunk_size,
+         stream->out_chunk_size);
 
    /* Note: We have to set 'flush == true' here, otherwise we
     * can't guarantee that the entire chunk will be written
     * to the output buffer - this is inefficient, but not
     * much we can do... */
-   if (!stream->inflate_backend->trans(
-         stream->inflate_stream, true,
-         &inflate_read, &inflate_written, NULL))
-      return false;
+   if (!stream->backend->trans(trans_stream, true,
+         &trans_read, &trans_written, NULL))
+      return;
 
    /* Error checking */
-   if (inflate_read != compressed_chunk_size)
+   if (trans_read != in_size)
+      return;
+
+   if (   (trans_written == 0)
+       || (trans_written > stream->out_chunk_size))
+      return;
+
+   stream->chunk_out_size[i] = trans_written;
+}
+
+static void rzipstream_trans_chunk_range(size_t begin, size_t end,
+      void *arg)
+{
+   size_t i;
+   for (i = begin; i < end; i++)
+      rzipstream_trans_chunk((rzipstream_t*)arg, (unsigned)i);
+}
+
+/* Compresses or decompresses the first 'count'
+ * chunks of the current batch, spread over a
+ * thread pool when there is more than one.
+ * Returns false if any chunk failed */
+static bool rzipstream_trans_chunks(rzipstream_t *stream, unsigned count)
+{
+   unsigned i;
+
+   if (!rzipstream_init_trans_streams(stream, count))
+      return false;
+
+#ifdef HAVE_THREADS
+   /* Batches only have more than
+    * one chunk when there is a pool */
+   if (count > 1)
+      tpool_parallel_for(rzipstream_pool, 0, count, 1,
+            rzipstream_trans_chunk_range, stream);
+   else
+#endif
+      rzipstream_trans_chunk_range(0, count, stream);
+
+   for (i = 0; i < count; i++)
+      if (stream->chunk_out_size[i] == 0)
+         return false;
+
+   return true;
+}
+
+/* File Read */
+
+/* Reads the next batch of chunks from the RZIP
+ * file and decompresses them */
+static bool rzipstream_read_chunk(rzipstream_t *stream)
+{
+   unsigned i;
+   unsigned count;
+   uint32_t in_buf_used = 0;
+   uint64_t remaining;
+
+   if (!stream || !stream->backend)
       return false;
 
-   if (   (inflate_written == 0)
-       || (inflate_written > stream->out_buf_size))
+   /* Read as many chunks as the batch holds,
+    * but no more than the file should have left */
+   if (stream->decoded >= stream->size)
+      return false;
+
+   remaining = stream->size - stream->decoded;
+   count     = stream->batch_chunks;
+   if ((uint64_t)count * stream->chunk_size > remaining)
+      count  = (unsigned)((remaining + stream->chunk_size - 1) /
+            stream->chunk_size);
+
+   for (i = 0; i < count; i++)
+   {
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      uint32_t compressed_chunk_size;
+      int64_t header_read;
+
+      /* Attempt to read chunk header bytes
+       * > Earlier chunks may have been short, in
+       *   which case the file can end before
+       *   the batch is full */
+      if ((header_read = filestream_read(stream->file,
+            chunk_header_bytes, sizeof(chunk_header_bytes))) == 0 && i > 0)
+         break;
+
+      if (header_read != RZIP_CHUNK_HEADER_SIZE)
+         return false;
+
+      /* Get size of next compressed chunk */
+      compressed_chunk_size = ( (uint32_t)chunk_header_bytes[3]  << 24)
+                              | ((uint32_t)chunk_header_bytes[2] << 16)
+                              | ((uint32_t)chunk_header_bytes[1] <<  8)
+                              | (uint32_t)chunk_header_bytes[0];
+      if (compressed_chunk_size == 0)
+         return false;
+
+      /* Resize input buffer, if required */
+      if (compressed_chunk_size > stream->in_buf_size - in_buf_used)
+      {
+         uint8_t *in_buf;
+         uint32_t in_buf_size = in_buf_used + compressed_chunk_size;
+
+         /* Guard against overflow with corrupt sizes */
+         if (in_buf_size < in_buf_used)
+            return false;
+
+         if (!(in_buf = (uint8_t *)realloc(stream->in_buf, in_buf_size)))
+            return false;
+
+         stream->in_buf      = in_buf;
+         stream->in_buf_size = in_buf_size;
+
+         /* Note: Uncompressed data size is fixed, and read
+          * from the file header - we therefore don't attempt
+          * to resize the output buffer (if it's too small, then
+          * that's an error condition) */
+      }
+
+      /* Read compressed chunk from file */
+      if (filestream_read(
+            stream->file, stream->in_buf + in_buf_used,
+            compressed_chunk_size) != compressed_chunk_size)
+         return false;
+
+      stream->chunk_offset[i]  = in_buf_used;
+      stream->chunk_in_size[i] = compressed_chunk_size;
+      in_buf_used             += compressed_chunk_size;
+   }
+
+   count = i;
+
+   /* Decompress chunk data */
+   if (!rzipstream_trans_chunks(stream, count))
       return false;
 
+   for (i = 0; i < count; i++)
+      stream->decoded += stream->chunk_out_size[i];
+
    /* Record current output buffer occupancy
     * and reset pointer */
-   stream->out_buf_occupancy = inflate_written;
+   stream->chunk_count       = count;
+   stream->chunk_index       = 0;
+   stream->out_buf_occupancy = stream->chunk_out_size[0];
    stream->out_buf_ptr       = 0;
 
    return true;
 }
 
+/* Moves on to the next decompressed chunk, reading
+ * and decompressing a new batch if none are left */
+static bool rzipstream_next_chunk(rzipstream_t *stream)
+{
+   if (stream->chunk_index + 1 < stream->chunk_count)
+   {
+      stream->chunk_index++;
+      stream->out_buf_occupancy = stream->chunk_out_size[stream->chunk_index];
+      stream->out_buf_ptr       = 0;
+      return true;
+   }
+
+   return rzipstream_read_chunk(stream);
+}
+
 /* Reads (a maximum of) 'len' bytes from an RZIP file.
  * Returns actual number of bytes read, or -1 in
  * the event of an error */
@@ -552,7 +854,7 @@ int64_t rzipstream_read(rzipstream_t *stream, void *data, int64_t len)
        * been read, grab and extract the next chunk
        * from disk */
       if (stream->out_buf_ptr >= stream->out_buf_occupancy)
-         if (!rzipstream_read_chunk(stream))
+         if (!rzipstream_next_chunk(stream))
             return -1;
 
       /* Get amount of data to 'read out' this loop
@@ -564,7 +866,9 @@ int64_t rzipstream_read(rzipstream_t *stream, void *data, int64_t len)
 
       /* Copy as much cached data as possible into
        * the read buffer */
-      memcpy(data_ptr, stream->out_buf + stream->out_buf_ptr, (size_t)read_size);
+      memcpy(data_ptr, stream->out_buf
+            + stream->chunk_index * stream->out_chunk_size
+            + stream->out_buf_ptr, (size_t)read_size);
 
       /* Increment pointers and remaining length */
       stream->out_buf_ptr += read_size;
@@ -720,61 +1024,51 @@ error:
 /* File Write */
 
 /* Compresses currently cached data and writes it
- * as the next RZIP file chunk */
+ * as the next RZIP file chunk(s) */
 static bool rzipstream_write_chunk(rzipstream_t *stream)
 {
    unsigned i;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
-   uint32_t deflate_read;
-   uint32_t deflate_written;
+   unsigned count;
 
-   if (!stream || !stream->deflate_backend || !stream->deflate_stream)
+   if (!stream || !stream->backend)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
+   /* Split data currently held in input
+    * buffer into chunks */
+   count = (stream->in_buf_ptr + stream->chunk_size - 1) / stream->chunk_size;
 
-   /* Compress data currently held in input buffer */
-   stream->deflate_backend->set_in(
-         stream->deflate_stream,
-         stream->in_buf, stream->in_buf_ptr);
+   for (i = 0; i < count; i++)
+      stream->chunk_in_size[i] = (i + 1 < count)
+            ? stream->chunk_size
+            : stream->in_buf_ptr - i * stream->chunk_size;
 
-   stream->deflate_backend->set_out(
-         stream->deflate_stream,
-         stream->out_buf, stream->out_buf_size);
-
-   /* Note: We have to set 'flush == true' here, otherwise we
-    * can't guarantee that the entire chunk will be written
-    * to the output buffer - this is inefficient, but not
-    * much we can do... */
-   if (!stream->deflate_backend->trans(
-         stream->deflate_stream, true,
-         &deflate_read, &deflate_written, NULL))
+   /* Compress chunks */
+   if (!rzipstream_trans_chunks(stream, count))
       return false;
 
-   /* Error checking */
-   if (deflate_read != stream->in_buf_ptr)
-      return false;
-
-   if (   (deflate_written == 0)
-       || (deflate_written > stream->out_buf_size))
-      return false;
-
-   /* Write compressed chunk size to file */
-   chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
-   chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
-   chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
-   chunk_header_bytes[0] =  deflate_written        & 0xFF;
-
-   if (filestream_write(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
-      return false;
+   /* Write chunks to file, in order */
+   for (i = 0; i < count; i++)
+   {
+      uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+      uint32_t compressed_chunk_size = stream->chunk_out_size[i];
+
+      /* Write compressed chunk size to file */
+      chunk_header_bytes[3] = (compressed_chunk_size >> 24) & 0xFF;
+      chunk_header_bytes[2] = (compressed_chunk_size >> 16) & 0xFF;
+      chunk_header_bytes[1] = (compressed_chunk_size >>  8) & 0xFF;
+      chunk_header_bytes[0] =  compressed_chunk_size        & 0xFF;
+
+      if (filestream_write(
+            stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
+            RZIP_CHUNK_HEADER_SIZE)
+         return false;
 
-   /* Write compressed data to file */
-   if (filestream_write(
-         stream->file, stream->out_buf, deflate_written) != deflate_written)
-      return false;
+      /* Write compressed data to file */
+      if (filestream_write(
+            stream->file, stream->out_buf + i * stream->out_chunk_size,
+            compressed_chunk_size) != compressed_chunk_size)
+         return false;
+   }
 
    /* Reset input buffer pointer */
    stream->in_buf_ptr = 0;
@@ -940,7 +1234,7 @@ void rzipstream_rewind(rzipstream_t *stream)
    if (stream->is_writing)
    {
       /* Reset file position to first chunk location */
-      filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
+      filestream_seek(stream->file, stream->header_size, SEEK_SET);
       if (filestream_error(stream->file))
          return;
 
@@ -953,27 +1247,35 @@ void rzipstream_rewind(rzipstream_t *stream)
    }
    else
    {
-      /* Check whether first file chunk is currently
-       * buffered in memory */
-      if ((stream->virtual_ptr < stream->chunk_size) &&
-          (stream->out_buf_ptr < stream->out_buf_occupancy))
+      unsigned i;
+      uint64_t batch_size = 0;
+
+      for (i = 0; i < stream->chunk_count; i++)
+         batch_size += stream->chunk_out_size[i];
+
+      /* Check whether first batch of file chunks is
+       * currently buffered in memory */
+      if (stream->chunk_count && (stream->decoded == batch_size))
       {
          /* It is: No file access is therefore required
           * > Just reset pointers */
-         stream->virtual_ptr = 0;
-         stream->out_buf_ptr = 0;
+         stream->virtual_ptr       = 0;
+         stream->chunk_index       = 0;
+         stream->out_buf_occupancy = stream->chunk_out_size[0];
+         stream->out_buf_ptr       = 0;
       }
       else
       {
-         /* It isn't: Have to re-read the first chunk
+         /* It isn't: Have to re-read the first batch
           * from disk... */
 
          /* Reset file position to first chunk location */
-         filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
+         filestream_seek(stream->file, stream->header_size, SEEK_SET);
          if (filestream_error(stream->file))
             return;
 
-         /* Read chunk */
+         /* Read chunks */
+         stream->decoded = 0;
          if (!rzipstream_read_chunk(stream))
             return;
 
@@ -0,0 +1,257 @@
+/* Copyright  (C) 2010-2026 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (trans_stream_zstd.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstd.h>
+#include <string/stdstring.h>
+#include <streams/trans_stream.h>
+
+struct zstd_trans_stream
+{
+   ZSTD_CCtx *cctx;
+   ZSTD_DCtx *dctx;
+   ZSTD_inBuffer in;
+   ZSTD_outBuffer out;
+   int level;
+   /* A frame has been started but not finished yet */
+   bool in_frame;
+};
+
+static void *zstd_compress_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   if (!(ret->cctx = ZSTD_createCCtx()))
+   {
+      free(ret);
+      return NULL;
+   }
+   ret->level = ZSTD_CLEVEL_DEFAULT;
+   return (void *)ret;
+}
+
+static void *zstd_decompress_stream_new(void)
+{
+   struct zstd_trans_stream *ret = (struct zstd_trans_stream*)
+      calloc(1, sizeof(*ret));
+   if (!ret)
+      return NULL;
+   if (!(ret->dctx = ZSTD_createDCtx()))
+   {
+      free(ret);
+      return NULL;
+   }
+   return (void *)ret;
+}
+
+static void zstd_stream_free(void *data)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+   if (!z)
+      return;
+   if (z->cctx)
+      ZSTD_freeCCtx(z->cctx);
+   if (z->dctx)
+      ZSTD_freeDCtx(z->dctx);
+   free(z);
+}
+
+static bool zstd_compress_define(void *data, const char *prop, uint32_t val)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream*)data;
+   if (!data)
+      return false;
+
+   if (string_is_equal(prop, "level"))
+   {
+      z->level = (int) val;
+      return true;
+   }
+   return false;
+}
+
+static bool zstd_decompress_define(void *data, const char *prop, uint32_t val)
+{
+   return false;
+}
+
+static void zstd_set_in(void *data, const uint8_t *in, uint32_t in_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->in.src  = in;
+   z->in.size = in_size;
+   z->in.pos  = 0;
+}
+
+static void zstd_set_out(void *data, uint8_t *out, uint32_t out_size)
+{
+   struct zstd_trans_stream *z = (struct zstd_trans_stream *) data;
+
+   if (!z)
+      return;
+
+   z->out.dst  = out;
+   z->out.size = out_size;
+   z->out.pos  = 0;
+}
+
+static bool zstd_compress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *err)
+{
+   size_t zret;
+   size_t pre_in_pos            = 0;
+   size_t pre_out_pos           = 0;
+   struct zstd_trans_stream *z  = (struct zstd_trans_stream *) data;
+
+   if (!z->in_frame)
+   {
+      ZSTD_CCtx_reset(z->cctx, ZSTD_reset_session_only);
+      ZSTD_CCtx_setParameter(z->cctx, ZSTD_c_compressionLevel, z->level);
+      z->in_frame = true;
+   }
+
+   pre_in_pos  = z->in.pos;
+   pre_out_pos = z->out.pos;
+   zret        = ZSTD_compressStream2(z->cctx, &z->out, &z->in,
+         flush ? ZSTD_e_end : ZSTD_e_continue);
+
+   *rd = (uint32_t)(z->in.pos  - pre_in_pos);
+   *wn = (uint32_t)(z->out.pos - pre_out_pos);
+
+   if (ZSTD_isError(zret))
+   {
+      z->in_frame = false;
+      if (err)
+         *err = TRANS_STREAM_ERROR_OTHER;
+      return false;
+   }
+
+   if (flush && zret == 0)
+   {
+      z->in_frame = false;
+      if (err)
+         *err = TRANS_STREAM_ERROR_NONE;
+      return true;
+   }
+
+   if (z->out.pos == z->out.size)
+   {
+      /* Filled buffer with data still pending; when finishing
+       * a frame, start over on the next call */
+      if (flush)
+         z->in_frame = false;
+      if (err)
+         *err = TRANS_STREAM_ERROR_BUFFER_FULL;
+      return false;
+   }
+
+   if (err)
+      *err = TRANS_STREAM_ERROR_AGAIN;
+   return true;
+}
+
+static bool zstd_decompress_trans(
+   void *data, bool flush,
+   uint32_t *rd, uint32_t *wn,
+   enum trans_stream_error *err)
+{
+   size_t zret;
+   size_t pre_in_pos            = 0;
+   size_t pre_out_pos           = 0;
+   struct zstd_trans_stream *z  = (struct zstd_trans_stream *) data;
+
+   if (!z->in_frame)
+   {
+      ZSTD_DCtx_reset(z->dctx, ZSTD_reset_session_only);
+      z->in_frame = true;
+   }
+
+   pre_in_pos  = z->in.pos;
+   pre_out_pos = z->out.pos;
+   zret        = ZSTD_decompressStream(z->dctx, &z->out, &z->in);
+
+   *rd = (uint32_t)(z->in.pos  - pre_in_pos);
+   *wn = (uint32_t)(z->out.pos - pre_out_pos);
+
+   if (ZSTD_isError(zret))
+   {
+      z->in_frame = false;
+      if (err)
+         *err = TRANS_STREAM_ERROR_OTHER;
+      return false;
+   }
+
+   /* Frame fully decoded and flushed */
+   if (zret == 0)
+   {
+      z->in_frame = false;
+      if (err)
+         *err = TRANS_STREAM_ERROR_NONE;
+      return true;
+   }
+
+   if (z->out.pos == z->out.size && z->in.pos != z->in.size)
+   {
+      if (flush)
+         z->in_frame = false;
+      if (err)
+         *err = TRANS_STREAM_ERROR_BUFFER_FULL;
+      return false;
+   }
+
+   if (err)
+      *err = TRANS_STREAM_ERROR_AGAIN;
+   return true;
+}
+
+const struct trans_stream_backend zstd_compress_backend = {
+   "zstd_compress",
+   &zstd_decompress_backend,
+   zstd_compress_stream_new,
+   zstd_stream_free,
+   zstd_compress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_compress_trans
+};
+
+const struct trans_stream_backend zstd_decompress_backend = {
+   "zstd_decompress",
+   &zstd_compress_backend,
+   zstd_decompress_stream_new,
+   zstd_stream_free,
+   zstd_decompress_define,
+   zstd_set_in,
+   zstd_set_out,
+   zstd_decompress_trans
+};
@@ -0,0 +1,170 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_crc32.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* CRC32 throughput benchmark.
+ *
+ * Runs buffers of several sizes, from netplay-sized blocks up to
+ * disc-image-sized reads, through every CRC32 implementation built
+ * for this machine and reports MiB/s for each. The implementations
+ * are checked against each other along the way.
+ *
+ * Usage: bench_crc32 [-m MiB per measurement] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+
+/* Pulled in whole to get at the individual
+ * implementations behind encoding_crc32() */
+#include "../../encodings/encoding_crc32.c"
+
+typedef uint32_t (*bench_crc32_t)(uint32_t crc, const uint8_t *s, size_t len);
+
+static uint32_t bench_crc32_bytewise(uint32_t crc, const uint8_t *s, size_t len)
+{
+#if __ARM_FEATURE_CRC32
+   while (len--)
+      crc = __crc32b(crc, *s++);
+#else
+   while (len--)
+      crc = crc32_table[0][(crc ^ (*s++)) & 0xff] ^ (crc >> 8);
+#endif
+   return crc;
+}
+
+#if !__ARM_FEATURE_CRC32
+static uint32_t bench_crc32_slice_by_8(uint32_t crc, const uint8_t *s, size_t len)
+{
+   return crc32_slice_by_8(crc, s, len);
+}
+#endif
+
+#ifdef CRC32_PCLMUL
+static uint32_t bench_crc32_pclmul(uint32_t crc, const uint8_t *s, size_t len)
+{
+   return crc32_pclmul(crc, s, len);
+}
+#endif
+
+/* encoding_crc32() inverts on the way in and out,
+ * the others work on the inverted CRC */
+static uint32_t bench_crc32_dispatch(uint32_t crc, const uint8_t *s, size_t len)
+{
+   return ~encoding_crc32(~crc, s, len);
+}
+
+static const struct
+{
+   const char *name;
+   bench_crc32_t func;
+   bool (*supported)(void);
+} bench_impls[] = {
+   { "bytewise",   bench_crc32_bytewise,   NULL },
+#if !__ARM_FEATURE_CRC32
+   { "slice-by-8", bench_crc32_slice_by_8, NULL },
+#endif
+#ifdef CRC32_PCLMUL
+   { "pclmul",     bench_crc32_pclmul,     crc32_pclmul_supported },
+#endif
+   { "dispatched", bench_crc32_dispatch,   NULL }
+};
+
+int main(int argc, char *argv[])
+{
+   int i;
+   size_t j, k;
+   static const size_t sizes[] = { 64, 1024, 16384, 1 << 20, 16 << 20 };
+   size_t total    = 256 << 20;
+   size_t max_size = sizes[sizeof(sizes) / sizeof(*sizes) - 1];
+   unsigned errors = 0;
+   uint8_t *buf;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-m") && i + 1 < argc)
+         total = (size_t)atoi(argv[++i]) << 20;
+      else
+      {
+         fprintf(stderr, "Usage: %s [-m MiB per measurement]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (!(buf = (uint8_t*)malloc(max_size + 1)))
+      return 1;
+
+   for (j = 0; j < max_size + 1; j++)
+      buf[j] = (uint8_t)(j * 2654435761u >> 13);
+
+   printf("%-12s", "bytes");
+   for (k = 0; k < sizeof(bench_impls) / sizeof(*bench_impls); k++)
+      printf("%14s", bench_impls[k].name);
+   printf("   MiB/s\n");
+
+   for (j = 0; j < sizeof(sizes) / sizeof(*sizes); j++)
+   {
+      /* Misaligned by one byte, as file reads
+       * into a caller's buffer often are */
+      const uint8_t *data = buf + 1;
+      size_t len          = sizes[j];
+      size_t rounds       = total / len ? total / len : 1;
+      uint32_t expected   = bench_crc32_bytewise(0xffffffff, data, len);
+
+      printf("%-12u", (unsigned)len);
+
+      for (k = 0; k < sizeof(bench_impls) / sizeof(*bench_impls); k++)
+      {
+         size_t r;
+         retro_time_t start, t;
+         uint32_t crc = 0;
+
+         if (bench_impls[k].supported && !bench_impls[k].supported())
+         {
+            printf("%14s", "-");
+            continue;
+         }
+
+         if (bench_impls[k].func(0xffffffff, data, len) != expected)
+            errors++;
+
+         start = cpu_features_get_time_usec();
+         for (r = 0; r < rounds; r++)
+            crc = bench_impls[k].func(crc, data, len);
+         t     = cpu_features_get_time_usec() - start;
+
+         /* Keeps the loop from being optimized away */
+         if (crc == 0x12345678)
+            putchar(' ');
+
+         printf("%14.1f", t ? ((double)len * rounds / (1 << 20))
+               / (t / 1000000.0) : 0.0);
+      }
+      printf("\n");
+   }
+
+   printf("%s\n", errors ? "CRC MISMATCH" : "CRCs match");
+   free(buf);
+
+   return errors ? 1 : 0;
+}
@@ -71,6 +71,43 @@ START_TEST (test_crc32)
 }
 END_TEST
 
+/* Bit at a time, straight from the polynomial */
+static uint32_t crc32_reference(uint32_t crc, const uint8_t *s, size_t len)
+{
+   crc = ~crc;
+   while (len--)
+   {
+      int k;
+      crc ^= *s++;
+      for (k = 0; k < 8; k++)
+         crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+   }
+   return ~crc;
+}
+
+START_TEST (test_crc32_lengths)
+{
+   size_t i, len, offset;
+   uint8_t buf[1024 + 16];
+
+   for (i = 0; i < sizeof(buf); i++)
+      buf[i] = (uint8_t)(i * 2654435761u >> 13);
+
+   /* Every length and alignment the wide paths
+    * and their tails can see */
+   for (offset = 0; offset < 16; offset++)
+      for (len = 0; len <= 1024; len++)
+         ck_assert_uint_eq(encoding_crc32(0, buf + offset, len),
+               crc32_reference(0, buf + offset, len));
+
+   /* Chaining */
+   for (len = 0; len <= 1024; len += 7)
+      ck_assert_uint_eq(
+            encoding_crc32(encoding_crc32(0, buf, len), buf + len, 1024 - len),
+            crc32_reference(0, buf, 1024));
+}
+END_TEST
+
 #define CRC32_BUFFER_SIZE 1048576
 #define CRC32_MAX_MB 64
 
@@ -141,6 +178,7 @@ Suite *create_suite(void)
    TCase *tc_core = tcase_create("Core");
    tcase_add_test(tc_core, test_md5);
    tcase_add_test(tc_core, test_crc32);
+   tcase_add_test(tc_core, test_crc32_lengths);
    tcase_add_test(tc_core, test_crc32_file);
    suite_add_tcase(s, tc_core);
 
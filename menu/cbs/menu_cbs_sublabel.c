@@ -764,6 +764,8 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_runahead_mode,                 MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_runahead_mode,                 MENU_ENUM_SUBLABEL_RUNAHEAD_MODE_NO_SECOND_INSTANCE)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_hide_warnings,       MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_state_cache,         MENU_ENUM_SUBLABEL_RUN_AHEAD_STATE_CACHE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_secondary_thread,    MENU_ENUM_SUBLABEL_RUN_AHEAD_SECONDARY_THREAD)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_run_ahead_frames,              MENU_ENUM_SUBLABEL_RUN_AHEAD_FRAMES)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_preempt_frames,                MENU_ENUM_SUBLABEL_PREEMPT_FRAMES)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_block_timeout,           MENU_ENUM_SUBLABEL_INPUT_BLOCK_TIMEOUT)
@@ -807,8 +809,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_cheat_file_load_append,        MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_cheat_file_save_as,            MENU_ENUM_SUBLABEL_CHEAT_FILE_SAVE_AS)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_granularity,            MENU_ENUM_SUBLABEL_REWIND_GRANULARITY)
-DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size,            MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size_step,       MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_threaded,               MENU_ENUM_SUBLABEL_REWIND_THREADED)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_compression,            MENU_ENUM_SUBLABEL_REWIND_COMPRESSION)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_libretro_log_level,            MENU_ENUM_SUBLABEL_LIBRETRO_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_frontend_log_level,            MENU_ENUM_SUBLABEL_FRONTEND_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_perfcnt_enable,                MENU_ENUM_SUBLABEL_PERFCNT_ENABLE)
@@ -817,6 +820,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_auto_load,           MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_thumbnail_enable,    MENU_ENUM_SUBLABEL_SAVESTATE_THUMBNAIL_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_save_file_compression,         MENU_ENUM_SUBLABEL_SAVE_FILE_COMPRESSION)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_file_compression,    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_save_compression_zstd,         MENU_ENUM_SUBLABEL_SAVE_COMPRESSION_ZSTD)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_max_keep,            MENU_ENUM_SUBLABEL_SAVESTATE_MAX_KEEP)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_autosave_interval,             MENU_ENUM_SUBLABEL_AUTOSAVE_INTERVAL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_replay_max_keep,               MENU_ENUM_SUBLABEL_REPLAY_MAX_KEEP)
@@ -974,6 +978,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_ozone_truncate_playlist_name,
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_ozone_sort_after_truncate_playlist_name, MENU_ENUM_SUBLABEL_OZONE_SORT_AFTER_TRUNCATE_PLAYLIST_NAME)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_thumbnail_upscale_threshold,      MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_thumbnail_cache_enable,           MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_thumbnail_background_enable,      MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_BACKGROUND_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_timedate_enable,                       MENU_ENUM_SUBLABEL_TIMEDATE_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_timedate_style,                        MENU_ENUM_SUBLABEL_TIMEDATE_STYLE)
@@ -1538,6 +1543,40 @@ static int action_bind_sublabel_cpu_perf_mode(
 }
 #endif
 
+static int action_bind_sublabel_rewind_buffer_size(
+      file_list_t *list,
+      unsigned type, unsigned i,
+      const char *label, const char *path,
+      char *s, size_t len)
+{
+   size_t _len = strlcpy(s,
+         msg_hash_to_str(MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE), len);
+#ifdef HAVE_REWIND
+   {
+      /* Append how much history the running buffer holds */
+      unsigned entries               = 0;
+      size_t used                    = 0;
+      runloop_state_t *runloop_st    = runloop_state_get_ptr();
+      video_driver_state_t *video_st = video_state_get_ptr();
+      double fps                     = video_st->av_info.timing.fps;
+      unsigned granularity           = config_get_ptr()->uints.rewind_granularity;
+
+      if (     state_manager_get_history(&runloop_st->rewind_st,
+                  &entries, &used)
+            && fps > 0.0)
+      {
+         _len += strlcpy(s + _len, "\n", len - _len);
+         snprintf(s + _len, len - _len,
+               msg_hash_to_str(MSG_REWIND_HISTORY),
+               entries * (granularity ? granularity : 1) / fps,
+               entries,
+               (unsigned)(used / (1024 * 1024)));
+      }
+   }
+#endif
+   return 0;
+}
+
 #ifdef HAVE_CHEEVOS
 static int action_bind_sublabel_cheevos_entry(
       file_list_t *list,
@@ -3821,6 +3860,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_menu_thumbnail_upscale_threshold);
             break;
+         case MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_ENABLE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_menu_thumbnail_cache_enable);
+            break;
          case MENU_ENUM_LABEL_MOUSE_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_mouse_enable);
             break;
@@ -4173,6 +4215,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_file_compression);
             break;
+         case MENU_ENUM_LABEL_SAVE_COMPRESSION_ZSTD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_save_compression_zstd);
+            break;
          case MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_auto_save);
             break;
@@ -4205,6 +4250,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_buffer_size_step);
             break;
+         case MENU_ENUM_LABEL_REWIND_THREADED:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_threaded);
+            break;
+         case MENU_ENUM_LABEL_REWIND_COMPRESSION:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_compression);
+            break;
          case MENU_ENUM_LABEL_CHEAT_IDX:
 #ifdef HAVE_CHEATS
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheat_idx);
@@ -4337,6 +4388,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_hide_warnings);
             break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_STATE_CACHE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_state_cache);
+            break;
+         case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_secondary_thread);
+            break;
          case MENU_ENUM_LABEL_RUN_AHEAD_FRAMES:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_run_ahead_frames);
             break;
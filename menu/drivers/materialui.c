@@ -9223,6 +9223,7 @@ static void materialui_context_destroy(void *data)
 
    /* Free node thumbnails */
    materialui_reset_thumbnails(mui);
+   gfx_thumbnail_flush_texture_cache();
 
    /* Free background/wallpaper textures */
    materialui_context_bg_destroy(mui);
@@ -11431,6 +11432,7 @@ static void materialui_list_insert(void *userdata,
 
       node->thumbnails.primary.status        = GFX_THUMBNAIL_STATUS_UNKNOWN;
       node->thumbnails.primary.texture       = 0;
+      node->thumbnails.primary.cache_key     = 0;
       node->thumbnails.primary.width         = 0;
       node->thumbnails.primary.height        = 0;
       node->thumbnails.primary.alpha         = 0.0f;
@@ -11440,6 +11442,7 @@ static void materialui_list_insert(void *userdata,
 
       node->thumbnails.secondary.status      = GFX_THUMBNAIL_STATUS_UNKNOWN;
       node->thumbnails.secondary.texture     = 0;
+      node->thumbnails.secondary.cache_key   = 0;
       node->thumbnails.secondary.width       = 0;
       node->thumbnails.secondary.height      = 0;
       node->thumbnails.secondary.alpha       = 0.0f;
@@ -9851,6 +9851,7 @@ static void ozone_context_destroy(void *data)
 
    /* Thumbnails */
    ozone_unload_thumbnail_textures(ozone);
+   gfx_thumbnail_flush_texture_cache();
 
    gfx_display_deinit_white_texture();
 
@@ -9235,6 +9235,7 @@ static void xmb_context_destroy(void *data)
 
    xmb_unload_thumbnail_textures(xmb);
    xmb_unload_icon_thumbnail_textures(xmb);
+   gfx_thumbnail_flush_texture_cache();
 
    xmb_context_destroy_horizontal_list(xmb);
    xmb_context_bg_destroy(xmb);
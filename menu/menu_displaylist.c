@@ -10608,6 +10608,7 @@ unsigned menu_displaylist_build_list(
 #ifdef HAVE_RUNAHEAD
             bool runahead_supported       = true;
             bool runahead_enabled         = settings->bools.run_ahead_enabled;
+            bool runahead_secondary       = settings->bools.run_ahead_secondary_instance;
             bool preempt_enabled          = settings->bools.preemptive_frames_enable;
 #endif
             menu_displaylist_build_info_selective_t build_list[] = {
@@ -10616,6 +10617,10 @@ unsigned menu_displaylist_build_list(
 #ifdef HAVE_RUNAHEAD
                {MENU_ENUM_LABEL_RUNAHEAD_MODE,                         PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,                      PARSE_ONLY_UINT, false },
+               {MENU_ENUM_LABEL_RUN_AHEAD_STATE_CACHE,                 PARSE_ONLY_BOOL, false },
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+               {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD,            PARSE_ONLY_BOOL, false },
+#endif
                {MENU_ENUM_LABEL_PREEMPT_FRAMES,                        PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,               PARSE_ONLY_BOOL, false },
 #endif
@@ -10681,6 +10686,14 @@ unsigned menu_displaylist_build_list(
                         if (runahead_enabled)
                            build_list[i].checked = true;
                         break;
+                     case MENU_ENUM_LABEL_RUN_AHEAD_STATE_CACHE:
+                        if (runahead_enabled && !runahead_secondary)
+                           build_list[i].checked = true;
+                        break;
+                     case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD:
+                        if (runahead_enabled && runahead_secondary)
+                           build_list[i].checked = true;
+                        break;
                      case MENU_ENUM_LABEL_PREEMPT_FRAMES:
                         if (preempt_enabled)
                            build_list[i].checked = true;
@@ -11018,6 +11031,9 @@ unsigned menu_displaylist_build_list(
 #if defined(HAVE_ZLIB)
                {MENU_ENUM_LABEL_SAVE_FILE_COMPRESSION,              PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,         PARSE_ONLY_BOOL, true},
+#if defined(HAVE_ZSTD)
+               {MENU_ENUM_LABEL_SAVE_COMPRESSION_ZSTD,              PARSE_ONLY_BOOL, true},
+#endif
 #endif
                {MENU_ENUM_LABEL_SAVESTATE_THUMBNAIL_ENABLE,         PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,                PARSE_ONLY_BOOL, true},
@@ -11713,6 +11729,10 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_REWIND_GRANULARITY,      PARSE_ONLY_UINT, true },
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,      PARSE_ONLY_SIZE, true },
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP, PARSE_ONLY_UINT, true },
+#ifdef HAVE_THREADS
+               {MENU_ENUM_LABEL_REWIND_THREADED,         PARSE_ONLY_BOOL, true },
+#endif
+               {MENU_ENUM_LABEL_REWIND_COMPRESSION,      PARSE_ONLY_BOOL, true },
                {MENU_ENUM_LABEL_AUDIO_REWIND_MUTE,       PARSE_ONLY_BOOL, true },
             };
 
@@ -11859,6 +11879,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_MENU_XMB_THUMBNAIL_SCALE_FACTOR,              PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_OZONE_THUMBNAIL_SCALE_FACTOR,                 PARSE_ONLY_FLOAT,  true},
                {MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,             PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_ENABLE,                  PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_SWAP_THUMBNAILS,                    PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,               PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DELAY,                    PARSE_ONLY_UINT,   true},
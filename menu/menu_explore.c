@@ -20,6 +20,7 @@
 #include <compat/strl.h>
 #include <array/rbuf.h>
 #include <array/rhmap.h>
+#include <file/file_path.h>
 #include <formats/rjson.h>
 #include <formats/rjson_helpers.h>
 #include <retro_endianness.h>
@@ -448,29 +449,417 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
+/* Persistent index
+ *
+ * Walking every RDB referenced by the playlists is what makes
+ * building the explore state slow. The matches it produces are
+ * kept in FILE_PATH_EXPLORE_CACHE in the playlist directory, one
+ * record per RDB. A record is reused as long as the RDB file is
+ * unchanged and the playlists still ask it for the same content;
+ * otherwise only that RDB is walked again.
+ *
+ * A record holds the matches in the order the walk produced them,
+ * with the metadata fields as read from the RDB, so replaying it
+ * goes through the same steps as the walk. Boolean fields are
+ * stored as "0"/"1" and localized on replay. All values are in
+ * native byte order; a cache written on another platform is
+ * rebuilt. */
+#define EXPLORE_CACHE_MAGIC      0x43584552 /* "REXC" */
+#define EXPLORE_CACHE_VERSION    2
+#define EXPLORE_CACHE_BYTE_ORDER 0x01020304
+
+struct explore_source
+{
+   const struct playlist_entry *source;
+   uint32_t entry_index, meta_count;
+};
+
+struct explore_rdb
+{
+   libretrodb_t *handle;
+   struct explore_source *playlist_crcs;
+   struct explore_source *playlist_names;
+   char *path;
+   size_t count;
+   uint64_t key_hash;  /* Sum of the hashed lookup keys */
+   uint32_t key_count;
+   char systemname[NAME_MAX_LENGTH];
+};
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t byte_order;
+   uint32_t cat_count;
+   uint32_t record_count;
+} explore_cache_header_t;
+
+typedef struct
+{
+   uint64_t rdb_size;
+   int64_t rdb_mtime;
+   uint64_t key_hash;
+   uint32_t key_count;
+   uint32_t match_count;
+} explore_cache_record_t;
+
+/* Read cursor over a loaded cache file */
+typedef struct
+{
+   const uint8_t *ptr;
+   const uint8_t *end;
+   bool error;
+} explore_cache_reader_t;
+
+static bool explore_cache_stat(const char *path,
+      explore_cache_record_t *record)
+{
+   int32_t size;
+   int flags = path_stat(path);
+
+   if (     !(flags & RETRO_VFS_STAT_IS_VALID)
+         ||  (flags & RETRO_VFS_STAT_IS_DIRECTORY)
+         || (size = path_get_size(path)) < 0)
+      return false;
+
+   record->rdb_size  = (uint64_t)size;
+   record->rdb_mtime = path_get_mtime(path);
+   return true;
+}
+
+static uint64_t explore_cache_key_hash(uint64_t h)
+{
+   /* splitmix64 finalizer, so that summing
+    * the keys still tells sets apart */
+   h ^= h >> 30;
+   h *= 0xbf58476d1ce4e5b9ULL;
+   h ^= h >> 27;
+   h *= 0x94d049bb133111ebULL;
+   h ^= h >> 31;
+   return h;
+}
+
+static void explore_cache_put(char **buf, const void *data, size_t len)
+{
+   size_t pos = RBUF_LEN(*buf);
+   RBUF_RESIZE(*buf, pos + len);
+   memcpy(*buf + pos, data, len);
+}
+
+static void explore_cache_put_u32(char **buf, uint32_t val)
+{
+   explore_cache_put(buf, &val, sizeof(val));
+}
+
+/* Strings are stored as their length plus one (0 for NULL)
+ * and their characters including the terminator, so they
+ * can be used straight from the loaded file */
+static void explore_cache_put_str(char **buf, const char *str)
+{
+   uint32_t _len = str ? (uint32_t)strlen(str) + 1 : 0;
+   explore_cache_put_u32(buf, _len);
+   if (_len)
+      explore_cache_put(buf, str, _len);
+}
+
+static void explore_cache_get(explore_cache_reader_t *reader,
+      void *data, size_t len)
+{
+   if (reader->error || len > (size_t)(reader->end - reader->ptr))
+   {
+      reader->error = true;
+      memset(data, 0, len);
+      return;
+   }
+   memcpy(data, reader->ptr, len);
+   reader->ptr += len;
+}
+
+static uint32_t explore_cache_get_u32(explore_cache_reader_t *reader)
+{
+   uint32_t val;
+   explore_cache_get(reader, &val, sizeof(val));
+   return val;
+}
+
+static const char *explore_cache_get_str(explore_cache_reader_t *reader)
+{
+   const char *str;
+   uint32_t _len = explore_cache_get_u32(reader);
+
+   if (!_len || reader->error)
+      return NULL;
+
+   if (     _len > (size_t)(reader->end - reader->ptr)
+         || reader->ptr[_len - 1] != '\0')
+   {
+      reader->error = true;
+      return NULL;
+   }
+
+   str          = (const char*)reader->ptr;
+   reader->ptr += _len;
+   return str;
+}
+
+static void explore_cache_put_match(char **buf, uint32_t crc32,
+      const char *name, uint32_t meta_count,
+      const char *fields[EXPLORE_CAT_COUNT], const char *original_title)
+{
+   unsigned cat;
+   const char *str_yes = msg_hash_to_str(MENU_ENUM_LABEL_VALUE_YES);
+
+   explore_cache_put_u32(buf, crc32);
+   explore_cache_put_str(buf, name);
+   explore_cache_put_u32(buf, meta_count);
+   explore_cache_put_str(buf, original_title);
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      if (cat == EXPLORE_BY_SYSTEM)
+         continue;
+      if (explore_by_info[cat].is_boolean && fields[cat])
+         explore_cache_put_str(buf, fields[cat] == str_yes ? "1" : "0");
+      else
+         explore_cache_put_str(buf, fields[cat]);
+   }
+}
+
+static void explore_cache_get_match(explore_cache_reader_t *reader,
+      uint32_t *crc32, const char **name, uint32_t *meta_count,
+      const char *fields[EXPLORE_CAT_COUNT], const char **original_title)
+{
+   unsigned cat;
+
+   *crc32          = explore_cache_get_u32(reader);
+   *name           = explore_cache_get_str(reader);
+   *meta_count     = explore_cache_get_u32(reader);
+   *original_title = explore_cache_get_str(reader);
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      if (cat == EXPLORE_BY_SYSTEM)
+         fields[cat] = NULL;
+      else if (     (fields[cat] = explore_cache_get_str(reader))
+               && explore_by_info[cat].is_boolean)
+         fields[cat] = msg_hash_to_str(*fields[cat] == '1'
+               ? MENU_ENUM_LABEL_VALUE_YES
+               : MENU_ENUM_LABEL_VALUE_NO);
+   }
+}
+
+/* Loads the cache file and maps each RDB path to the
+ * start of its record. Returns the file contents, which
+ * the map points into, or NULL if there is no usable
+ * cache. */
+static uint8_t *explore_cache_load(const char *path,
+      const uint8_t ***records)
+{
+   uint32_t i;
+   explore_cache_header_t header;
+   explore_cache_reader_t reader;
+   const uint8_t **map = NULL;
+   void *buf           = NULL;
+   int64_t len         = 0;
+
+   if (     !filestream_exists(path)
+         || !filestream_read_file(path, &buf, &len)
+         || !buf)
+      return NULL;
+
+   reader.ptr   = (const uint8_t*)buf;
+   reader.end   = reader.ptr + len;
+   reader.error = false;
+
+   explore_cache_get(&reader, &header, sizeof(header));
+
+   if (     reader.error
+         || header.magic      != EXPLORE_CACHE_MAGIC
+         || header.version    != EXPLORE_CACHE_VERSION
+         || header.byte_order != EXPLORE_CACHE_BYTE_ORDER
+         || header.cat_count  != EXPLORE_CAT_COUNT)
+   {
+      free(buf);
+      return NULL;
+   }
+
+   for (i = 0; i < header.record_count; i++)
+   {
+      const uint8_t *record = reader.ptr;
+      uint32_t record_len   = explore_cache_get_u32(&reader);
+      const char *rdb_path  = explore_cache_get_str(&reader);
+
+      if (   !rdb_path
+          || record_len > (size_t)(reader.end - record) - sizeof(uint32_t))
+         break;
+
+      RHMAP_SET_STR(map, rdb_path, record);
+      reader.ptr = record + sizeof(uint32_t) + record_len;
+   }
+
+   *records = map;
+   return (uint8_t*)buf;
+}
+
+static void explore_add_entry(explore_state_t *state,
+      explore_string_t **cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf,
+      struct explore_rdb *rdb, struct explore_source *src,
+      uint32_t meta_count, const char *fields[EXPLORE_CAT_COUNT],
+      const char *original_title)
+{
+   unsigned l, cat;
+   explore_entry_t *e;
+
+   if (src->entry_index == (uint32_t)-1)
+   {
+      src->entry_index = (uint32_t)RBUF_LEN(state->entries);
+      RBUF_RESIZE(state->entries, src->entry_index + 1);
+   }
+   e = &state->entries[src->entry_index];
+   src->meta_count = meta_count;
+   e->playlist_entry = src->source;
+   for (l = 0; l < EXPLORE_CAT_COUNT; l++)
+      e->by[l]       = NULL;
+   e->split          = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   e->original_title = NULL;
+#endif
+
+   fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      explore_add_unique_string(state,
+            cat_maps, e, cat,
+            fields[cat], split_buf);
+   }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   if (original_title && *original_title)
+   {
+      size_t _len       = strlen(original_title) + 1;
+      e->original_title = (char*)
+         ex_arena_alloc(&state->arena, _len);
+      memcpy(e->original_title, original_title, _len);
+   }
+#endif
+
+   if (RBUF_LEN(*split_buf))
+   {
+      size_t _len;
+
+      RBUF_PUSH(*split_buf, NULL); /* terminator */
+      _len       = RBUF_SIZEOF(*split_buf);
+      e->split   = (explore_string_t **)
+         ex_arena_alloc(&state->arena, _len);
+      memcpy(e->split, *split_buf, _len);
+      RBUF_CLEAR(*split_buf);
+   }
+}
+
+/* Finds the playlist entry an RDB item belongs to, if
+ * it doesn't already have at least as much metadata. */
+static struct explore_source *explore_find_source(
+      struct explore_rdb *rdb, uint32_t crc32, const char *name,
+      uint32_t meta_count)
+{
+   struct explore_source *src = NULL;
+
+   if (crc32)
+   {
+      ptrdiff_t idx = RHMAP_IDX(rdb->playlist_crcs, crc32);
+      src = (idx != -1 ? &rdb->playlist_crcs[idx] : NULL);
+   }
+   if (!src && name)
+   {
+      ptrdiff_t idx = RHMAP_IDX_STR(rdb->playlist_names, name);
+      src = (idx != -1 ? &rdb->playlist_names[idx] : NULL);
+   }
+   if (!src)
+      return NULL;
+   if (src->entry_index != (uint32_t)-1 && src->meta_count >= meta_count)
+      return NULL;
+   return src;
+}
+
+/* Replays a cache record into the explore state and
+ * appends it to @out. Returns false if the record is
+ * stale or damaged, in which case the RDB needs to be
+ * walked instead. */
+static bool explore_cache_replay(explore_state_t *state,
+      explore_string_t **cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf, struct explore_rdb *rdb,
+      const uint8_t *record, const explore_cache_record_t *stamp,
+      char **out)
+{
+   uint32_t i;
+   explore_cache_record_t cached;
+   explore_cache_reader_t reader;
+   const uint8_t *matches;
+   const char *fields[EXPLORE_CAT_COUNT];
+   const char *name, *original_title;
+   uint32_t crc32, meta_count;
+   uint32_t record_len;
+
+   memcpy(&record_len, record, sizeof(record_len));
+   reader.ptr   = record + sizeof(record_len);
+   reader.end   = reader.ptr + record_len;
+   reader.error = false;
+
+   explore_cache_get_str(&reader);
+   explore_cache_get(&reader, &cached, sizeof(cached));
+
+   if (     reader.error
+         || cached.rdb_size  != stamp->rdb_size
+         || cached.rdb_mtime != stamp->rdb_mtime
+         || cached.key_hash  != rdb->key_hash
+         || cached.key_count != rdb->key_count)
+      return false;
+
+   /* Check the whole record before touching the state */
+   matches = reader.ptr;
+   for (i = 0; i < cached.match_count && !reader.error; i++)
+      explore_cache_get_match(&reader, &crc32, &name, &meta_count,
+            fields, &original_title);
+
+   if (reader.error || reader.ptr != reader.end)
+      return false;
+
+   reader.ptr = matches;
+   for (i = 0; i < cached.match_count; i++)
+   {
+      struct explore_source *src;
+
+      explore_cache_get_match(&reader, &crc32, &name, &meta_count,
+            fields, &original_title);
+
+      if ((src = explore_find_source(rdb, crc32, name, meta_count)))
+         explore_add_entry(state, cat_maps, split_buf, rdb, src,
+               meta_count, fields, original_title);
+   }
+
+   explore_cache_put(out, record, sizeof(record_len) + record_len);
+   return true;
+}
+
 explore_state_t *menu_explore_build_list(const char *directory_playlist,
       const char *directory_database)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
-   struct explore_source
-   {
-      const struct playlist_entry *source;
-      uint32_t entry_index, meta_count;
-   };
-   struct explore_rdb
-   {
-      libretrodb_t *handle;
-      struct explore_source *playlist_crcs;
-      struct explore_source *playlist_names;
-      size_t count;
-      char systemname[NAME_MAX_LENGTH];
-   }
-   *rdbs                                          = NULL;
+   char cache_path[PATH_MAX_LENGTH];
+   struct explore_rdb *rdbs                       = NULL;
    int *rdb_indices                               = NULL;
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
    libretro_vfs_implementation_dir *dir           = NULL;
+   const uint8_t **cache_records                  = NULL;
+   uint8_t *cache_buf                             = NULL;
+   char *cache_out                                = NULL;
+   uint32_t cache_out_count                       = 0;
+   bool cache_dirty                               = false;
 
    explore_state_t *state = (explore_state_t*)calloc(1, sizeof(*state));
 
@@ -480,6 +869,10 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    state->label_explore_item_str    =
       msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
 
+   fill_pathname_join_special(cache_path, directory_playlist,
+         FILE_PATH_EXPLORE_CACHE, sizeof(cache_path));
+   cache_buf = explore_cache_load(cache_path, &cache_records);
+
    /* Index all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
    {
@@ -559,6 +952,8 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
             newrdb.count            = 0;
             newrdb.playlist_crcs    = NULL;
             newrdb.playlist_names   = NULL;
+            newrdb.key_hash         = 0;
+            newrdb.key_count        = 0;
 
             _len                    = db_ext - db_name;
             if (_len >= sizeof(newrdb.systemname))
@@ -589,6 +984,7 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
                continue;
             }
 
+            newrdb.path             = strdup(tmp);
             RBUF_PUSH(rdbs, newrdb);
             rdb_num = (int)RBUF_LEN(rdbs);
             RHMAP_SET(rdb_indices, rdb_hash, rdb_num);
@@ -601,16 +997,21 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
          if (rdb)
          {
             rdb->count++;
+            rdb->key_count++;
             entry_crc32 = (uint32_t)strtoul(
                   (entry->crc32 ? entry->crc32 : ""), NULL, 16);
             src.source = entry;
             if (entry_crc32)
             {
                RHMAP_SET(rdb->playlist_crcs, entry_crc32, src);
+               rdb->key_hash += explore_cache_key_hash(
+                     ((uint64_t)1 << 32) | entry_crc32);
             }
             else
             {
                RHMAP_SET_STR(rdb->playlist_names, entry->label, src);
+               rdb->key_hash += explore_cache_key_hash(
+                     rhmap_hash_string(entry->label));
             }
          }
          used_entries++;
@@ -627,9 +1028,37 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
    for (i = 0; i != RBUF_LEN(rdbs); i++)
    {
       struct rmsgpack_dom_value item;
+      explore_cache_record_t stamp;
+      size_t record_start, match_count_pos;
       struct explore_rdb* rdb  = &rdbs[i];
-      libretrodb_cursor_t *cur = libretrodb_cursor_new();
-      bool more                =
+      const uint8_t *record    = cache_records
+         ? RHMAP_GET_STR(cache_records, rdb->path) : NULL;
+      libretrodb_cursor_t *cur = NULL;
+      bool can_cache           = explore_cache_stat(rdb->path, &stamp);
+      bool more                = false;
+
+      if (can_cache && record && explore_cache_replay(state, cat_maps,
+               &split_buf, rdb, record, &stamp, &cache_out))
+      {
+         cache_out_count++;
+         goto next_rdb;
+      }
+
+      /* The record is written as the RDB is walked
+       * and dropped again if it can't be stamped */
+      cache_dirty            = true;
+      record_start           = RBUF_LEN(cache_out);
+      stamp.key_hash         = rdb->key_hash;
+      stamp.key_count        = rdb->key_count;
+      stamp.match_count      = 0;
+      explore_cache_put_u32(&cache_out, 0);
+      explore_cache_put_str(&cache_out, rdb->path);
+      match_count_pos        = RBUF_LEN(cache_out)
+         + offsetof(explore_cache_record_t, match_count);
+      explore_cache_put(&cache_out, &stamp, sizeof(stamp));
+
+      cur                    = libretrodb_cursor_new();
+      more                   =
          (
           libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
           && libretrodb_cursor_read_item(cur, &item) == 0);
@@ -637,16 +1066,13 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
       for (; more; more = (rmsgpack_dom_value_free(&item),
                libretrodb_cursor_read_item(cur, &item) == 0))
       {
-         unsigned k, l, cat;
-         explore_entry_t* e;
+         unsigned k, cat;
          const char *fields[EXPLORE_CAT_COUNT];
          char numeric_buf[EXPLORE_CAT_COUNT][16];
          uint32_t crc32                     = 0;
          uint32_t meta_count                = 0;
          char *name                         = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
          char *original_title               = NULL;
-#endif
          struct explore_source* src         = NULL;
 
          if (item.type != RDT_MAP)
@@ -728,66 +1154,15 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
             }
          }
 
-         if (crc32)
-         {
-            ptrdiff_t idx = RHMAP_IDX(rdb->playlist_crcs, crc32);
-            src = (idx != -1 ? &rdb->playlist_crcs[idx] : NULL);
-         }
-         if (!src && name)
-         {
-            ptrdiff_t idx = RHMAP_IDX_STR(rdb->playlist_names, name);
-            src = (idx != -1 ? &rdb->playlist_names[idx] : NULL);
-         }
-         if (!src)
-            continue;
-         if (src->entry_index != (uint32_t)-1 && src->meta_count >= meta_count)
+         if (!(src = explore_find_source(rdb, crc32, name, meta_count)))
             continue;
 
-         if (src->entry_index == (uint32_t)-1)
-         {
-            src->entry_index = (uint32_t)RBUF_LEN(state->entries);
-            RBUF_RESIZE(state->entries, src->entry_index + 1);
-         }
-         e = &state->entries[src->entry_index];
-         src->meta_count = meta_count;
-         e->playlist_entry = src->source;
-         for (l = 0; l < EXPLORE_CAT_COUNT; l++)
-            e->by[l]       = NULL;
-         e->split          = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         e->original_title = NULL;
-#endif
+         explore_cache_put_match(&cache_out, crc32, name, meta_count,
+               fields, original_title);
+         stamp.match_count++;
 
-         fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
-
-         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-         {
-            explore_add_unique_string(state,
-                  cat_maps, e, cat,
-                  fields[cat], &split_buf);
-         }
-
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         if (original_title && *original_title)
-         {
-            size_t _len       = strlen(original_title) + 1;
-            e->original_title = (char*)
-               ex_arena_alloc(&state->arena, _len);
-            memcpy(e->original_title, original_title, _len);
-         }
-#endif
-
-         if (RBUF_LEN(split_buf))
-         {
-            size_t _len;
-
-            RBUF_PUSH(split_buf, NULL); /* terminator */
-            _len       = RBUF_SIZEOF(split_buf);
-            e->split   = (explore_string_t **)
-               ex_arena_alloc(&state->arena, _len);
-            memcpy(e->split, split_buf, _len);
-            RBUF_CLEAR(split_buf);
-         }
+         explore_add_entry(state, cat_maps, &split_buf, rdb, src,
+               meta_count, fields, original_title);
 
          /* if all entries have found connections, we can leave early */
          if (--rdb->count == 0)
@@ -799,15 +1174,55 @@ explore_state_t *menu_explore_build_list(const char *directory_playlist,
 
       libretrodb_cursor_close(cur);
       libretrodb_cursor_free(cur);
+
+      if (can_cache)
+      {
+         uint32_t record_len = (uint32_t)(RBUF_LEN(cache_out)
+               - record_start - sizeof(uint32_t));
+         memcpy(cache_out + record_start, &record_len, sizeof(record_len));
+         memcpy(cache_out + match_count_pos, &stamp.match_count,
+               sizeof(stamp.match_count));
+         cache_out_count++;
+      }
+      else
+         RBUF_RESIZE(cache_out, record_start);
+
+next_rdb:
       libretrodb_close(rdb->handle);
       libretrodb_free(rdb->handle);
       RHMAP_FREE(rdb->playlist_crcs);
       RHMAP_FREE(rdb->playlist_names);
+      free(rdb->path);
    }
    RBUF_FREE(split_buf);
    RHMAP_FREE(rdb_indices);
    RBUF_FREE(rdbs);
 
+   /* Rewrite the cache if an RDB had to be walked
+    * or a system is no longer in any playlist */
+   if (cache_dirty || cache_out_count != RHMAP_LEN(cache_records))
+   {
+      explore_cache_header_t header;
+      char *out           = NULL;
+
+      header.magic        = EXPLORE_CACHE_MAGIC;
+      header.version      = EXPLORE_CACHE_VERSION;
+      header.byte_order   = EXPLORE_CACHE_BYTE_ORDER;
+      header.cat_count    = EXPLORE_CAT_COUNT;
+      header.record_count = cache_out_count;
+      explore_cache_put(&out, &header, sizeof(header));
+      if (RBUF_LEN(cache_out))
+         explore_cache_put(&out, cache_out, RBUF_LEN(cache_out));
+
+      if (!filestream_write_file(cache_path, out, RBUF_LEN(out)))
+         RARCH_WARN("[Explore] Failed to write cache file \"%s\".\n",
+               cache_path);
+      RBUF_FREE(out);
+   }
+   RBUF_FREE(cache_out);
+   RHMAP_FREE(cache_records);
+   free(cache_buf);
+
    for (i = 0; i != EXPLORE_CAT_COUNT; i++)
    {
       uint32_t idx;
@@ -27,6 +27,9 @@
 #include <string/stdstring.h>
 #include <lists/string_list.h>
 #include <streams/file_stream.h>
+#if defined(HAVE_ZLIB)
+#include <streams/rzip_stream.h>
+#endif
 #include <audio/audio_resampler.h>
 
 #include <compat/strl.h>
@@ -6626,6 +6629,9 @@ static size_t setting_get_string_representation_uint_audio_resampler_quality(
          case RESAMPLER_QUALITY_NORMAL:
             return strlcpy(s, msg_hash_to_str(MSG_RESAMPLER_QUALITY_NORMAL),
                   len);
+         case RESAMPLER_QUALITY_POLYPHASE:
+            return strlcpy(s, msg_hash_to_str(MSG_RESAMPLER_QUALITY_POLYPHASE),
+                  len);
       }
    }
    return 0;
@@ -8704,6 +8710,12 @@ static void general_write_handler(rarch_setting_t *setting)
       case MENU_ENUM_LABEL_SUSTAINED_PERFORMANCE_MODE:
          frontend_driver_set_sustained_performance_mode(settings->bools.sustained_performance_mode);
          break;
+#if defined(HAVE_ZLIB) && defined(HAVE_ZSTD)
+      case MENU_ENUM_LABEL_SAVE_COMPRESSION_ZSTD:
+         rzipstream_set_default_codec(settings->bools.save_compression_zstd
+               ? RZIP_CODEC_ZSTD : RZIP_CODEC_ZLIB);
+         break;
+#endif
       case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
          {
             rarch_setting_t *buffer_size_setting = menu_setting_find_enum(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE);
@@ -11683,6 +11695,23 @@ static bool setting_append_list(
                   general_write_handler,
                   general_read_handler,
                   SD_FLAG_NONE);
+
+#if defined(HAVE_ZSTD)
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.save_compression_zstd,
+                  MENU_ENUM_LABEL_SAVE_COMPRESSION_ZSTD,
+                  MENU_ENUM_LABEL_VALUE_SAVE_COMPRESSION_ZSTD,
+                  DEFAULT_SAVE_COMPRESSION_ZSTD,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
 #endif
 
             CONFIG_ACTION(
@@ -11996,6 +12025,40 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+#ifdef HAVE_THREADS
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_threaded,
+                  MENU_ENUM_LABEL_REWIND_THREADED,
+                  MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+                  DEFAULT_REWIND_THREADED,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REWIND_REINIT);
+#endif
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_compression,
+                  MENU_ENUM_LABEL_REWIND_COMPRESSION,
+                  MENU_ENUM_LABEL_VALUE_REWIND_COMPRESSION,
+                  DEFAULT_REWIND_COMPRESSION,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_REWIND_REINIT);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -14653,7 +14716,7 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
          (*list)[list_info->index - 1].get_string_representation =
             &setting_get_string_representation_uint_audio_resampler_quality;
-         menu_settings_list_current_add_range(list, list_info, RESAMPLER_QUALITY_DONTCARE, RESAMPLER_QUALITY_HIGHEST, 1.0, true, true);
+         menu_settings_list_current_add_range(list, list_info, RESAMPLER_QUALITY_DONTCARE, RESAMPLER_QUALITY_POLYPHASE, 1.0, true, true);
 
          CONFIG_FLOAT(
                list, list_info,
@@ -16482,6 +16545,40 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].change_handler = runahead_change_handler;
          menu_settings_list_current_add_range(list, list_info, 1, MAX_RUNAHEAD_FRAMES, 1, true, true);
 
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_secondary_thread,
+               MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_THREAD,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_SECONDARY_THREAD,
+               DEFAULT_RUN_AHEAD_SECONDARY_THREAD,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+#endif
+
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_state_cache,
+               MENU_ENUM_LABEL_RUN_AHEAD_STATE_CACHE,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_STATE_CACHE,
+               DEFAULT_RUN_AHEAD_STATE_CACHE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_ADVANCED
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.run_ahead_hide_warnings,
@@ -20245,6 +20342,21 @@ static bool setting_append_list(
                   general_read_handler);
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint_special;
             menu_settings_list_current_add_range(list, list_info, 0, 1024, 256, true, true);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.menu_thumbnail_cache_enable,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_ENABLE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_ENABLE,
+                  DEFAULT_MENU_THUMBNAIL_CACHE_ENABLE,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
          }
 
          if (string_is_equal(settings->arrays.menu_driver, "rgui"))
@@ -243,6 +243,7 @@ enum msg_hash_enums
    MSG_RESAMPLER_QUALITY_NORMAL,
    MSG_RESAMPLER_QUALITY_HIGHER,
    MSG_RESAMPLER_QUALITY_HIGHEST,
+   MSG_RESAMPLER_QUALITY_POLYPHASE,
    MSG_DISCORD_CONNECTION_REQUEST,
    MSG_ADDED_TO_FAVORITES,
    MSG_ADD_TO_FAVORITES_FAILED,
@@ -428,6 +429,7 @@ enum msg_hash_enums
    MSG_REWIND_INIT,
    MSG_REWIND_INIT_FAILED,
    MSG_REWIND_INIT_FAILED_THREADED_AUDIO,
+   MSG_REWIND_HISTORY,
    MSG_LIBRETRO_ABI_BREAK,
    MSG_DETECTED_VIEWPORT_OF,
    MSG_RECORDING_TO,
@@ -1652,6 +1654,7 @@ enum msg_hash_enums
    MENU_LABEL(MENU_XMB_TITLE_MARGIN),
    MENU_LABEL(MENU_XMB_TITLE_MARGIN_HORIZONTAL_OFFSET),
    MENU_LABEL(MENU_THUMBNAIL_UPSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_CACHE_ENABLE),
    MENU_LABEL(MENU_THUMBNAIL_BACKGROUND_ENABLE),
    MENU_LABEL(MENU_RGUI_INLINE_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_SWAP_THUMBNAILS),
@@ -2406,6 +2409,8 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_THREADED),
+   MENU_LABEL(REWIND_COMPRESSION),
    /* TODO/FIXME: INPUT_META_REWIND is incorrectly defined;
     * the LABEL/SUBLABEL enums should be entered 'manually',
     * like all the other hotkeys. Moreover, the resultant
@@ -2494,6 +2499,7 @@ enum msg_hash_enums
    MENU_LABEL(SAVESTATE_THUMBNAIL_ENABLE),
    MENU_LABEL(SAVE_FILE_COMPRESSION),
    MENU_LABEL(SAVESTATE_FILE_COMPRESSION),
+   MENU_LABEL(SAVE_COMPRESSION_ZSTD),
 
    MENU_LBL_H(SUSPEND_SCREENSAVER_ENABLE),
    MENU_ENUM_LABEL_VOLUME_UP,
@@ -2811,6 +2817,8 @@ enum msg_hash_enums
    MENU_LABEL(SLOWMOTION_RATIO),
    MENU_LABEL(RUN_AHEAD_UNSUPPORTED),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
+   MENU_LABEL(RUN_AHEAD_STATE_CACHE),
+   MENU_LABEL(RUN_AHEAD_SECONDARY_THREAD),
    MENU_LABEL(RUN_AHEAD_FRAMES),
    MENU_LABEL(PREEMPT_FRAMES),
    MENU_LABEL(INPUT_BLOCK_TIMEOUT),
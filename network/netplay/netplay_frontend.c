@@ -40,6 +40,13 @@
 #include <features/features_cpu.h>
 #include <lrc_hash.h>
 
+#define XXH_INLINE_ALL
+#include <xxHash/xxhash.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #ifdef HAVE_IFINFO
 #include <net/net_ifinfo.h>
 #endif
@@ -218,6 +225,22 @@ net_driver_state_t *networking_state_get_ptr(void)
 
 static bool netplay_build_savestate(netplay_t* netplay, retro_ctx_serialize_info_t* serial_info, bool force_capture_achievements);
 static bool netplay_process_savestate(netplay_t* netplay, retro_ctx_serialize_info_t* serial_info);
+static bool netplay_savestate_job_poll(netplay_t *netplay, bool wait);
+static void netplay_savestate_job_discard(netplay_t *netplay);
+
+/* Savestates at least this large are compressed on a thread
+ * while the host holds its frame */
+#define NETPLAY_SAVESTATE_ASYNC_SIZE  (256 * 1024)
+
+/* Savestate deltas mark changes in blocks of this many bytes */
+#define NETPLAY_SAVESTATE_DELTA_BLOCK 256
+#define NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(size) \
+   ((((size) + NETPLAY_SAVESTATE_DELTA_BLOCK - 1) \
+      / NETPLAY_SAVESTATE_DELTA_BLOCK + 7) / 8)
+
+/* Frames are checked in blocks of this many bytes with peers that
+ * support it, so that a desync can be narrowed down to where it is */
+#define NETPLAY_HASH_BLOCK_SIZE (16 * 1024)
 
 /* Align to 8-byte boundary */
 #define CONTENT_ALIGN_SIZE(size) ((((size) + 7) & ~7))
@@ -742,6 +765,7 @@ static bool netplay_init_socket_buffer(struct socket_buffer *sbuf, size_t len)
       return false;
    sbuf->bufsz = len;
    sbuf->start = sbuf->read = sbuf->end = 0;
+   sbuf->hold  = false;
 
    return true;
 }
@@ -755,6 +779,7 @@ static void netplay_deinit_socket_buffer(struct socket_buffer *sbuf)
 {
    free(sbuf->data);
    sbuf->data = NULL;
+   sbuf->hold = false;
 }
 
 
@@ -908,6 +933,17 @@ static int select_compression(netplay_t *netplay, uint32_t compression)
 
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
+#ifdef HAVE_ZSTD
+   if (compression & NETPLAY_COMPRESSION_ZSTD)
+   {
+      ctrans = &netplay->compress_zstd;
+      if (!ctrans->compression_backend)
+         ctrans->compression_backend =
+            trans_stream_get_zstd_compress_backend();
+      ret = NETPLAY_COMPRESSION_ZSTD;
+   }
+   else
+#endif
    if (compression & NETPLAY_COMPRESSION_ZLIB)
    {
       ctrans = &netplay->compress_zlib;
@@ -1117,6 +1153,20 @@ bool netplay_handshake_init(netplay_t *netplay,
       return false;
    connection->compression_supported = (uint32_t)compression;
 
+   /* Savestate deltas are negotiated alongside compression */
+   if (ntohl(header[2]) & NETPLAY_COMPRESSION_SUPPORTED
+         & NETPLAY_COMPRESSION_DELTA)
+      connection->flags |=  NETPLAY_CONN_FLAG_DELTA;
+   else
+      connection->flags &= ~NETPLAY_CONN_FLAG_DELTA;
+
+   /* And so is how frames are checked */
+   if (ntohl(header[2]) & NETPLAY_COMPRESSION_SUPPORTED
+         & NETPLAY_COMPRESSION_XXH3)
+      connection->flags |=  NETPLAY_CONN_FLAG_XXH3;
+   else
+      connection->flags &= ~NETPLAY_CONN_FLAG_XXH3;
+
    if (!netplay->is_server)
    {
       /* If a password is demanded, ask for it */
@@ -2092,9 +2142,10 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
          return false;
    }
 
-   delta->used  = true;
-   delta->frame = frame;
-   delta->crc   = 0;
+   delta->used              = true;
+   delta->frame             = frame;
+   delta->crc               = 0;
+   delta->have_block_hashes = false;
 
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
@@ -2153,6 +2204,213 @@ static uint32_t netplay_delta_frame_crc(netplay_t *netplay,
    return encoding_crc32(0L, input, netplay->coremem_size);
 }
 
+/**
+ * netplay_block_hashes_count
+ *
+ * Get the number of blocks the core's part of the state hashes as.
+ */
+static uint32_t netplay_block_hashes_count(netplay_t *netplay,
+      uint32_t block_size)
+{
+   if (!netplay->state_size)
+      return 0;
+   return (uint32_t)((netplay->coremem_size + block_size - 1) / block_size);
+}
+
+/**
+ * netplay_delta_frame_block_hashes
+ *
+ * Hash each block of the core's part of a frame's state into @hashes,
+ * which must have room for netplay_block_hashes_count of them.
+ */
+static void netplay_delta_frame_block_hashes(netplay_t *netplay,
+      struct delta_frame *delta, uint32_t block_size, uint32_t *hashes)
+{
+   uint32_t i;
+   const uint8_t *input;
+   uint32_t count = netplay_block_hashes_count(netplay, block_size);
+
+   NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
+   if (!count)
+      return;
+
+   input = netplay_get_savestate_coremem(netplay,
+      (const uint8_t*)delta->state);
+
+   for (i = 0; i < count; i++)
+   {
+      size_t ofs = (size_t)i * block_size;
+      hashes[i]  = (uint32_t)XXH3_64bits(input + ofs,
+         MIN(netplay->coremem_size - ofs, block_size));
+   }
+}
+
+/**
+ * netplay_check_block_hashes
+ *
+ * Check a frame's state against the server's block hashes,
+ * logging which parts of the core's memory differ.
+ *
+ * Returns true if they all match.
+ */
+static bool netplay_check_block_hashes(netplay_t *netplay,
+      struct delta_frame *delta, const uint32_t *remote,
+      uint32_t count, uint32_t block_size)
+{
+   uint32_t i;
+   uint32_t *local;
+   uint32_t first      = 0;
+   uint32_t mismatches = 0;
+   unsigned ranges     = 0;
+
+   if (count != netplay_block_hashes_count(netplay, block_size))
+   {
+      RARCH_WARN("[Netplay] Desync at frame %u: core state size differs from the host.\n",
+         delta->frame);
+      return false;
+   }
+
+   if (!count || !(local = (uint32_t*)malloc(count * sizeof(*local))))
+      return true;
+
+   netplay_delta_frame_block_hashes(netplay, delta, block_size, local);
+
+   for (i = 0; i <= count; i++)
+   {
+      if (i < count && local[i] != remote[i])
+      {
+         if (!mismatches++ || local[i - 1] == remote[i - 1])
+            first = i;
+         continue;
+      }
+
+      /* Log the end of a run of differing blocks */
+      if (mismatches && i > 0 && local[i - 1] != remote[i - 1] && ranges++ < 8)
+         RARCH_WARN("[Netplay] Desync at frame %u in core memory 0x%X-0x%X.\n",
+            delta->frame, (unsigned)((size_t)first * block_size),
+            (unsigned)(MIN((size_t)i * block_size, netplay->coremem_size) - 1));
+   }
+
+   if (mismatches)
+      RARCH_WARN("[Netplay] %u of %u blocks differ at frame %u.\n",
+         mismatches, count, delta->frame);
+
+   free(local);
+   return !mismatches;
+}
+
+/**
+ * netplay_compression_transcoder
+ *
+ * Get the transcoder for a negotiated compression protocol.
+ */
+static struct compression_transcoder *netplay_compression_transcoder(
+      netplay_t *netplay, uint32_t compression)
+{
+   switch (compression)
+   {
+      case NETPLAY_COMPRESSION_ZSTD:
+         return &netplay->compress_zstd;
+      case NETPLAY_COMPRESSION_ZLIB:
+         return &netplay->compress_zlib;
+      default:
+         break;
+   }
+
+   return &netplay->compress_nil;
+}
+
+/**
+ * netplay_savestate_delta_build
+ *
+ * Write a bitmap of the blocks of @state which differ from @base into
+ * @delta, followed by those blocks. @delta must have room for the bitmap
+ * and the whole state.
+ *
+ * Returns the size of the delta.
+ */
+static size_t netplay_savestate_delta_build(uint8_t *delta,
+      const uint8_t *state, size_t state_size,
+      const uint8_t *base, size_t base_size)
+{
+   size_t i;
+   size_t blocks = (state_size + NETPLAY_SAVESTATE_DELTA_BLOCK - 1)
+      / NETPLAY_SAVESTATE_DELTA_BLOCK;
+   uint8_t *out  = delta + NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(state_size);
+
+   memset(delta, 0, NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(state_size));
+
+   for (i = 0; i < blocks; i++)
+   {
+      size_t ofs = i * NETPLAY_SAVESTATE_DELTA_BLOCK;
+      size_t len = MIN(state_size - ofs, NETPLAY_SAVESTATE_DELTA_BLOCK);
+
+      if (     ofs + len <= base_size
+            && !memcmp(state + ofs, base + ofs, len))
+         continue;
+
+      delta[i >> 3] |= (uint8_t)(1 << (i & 7));
+      memcpy(out, state + ofs, len);
+      out += len;
+   }
+
+   return (size_t)(out - delta);
+}
+
+/**
+ * netplay_savestate_delta_apply
+ *
+ * Rebuild a savestate from @base and a delta made by
+ * netplay_savestate_delta_build. @state is left alone
+ * if the delta is not well formed.
+ *
+ * Returns true if the delta was well formed.
+ */
+static bool netplay_savestate_delta_apply(uint8_t *state, size_t state_size,
+      const uint8_t *base, size_t base_size,
+      const uint8_t *delta, size_t delta_size)
+{
+   size_t i;
+   size_t blocks      = (state_size + NETPLAY_SAVESTATE_DELTA_BLOCK - 1)
+      / NETPLAY_SAVESTATE_DELTA_BLOCK;
+   size_t changed     = 0;
+   const uint8_t *in  = delta + NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(state_size);
+
+   if (delta_size < NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(state_size))
+      return false;
+
+   /* Check it all adds up before touching the state */
+   for (i = 0; i < blocks; i++)
+   {
+      size_t ofs = i * NETPLAY_SAVESTATE_DELTA_BLOCK;
+      size_t len = MIN(state_size - ofs, NETPLAY_SAVESTATE_DELTA_BLOCK);
+
+      if (delta[i >> 3] & (1 << (i & 7)))
+         changed += len;
+      else if (ofs + len > base_size)
+         return false;
+   }
+
+   if (changed != delta_size - (size_t)(in - delta))
+      return false;
+
+   for (i = 0; i < blocks; i++)
+   {
+      size_t ofs = i * NETPLAY_SAVESTATE_DELTA_BLOCK;
+      size_t len = MIN(state_size - ofs, NETPLAY_SAVESTATE_DELTA_BLOCK);
+
+      if (delta[i >> 3] & (1 << (i & 7)))
+      {
+         memcpy(state + ofs, in, len);
+         in += len;
+      }
+      else
+         memcpy(state + ofs, base + ofs, len);
+   }
+
+   return true;
+}
+
 /*
  * Free an input state list
  */
@@ -2184,6 +2442,11 @@ static void netplay_delta_frame_free(struct delta_frame *delta)
       delta->state = NULL;
    }
 
+   free(delta->block_hashes);
+   delta->block_hashes       = NULL;
+   delta->block_hashes_count = 0;
+   delta->have_block_hashes  = false;
+
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
       free_input_state(&delta->resolved_input[i]);
@@ -2370,6 +2633,14 @@ bool netplay_send(
       int sockfd, const void *buf,
       size_t len)
 {
+   if (sbuf->hold && buf_remaining(sbuf) < len)
+   {
+      /* Nothing may go out yet, so make room instead */
+      if (!netplay_resize_socket_buffer(sbuf,
+            MAX(sbuf->bufsz * 2, buf_used(sbuf) + len + 1)))
+         return false;
+   }
+
    if (buf_remaining(sbuf) < len)
    {
       /* Need to force a blocking send */
@@ -2418,7 +2689,7 @@ bool netplay_send(
  */
 bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
 {
-   if (buf_used(sbuf) == 0)
+   if (sbuf->hold || buf_used(sbuf) == 0)
       return true;
 
    if (sbuf->end > sbuf->start)
@@ -2485,6 +2756,38 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
    return true;
 }
 
+/**
+ * netplay_send_release
+ *
+ * Stop holding the given socket buffer, taking out everything queued
+ * after its first @held bytes so that something can go ahead of it.
+ * The caller queues that again and frees it.
+ *
+ * Returns false if memory ran out.
+ */
+static bool netplay_send_release(struct socket_buffer *sbuf, size_t held,
+      unsigned char **queued, size_t *queued_size)
+{
+   *queued      = NULL;
+   *queued_size = 0;
+   sbuf->hold   = false;
+
+   /* Get it all in one piece */
+   if (!netplay_resize_socket_buffer(sbuf, sbuf->bufsz))
+      return false;
+
+   if (sbuf->end > held)
+   {
+      if (!(*queued = (unsigned char*)malloc(sbuf->end - held)))
+         return false;
+      *queued_size = sbuf->end - held;
+      memcpy(*queued, sbuf->data + held, *queued_size);
+      sbuf->end    = held;
+   }
+
+   return true;
+}
+
 /**
  * netplay_recv
  *
@@ -2686,19 +2989,63 @@ static bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta)
 {
    size_t i;
    uint32_t payload[2];
-   bool success = true;
+   uint32_t *hashes = NULL;
+   uint32_t count   = 0;
+   bool have_crc    = false;
+   bool success     = true;
    NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
 
-   payload[0]   = htonl(delta->frame);
-   payload[1]   = htonl(delta->crc);
-
    for (i = 0; i < netplay->connections_size; i++)
    {
-      if (     (netplay->connections[i].flags & NETPLAY_CONN_FLAG_ACTIVE)
-            && (netplay->connections[i].mode >= NETPLAY_CONNECTION_CONNECTED))
-         success = netplay_send_raw_cmd(netplay, &netplay->connections[i],
-            NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (     (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE))
+            ||  (connection->mode < NETPLAY_CONNECTION_CONNECTED))
+         continue;
+
+      /* Peers which support it get a hash of each block instead */
+      if (connection->flags & NETPLAY_CONN_FLAG_XXH3)
+      {
+         if (!hashes)
+         {
+            uint32_t j;
+
+            count = netplay_block_hashes_count(netplay,
+               NETPLAY_HASH_BLOCK_SIZE);
+            if (!(hashes = (uint32_t*)malloc((count + 2) * sizeof(*hashes))))
+            {
+               success = false;
+               continue;
+            }
+
+            hashes[0] = htonl(delta->frame);
+            hashes[1] = htonl(NETPLAY_HASH_BLOCK_SIZE);
+            netplay_delta_frame_block_hashes(netplay, delta,
+               NETPLAY_HASH_BLOCK_SIZE, hashes + 2);
+            for (j = 0; j < count; j++)
+               hashes[j + 2] = htonl(hashes[j + 2]);
+         }
+
+         success = netplay_send_raw_cmd(netplay, connection,
+            NETPLAY_CMD_BLOCK_HASHES, hashes,
+            (count + 2) * sizeof(*hashes)) && success;
+         continue;
+      }
+
+      if (!have_crc)
+      {
+         delta->crc = netplay->state_size ?
+            netplay_delta_frame_crc(netplay, delta) : 0;
+         payload[0] = htonl(delta->frame);
+         payload[1] = htonl(delta->crc);
+         have_crc   = true;
+      }
+
+      success = netplay_send_raw_cmd(netplay, connection,
+         NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
    }
+
+   free(hashes);
    return success;
 }
 
@@ -3216,21 +3563,24 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
    if (netplay->is_server)
    {
       if (netplay->check_frames && (delta->frame % netplay->check_frames) == 0)
-      {
-         delta->crc = netplay->state_size ?
-            netplay_delta_frame_crc(netplay, delta) : 0;
          netplay_cmd_crc(netplay, delta);
-      }
    }
    else
    {
-      if (netplay->crcs_valid && delta->crc)
+      if (netplay->crcs_valid && (delta->have_block_hashes || delta->crc))
       {
-         /* We have a remote CRC, so check it. */
-         uint32_t local_crc = netplay->state_size ?
-            netplay_delta_frame_crc(netplay, delta) : 0;
+         bool matches;
+
+         /* We have remote hashes or a remote CRC, so check it. */
+         if (delta->have_block_hashes)
+            matches = netplay_check_block_hashes(netplay, delta,
+               delta->block_hashes, delta->block_hashes_count,
+               delta->block_hash_size);
+         else
+            matches = (netplay->state_size ?
+               netplay_delta_frame_crc(netplay, delta) : 0) == delta->crc;
 
-         if (local_crc != delta->crc)
+         if (!matches)
          {
             /* If the very first check frame is wrong,
                they probably just don't work. */
@@ -5997,6 +6347,95 @@ static bool netplay_get_cmd(netplay_t *netplay,
             break;
          }
 
+      case NETPLAY_CMD_BLOCK_HASHES:
+         {
+            uint32_t i;
+            uint32_t header[2];
+            uint32_t count;
+            uint32_t *hashes      = (uint32_t*)netplay->zbuffer;
+            size_t tmp_ptr        = netplay->run_ptr;
+            bool found            = false;
+            struct delta_frame *delta;
+            NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
+
+            if (netplay->is_server)
+            {
+               RARCH_ERR("[Netplay] NETPLAY_CMD_BLOCK_HASHES from client.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (     cmd_size < sizeof(header)
+                  || (cmd_size - sizeof(header)) % sizeof(uint32_t)
+                  || (cmd_size - sizeof(header)) > netplay->zbuffer_size)
+            {
+               RARCH_ERR("[Netplay] NETPLAY_CMD_BLOCK_HASHES received unexpected payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(header, sizeof(header))
+               return false;
+
+            header[0] = ntohl(header[0]);
+            header[1] = ntohl(header[1]);
+            count     = (uint32_t)((cmd_size - sizeof(header))
+               / sizeof(uint32_t));
+
+            if (!header[1])
+            {
+               RARCH_ERR("[Netplay] NETPLAY_CMD_BLOCK_HASHES received invalid block size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (count)
+            {
+               RECV(hashes, count * sizeof(uint32_t))
+                  return false;
+               for (i = 0; i < count; i++)
+                  hashes[i] = ntohl(hashes[i]);
+            }
+
+            /* Same as NETPLAY_CMD_CRC from here on */
+            do
+            {
+               if (     netplay->buffer[tmp_ptr].used
+                     && netplay->buffer[tmp_ptr].frame == header[0])
+               {
+                  found = true;
+                  break;
+               }
+
+               tmp_ptr = PREV_PTR(tmp_ptr);
+            } while (tmp_ptr != netplay->run_ptr);
+
+            if (!found)
+               break;
+
+            delta = &netplay->buffer[tmp_ptr];
+
+            if (header[0] <= netplay->other_frame_count)
+            {
+               if (!netplay_check_block_hashes(netplay, delta,
+                     hashes, count, header[1]))
+                  netplay_cmd_request_savestate(netplay);
+            }
+            else
+            {
+               uint32_t *block_hashes = (uint32_t*)realloc(
+                  delta->block_hashes, (count + 1) * sizeof(uint32_t));
+
+               if (!block_hashes)
+                  break;
+
+               memcpy(block_hashes, hashes, count * sizeof(uint32_t));
+               delta->block_hashes       = block_hashes;
+               delta->block_hashes_count = count;
+               delta->block_hash_size    = header[1];
+               delta->have_block_hashes  = true;
+            }
+
+            break;
+         }
+
       case NETPLAY_CMD_REQUEST_SAVESTATE:
          NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
          /* Delay until next frame so we don't send the savestate after the
@@ -6005,6 +6444,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
          {
             uint32_t i;
             uint32_t frame;
@@ -6012,7 +6452,10 @@ static bool netplay_get_cmd(netplay_t *netplay,
             size_t   load_ptr;
             uint32_t load_frame_count;
             uint32_t rd, wn;
+            uint32_t delta_info[3];
             struct compression_transcoder *ctrans = NULL;
+            size_t header_size = sizeof(frame) + sizeof(state_size);
+            bool is_delta      = (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
             NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
 
             if (netplay->is_server)
@@ -6021,7 +6464,10 @@ static bool netplay_get_cmd(netplay_t *netplay,
                return netplay_cmd_nak(netplay, connection);
             }
 
-            if (cmd_size < sizeof(frame) + sizeof(state_size))
+            if (is_delta)
+               header_size += sizeof(delta_info);
+
+            if (cmd_size < header_size)
             {
                RARCH_ERR("[Netplay] Received invalid payload size for NETPLAY_CMD_LOAD_SAVESTATE.\n");
                return netplay_cmd_nak(netplay, connection);
@@ -6083,7 +6529,24 @@ static bool netplay_get_cmd(netplay_t *netplay,
             RECV(&state_size, sizeof(state_size))
                return false;
             state_size     = ntohl(state_size);
-            state_size_raw = cmd_size - (sizeof(frame) + sizeof(state_size));
+            state_size_raw = cmd_size - header_size;
+
+            /* Base frame, base CRC and uncompressed delta size */
+            if (is_delta)
+            {
+               RECV(delta_info, sizeof(delta_info))
+                  return false;
+               for (i = 0; i < ARRAY_SIZE(delta_info); i++)
+                  delta_info[i] = ntohl(delta_info[i]);
+
+               if (delta_info[2] >
+                     NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(state_size)
+                     + state_size)
+               {
+                  RARCH_ERR("[Netplay] Netplay state load with an unexpected save state size.\n");
+                  return netplay_cmd_nak(netplay, connection);
+               }
+            }
 
             if (state_size_raw > netplay->zbuffer_size)
             {
@@ -6094,14 +6557,17 @@ static bool netplay_get_cmd(netplay_t *netplay,
             RECV(netplay->zbuffer, state_size_raw)
                return false;
 
-            switch (connection->compression_supported)
+            ctrans = netplay_compression_transcoder(netplay,
+               connection->compression_supported);
+
+            if (is_delta && (!netplay->savestate_base
+                  || delta_info[0] != netplay->savestate_base_frame
+                  || delta_info[1] != netplay->savestate_base_crc))
             {
-               case NETPLAY_COMPRESSION_ZLIB:
-                  ctrans = &netplay->compress_zlib;
-                  break;
-               default:
-                  ctrans = &netplay->compress_nil;
-                  break;
+               /* Not against what we have; ask for all of it */
+               RARCH_WARN("[Netplay] Savestate delta against an unknown base, requesting a full savestate.\n");
+               netplay_cmd_request_savestate(netplay);
+               break;
             }
 
             if (state_size > netplay->state_size)
@@ -6116,15 +6582,51 @@ static bool netplay_get_cmd(netplay_t *netplay,
                }
             }
 
-            ctrans->decompression_backend->set_in(
-               ctrans->decompression_stream,
-               netplay->zbuffer, state_size_raw);
-            ctrans->decompression_backend->set_out(
-               ctrans->decompression_stream,
-               (uint8_t*)netplay->buffer[load_ptr].state, state_size);
-            ctrans->decompression_backend->trans(
-               ctrans->decompression_stream,
-               true, &rd, &wn, NULL);
+            if (is_delta)
+            {
+               uint8_t *delta = (uint8_t*)malloc(delta_info[2] + 1);
+               bool ok        = false;
+
+               if (delta)
+               {
+                  ctrans->decompression_backend->set_in(
+                     ctrans->decompression_stream,
+                     netplay->zbuffer, state_size_raw);
+                  ctrans->decompression_backend->set_out(
+                     ctrans->decompression_stream,
+                     delta, delta_info[2]);
+                  ctrans->decompression_backend->trans(
+                     ctrans->decompression_stream,
+                     true, &rd, &wn, NULL);
+
+                  ok = (wn == delta_info[2])
+                     && netplay_savestate_delta_apply(
+                        (uint8_t*)netplay->buffer[load_ptr].state, state_size,
+                        netplay->savestate_base,
+                        netplay->savestate_base_size,
+                        delta, delta_info[2]);
+                  free(delta);
+               }
+
+               if (!ok)
+               {
+                  RARCH_WARN("[Netplay] Could not apply savestate delta, requesting a full savestate.\n");
+                  netplay_cmd_request_savestate(netplay);
+                  break;
+               }
+            }
+            else
+            {
+               ctrans->decompression_backend->set_in(
+                  ctrans->decompression_stream,
+                  netplay->zbuffer, state_size_raw);
+               ctrans->decompression_backend->set_out(
+                  ctrans->decompression_stream,
+                  (uint8_t*)netplay->buffer[load_ptr].state, state_size);
+               ctrans->decompression_backend->trans(
+                  ctrans->decompression_stream,
+                  true, &rd, &wn, NULL);
+            }
 
             if (memcmp(netplay->buffer[load_ptr].state, "NETPLAY", 7) != 0)
             {
@@ -6190,6 +6692,57 @@ static bool netplay_get_cmd(netplay_t *netplay,
             netplay->other_ptr                     = load_ptr;
             netplay->other_frame_count             = load_frame_count;
 
+            /* Keep this one around for the server to send deltas against */
+            if (connection->flags & NETPLAY_CONN_FLAG_DELTA)
+            {
+               uint8_t *base = (uint8_t*)realloc(netplay->savestate_base,
+                  state_size);
+
+               if (base)
+               {
+                  memcpy(base, netplay->buffer[load_ptr].state, state_size);
+                  netplay->savestate_base       = base;
+                  netplay->savestate_base_size  = state_size;
+                  netplay->savestate_base_frame = frame;
+                  netplay->savestate_base_crc   = encoding_crc32(0L, base,
+                     state_size);
+
+                  frame = htonl(frame);
+                  if (!netplay_send_raw_cmd(netplay, connection,
+                        NETPLAY_CMD_SAVESTATE_ACK, &frame, sizeof(frame)))
+                     return false;
+               }
+            }
+
+            break;
+         }
+
+      case NETPLAY_CMD_SAVESTATE_ACK:
+         {
+            uint32_t frame;
+
+            if (!netplay->is_server)
+            {
+               RARCH_ERR("[Netplay] NETPLAY_CMD_SAVESTATE_ACK from server.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd_size != sizeof(frame))
+            {
+               RARCH_ERR("[Netplay] Received invalid payload size for NETPLAY_CMD_SAVESTATE_ACK.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(&frame, sizeof(frame))
+               return false;
+            frame = ntohl(frame);
+
+            /* Only the latest savestate sent is any good as a base */
+            if (     netplay->savestate_base
+                  && frame == netplay->savestate_base_frame)
+               connection->flags |=  NETPLAY_CONN_FLAG_DELTA_BASE;
+            else
+               connection->flags &= ~NETPLAY_CONN_FLAG_DELTA_BASE;
             break;
          }
 
@@ -7239,6 +7792,8 @@ static void netplay_free(netplay_t *netplay)
 {
    size_t i;
 
+   netplay_savestate_job_discard(netplay);
+
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
@@ -7280,6 +7835,7 @@ static void netplay_free(netplay_t *netplay)
    }
 
    free(netplay->zbuffer);
+   free(netplay->savestate_base);
 
    if (netplay->compress_nil.compression_stream)
       netplay->compress_nil.compression_backend->stream_free(
@@ -7293,6 +7849,12 @@ static void netplay_free(netplay_t *netplay)
    if (netplay->compress_zlib.decompression_stream)
       netplay->compress_zlib.decompression_backend->stream_free(
          netplay->compress_zlib.decompression_stream);
+   if (netplay->compress_zstd.compression_stream)
+      netplay->compress_zstd.compression_backend->stream_free(
+         netplay->compress_zstd.compression_stream);
+   if (netplay->compress_zstd.decompression_stream)
+      netplay->compress_zstd.decompression_backend->stream_free(
+         netplay->compress_zstd.decompression_stream);
 
    free(netplay);
 }
@@ -7433,33 +7995,210 @@ failure:
    return NULL;
 }
 
-/**
- * netplay_send_savestate
- * @netplay              : pointer to netplay object
- * @serial_info          : the savestate being loaded
- * @cx                   : compression type
- * @z                    : compression backend to use
- *
- * Send a loaded savestate to those connected peers using the given compression
- * scheme.
- */
-static void netplay_send_savestate(netplay_t *netplay,
-   retro_ctx_serialize_info_t *serial_info, uint32_t cx,
-   struct compression_transcoder *z, bool is_legacy_data)
+/* What a connection is sent of a savestate */
+enum netplay_savestate_kind
+{
+   NETPLAY_SAVESTATE_NONE = 0,
+   NETPLAY_SAVESTATE_FULL,
+   NETPLAY_SAVESTATE_DELTA,
+   /* Just the core's part, for peers before protocol 7 */
+   NETPLAY_SAVESTATE_LEGACY,
+   NETPLAY_SAVESTATE_KINDS
+};
+
+/* Compression protocols, in the order of netplay_compression_index */
+#define NETPLAY_SAVESTATE_CODECS 3
+
+struct netplay_savestate_recipient
+{
+   /* Bytes queued for the peer before the savestate */
+   size_t held;
+   int fd;
+   uint8_t kind;
+   uint8_t codec;
+};
+
+struct netplay_savestate_job
+{
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t   *lock;
+#endif
+   struct compression_transcoder *codecs[NETPLAY_SAVESTATE_CODECS];
+   struct netplay_savestate_recipient *recipients;
+   uint8_t *state;
+   const uint8_t *legacy;
+   const uint8_t *base;
+   uint8_t *delta;
+   uint8_t *out[NETPLAY_SAVESTATE_KINDS][NETPLAY_SAVESTATE_CODECS];
+   size_t raw_size[NETPLAY_SAVESTATE_KINDS];
+   size_t recipients_size;
+   size_t base_size;
+   retro_time_t time;
+   uint32_t out_size[NETPLAY_SAVESTATE_KINDS][NETPLAY_SAVESTATE_CODECS];
+   uint32_t frame;
+   uint32_t crc;
+   uint32_t base_frame;
+   uint32_t base_crc;
+   /* Frames run while the savestate was being compressed */
+   uint32_t frames;
+   /* Compression protocols each kind is needed in */
+   uint8_t needed[NETPLAY_SAVESTATE_KINDS];
+   bool keep_base;
+   bool failed;
+   bool done;
+};
+
+static unsigned netplay_compression_index(uint32_t compression)
+{
+   switch (compression)
+   {
+      case NETPLAY_COMPRESSION_ZSTD:
+         return 2;
+      case NETPLAY_COMPRESSION_ZLIB:
+         return 1;
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+static bool netplay_savestate_job_compress(struct netplay_savestate_job *job,
+      unsigned kind, unsigned codec, const uint8_t *in, size_t in_size)
 {
-   uint32_t header[4];
    uint32_t rd, wn;
-   size_t i;
-   bool has_legacy_connection = false;
-   NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
+   struct compression_transcoder *z = job->codecs[codec];
+   size_t out_size                  = in_size + in_size / 8 + 1024;
+   uint8_t *out                     = (uint8_t*)malloc(out_size);
+
+   if (!out)
+      return false;
 
-   /* Compress it */
    z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
+      in, (uint32_t)in_size);
    z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+      out, (uint32_t)out_size);
    if (!z->compression_backend->trans(z->compression_stream, true, &rd,
          &wn, NULL))
+   {
+      free(out);
+      return false;
+   }
+
+   job->out[kind][codec]      = out;
+   job->out_size[kind][codec] = wn;
+   return true;
+}
+
+/**
+ * netplay_savestate_job_run
+ *
+ * Build and compress everything a savestate is to be sent as. May run on
+ * a thread of its own, in which case the compression streams belong to it
+ * until it is done.
+ */
+static void netplay_savestate_job_run(struct netplay_savestate_job *job)
+{
+   unsigned kind, codec;
+   retro_time_t start = cpu_features_get_time_usec();
+
+   if (job->needed[NETPLAY_SAVESTATE_DELTA])
+   {
+      size_t state_size = job->raw_size[NETPLAY_SAVESTATE_FULL];
+
+      if ((job->delta = (uint8_t*)malloc(
+            NETPLAY_SAVESTATE_DELTA_BITMAP_SIZE(state_size) + state_size)))
+         job->raw_size[NETPLAY_SAVESTATE_DELTA] =
+            netplay_savestate_delta_build(job->delta,
+               job->state, state_size, job->base, job->base_size);
+      else
+         job->failed = true;
+   }
+
+   for (kind = NETPLAY_SAVESTATE_FULL;
+         kind < NETPLAY_SAVESTATE_KINDS && !job->failed; kind++)
+   {
+      const uint8_t *in = job->state;
+
+      if (kind == NETPLAY_SAVESTATE_DELTA)
+         in = job->delta;
+      else if (kind == NETPLAY_SAVESTATE_LEGACY)
+         in = job->legacy;
+
+      for (codec = 0; codec < NETPLAY_SAVESTATE_CODECS; codec++)
+      {
+         if (!(job->needed[kind] & (1 << codec)))
+            continue;
+         if (!netplay_savestate_job_compress(job, kind, codec,
+               in, job->raw_size[kind]))
+         {
+            job->failed = true;
+            break;
+         }
+      }
+   }
+
+   if (job->keep_base && !job->failed)
+      job->crc = encoding_crc32(0L, job->state,
+         job->raw_size[NETPLAY_SAVESTATE_FULL]);
+
+   job->time = cpu_features_get_time_usec() - start;
+}
+
+#ifdef HAVE_THREADS
+static void netplay_savestate_job_thread(void *data)
+{
+   struct netplay_savestate_job *job = (struct netplay_savestate_job*)data;
+
+   netplay_savestate_job_run(job);
+
+   slock_lock(job->lock);
+   job->done = true;
+   slock_unlock(job->lock);
+}
+#endif
+
+static void netplay_savestate_job_free(struct netplay_savestate_job *job)
+{
+   unsigned kind, codec;
+
+#ifdef HAVE_THREADS
+   if (job->thread)
+      sthread_join(job->thread);
+   if (job->lock)
+      slock_free(job->lock);
+#endif
+
+   for (kind = 0; kind < NETPLAY_SAVESTATE_KINDS; kind++)
+      for (codec = 0; codec < NETPLAY_SAVESTATE_CODECS; codec++)
+         free(job->out[kind][codec]);
+
+   free(job->delta);
+   free(job->state);
+   free(job->recipients);
+   free(job);
+}
+
+/**
+ * netplay_savestate_job_finish
+ *
+ * Send a compressed savestate to the peers it was compressed for, and make
+ * it the base for the next round of deltas.
+ */
+static void netplay_savestate_job_finish(netplay_t *netplay,
+      struct netplay_savestate_job *job)
+{
+   size_t i;
+   unsigned kind, codec;
+   static const char *kind_names[NETPLAY_SAVESTATE_KINDS] = {
+      NULL, "full", "delta", "legacy"
+   };
+   static const char *codec_names[NETPLAY_SAVESTATE_CODECS] = {
+      "uncompressed", "zlib", "zstd"
+   };
+
+   if (job->failed)
    {
       /* Catastrophe! */
       for (i = 0; i < netplay->connections_size; i++)
@@ -7467,57 +8206,304 @@ static void netplay_send_savestate(netplay_t *netplay,
       return;
    }
 
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
-   header[2] = htonl(netplay->run_frame_count);
-   header[3] = htonl(serial_info->size);
+   for (i = 0; i < job->recipients_size && i < netplay->connections_size; i++)
+   {
+      uint32_t header[7];
+      size_t header_size;
+      unsigned char *queued                 = NULL;
+      size_t queued_size                    = 0;
+      struct netplay_connection *connection = &netplay->connections[i];
+      struct netplay_savestate_recipient *r = &job->recipients[i];
+
+      /* Peers that came and went in the meantime
+       * will get a savestate of their own */
+      if (     (r->kind == NETPLAY_SAVESTATE_NONE)
+            || (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE))
+            ||  (connection->fd != r->fd))
+         continue;
 
+      /* Take out what was held back behind the savestate */
+      if (!netplay_send_release(&connection->send_packet_buffer, r->held,
+            &queued, &queued_size))
+      {
+         free(queued);
+         netplay_hangup(netplay, connection);
+         continue;
+      }
+
+      if (connection->mode < NETPLAY_CONNECTION_CONNECTED)
+      {
+         free(queued);
+         continue;
+      }
+
+      header[2] = htonl(job->frame);
+      header[3] = htonl((uint32_t)job->raw_size[
+            r->kind == NETPLAY_SAVESTATE_LEGACY
+         ?  NETPLAY_SAVESTATE_LEGACY
+         :  NETPLAY_SAVESTATE_FULL]);
+
+      if (r->kind == NETPLAY_SAVESTATE_DELTA)
+      {
+         header[0]   = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+         header[4]   = htonl(job->base_frame);
+         header[5]   = htonl(job->base_crc);
+         header[6]   = htonl((uint32_t)job->raw_size[NETPLAY_SAVESTATE_DELTA]);
+         header_size = 7 * sizeof(uint32_t);
+      }
+      else
+      {
+         header[0]   = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+         header_size = 4 * sizeof(uint32_t);
+      }
+      header[1] = htonl((uint32_t)(job->out_size[r->kind][r->codec]
+         + header_size - 2 * sizeof(uint32_t)));
+
+      if (  !netplay_send(&connection->send_packet_buffer,
+              connection->fd, header, header_size)
+         || !netplay_send(&connection->send_packet_buffer,
+              connection->fd, job->out[r->kind][r->codec],
+              job->out_size[r->kind][r->codec])
+         || (queued_size && !netplay_send(&connection->send_packet_buffer,
+              connection->fd, queued, queued_size)))
+         netplay_hangup(netplay, connection);
+      free(queued);
+   }
+
+   /* Whatever our peers acknowledged before is no good anymore */
    for (i = 0; i < netplay->connections_size; i++)
+      netplay->connections[i].flags &= ~NETPLAY_CONN_FLAG_DELTA_BASE;
+
+   free(netplay->savestate_base);
+   netplay->savestate_base      = NULL;
+   netplay->savestate_base_size = 0;
+   if (job->keep_base)
    {
-      struct netplay_connection* connection = &netplay->connections[i];
-      bool can_send;
+      netplay->savestate_base       = job->state;
+      netplay->savestate_base_size  = job->raw_size[NETPLAY_SAVESTATE_FULL];
+      netplay->savestate_base_frame = job->frame;
+      netplay->savestate_base_crc   = job->crc;
+      job->state                    = NULL;
+   }
 
-      /* if is_legacy_data is false, only send to peers on protocol 7 or higher */
-      REQUIRE_PROTOCOL_VERSION(connection, 7)
-         can_send = !is_legacy_data;
-      else
-         can_send = is_legacy_data;
+   for (kind = NETPLAY_SAVESTATE_FULL; kind < NETPLAY_SAVESTATE_KINDS; kind++)
+      for (codec = 0; codec < NETPLAY_SAVESTATE_CODECS; codec++)
+         if (job->out[kind][codec])
+            RARCH_LOG("[Netplay] Sent %s savestate for frame %u: %u -> %u bytes (%s).\n",
+               kind_names[kind], job->frame, (unsigned)job->raw_size[kind],
+               (unsigned)job->out_size[kind][codec], codec_names[codec]);
+   RARCH_LOG("[Netplay] Savestate compression took %.2f ms, over %u frames.\n",
+      job->time / 1000.0, job->frames);
+}
 
-      if (can_send)
+/**
+ * netplay_savestate_job_poll
+ * @netplay              : pointer to netplay object
+ * @wait                 : wait for the savestate to be compressed
+ *
+ * Send the savestate being compressed once it is ready.
+ *
+ * Returns true if there is no savestate left to send.
+ */
+static bool netplay_savestate_job_poll(netplay_t *netplay, bool wait)
+{
+   struct netplay_savestate_job *job = netplay->savestate_job;
+
+   if (!job)
+      return true;
+
+#ifdef HAVE_THREADS
+   if (job->thread)
+   {
+      if (!wait)
       {
-         if ( (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE))
+         bool done;
+
+         slock_lock(job->lock);
+         done = job->done;
+         slock_unlock(job->lock);
+
+         if (!done)
+            return false;
+      }
+
+      sthread_join(job->thread);
+      job->thread = NULL;
+   }
+#endif
+
+   netplay->savestate_job = NULL;
+   netplay_savestate_job_finish(netplay, job);
+   netplay_savestate_job_free(job);
+
+   return true;
+}
+
+/**
+ * netplay_savestate_job_discard
+ * @netplay              : pointer to netplay object
+ *
+ * Drop the savestate being compressed without sending it.
+ */
+static void netplay_savestate_job_discard(netplay_t *netplay)
+{
+   size_t i;
+
+   if (netplay->savestate_job)
+   {
+      for (i = 0; i < netplay->connections_size; i++)
+         netplay->connections[i].send_packet_buffer.hold = false;
+      netplay_savestate_job_free(netplay->savestate_job);
+      netplay->savestate_job = NULL;
+   }
+}
+
+/**
+ * netplay_send_savestate
+ * @netplay              : pointer to netplay object
+ * @serial_info          : the savestate being loaded
+ *
+ * Send a loaded savestate to those connected peers, each in the compression
+ * scheme it uses, and as a delta to those that have the last one. Large
+ * savestates are compressed on a thread; until they are sent, everything
+ * else for those peers is held back behind them, while the host and
+ * everyone else keep going.
+ */
+static void netplay_send_savestate(netplay_t *netplay,
+   retro_ctx_serialize_info_t *serial_info)
+{
+   size_t i;
+   const uint8_t *legacy;
+   struct netplay_savestate_job *job = NULL;
+   bool has_recipients               = false;
+   NETPLAY_ASSERT_MODUS(NETPLAY_MODUS_INPUT_FRAME_SYNC);
+
+   /* Savestates go out in order */
+   netplay_savestate_job_poll(netplay, true);
+
+   if (!(job = (struct netplay_savestate_job*)calloc(1, sizeof(*job))))
+      goto error;
+
+   job->recipients_size = netplay->connections_size;
+   job->recipients      = (struct netplay_savestate_recipient*)calloc(
+      job->recipients_size + 1, sizeof(*job->recipients));
+   /* Finding the core's part looks as far as our own state size */
+   job->state           = (uint8_t*)calloc(1,
+      MAX(serial_info->size, netplay->state_size));
+   if (!job->recipients || !job->state)
+      goto error;
+
+   memcpy(job->state, serial_info->data_const, serial_info->size);
+   job->raw_size[NETPLAY_SAVESTATE_FULL] = serial_info->size;
+   job->frame                            = netplay->run_frame_count;
+   job->codecs[0]                        = &netplay->compress_nil;
+   job->codecs[1]                        = &netplay->compress_zlib;
+   job->codecs[2]                        = &netplay->compress_zstd;
+
+   legacy = netplay_get_savestate_coremem(netplay, job->state);
+   if (legacy != job->state)
+   {
+      job->legacy                             = legacy;
+      job->raw_size[NETPLAY_SAVESTATE_LEGACY] = netplay->coremem_size;
+   }
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      struct netplay_savestate_recipient *r = &job->recipients[i];
+      unsigned codec = netplay_compression_index(
+         connection->compression_supported);
+
+      if (     (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE))
             ||  (connection->mode < NETPLAY_CONNECTION_CONNECTED)
-            ||  (connection->compression_supported != cx))
-            continue;
+            ||  (!job->codecs[codec]->compression_backend))
+         continue;
 
-         if (  !netplay_send(&connection->send_packet_buffer,
-                 connection->fd, header, sizeof(header))
-            || !netplay_send(&connection->send_packet_buffer,
-                 connection->fd, netplay->zbuffer, wn))
-            netplay_hangup(netplay, connection);
+      /* Peers before protocol 7 only take the core's part */
+      REQUIRE_PROTOCOL_VERSION(connection, 7)
+      {
+         if (     (connection->flags & NETPLAY_CONN_FLAG_DELTA_BASE)
+               &&  netplay->savestate_base)
+            r->kind = NETPLAY_SAVESTATE_DELTA;
+         else
+            r->kind = NETPLAY_SAVESTATE_FULL;
+
+         if (connection->flags & NETPLAY_CONN_FLAG_DELTA)
+            job->keep_base = true;
       }
+      else if (job->legacy)
+         r->kind = NETPLAY_SAVESTATE_LEGACY;
       else
+         continue;
+
+      r->fd              = connection->fd;
+      r->codec           = (uint8_t)codec;
+      job->needed[r->kind] |= (uint8_t)(1 << codec);
+      has_recipients     = true;
+   }
+
+   if (!has_recipients)
+   {
+      netplay_savestate_job_free(job);
+      return;
+   }
+
+   if (job->needed[NETPLAY_SAVESTATE_DELTA])
+   {
+      job->base       = netplay->savestate_base;
+      job->base_size  = netplay->savestate_base_size;
+      job->base_frame = netplay->savestate_base_frame;
+      job->base_crc   = netplay->savestate_base_crc;
+   }
+
+   /* Hold back what comes after the savestate */
+   for (i = 0; i < job->recipients_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      struct netplay_savestate_recipient *r = &job->recipients[i];
+
+      if (r->kind == NETPLAY_SAVESTATE_NONE)
+         continue;
+
+      if (!netplay_send_flush(&connection->send_packet_buffer,
+            connection->fd, false))
       {
-         has_legacy_connection = true;
+         netplay_hangup(netplay, connection);
+         r->kind = NETPLAY_SAVESTATE_NONE;
+         continue;
       }
+      r->held                              = buf_used(
+         &connection->send_packet_buffer);
+      connection->send_packet_buffer.hold  = true;
    }
 
-   if (has_legacy_connection && !is_legacy_data)
+   netplay->savestate_job = job;
+
+#ifdef HAVE_THREADS
+   if (     serial_info->size >= NETPLAY_SAVESTATE_ASYNC_SIZE
+         && (job->lock = slock_new()))
    {
-      /* at least one peer is not on protocol 7 or higher. extract the coremem segment
-       * and only send it. */
-      const uint8_t* input = netplay_get_savestate_coremem(netplay,
-            (const uint8_t*)serial_info->data_const);
+      if ((job->thread = sthread_create(netplay_savestate_job_thread, job)))
+         return;
+      slock_free(job->lock);
+      job->lock = NULL;
+   }
+#endif
 
-      if (input != serial_info->data_const)
-      {
-         serial_info->data_const = input;
-         serial_info->size = netplay->coremem_size;
+   netplay_savestate_job_run(job);
+   netplay_savestate_job_poll(netplay, true);
+   return;
 
-         netplay_send_savestate(netplay, serial_info, cx, z, true);
-      }
+error:
+   if (job)
+   {
+      free(job->recipients);
+      free(job->state);
+      free(job);
    }
+   /* Catastrophe! */
+   for (i = 0; i < netplay->connections_size; i++)
+      netplay_hangup(netplay, &netplay->connections[i]);
 }
 
 /**
@@ -7638,6 +8624,9 @@ static void netplay_core_reset(netplay_t *netplay)
    /* Ignore past input */
    netplay_force_future(netplay);
 
+   /* Any savestate still being compressed goes first */
+   netplay_savestate_job_poll(netplay, true);
+
    /* Request that our peers reset */
    cmd[0] = htonl(NETPLAY_CMD_RESET);
    cmd[1] = htonl(sizeof(uint32_t));
@@ -7831,12 +8820,7 @@ void netplay_load_savestate(netplay_t *netplay,
    if (!netplay->desync)
    {
       /* Send this to every peer. */
-      if (netplay->compress_nil.compression_backend)
-         netplay_send_savestate(netplay, serial_info, 0,
-            &netplay->compress_nil, false);
-      if (netplay->compress_zlib.compression_backend)
-         netplay_send_savestate(netplay, serial_info, NETPLAY_COMPRESSION_ZLIB,
-            &netplay->compress_zlib, false);
+      netplay_send_savestate(netplay, serial_info);
    }
 }
 
@@ -7847,6 +8831,9 @@ void netplay_load_savestate(netplay_t *netplay,
  */
 static void netplay_toggle_play_spectate(netplay_t *netplay)
 {
+   /* Any savestate still being compressed goes first */
+   netplay_savestate_job_poll(netplay, true);
+
    switch (netplay->self_mode)
    {
       case NETPLAY_CONNECTION_PLAYING:
@@ -8927,6 +9914,10 @@ static bool netplay_pre_frame(netplay_t *netplay)
    if (netplay->local_paused)
       netplay_frontend_paused(netplay, false);
 
+   /* Send the savestate being compressed once it is ready */
+   if (!netplay_savestate_job_poll(netplay, false))
+      netplay->savestate_job->frames++;
+
    /* Are we ready now? */
    if (netplay->quirks & NETPLAY_QUIRK_INITIALIZATION)
       netplay_try_init_serialization(netplay);
@@ -9085,6 +10076,12 @@ bool init_netplay(const char *server, unsigned port, const char *mitm_session)
    if (!(net_st->flags & NET_DRIVER_ST_FLAG_NETPLAY_ENABLED))
       return false;
 
+#if HAVE_RUNAHEAD
+   /* Netplay starts from the real frame, not the one
+    * the run-ahead state cache may have run ahead to */
+   runahead_state_cache_sync(runloop_state_get_ptr());
+#endif
+
 #ifdef HAVE_NETPLAYDISCOVERY
    net_st->lan_ad_server_fd       = -1;
 #endif
@@ -9422,6 +10419,9 @@ bool netplay_reinit_serialization(void)
    if (!netplay)
       return true;
 
+   /* The savestate being compressed was taken before the change */
+   netplay_savestate_job_poll(netplay, true);
+
    netplay->state_size = 0;
 
    /* netplay_init_serialization rebuilds the delta states and zbuffer, but
@@ -72,12 +72,27 @@
 #define NETPLAY_QUIRK_PLATFORM_DEPENDENT (1 << 2)
 
 /* Compression protocols supported */
-#define NETPLAY_COMPRESSION_ZLIB (1<<0)
+#define NETPLAY_COMPRESSION_ZLIB  (1<<0)
+#define NETPLAY_COMPRESSION_ZSTD  (1<<1)
+/* Not compression protocols, but announced alongside them */
+/* Savestates may be sent as a delta against
+ * the last one the peer acknowledged */
+#define NETPLAY_COMPRESSION_DELTA (1<<2)
+/* Frames are checked with per-block XXH3 hashes instead of CRC32 */
+#define NETPLAY_COMPRESSION_XXH3  (1<<3)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED_ZLIB NETPLAY_COMPRESSION_ZLIB
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED_ZLIB 0
 #endif
+#ifdef HAVE_ZSTD
+#define NETPLAY_COMPRESSION_SUPPORTED_ZSTD NETPLAY_COMPRESSION_ZSTD
+#else
+#define NETPLAY_COMPRESSION_SUPPORTED_ZSTD 0
+#endif
+#define NETPLAY_COMPRESSION_SUPPORTED (NETPLAY_COMPRESSION_SUPPORTED_ZLIB \
+      | NETPLAY_COMPRESSION_SUPPORTED_ZSTD | NETPLAY_COMPRESSION_DELTA \
+      | NETPLAY_COMPRESSION_XXH3)
 
 /* The keys supported by netplay */
 enum netplay_keys
@@ -165,6 +180,16 @@ enum netplay_cmd
    /* Send a network packet from the raw packet core interface */
    NETPLAY_CMD_NETPACKET      = 0x0048,
 
+   /* Send a savestate for the client to load, as the blocks
+    * that differ from the last one it acknowledged */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0049,
+
+   /* Acknowledge a loaded savestate */
+   NETPLAY_CMD_SAVESTATE_ACK  = 0x004A,
+
+   /* CRC, as a hash of each block of the core's state */
+   NETPLAY_CMD_BLOCK_HASHES   = 0x004B,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -320,14 +345,23 @@ struct delta_frame
    /* The serialized state of the core at this frame, before input */
    void *state;
 
+   /* The remote block hashes of the core's state, if we've received them */
+   uint32_t *block_hashes;
+
    uint32_t frame;
 
    /* The CRC-32 of the serialized state if we've calculated it, else 0 */
    uint32_t crc;
 
+   uint32_t block_hashes_count;
+   uint32_t block_hash_size;
+
    /* Have we read local input? */
    bool have_local;
 
+   /* Have we received block hashes for this frame? */
+   bool have_block_hashes;
+
    /* Have we read the real (remote) input? */
    bool have_real[MAX_CLIENTS];
 
@@ -343,6 +377,9 @@ struct socket_buffer
    size_t start;
    size_t end;
    size_t read;
+   /* Queue without sending: a savestate still being
+    * compressed goes ahead of what is queued from here on */
+   bool hold;
 };
 
 /* We do it like this instead of using sockaddr_storage
@@ -364,7 +401,14 @@ enum netplay_connection_flags
    /* Is this connection allowed to play (server only)? */
    NETPLAY_CONN_FLAG_CAN_PLAY       = (1 << 2),
    /* Did we request a ping response? */
-   NETPLAY_CONN_FLAG_PING_REQUESTED = (1 << 3)
+   NETPLAY_CONN_FLAG_PING_REQUESTED = (1 << 3),
+   /* Does this peer take savestate deltas? */
+   NETPLAY_CONN_FLAG_DELTA          = (1 << 4),
+   /* Has this peer acknowledged the savestate
+    * deltas are currently taken against? */
+   NETPLAY_CONN_FLAG_DELTA_BASE     = (1 << 5),
+   /* Does this peer check frames with block hashes? */
+   NETPLAY_CONN_FLAG_XXH3           = (1 << 6)
 };
 
 /* Each connection gets a connection struct */
@@ -477,6 +521,8 @@ struct netplay_chat
    } messages[NETPLAY_CHAT_MAX_MESSAGES];
 };
 
+struct netplay_savestate_job;
+
 struct netplay
 {
    /* We stall if we're far enough ahead that we
@@ -501,6 +547,7 @@ struct netplay
    /* Compression transcoder */
    struct compression_transcoder compress_nil;
    struct compression_transcoder compress_zlib;
+   struct compression_transcoder compress_zstd;
 
    /* MITM session id */
    mitm_id_t mitm_session_id;
@@ -522,9 +569,17 @@ struct netplay
    /* A buffer into which to compress frames for transfer */
    uint8_t *zbuffer;
 
+   /* The last savestate sent (server) or loaded (client),
+    * which savestate deltas are taken against */
+   uint8_t *savestate_base;
+
+   /* A savestate still being compressed for sending */
+   struct netplay_savestate_job *savestate_job;
+
    size_t connections_size;
    size_t buffer_size;
    size_t zbuffer_size;
+   size_t savestate_base_size;
    /* The size of our packet buffers */
    size_t packet_buffer_size;
    /* Size of savestates (coremem_size + cheevos_size + headers) */
@@ -605,6 +660,10 @@ struct netplay
     * If set, we don't attempt to stay in sync. */
    uint32_t desync;
 
+   /* Frame and CRC of the savestate base */
+   uint32_t savestate_base_frame;
+   uint32_t savestate_base_crc;
+
    /* Host settings */
    int32_t input_latency_frames_min;
    int32_t input_latency_frames_max;
@@ -15,21 +15,36 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <libretro.h>
 #include <boolean.h>
 #include <retro_miscellaneous.h>
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 #include <streams/interface_stream.h>
+#include <streams/file_stream.h>
 #include <file/file_path.h>
 #include <file/archive_file.h>
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -44,6 +59,9 @@
 #define PLAYLIST_ENTRIES 6
 #endif
 
+/* Minimum size of a playlist string pool block */
+#define PLAYLIST_STRING_BLOCK_SIZE 0x4000
+
 #define WINDOWS_PATH_DELIMITER '\\'
 #define POSIX_PATH_DELIMITER '/'
 
@@ -61,12 +79,92 @@ typedef struct
    bool overwrite_playlist;
 } playlist_manual_scan_record_t;
 
+typedef struct playlist_string_block
+{
+   struct playlist_string_block *next;
+   char *data;
+   size_t size;
+   size_t used;
+   bool mapped; /* data is a playlist_cache_read() mapping */
+} playlist_string_block_t;
+
+#ifdef HAVE_MMAP
+#define PLAYLIST_CACHE_MAGIC      "RPLC"
+#define PLAYLIST_CACHE_VERSION    1
+#define PLAYLIST_CACHE_BYTE_ORDER 0x01020304
+
+enum playlist_cache_flags
+{
+   PLAYLIST_CACHE_FLG_COMPRESSED         = (1 << 0),
+   PLAYLIST_CACHE_FLG_SEARCH_RECURSIVELY = (1 << 1),
+   PLAYLIST_CACHE_FLG_SEARCH_ARCHIVES    = (1 << 2),
+   PLAYLIST_CACHE_FLG_FILTER_DAT_CONTENT = (1 << 3),
+   PLAYLIST_CACHE_FLG_OVERWRITE_PLAYLIST = (1 << 4)
+};
+
+/* Binary playlist cache file (see playlist_cache_read()):
+ * header, entry table, subsystem rom table, string pool.
+ * All strings are offsets into the string pool, where
+ * offset 0 is an empty string that stands for NULL.
+ * Data is stored in native byte order. */
+typedef struct
+{
+   char     magic[4];
+   uint32_t version;
+   uint32_t byte_order;
+   uint32_t flags;
+   /* State of the .lpl file the cache was made from */
+   uint64_t lpl_size;
+   int64_t  lpl_mtime;
+   int64_t  lpl_mtime_nsec;
+   uint32_t entry_count;
+   uint32_t rom_count;
+   uint32_t strings_size;
+   uint32_t default_core_path;
+   uint32_t default_core_name;
+   uint32_t base_content_directory;
+   uint32_t scan_content_dir;
+   uint32_t scan_file_exts;
+   uint32_t scan_dat_file_path;
+   uint32_t label_display_mode;
+   uint32_t right_thumbnail_mode;
+   uint32_t left_thumbnail_mode;
+   uint32_t thumbnail_match_mode;
+   uint32_t sort_mode;
+} playlist_cache_header_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t label;
+   uint32_t core_path;
+   uint32_t core_name;
+   uint32_t db_name;
+   uint32_t crc32;
+   uint32_t subsystem_ident;
+   uint32_t subsystem_name;
+   uint32_t rom_first;
+   uint32_t rom_count;
+   uint32_t entry_slot;
+   uint32_t runtime_hours;
+   uint32_t runtime_minutes;
+   uint32_t runtime_seconds;
+   uint32_t last_played_year;
+   uint32_t last_played_month;
+   uint32_t last_played_day;
+   uint32_t last_played_hour;
+   uint32_t last_played_minute;
+   uint32_t last_played_second;
+} playlist_cache_entry_t;
+#endif
+
 enum content_playlist_flags
 {
    CNT_PLAYLIST_FLG_MOD        = (1 << 0),
    CNT_PLAYLIST_FLG_OLD_FMT    = (1 << 1),
    CNT_PLAYLIST_FLG_COMPRESSED = (1 << 2),
-   CNT_PLAYLIST_FLG_CACHED_EXT = (1 << 3)
+   CNT_PLAYLIST_FLG_CACHED_EXT = (1 << 3),
+   CNT_PLAYLIST_FLG_INDEXED    = (1 << 4)
 };
 
 struct content_playlist
@@ -76,9 +174,16 @@ struct content_playlist
    char *base_content_directory;
 
    struct playlist_entry *entries;
+   /* Pool for strings of entries read from disk */
+   playlist_string_block_t *strings;
+
+   /* Path hash index (see playlist_index_build()) */
+   playlist_path_id_t **real_path_index;
+   playlist_path_id_t **archive_path_index;
 
    playlist_manual_scan_record_t scan_record; /* ptr alignment */
    playlist_config_t config;                  /* size_t alignment */
+   size_t index_head;
 
    enum playlist_label_display_mode label_display_mode;
    enum playlist_thumbnail_mode right_thumbnail_mode;
@@ -267,6 +372,9 @@ static playlist_path_id_t *playlist_path_id_init(const char *path)
 
    path_id->real_path           = NULL;
    path_id->archive_path        = NULL;
+   path_id->real_path_next      = NULL;
+   path_id->archive_path_next   = NULL;
+   path_id->index_slot          = 0;
    path_id->real_path_hash      = 0;
    path_id->archive_path_hash   = 0;
    path_id->is_archive          = false;
@@ -492,6 +600,293 @@ static bool playlist_path_matches_entry(playlist_path_id_t *path_id,
    return false;
 }
 
+/* Path hash index
+ *
+ * Comparing a search path (push, exists, delete by
+ * path...) against every entry in the playlist would
+ * make building a playlist of N entries O(N^2), so
+ * entries are indexed by
+ * the hash of their 'real' path - and entries inside
+ * an archive also by the hash of their parent archive
+ * path, for fuzzy archive matching - so a lookup only
+ * has to compare against the entries sharing a hash.
+ *
+ * Entries sharing a hash are chained through their
+ * path IDs. The position of an entry is recorded as
+ * a 'slot' relative to index_head, so that pushing a
+ * new entry to the top of the playlist only has to
+ * decrement index_head rather than renumber every
+ * other entry. Moves and deletes renumber only the
+ * entries they shift anyway.
+ *
+ * The index is built on first use, and kept up to
+ * date from then on; while it exists, every entry
+ * has a path ID. */
+
+static void playlist_index_link(playlist_t *playlist,
+      playlist_path_id_t *path_id)
+{
+   if (!string_is_empty(path_id->real_path))
+   {
+      path_id->real_path_next    = RHMAP_GET(playlist->real_path_index,
+            path_id->real_path_hash);
+      RHMAP_SET(playlist->real_path_index,
+            path_id->real_path_hash, path_id);
+   }
+
+   if (      path_id->is_in_archive
+         && !string_is_empty(path_id->archive_path))
+   {
+      path_id->archive_path_next = RHMAP_GET(playlist->archive_path_index,
+            path_id->archive_path_hash);
+      RHMAP_SET(playlist->archive_path_index,
+            path_id->archive_path_hash, path_id);
+   }
+}
+
+static void playlist_index_unlink(playlist_t *playlist,
+      playlist_path_id_t *path_id)
+{
+   ptrdiff_t idx;
+   playlist_path_id_t **link;
+
+   if (    !string_is_empty(path_id->real_path)
+         && (idx = RHMAP_IDX(playlist->real_path_index,
+               path_id->real_path_hash)) != -1)
+   {
+      for (link = &playlist->real_path_index[idx];
+            *link; link = &(*link)->real_path_next)
+      {
+         if (*link == path_id)
+         {
+            *link = path_id->real_path_next;
+            break;
+         }
+      }
+
+      if (!playlist->real_path_index[idx])
+         (void)RHMAP_DEL(playlist->real_path_index, path_id->real_path_hash);
+   }
+
+   if (     path_id->is_in_archive
+         && !string_is_empty(path_id->archive_path)
+         && (idx = RHMAP_IDX(playlist->archive_path_index,
+               path_id->archive_path_hash)) != -1)
+   {
+      for (link = &playlist->archive_path_index[idx];
+            *link; link = &(*link)->archive_path_next)
+      {
+         if (*link == path_id)
+         {
+            *link = path_id->archive_path_next;
+            break;
+         }
+      }
+
+      if (!playlist->archive_path_index[idx])
+         (void)RHMAP_DEL(playlist->archive_path_index, path_id->archive_path_hash);
+   }
+
+   path_id->real_path_next    = NULL;
+   path_id->archive_path_next = NULL;
+}
+
+static void playlist_index_free(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->real_path_index);
+   RHMAP_FREE(playlist->archive_path_index);
+   playlist->index_head  = 0;
+   playlist->flags      &= ~CNT_PLAYLIST_FLG_INDEXED;
+}
+
+static bool playlist_index_build(playlist_t *playlist)
+{
+   size_t i, _len;
+
+   if (playlist->flags & CNT_PLAYLIST_FLG_INDEXED)
+      return true;
+
+   playlist_index_free(playlist);
+
+   _len = RBUF_LEN(playlist->entries);
+   RHMAP_FIT(playlist->real_path_index, _len);
+
+   for (i = 0; i < _len; i++)
+   {
+      struct playlist_entry *entry = &playlist->entries[i];
+
+      if (     !entry->path_id
+            && !(entry->path_id = playlist_path_id_init(entry->path)))
+      {
+         playlist_index_free(playlist);
+         return false;
+      }
+
+      entry->path_id->index_slot = i;
+      playlist_index_link(playlist, entry->path_id);
+   }
+
+   playlist->flags |= CNT_PLAYLIST_FLG_INDEXED;
+   return true;
+}
+
+/* Renumbers entries [start, end) after they have
+ * been shifted down (towards the end of the
+ * playlist) or up by one position */
+static void playlist_index_shift(playlist_t *playlist,
+      size_t start, size_t end, bool down)
+{
+   size_t i;
+
+   if (!(playlist->flags & CNT_PLAYLIST_FLG_INDEXED))
+      return;
+
+   for (i = start; i < end; i++)
+   {
+      if (down)
+         playlist->entries[i].path_id->index_slot++;
+      else
+         playlist->entries[i].path_id->index_slot--;
+   }
+}
+
+static void playlist_index_scan_chain(playlist_t *playlist,
+      playlist_path_id_t *path_id, playlist_path_id_t *chain,
+      bool archive_chain, size_t start, size_t *best)
+{
+   for (; chain; chain = archive_chain
+         ? chain->archive_path_next : chain->real_path_next)
+   {
+      size_t i = chain->index_slot - playlist->index_head;
+
+      if (     (i < start)
+            || (i >= *best)
+            || (playlist->entries[i].path_id != chain))
+         continue;
+
+      if (playlist_path_matches_entry(path_id,
+            &playlist->entries[i], &playlist->config))
+         *best = i;
+   }
+}
+
+/**
+ * playlist_find_next:
+ * @playlist          : Playlist handle.
+ * @path_id           : Path identity to search for.
+ * @match_empty       : If true, an empty search path
+ *                      matches entries without content path.
+ * @idx               : Position to search from; receives the
+ *                      position of the match.
+ *
+ * Finds the first entry at or after @idx matching @path_id,
+ * with the same semantics as playlist_path_matches_entry().
+ *
+ * Returns: true if a matching entry was found.
+ **/
+static bool playlist_find_next(playlist_t *playlist,
+      playlist_path_id_t *path_id, bool match_empty, size_t *idx)
+{
+   size_t i;
+   size_t _len = RBUF_LEN(playlist->entries);
+
+   if (     !string_is_empty(path_id->real_path)
+         && playlist_index_build(playlist))
+   {
+      size_t best = _len;
+#ifdef RARCH_INTERNAL
+      bool fuzzy  = playlist->config.fuzzy_archive_match;
+#else
+      bool fuzzy  = true;
+#endif
+
+      playlist_index_scan_chain(playlist, path_id,
+            RHMAP_GET(playlist->real_path_index, path_id->real_path_hash),
+            false, *idx, &best);
+
+      if (fuzzy && !string_is_empty(path_id->archive_path))
+      {
+         /* File inside an archive: look for the bare archive */
+         if (path_id->is_in_archive)
+            playlist_index_scan_chain(playlist, path_id,
+                  RHMAP_GET(playlist->real_path_index,
+                     path_id->archive_path_hash),
+                  false, *idx, &best);
+         /* Bare archive: look for files inside it */
+         else if (path_id->is_archive)
+            playlist_index_scan_chain(playlist, path_id,
+                  RHMAP_GET(playlist->archive_path_index,
+                     path_id->archive_path_hash),
+                  true, *idx, &best);
+      }
+
+      if (best == _len)
+         return false;
+
+      *idx = best;
+      return true;
+   }
+
+   for (i = *idx; i < _len; i++)
+   {
+      if (   (   match_empty
+              && string_is_empty(path_id->real_path)
+              && string_is_empty(playlist->entries[i].path))
+          || playlist_path_matches_entry(path_id,
+               &playlist->entries[i], &playlist->config))
+      {
+         *idx = i;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/* Moves the entry at @idx to the top of the playlist */
+static void playlist_move_to_top(playlist_t *playlist, size_t idx)
+{
+   struct playlist_entry tmp = playlist->entries[idx];
+
+   memmove(playlist->entries + 1, playlist->entries,
+         idx * sizeof(struct playlist_entry));
+   playlist->entries[0] = tmp;
+
+   if (playlist->flags & CNT_PLAYLIST_FLG_INDEXED)
+   {
+      playlist_index_shift(playlist, 1, idx + 1, true);
+      tmp.path_id->index_slot = playlist->index_head;
+   }
+}
+
+/* Discards the path ID of the entry at @idx after
+ * its path has changed, re-indexing the entry
+ * if required */
+static void playlist_reset_path_id(playlist_t *playlist, size_t idx)
+{
+   struct playlist_entry *entry = &playlist->entries[idx];
+
+   if (entry->path_id)
+   {
+      if (playlist->flags & CNT_PLAYLIST_FLG_INDEXED)
+         playlist_index_unlink(playlist, entry->path_id);
+      playlist_path_id_free(entry->path_id);
+      entry->path_id = NULL;
+   }
+
+   if (!(playlist->flags & CNT_PLAYLIST_FLG_INDEXED))
+      return;
+
+   if (!(entry->path_id = playlist_path_id_init(entry->path)))
+   {
+      playlist_index_free(playlist);
+      return;
+   }
+
+   entry->path_id->index_slot = playlist->index_head + idx;
+   playlist_index_link(playlist, entry->path_id);
+}
+
 /**
  * playlist_core_path_equal:
  * @real_core_path  : 'Real' search path, generated by path_resolve_realpath()
@@ -571,37 +966,116 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Entry strings loaded from disk are carved out of a
+ * handful of large blocks owned by the playlist, rather
+ * than being strdup()'d one by one: loading or freeing
+ * a big playlist then costs a few allocations instead
+ * of one per string. Pooled strings are never freed
+ * individually - a field that is modified later gets
+ * a regular heap copy, and the pooled original is
+ * reclaimed along with its block when the playlist
+ * is cleared or freed. */
+
+static bool playlist_string_is_pooled(const playlist_t *playlist,
+      const char *str)
+{
+   const playlist_string_block_t *block;
+
+   for (block = playlist->strings; block; block = block->next)
+      if (str >= block->data && str < block->data + block->used)
+         return true;
+
+   return false;
+}
+
+static void playlist_string_free(const playlist_t *playlist, char *str)
+{
+   if (str && !playlist_string_is_pooled(playlist, str))
+      free(str);
+}
+
+static bool playlist_strings_reserve(playlist_t *playlist, size_t size)
+{
+   playlist_string_block_t *block = (playlist_string_block_t*)
+      malloc(sizeof(*block) + size);
+
+   if (!block)
+      return false;
+
+   block->next        = playlist->strings;
+   block->data        = (char*)(block + 1);
+   block->size        = size;
+   block->used        = 0;
+   block->mapped      = false;
+   playlist->strings  = block;
+   return true;
+}
+
+static char *playlist_string_dup(playlist_t *playlist,
+      const char *str, size_t len)
+{
+   char *dst;
+   playlist_string_block_t *block = playlist->strings;
+
+   if (!block || block->size - block->used < len + 1)
+   {
+      /* Each new block is half the size of the
+       * previous one, so a reservation based on
+       * the file size needs few follow-ups */
+      size_t size = block ? (block->size / 2) : 0;
+      if (size < PLAYLIST_STRING_BLOCK_SIZE)
+         size     = PLAYLIST_STRING_BLOCK_SIZE;
+      if (size < len + 1)
+         size     = len + 1;
+      if (!playlist_strings_reserve(playlist, size))
+         return NULL;
+      block       = playlist->strings;
+   }
+
+   dst          = block->data + block->used;
+   memcpy(dst, str, len);
+   dst[len]     = '\0';
+   block->used += len + 1;
+   return dst;
+}
+
+static void playlist_strings_free(playlist_t *playlist)
+{
+   while (playlist->strings)
+   {
+      playlist_string_block_t *next = playlist->strings->next;
+#ifdef HAVE_MMAP
+      if (playlist->strings->mapped)
+         munmap(playlist->strings->data, playlist->strings->size);
+#endif
+      free(playlist->strings);
+      playlist->strings = next;
+   }
+}
+
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(const playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
-   if (entry->path)
-      free(entry->path);
-   if (entry->label)
-      free(entry->label);
-   if (entry->core_path)
-      free(entry->core_path);
-   if (entry->core_name)
-      free(entry->core_name);
-   if (entry->db_name)
-      free(entry->db_name);
-   if (entry->crc32)
-      free(entry->crc32);
-   if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
-   if (entry->subsystem_name)
-      free(entry->subsystem_name);
-   if (entry->runtime_str)
-      free(entry->runtime_str);
-   if (entry->last_played_str)
-      free(entry->last_played_str);
+   playlist_string_free(playlist, entry->path);
+   playlist_string_free(playlist, entry->label);
+   playlist_string_free(playlist, entry->core_path);
+   playlist_string_free(playlist, entry->core_name);
+   playlist_string_free(playlist, entry->db_name);
+   playlist_string_free(playlist, entry->crc32);
+   playlist_string_free(playlist, entry->subsystem_ident);
+   playlist_string_free(playlist, entry->subsystem_name);
+   playlist_string_free(playlist, entry->runtime_str);
+   playlist_string_free(playlist, entry->last_played_str);
    if (entry->subsystem_roms)
       string_list_free(entry->subsystem_roms);
    if (entry->path_id)
@@ -655,11 +1129,17 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+   {
+      if (     entry_to_delete->path_id
+            && (playlist->flags & CNT_PLAYLIST_FLG_INDEXED))
+         playlist_index_unlink(playlist, entry_to_delete->path_id);
+      playlist_free_entry(playlist, entry_to_delete);
+   }
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
          (_len - 1 - idx) * sizeof(struct playlist_entry));
+   playlist_index_shift(playlist, idx, _len - 1, false);
 
    RBUF_RESIZE(playlist->entries, _len - 1);
 
@@ -686,22 +1166,11 @@ void playlist_delete_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
-   while (i < RBUF_LEN(playlist->entries))
-   {
-      if (!playlist_path_matches_entry(path_id,
-            &playlist->entries[i], &playlist->config))
-      {
-         i++;
-         continue;
-      }
-
-      /* Paths are equal - delete entry */
+   /* Entries are shifted up by the delete
+    * operation - *do not* increment i */
+   while (playlist_find_next(playlist, path_id, false, &i))
       playlist_delete_index(playlist, i);
 
-      /* Entries are shifted up by the delete
-       * operation - *do not* increment i */
-   }
-
    playlist_path_id_free(path_id);
 }
 
@@ -710,7 +1179,7 @@ void playlist_get_index_by_path(playlist_t *playlist,
       const struct playlist_entry **entry)
 {
    playlist_path_id_t *path_id = NULL;
-   size_t i, len;
+   size_t i                    = 0;
 
    if (!playlist || !entry || string_is_empty(search_path))
       return;
@@ -718,15 +1187,8 @@ void playlist_get_index_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (!playlist_path_matches_entry(path_id,
-            &playlist->entries[i], &playlist->config))
-         continue;
-
+   if (playlist_find_next(playlist, path_id, false, &i))
       *entry = &playlist->entries[i];
-      break;
-   }
 
    playlist_path_id_free(path_id);
 }
@@ -734,8 +1196,9 @@ void playlist_get_index_by_path(playlist_t *playlist,
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path)
 {
+   bool ret;
    playlist_path_id_t *path_id = NULL;
-   size_t i, len;
+   size_t i                    = 0;
 
    if (!playlist || string_is_empty(path))
       return false;
@@ -743,18 +1206,10 @@ bool playlist_entry_exists(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(path)))
       return false;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (playlist_path_matches_entry(path_id,
-            &playlist->entries[i], &playlist->config))
-      {
-         playlist_path_id_free(path_id);
-         return true;
-      }
-   }
+   ret = playlist_find_next(playlist, path_id, false, &i);
 
    playlist_path_id_free(path_id);
-   return false;
+   return ret;
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
@@ -769,55 +1224,45 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_string_free(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
-      if (entry->path_id)
-      {
-         playlist_path_id_free(entry->path_id);
-         entry->path_id  = NULL;
-      }
+      playlist_reset_path_id(playlist, idx);
 
       playlist->flags |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
-      if (entry->label)
-         free(entry->label);
+      playlist_string_free(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_string_free(playlist, entry->core_path);
       entry->core_path   = strdup(update_entry->core_path);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
-      if (entry->core_name)
-         free(entry->core_name);
+      playlist_string_free(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
-      if (entry->db_name)
-         free(entry->db_name);
+      playlist_string_free(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
-      if (entry->crc32)
-         free(entry->crc32);
+      playlist_string_free(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
    }
@@ -836,15 +1281,10 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_string_free(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
-      if (entry->path_id)
-      {
-         playlist_path_id_free(entry->path_id);
-         entry->path_id  = NULL;
-      }
+      playlist_reset_path_id(playlist, idx);
 
       if (register_update)
          playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
@@ -852,8 +1292,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_string_free(playlist, entry->core_path);
       entry->core_path      = strdup(update_entry->core_path);
       if (register_update)
          playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
@@ -931,8 +1370,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->runtime_str && (update_entry->runtime_str != entry->runtime_str))
    {
-      if (entry->runtime_str)
-         free(entry->runtime_str);
+      playlist_string_free(playlist, entry->runtime_str);
       entry->runtime_str    = strdup(update_entry->runtime_str);
       if (register_update)
          playlist->flags   |= CNT_PLAYLIST_FLG_MOD;
@@ -940,8 +1378,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->last_played_str && (update_entry->last_played_str != entry->last_played_str))
    {
-      if (entry->last_played_str)
-         free(entry->last_played_str);
+      playlist_string_free(playlist, entry->last_played_str);
       entry->last_played_str = NULL;
       entry->last_played_str = strdup(update_entry->last_played_str);
       if (register_update)
@@ -983,18 +1420,8 @@ bool playlist_push_runtime(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   for (i = 0; playlist_find_next(playlist, path_id, true, &i); i++)
    {
-      struct playlist_entry tmp;
-      bool equal_path  = (string_is_empty(path_id->real_path)
-            && string_is_empty(playlist->entries[i].path));
-
-      equal_path       = equal_path || playlist_path_matches_entry(
-            path_id, &playlist->entries[i], &playlist->config);
-
-      if (!equal_path)
-         continue;
-
       /* Core name can have changed while still being the same core.
        * Differentiate based on the core path only. */
       if (!playlist_core_path_equal(real_core_path, playlist->entries[i].core_path, &playlist->config))
@@ -1006,10 +1433,7 @@ bool playlist_push_runtime(playlist_t *playlist,
          goto error;
 
       /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+      playlist_move_to_top(playlist, i);
 
       goto success;
    }
@@ -1020,7 +1444,10 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      if (     last_entry->path_id
+            && (playlist->flags & CNT_PLAYLIST_FLG_INDEXED))
+         playlist_index_unlink(playlist, last_entry->path_id);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1041,6 +1468,11 @@ bool playlist_push_runtime(playlist_t *playlist,
 
       if (!string_is_empty(path_id->real_path))
          playlist->entries[0].path            = strdup(path_id->real_path);
+      if (playlist->flags & CNT_PLAYLIST_FLG_INDEXED)
+      {
+         path_id->index_slot                  = --playlist->index_head;
+         playlist_index_link(playlist, path_id);
+      }
       playlist->entries[0].path_id            = path_id;
       path_id                                 = NULL;
 
@@ -1328,18 +1760,8 @@ bool playlist_push(playlist_t *playlist,
    }
 
    _len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < _len; i++)
+   for (i = 0; playlist_find_next(playlist, path_id, true, &i); i++)
    {
-      struct playlist_entry tmp;
-      bool equal_path  = (string_is_empty(path_id->real_path)
-                       && string_is_empty(playlist->entries[i].path));
-
-      equal_path       = equal_path || playlist_path_matches_entry(
-            path_id, &playlist->entries[i], &playlist->config);
-
-      if (!equal_path)
-         continue;
-
       /* Core name can have changed while still being the same core.
        * Differentiate based on the core path only. */
       if (!playlist_core_path_equal(real_core_path, playlist->entries[i].core_path, &playlist->config))
@@ -1446,10 +1868,7 @@ bool playlist_push(playlist_t *playlist,
       }
 
       /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+      playlist_move_to_top(playlist, i);
 
       goto success;
    }
@@ -1460,7 +1879,10 @@ bool playlist_push(playlist_t *playlist,
    if (_len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[_len - 1];
-      playlist_free_entry(last_entry);
+      if (     last_entry->path_id
+            && (playlist->flags & CNT_PLAYLIST_FLG_INDEXED))
+         playlist_index_unlink(playlist, last_entry->path_id);
+      playlist_free_entry(playlist, last_entry);
       _len--;
    }
    else
@@ -1501,6 +1923,11 @@ bool playlist_push(playlist_t *playlist,
 
       if (!string_is_empty(path_id->real_path))
          playlist->entries[0].path            = strdup(path_id->real_path);
+      if (playlist->flags & CNT_PLAYLIST_FLG_INDEXED)
+      {
+         path_id->index_slot                  = --playlist->index_head;
+         playlist_index_link(playlist, path_id);
+      }
       playlist->entries[0].path_id            = path_id;
       path_id                                 = NULL;
 
@@ -1544,6 +1971,565 @@ error:
    return false;
 }
 
+#ifdef HAVE_MMAP
+/* Binary playlist cache
+ *
+ * Parsing a big JSON playlist takes a while, so each
+ * time a playlist is written (or parsed, when there is
+ * no usable cache yet) its contents are also dumped to
+ * a binary file next to it. On the next load that file
+ * is mapped into memory and, provided the .lpl file has
+ * the same size and modification time as when the cache
+ * was made, the entry strings are used straight from the
+ * mapping - nothing is parsed or copied. The cache holds
+ * exactly what parsing the .lpl file would yield, so the
+ * two ways of loading a playlist are interchangeable. */
+
+static bool playlist_cache_get_path(const playlist_t *playlist,
+      char *s, size_t len)
+{
+   if (!string_is_equal_noncase(path_get_extension(playlist->config.path),
+         FILE_PATH_LPL_EXTENSION_NO_DOT))
+      return false;
+   fill_pathname(s, playlist->config.path,
+         FILE_PATH_LPL_CACHE_EXTENSION, len);
+   return true;
+}
+
+/* Records the current state of the .lpl file in
+ * the lpl_* fields of @stamp */
+static bool playlist_cache_stat_lpl(const char *path,
+      playlist_cache_header_t *stamp)
+{
+   struct stat st;
+
+   if (stat(path, &st) != 0)
+      return false;
+
+   stamp->lpl_size       = (uint64_t)st.st_size;
+   stamp->lpl_mtime      = (int64_t)st.st_mtime;
+#if defined(__APPLE__)
+   stamp->lpl_mtime_nsec = (int64_t)st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+   stamp->lpl_mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+#else
+   stamp->lpl_mtime_nsec = 0;
+#endif
+   return true;
+}
+
+static size_t playlist_cache_string_size(const char *str)
+{
+   return string_is_empty(str) ? 0 : strlen(str) + 1;
+}
+
+static uint32_t playlist_cache_add_string(char *pool, uint32_t *pool_len,
+      uint32_t **offsets, const char *str)
+{
+   size_t _len;
+   uint32_t ofs;
+   uint32_t hash;
+   uint32_t *map = *offsets;
+
+   if (string_is_empty(str))
+      return 0;
+
+   /* Core paths and names, database names etc. repeat
+    * across entries and are only stored once. On a hash
+    * collision the string is simply stored again. */
+   hash = rhmap_hash_string(str);
+   if (     (ofs = RHMAP_GET(map, hash))
+         && string_is_equal(pool + ofs, str))
+   {
+      *offsets   = map;
+      return ofs;
+   }
+
+   _len       = strlen(str) + 1;
+   ofs        = *pool_len;
+   memcpy(pool + ofs, str, _len);
+   *pool_len += (uint32_t)_len;
+   RHMAP_SET(map, hash, ofs);
+   *offsets   = map;
+   return ofs;
+}
+
+/**
+ * playlist_cache_write:
+ * @playlist            : Playlist handle.
+ * @stamp               : State of the .lpl file the
+ *                        entries correspond to.
+ * @normalize           : Entries are the in-memory state
+ *                        just saved by playlist_write_file(),
+ *                        rather than freshly parsed.
+ *
+ * Writes the binary cache of @playlist. With @normalize,
+ * anything playlist_write_file() leaves out of the .lpl
+ * file is left out of the cache as well.
+ **/
+static void playlist_cache_write(playlist_t *playlist,
+      const playlist_cache_header_t *stamp, bool normalize)
+{
+   size_t i, j;
+   char cache_path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   char tmp_suffix[48];
+   playlist_cache_header_t *hdr;
+   playlist_cache_entry_t *cache_entries;
+   uint32_t *roms;
+   char *pool;
+   uint8_t *data;
+   size_t data_size;
+   bool builtin;
+   bool scan_record;
+   uint64_t strings_max = 1;
+   uint32_t pool_len    = 1;
+   size_t rom_count     = 0;
+   uint32_t rom_ofs     = 0;
+   uint32_t *offsets    = NULL;
+   size_t entry_count   = RBUF_LEN(playlist->entries);
+
+   if (!playlist_cache_get_path(playlist, cache_path, sizeof(cache_path)))
+      return;
+
+   builtin     = normalize
+      && strstr(playlist->config.path, FILE_PATH_BUILTIN);
+   scan_record = !normalize
+      || !string_is_empty(playlist->scan_record.content_dir);
+
+   /* Upper bound of the string pool size */
+   strings_max += playlist_cache_string_size(playlist->default_core_path);
+   strings_max += playlist_cache_string_size(playlist->default_core_name);
+   strings_max += playlist_cache_string_size(playlist->base_content_directory);
+   if (scan_record)
+   {
+      strings_max += playlist_cache_string_size(playlist->scan_record.content_dir);
+      strings_max += playlist_cache_string_size(playlist->scan_record.file_exts);
+      strings_max += playlist_cache_string_size(playlist->scan_record.dat_file_path);
+   }
+
+   for (i = 0; i < entry_count; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+
+      strings_max += playlist_cache_string_size(entry->path);
+      strings_max += playlist_cache_string_size(entry->label);
+      strings_max += playlist_cache_string_size(entry->core_path);
+      strings_max += playlist_cache_string_size(entry->core_name);
+      strings_max += playlist_cache_string_size(entry->db_name);
+      strings_max += playlist_cache_string_size(entry->crc32);
+      strings_max += playlist_cache_string_size(entry->subsystem_ident);
+      strings_max += playlist_cache_string_size(entry->subsystem_name);
+
+      if (entry->subsystem_roms)
+      {
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+         {
+            const char *rom = entry->subsystem_roms->elems[j].data;
+            if (!string_is_empty(rom))
+            {
+               strings_max += strlen(rom) + 1;
+               rom_count++;
+            }
+         }
+      }
+   }
+
+   if (     strings_max > UINT32_MAX
+         || entry_count > UINT32_MAX
+         || rom_count   > UINT32_MAX)
+      return;
+
+   data_size = sizeof(*hdr)
+      + entry_count * sizeof(*cache_entries)
+      + rom_count   * sizeof(*roms)
+      + (size_t)strings_max;
+
+   if (!(data = (uint8_t*)malloc(data_size)))
+      return;
+
+   hdr           = (playlist_cache_header_t*)data;
+   cache_entries = (playlist_cache_entry_t*)(hdr + 1);
+   roms          = (uint32_t*)(cache_entries + entry_count);
+   pool          = (char*)(roms + rom_count);
+   pool[0]       = '\0';
+
+   for (i = 0; i < entry_count; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      playlist_cache_entry_t *cache_entry = &cache_entries[i];
+
+      cache_entry->path            = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->path);
+      cache_entry->label           = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->label);
+      cache_entry->core_path       = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->core_path);
+      cache_entry->core_name       = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->core_name);
+      cache_entry->db_name         = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->db_name);
+      cache_entry->crc32           = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->crc32);
+      cache_entry->subsystem_ident = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->subsystem_ident);
+      cache_entry->subsystem_name  = playlist_cache_add_string(pool,
+            &pool_len, &offsets, entry->subsystem_name);
+
+      cache_entry->rom_first       = rom_ofs;
+      if (entry->subsystem_roms)
+      {
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+         {
+            const char *rom = entry->subsystem_roms->elems[j].data;
+            if (!string_is_empty(rom))
+               roms[rom_ofs++] = playlist_cache_add_string(pool,
+                     &pool_len, &offsets, rom);
+         }
+      }
+      cache_entry->rom_count       = rom_ofs - cache_entry->rom_first;
+
+      /* See playlist_write_file() */
+      if (normalize && ((int)entry->entry_slot <= 0 || builtin))
+         cache_entry->entry_slot   = 0;
+      else
+         cache_entry->entry_slot   = entry->entry_slot;
+
+      if (normalize)
+      {
+         cache_entry->runtime_hours      = 0;
+         cache_entry->runtime_minutes    = 0;
+         cache_entry->runtime_seconds    = 0;
+         cache_entry->last_played_year   = 0;
+         cache_entry->last_played_month  = 0;
+         cache_entry->last_played_day    = 0;
+         cache_entry->last_played_hour   = 0;
+         cache_entry->last_played_minute = 0;
+         cache_entry->last_played_second = 0;
+      }
+      else
+      {
+         cache_entry->runtime_hours      = entry->runtime_hours;
+         cache_entry->runtime_minutes    = entry->runtime_minutes;
+         cache_entry->runtime_seconds    = entry->runtime_seconds;
+         cache_entry->last_played_year   = entry->last_played_year;
+         cache_entry->last_played_month  = entry->last_played_month;
+         cache_entry->last_played_day    = entry->last_played_day;
+         cache_entry->last_played_hour   = entry->last_played_hour;
+         cache_entry->last_played_minute = entry->last_played_minute;
+         cache_entry->last_played_second = entry->last_played_second;
+      }
+   }
+
+   memset(hdr, 0, sizeof(*hdr));
+   memcpy(hdr->magic, PLAYLIST_CACHE_MAGIC, sizeof(hdr->magic));
+   hdr->version                = PLAYLIST_CACHE_VERSION;
+   hdr->byte_order             = PLAYLIST_CACHE_BYTE_ORDER;
+   hdr->lpl_size               = stamp->lpl_size;
+   hdr->lpl_mtime              = stamp->lpl_mtime;
+   hdr->lpl_mtime_nsec         = stamp->lpl_mtime_nsec;
+   hdr->entry_count            = (uint32_t)entry_count;
+   hdr->rom_count              = (uint32_t)rom_count;
+   hdr->default_core_path      = playlist_cache_add_string(pool,
+         &pool_len, &offsets, playlist->default_core_path);
+   hdr->default_core_name      = playlist_cache_add_string(pool,
+         &pool_len, &offsets, playlist->default_core_name);
+   hdr->base_content_directory = playlist_cache_add_string(pool,
+         &pool_len, &offsets, playlist->base_content_directory);
+   hdr->label_display_mode     = (uint32_t)playlist->label_display_mode;
+   hdr->right_thumbnail_mode   = (uint32_t)playlist->right_thumbnail_mode;
+   hdr->left_thumbnail_mode    = (uint32_t)playlist->left_thumbnail_mode;
+   hdr->thumbnail_match_mode   = (uint32_t)playlist->thumbnail_match_mode;
+   hdr->sort_mode              = (uint32_t)playlist->sort_mode;
+
+   if (playlist->flags & CNT_PLAYLIST_FLG_COMPRESSED)
+      hdr->flags              |= PLAYLIST_CACHE_FLG_COMPRESSED;
+
+   if (scan_record)
+   {
+      hdr->scan_content_dir    = playlist_cache_add_string(pool,
+            &pool_len, &offsets, playlist->scan_record.content_dir);
+      hdr->scan_file_exts      = playlist_cache_add_string(pool,
+            &pool_len, &offsets, playlist->scan_record.file_exts);
+      hdr->scan_dat_file_path  = playlist_cache_add_string(pool,
+            &pool_len, &offsets, playlist->scan_record.dat_file_path);
+
+      if (playlist->scan_record.search_recursively)
+         hdr->flags           |= PLAYLIST_CACHE_FLG_SEARCH_RECURSIVELY;
+      if (playlist->scan_record.search_archives)
+         hdr->flags           |= PLAYLIST_CACHE_FLG_SEARCH_ARCHIVES;
+      if (playlist->scan_record.filter_dat_content)
+         hdr->flags           |= PLAYLIST_CACHE_FLG_FILTER_DAT_CONTENT;
+      if (playlist->scan_record.overwrite_playlist)
+         hdr->flags           |= PLAYLIST_CACHE_FLG_OVERWRITE_PLAYLIST;
+   }
+
+   hdr->strings_size           = pool_len;
+   data_size                   = (size_t)((uint8_t*)pool - data) + pool_len;
+
+   /* Write to a temporary file first, so that a reader
+    * never maps a half written cache. The name is unique to
+    * this write, so that two writers (tasks or processes)
+    * never fill the same file: 'data' stays allocated until
+    * the rename, and the time tells processes apart. */
+   snprintf(tmp_suffix, sizeof(tmp_suffix), ".%llx.%lx.tmp",
+         (unsigned long long)cpu_features_get_time_usec(),
+         (unsigned long)(uintptr_t)data);
+   strlcpy(tmp_path, cache_path, sizeof(tmp_path));
+   strlcat(tmp_path, tmp_suffix, sizeof(tmp_path));
+
+   if (     !filestream_write_file(tmp_path, data, (int64_t)data_size)
+         || filestream_rename(tmp_path, cache_path) != 0)
+      filestream_delete(tmp_path);
+
+   RHMAP_FREE(offsets);
+   free(data);
+}
+
+static bool playlist_cache_is_valid(const playlist_cache_header_t *hdr,
+      size_t data_size, const playlist_cache_header_t *stamp)
+{
+   size_t i;
+   uint64_t tables_size;
+   const playlist_cache_entry_t *cache_entries;
+   const uint32_t *roms;
+   const char *pool;
+   uint32_t strings_size = hdr->strings_size;
+
+   if (     memcmp(hdr->magic, PLAYLIST_CACHE_MAGIC, sizeof(hdr->magic))
+         || (hdr->version        != PLAYLIST_CACHE_VERSION)
+         || (hdr->byte_order     != PLAYLIST_CACHE_BYTE_ORDER)
+         || (hdr->lpl_size       != stamp->lpl_size)
+         || (hdr->lpl_mtime      != stamp->lpl_mtime)
+         || (hdr->lpl_mtime_nsec != stamp->lpl_mtime_nsec))
+      return false;
+
+   tables_size = sizeof(*hdr)
+      + (uint64_t)hdr->entry_count * sizeof(*cache_entries)
+      + (uint64_t)hdr->rom_count   * sizeof(*roms);
+
+   if (     !strings_size
+         || (tables_size + strings_size != (uint64_t)data_size))
+      return false;
+
+   cache_entries = (const playlist_cache_entry_t*)(hdr + 1);
+   roms          = (const uint32_t*)(cache_entries + hdr->entry_count);
+   pool          = (const char*)(roms + hdr->rom_count);
+
+   /* Every string must start inside the pool,
+    * and the last one must be terminated */
+   if (     pool[strings_size - 1]
+         || (hdr->default_core_path      >= strings_size)
+         || (hdr->default_core_name      >= strings_size)
+         || (hdr->base_content_directory >= strings_size)
+         || (hdr->scan_content_dir       >= strings_size)
+         || (hdr->scan_file_exts         >= strings_size)
+         || (hdr->scan_dat_file_path     >= strings_size))
+      return false;
+
+   for (i = 0; i < hdr->entry_count; i++)
+   {
+      const playlist_cache_entry_t *cache_entry = &cache_entries[i];
+
+      if (     (cache_entry->path            >= strings_size)
+            || (cache_entry->label           >= strings_size)
+            || (cache_entry->core_path       >= strings_size)
+            || (cache_entry->core_name       >= strings_size)
+            || (cache_entry->db_name         >= strings_size)
+            || (cache_entry->crc32           >= strings_size)
+            || (cache_entry->subsystem_ident >= strings_size)
+            || (cache_entry->subsystem_name  >= strings_size)
+            || ((uint64_t)cache_entry->rom_first + cache_entry->rom_count
+               > hdr->rom_count))
+         return false;
+   }
+
+   for (i = 0; i < hdr->rom_count; i++)
+      if (roms[i] >= strings_size)
+         return false;
+
+   return true;
+}
+
+static char *playlist_cache_string(char *pool, uint32_t ofs)
+{
+   return ofs ? pool + ofs : NULL;
+}
+
+static char *playlist_cache_strdup(const char *pool, uint32_t ofs)
+{
+   return ofs ? strdup(pool + ofs) : NULL;
+}
+
+/**
+ * playlist_cache_read:
+ * @playlist            : Playlist handle.
+ * @stamp               : Current state of the .lpl file.
+ *
+ * Loads @playlist from its binary cache, if there is
+ * one that matches @stamp.
+ *
+ * Returns: true if the playlist was loaded.
+ **/
+static bool playlist_cache_read(playlist_t *playlist,
+      const playlist_cache_header_t *stamp)
+{
+   size_t i, j;
+   int fd;
+   struct stat st;
+   char cache_path[PATH_MAX_LENGTH];
+   union string_list_elem_attr attr;
+   const playlist_cache_header_t *hdr;
+   const playlist_cache_entry_t *cache_entries;
+   const uint32_t *roms;
+   playlist_string_block_t *block;
+   char *pool;
+   void *data;
+   size_t data_size;
+   size_t entry_count;
+
+   if (!playlist_cache_get_path(playlist, cache_path, sizeof(cache_path)))
+      return false;
+
+   if ((fd = open(cache_path, O_RDONLY)) < 0)
+      return false;
+
+   if (     (fstat(fd, &st) != 0)
+         || ((uint64_t)st.st_size < sizeof(*hdr))
+         || ((uint64_t)st.st_size > SIZE_MAX))
+   {
+      close(fd);
+      return false;
+   }
+
+   /* A private mapping: the pages are shared with the page
+    * cache unless a string gets modified in place */
+   data_size = (size_t)st.st_size;
+   data      = mmap(NULL, data_size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE, fd, 0);
+   close(fd);
+
+   if (data == MAP_FAILED)
+      return false;
+
+   hdr = (const playlist_cache_header_t*)data;
+
+   if (!playlist_cache_is_valid(hdr, data_size, stamp))
+      goto error;
+
+   cache_entries = (const playlist_cache_entry_t*)(hdr + 1);
+   roms          = (const uint32_t*)(cache_entries + hdr->entry_count);
+   pool          = (char*)(roms + hdr->rom_count);
+   entry_count   = MIN(hdr->entry_count, playlist->config.capacity);
+
+   if (!(block = (playlist_string_block_t*)malloc(sizeof(*block))))
+      goto error;
+
+   if (entry_count && !RBUF_TRYFIT(playlist->entries, entry_count))
+   {
+      free(block);
+      goto error;
+   }
+
+   /* The mapping becomes a (full) block of the string pool */
+   block->next       = playlist->strings;
+   block->data       = (char*)data;
+   block->size       = data_size;
+   block->used       = data_size;
+   block->mapped     = true;
+   playlist->strings = block;
+
+   attr.i            = 0;
+
+   for (i = 0; i < entry_count; i++)
+   {
+      const playlist_cache_entry_t *cache_entry = &cache_entries[i];
+      struct playlist_entry *entry              = &playlist->entries[i];
+
+      memset(entry, 0, sizeof(*entry));
+
+      entry->path               = playlist_cache_string(pool, cache_entry->path);
+      entry->label              = playlist_cache_string(pool, cache_entry->label);
+      entry->core_path          = playlist_cache_string(pool, cache_entry->core_path);
+      entry->core_name          = playlist_cache_string(pool, cache_entry->core_name);
+      entry->db_name            = playlist_cache_string(pool, cache_entry->db_name);
+      entry->crc32              = playlist_cache_string(pool, cache_entry->crc32);
+      entry->subsystem_ident    = playlist_cache_string(pool, cache_entry->subsystem_ident);
+      entry->subsystem_name     = playlist_cache_string(pool, cache_entry->subsystem_name);
+      entry->entry_slot         = cache_entry->entry_slot;
+      entry->runtime_hours      = cache_entry->runtime_hours;
+      entry->runtime_minutes    = cache_entry->runtime_minutes;
+      entry->runtime_seconds    = cache_entry->runtime_seconds;
+      entry->last_played_year   = cache_entry->last_played_year;
+      entry->last_played_month  = cache_entry->last_played_month;
+      entry->last_played_day    = cache_entry->last_played_day;
+      entry->last_played_hour   = cache_entry->last_played_hour;
+      entry->last_played_minute = cache_entry->last_played_minute;
+      entry->last_played_second = cache_entry->last_played_second;
+
+      if (     cache_entry->rom_count
+            && (entry->subsystem_roms = string_list_new()))
+         for (j = 0; j < cache_entry->rom_count; j++)
+            string_list_append(entry->subsystem_roms,
+                  pool + roms[cache_entry->rom_first + j], attr);
+   }
+
+   RBUF_RESIZE(playlist->entries, entry_count);
+
+   if (hdr->entry_count > entry_count)
+   {
+      /* As when parsing the .lpl file */
+      RARCH_WARN("[Playlist] JSON file contains more entries than current playlist capacity. Excess entries will be discarded.\n");
+      playlist->flags |= CNT_PLAYLIST_FLG_MOD;
+   }
+
+   playlist->default_core_path          = playlist_cache_strdup(pool,
+         hdr->default_core_path);
+   playlist->default_core_name          = playlist_cache_strdup(pool,
+         hdr->default_core_name);
+   playlist->base_content_directory     = playlist_cache_strdup(pool,
+         hdr->base_content_directory);
+   playlist->scan_record.content_dir    = playlist_cache_strdup(pool,
+         hdr->scan_content_dir);
+   playlist->scan_record.file_exts      = playlist_cache_strdup(pool,
+         hdr->scan_file_exts);
+   playlist->scan_record.dat_file_path  = playlist_cache_strdup(pool,
+         hdr->scan_dat_file_path);
+
+   playlist->scan_record.search_recursively =
+      (hdr->flags & PLAYLIST_CACHE_FLG_SEARCH_RECURSIVELY) != 0;
+   playlist->scan_record.search_archives    =
+      (hdr->flags & PLAYLIST_CACHE_FLG_SEARCH_ARCHIVES)    != 0;
+   playlist->scan_record.filter_dat_content =
+      (hdr->flags & PLAYLIST_CACHE_FLG_FILTER_DAT_CONTENT) != 0;
+   playlist->scan_record.overwrite_playlist =
+      (hdr->flags & PLAYLIST_CACHE_FLG_OVERWRITE_PLAYLIST) != 0;
+
+   playlist->label_display_mode   = (enum playlist_label_display_mode)
+      hdr->label_display_mode;
+   playlist->right_thumbnail_mode = (enum playlist_thumbnail_mode)
+      hdr->right_thumbnail_mode;
+   playlist->left_thumbnail_mode  = (enum playlist_thumbnail_mode)
+      hdr->left_thumbnail_mode;
+   playlist->thumbnail_match_mode = (enum playlist_thumbnail_match_mode)
+      hdr->thumbnail_match_mode;
+   playlist->sort_mode            = (enum playlist_sort_mode)
+      hdr->sort_mode;
+
+   if (hdr->flags & PLAYLIST_CACHE_FLG_COMPRESSED)
+      playlist->flags |=  CNT_PLAYLIST_FLG_COMPRESSED;
+   else
+      playlist->flags &= ~CNT_PLAYLIST_FLG_COMPRESSED;
+   playlist->flags    &= ~CNT_PLAYLIST_FLG_OLD_FMT;
+
+   return true;
+
+error:
+   munmap(data, data_size);
+   return false;
+}
+#endif
+
 void playlist_write_runtime_file(playlist_t *playlist)
 {
    size_t i, _len;
@@ -1706,6 +2692,9 @@ void playlist_write_file(playlist_t *playlist)
    size_t i, _len;
    intfstream_t *file = NULL;
    bool compressed    = false;
+#ifdef HAVE_MMAP
+   bool written       = false;
+#endif
 
    /* Playlist will be written if any of the
     * following are true:
@@ -2096,6 +3085,10 @@ void playlist_write_file(playlist_t *playlist)
       {
          RARCH_ERR("[Playlist] Failed to write to file: \"%s\".\n", playlist->config.path);
       }
+#ifdef HAVE_MMAP
+      else
+         written = true;
+#endif
 
       playlist->flags  &= ~(CNT_PLAYLIST_FLG_OLD_FMT);
    }
@@ -2111,6 +3104,14 @@ void playlist_write_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+#ifdef HAVE_MMAP
+   if (written)
+   {
+      playlist_cache_header_t stamp;
+      if (playlist_cache_stat_lpl(playlist->config.path, &stamp))
+         playlist_cache_write(playlist, &stamp, true);
+   }
+#endif
 }
 
 /**
@@ -2157,12 +3158,15 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   playlist_strings_free(playlist);
+   playlist_index_free(playlist);
+
    free(playlist);
 }
 
@@ -2183,9 +3187,11 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_strings_free(playlist);
+   playlist_index_free(playlist);
 }
 
 /**
@@ -2335,9 +3341,13 @@ static bool JSONStringHandler(void *context, const char *pValue, size_t len)
                && len
                && !string_is_empty(pValue))
          {
-            if (*pCtx->current_string_val)
-                free(*pCtx->current_string_val);
-             *pCtx->current_string_val = strdup(pValue);
+            playlist_string_free(pCtx->playlist, *pCtx->current_string_val);
+            if (!(*pCtx->current_string_val = playlist_string_dup(
+                  pCtx->playlist, pValue, len)))
+            {
+               pCtx->flags |= JSON_CTX_FLG_OOM;
+               return false;
+            }
          }
       }
    }
@@ -2579,16 +3589,28 @@ static size_t playlist_get_old_format_metadata_value(
 static bool playlist_read_file(playlist_t *playlist)
 {
    int test_char;
+   int64_t file_size;
+   intfstream_t *file;
    bool res             = true;
+#ifdef HAVE_MMAP
+   playlist_cache_header_t stamp;
+   bool parsed          = false;
+   bool stamped         = playlist_cache_stat_lpl(
+         playlist->config.path, &stamp);
+
+   if (stamped && playlist_cache_read(playlist, &stamp))
+      return true;
+#endif
+
 #if defined(HAVE_ZLIB)
-      /* Always use RZIP interface when reading playlists
-       * > this will automatically handle uncompressed
-       *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   /* Always use RZIP interface when reading playlists
+    * > this will automatically handle uncompressed
+    *   data */
+   file                 = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file                 = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -2604,6 +3626,12 @@ static bool playlist_read_file(playlist_t *playlist)
    else
       playlist->flags &= ~CNT_PLAYLIST_FLG_COMPRESSED;
 
+   /* Entry strings take up a little over half of a
+    * typical playlist file, so start the string pool
+    * at half the (uncompressed) file size */
+   if ((file_size = intfstream_get_size(file)) > 0)
+      playlist_strings_reserve(playlist, (size_t)(file_size / 2) + 1);
+
    /* Detect format of playlist
     * > Read file until we find the first printable
     *   non-whitespace ASCII character */
@@ -2668,6 +3696,10 @@ static bool playlist_read_file(playlist_t *playlist)
                   (*rjson_get_error(parser) ? rjson_get_error(parser) : "format error"));
          }
       }
+#ifdef HAVE_MMAP
+      else
+         parsed = true;
+#endif
       rjson_free(parser);
    }
    else
@@ -2720,27 +3752,33 @@ static bool playlist_read_file(playlist_t *playlist)
 
             /* path */
             if (!string_is_empty(line_buf[0]))
-               entry->path      = strdup(line_buf[0]);
+               entry->path      = playlist_string_dup(playlist,
+                     line_buf[0], strlen(line_buf[0]));
 
             /* label */
             if (!string_is_empty(line_buf[1]))
-               entry->label     = strdup(line_buf[1]);
+               entry->label     = playlist_string_dup(playlist,
+                     line_buf[1], strlen(line_buf[1]));
 
             /* core_path */
             if (!string_is_empty(line_buf[2]))
-               entry->core_path = strdup(line_buf[2]);
+               entry->core_path = playlist_string_dup(playlist,
+                     line_buf[2], strlen(line_buf[2]));
 
             /* core_name */
             if (!string_is_empty(line_buf[3]))
-               entry->core_name = strdup(line_buf[3]);
+               entry->core_name = playlist_string_dup(playlist,
+                     line_buf[3], strlen(line_buf[3]));
 
             /* crc32 */
             if (!string_is_empty(line_buf[4]))
-               entry->crc32     = strdup(line_buf[4]);
+               entry->crc32     = playlist_string_dup(playlist,
+                     line_buf[4], strlen(line_buf[4]));
 
             /* db_name */
             if (!string_is_empty(line_buf[5]))
-               entry->db_name   = strdup(line_buf[5]);
+               entry->db_name   = playlist_string_dup(playlist,
+                     line_buf[5], strlen(line_buf[5]));
          }
          /* If fewer than 'PLAYLIST_ENTRIES' lines were
           * read, then this is metadata */
@@ -2864,6 +3902,14 @@ static bool playlist_read_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+#ifdef HAVE_MMAP
+   /* Cache what was parsed, unless entries had
+    * to be dropped to fit the playlist capacity */
+   if (     parsed
+         && stamped
+         && !(playlist->flags & CNT_PLAYLIST_FLG_MOD))
+      playlist_cache_write(playlist, &stamp, false);
+#endif
    return res;
 }
 
@@ -2924,6 +3970,10 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path              = NULL;
    playlist->base_content_directory         = NULL;
    playlist->entries                        = NULL;
+   playlist->strings                        = NULL;
+   playlist->real_path_index                = NULL;
+   playlist->archive_path_index             = NULL;
+   playlist->index_head                     = 0;
    playlist->label_display_mode             = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode           = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode            = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2933,6 +3983,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->scan_record.search_recursively = false;
    playlist->scan_record.search_archives    = false;
    playlist->scan_record.filter_dat_content = false;
+   playlist->scan_record.overwrite_playlist = false;
    playlist->scan_record.content_dir        = NULL;
    playlist->scan_record.file_exts          = NULL;
    playlist->scan_record.dat_file_path      = NULL;
@@ -2971,7 +4022,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
                   playlist->config.base_content_directory,
                   sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_string_free(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
             /* Fix subsystem roms paths*/
@@ -3146,6 +4197,16 @@ void playlist_qsort(playlist_t *playlist)
    qsort(playlist->entries, RBUF_LEN(playlist->entries),
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+
+   /* Entries keep their path IDs and hash chains,
+    * only their positions need updating */
+   if (playlist->flags & CNT_PLAYLIST_FLG_INDEXED)
+   {
+      size_t i, _len;
+      playlist->index_head = 0;
+      for (i = 0, _len = RBUF_LEN(playlist->entries); i < _len; i++)
+         playlist->entries[i].path_id->index_slot = i;
+   }
 }
 
 void command_playlist_push_write(
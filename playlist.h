@@ -104,10 +104,17 @@ typedef struct content_playlist playlist_t;
 
 /* Holds all parameters required to uniquely
  * identify a playlist content path */
-typedef struct
+typedef struct playlist_path_id
 {
    char *real_path;
    char *archive_path;
+   /* Playlist path hash index bookkeeping:
+    * entries sharing a hash are chained, and
+    * index_slot locates the entry relative to
+    * the playlist's index head */
+   struct playlist_path_id *real_path_next;
+   struct playlist_path_id *archive_path_next;
+   size_t index_slot;
    uint32_t real_path_hash;
    uint32_t archive_path_hash;
    bool is_archive;
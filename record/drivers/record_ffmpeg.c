@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <compat/msvc.h>
 #include <compat/strl.h>
@@ -25,6 +26,7 @@
 #include <boolean.h>
 #include <queues/fifo_queue.h>
 #include <rthreads/rthreads.h>
+#include <features/features_cpu.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <file/config_file.h>
@@ -89,8 +91,6 @@ struct ff_video_info
    AVCodecContext *codec;
    const AVCodec *encoder;
 
-   AVFrame *conv_frame;
-   uint8_t *conv_frame_buf;
    int64_t frame_cnt;
 
    uint8_t *outbuf;
@@ -160,6 +160,16 @@ struct ff_muxer_info
    AVStream *vstream;
 };
 
+enum ff_frame_queue_policy
+{
+   /* Wait for the encoder to free a slot. */
+   FF_FRAME_QUEUE_BLOCK = 0,
+   /* Throw away the oldest frame still queued. */
+   FF_FRAME_QUEUE_DROP_OLDEST,
+   /* Throw away the frame being pushed. */
+   FF_FRAME_QUEUE_DROP_NEWEST
+};
+
 struct ff_config_param
 {
    config_file_t *conf;
@@ -169,6 +179,8 @@ struct ff_config_param
    enum AVPixelFormat out_pix_fmt;
    unsigned threads;
    unsigned frame_drop_ratio;
+   unsigned frame_queue_size;
+   enum ff_frame_queue_policy frame_queue_policy;
    unsigned sample_rate;
    float scale_factor;
 
@@ -185,6 +197,52 @@ struct ff_config_param
    AVDictionary *audio_opts;
 };
 
+/* A video frame on its way to the encoder. The packed input
+ * frame and its converted counterpart live in the same slot. */
+struct ff_frame_slot
+{
+   struct record_video_data attr;
+   uint8_t *buf;
+   AVFrame *frame;
+   uint8_t *frame_buf;
+   int64_t pts;
+   retro_time_t pushed_time;
+};
+
+/* FIFO of slot indices. */
+struct ff_slot_queue
+{
+   unsigned *idx;
+   unsigned head;
+   unsigned count;
+};
+
+/* Preallocated frame slots, passed along from the producer to the
+ * scaler thread to the encoder thread by index. The indices only
+ * move under ffmpeg_t::lock; frames are copied, converted and
+ * encoded with no lock held. */
+struct ff_frame_ring
+{
+   struct ff_frame_slot *slots;
+   /* Last slot the scaler converted, for duplicate frames. */
+   struct ff_frame_slot *last;
+   struct ff_slot_queue free_q;
+   struct ff_slot_queue raw_q;
+   struct ff_slot_queue conv_q;
+   unsigned size;
+
+   /* Written by the producer under the lock. */
+   uint64_t pushed;
+   uint64_t dropped;
+   uint64_t blocked;
+   retro_time_t blocked_time;
+
+   /* Written by the encoder. */
+   uint64_t encoded;
+   retro_time_t lag_total;
+   retro_time_t lag_max;
+};
+
 typedef struct ffmpeg
 {
    struct ff_video_info video;
@@ -196,16 +254,20 @@ typedef struct ffmpeg
 
    AVPacket *pkt;
 
+   struct ff_frame_ring ring;
+
+   /* Wakes the encoder thread. */
    scond_t *cond;
-   slock_t *cond_lock;
+   /* Wakes the scaler thread. */
+   scond_t *scale_cond;
+   /* Wakes a producer waiting for a free slot or audio space. */
+   scond_t *space_cond;
    slock_t *lock;
    fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
-   fifo_buffer_t *attr_fifo;
    sthread_t *thread;
+   sthread_t *scale_thread;
 
-   volatile bool alive;
-   volatile bool can_sleep;
+   bool alive;
 } ffmpeg_t;
 
 AVFormatContext *ctx;
@@ -395,7 +457,6 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle, const char *audio_resampler)
 
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
-   size_t size;
    struct ff_config_param *params  = &handle->config;
    struct ff_video_info *video     = &handle->video;
    struct record_params *param     = &handle->params;
@@ -517,19 +578,6 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    video->frame_drop_ratio = params->frame_drop_ratio;
 
-   size = av_image_get_buffer_size(video->pix_fmt, param->out_width,
-         param->out_height, 1);
-   video->conv_frame_buf   = (uint8_t*)av_malloc(size);
-   video->conv_frame       = av_frame_alloc();
-
-   AVFrame* frame = video->conv_frame;
-   av_image_fill_arrays(frame->data, frame->linesize, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height, 1);
-
-   video->conv_frame->width  = param->out_width;
-   video->conv_frame->height = param->out_height;
-   video->conv_frame->format = video->pix_fmt;
-
    return true;
 }
 
@@ -750,6 +798,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
 {
    struct config_file_entry entry;
    char pix_fmt[64]         = {0};
+   char queue_policy[64]    = {0};
 
    params->out_pix_fmt      = AV_PIX_FMT_NONE;
    params->scale_factor     = 1;
@@ -781,6 +830,26 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
             &params->frame_drop_ratio) || !params->frame_drop_ratio)
       params->frame_drop_ratio = 1;
 
+   config_get_uint(params->conf, "frame_queue_size",
+         &params->frame_queue_size);
+
+   if (config_get_array(params->conf, "frame_queue_policy", queue_policy,
+            sizeof(queue_policy)))
+   {
+      if (string_is_equal(queue_policy, "block"))
+         params->frame_queue_policy = FF_FRAME_QUEUE_BLOCK;
+      else if (string_is_equal(queue_policy, "drop_oldest"))
+         params->frame_queue_policy = FF_FRAME_QUEUE_DROP_OLDEST;
+      else if (string_is_equal(queue_policy, "drop_newest"))
+         params->frame_queue_policy = FF_FRAME_QUEUE_DROP_NEWEST;
+      else
+      {
+         RARCH_ERR("[FFmpeg] Unknown frame_queue_policy \"%s\".\n",
+               queue_policy);
+         return false;
+      }
+   }
+
    if (!config_get_bool(params->conf, "audio_enable", &params->audio_enable))
       params->audio_enable = true;
 
@@ -889,44 +958,175 @@ static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
 
 #define MAX_FRAMES 32
 
+/* Default and smallest number of video frame slots. With three,
+ * one slot can be converted and one encoded while another waits,
+ * so dropping the oldest frame always frees one up. */
+#define FRAME_SLOTS_DEFAULT 8
+#define FRAME_SLOTS_MIN     3
+/* Most slots, and most memory all of them may take up, that
+ * frame_queue_size can ask for. */
+#define FRAME_SLOTS_MAX     64
+#define FRAME_SLOTS_MAX_MEM ((size_t)512 << 20)
+
 static void ffmpeg_thread(void *data);
+static void ffmpeg_scale_thread(void *data);
+
+static bool ffmpeg_slot_queue_init(struct ff_slot_queue *q, unsigned size)
+{
+   q->head  = 0;
+   q->count = 0;
+   return (q->idx = (unsigned*)calloc(size, sizeof(*q->idx))) != NULL;
+}
+
+static void ffmpeg_slot_queue_push(struct ff_frame_ring *ring,
+      struct ff_slot_queue *q, unsigned slot)
+{
+   q->idx[(q->head + q->count++) % ring->size] = slot;
+}
+
+static unsigned ffmpeg_slot_queue_pop(struct ff_frame_ring *ring,
+      struct ff_slot_queue *q)
+{
+   unsigned slot = q->idx[q->head];
+   q->head       = (q->head + 1) % ring->size;
+   q->count--;
+   return slot;
+}
+
+static bool ffmpeg_init_frame_ring(ffmpeg_t *handle)
+{
+   unsigned i;
+   struct ff_frame_ring *ring = &handle->ring;
+   /* libswscale may read a little past the last input row. */
+   size_t buf_size            = (handle->params.fb_height + 1) *
+      handle->params.fb_width * handle->video.pix_size;
+   size_t frame_size          = av_image_get_buffer_size(
+         handle->video.pix_fmt, handle->params.out_width,
+         handle->params.out_height, 1);
+
+   ring->size = handle->config.frame_queue_size;
+   if (!ring->size)
+      ring->size = FRAME_SLOTS_DEFAULT;
+   else if (ring->size < FRAME_SLOTS_MIN)
+      ring->size = FRAME_SLOTS_MIN;
+   else if (ring->size > FRAME_SLOTS_MAX)
+      ring->size = FRAME_SLOTS_MAX;
+
+   if (     ring->size > FRAME_SLOTS_MIN
+         && ring->size * (buf_size + frame_size) > FRAME_SLOTS_MAX_MEM)
+   {
+      ring->size = (unsigned)(FRAME_SLOTS_MAX_MEM / (buf_size + frame_size));
+      if (ring->size < FRAME_SLOTS_MIN)
+         ring->size = FRAME_SLOTS_MIN;
+   }
+
+   if (     handle->config.frame_queue_size
+         && handle->config.frame_queue_size != ring->size)
+      RARCH_WARN("[FFmpeg] frame_queue_size %u out of range, using %u.\n",
+            handle->config.frame_queue_size, ring->size);
+
+   if (!(ring->slots = (struct ff_frame_slot*)calloc(ring->size,
+               sizeof(*ring->slots))))
+      return false;
+
+   if (     !ffmpeg_slot_queue_init(&ring->free_q, ring->size)
+         || !ffmpeg_slot_queue_init(&ring->raw_q,  ring->size)
+         || !ffmpeg_slot_queue_init(&ring->conv_q, ring->size))
+      return false;
+
+   for (i = 0; i < ring->size; i++)
+   {
+      struct ff_frame_slot *slot = &ring->slots[i];
+
+      if (     !(slot->buf       = (uint8_t*)av_malloc(buf_size))
+            || !(slot->frame_buf = (uint8_t*)av_malloc(frame_size))
+            || !(slot->frame     = av_frame_alloc()))
+         return false;
+
+      av_image_fill_arrays(slot->frame->data, slot->frame->linesize,
+            slot->frame_buf, handle->video.pix_fmt,
+            handle->params.out_width, handle->params.out_height, 1);
+
+      slot->frame->width  = handle->params.out_width;
+      slot->frame->height = handle->params.out_height;
+      slot->frame->format = handle->video.pix_fmt;
+
+      ffmpeg_slot_queue_push(ring, &ring->free_q, i);
+   }
+
+   return true;
+}
+
+static void ffmpeg_deinit_frame_ring(ffmpeg_t *handle)
+{
+   unsigned i;
+   struct ff_frame_ring *ring = &handle->ring;
+
+   if (ring->slots)
+   {
+      for (i = 0; i < ring->size; i++)
+      {
+         av_frame_free(&ring->slots[i].frame);
+         av_free(ring->slots[i].frame_buf);
+         av_free(ring->slots[i].buf);
+      }
+      free(ring->slots);
+   }
+
+   free(ring->free_q.idx);
+   free(ring->raw_q.idx);
+   free(ring->conv_q.idx);
+
+   memset(ring, 0, sizeof(*ring));
+}
 
 static bool init_thread(ffmpeg_t *handle)
 {
+   if (!ffmpeg_init_frame_ring(handle))
+   {
+      RARCH_ERR("[FFmpeg] Failed to allocate %u video frame slots.\n",
+            handle->ring.size);
+      return false;
+   }
+
    handle->lock       = slock_new();
-   handle->cond_lock  = slock_new();
    handle->cond       = scond_new();
+   handle->scale_cond = scond_new();
+   handle->space_cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo  = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-         handle->video.pix_size * MAX_FRAMES);
 
-   handle->alive     = true;
-   handle->can_sleep = true;
-   handle->thread    = sthread_create(ffmpeg_thread, handle);
+   handle->alive        = true;
+   handle->thread       = sthread_create(ffmpeg_thread, handle);
+   handle->scale_thread = sthread_create(ffmpeg_scale_thread, handle);
 
    return true;
 }
 
 static void deinit_thread(ffmpeg_t *handle)
 {
-   if (!handle->thread)
+   if (!handle->thread && !handle->scale_thread)
       return;
 
-   slock_lock(handle->cond_lock);
+   slock_lock(handle->lock);
    handle->alive = false;
-   handle->can_sleep = false;
-   slock_unlock(handle->cond_lock);
+   slock_unlock(handle->lock);
 
    scond_signal(handle->cond);
-   sthread_join(handle->thread);
+   scond_signal(handle->scale_cond);
+   scond_broadcast(handle->space_cond);
+   if (handle->thread)
+      sthread_join(handle->thread);
+   if (handle->scale_thread)
+      sthread_join(handle->scale_thread);
 
    slock_free(handle->lock);
-   slock_free(handle->cond_lock);
    scond_free(handle->cond);
+   scond_free(handle->scale_cond);
+   scond_free(handle->space_cond);
 
-   handle->thread = NULL;
+   handle->thread       = NULL;
+   handle->scale_thread = NULL;
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
@@ -937,17 +1137,7 @@ static void deinit_thread_buf(ffmpeg_t *handle)
       handle->audio_fifo = NULL;
    }
 
-   if (handle->attr_fifo)
-   {
-      fifo_free(handle->attr_fifo);
-      handle->attr_fifo = NULL;
-   }
-
-   if (handle->video_fifo)
-   {
-      fifo_free(handle->video_fifo);
-      handle->video_fifo = NULL;
-   }
+   ffmpeg_deinit_frame_ring(handle);
 }
 
 static void ffmpeg_free(void *data)
@@ -981,9 +1171,6 @@ static void ffmpeg_free(void *data)
       av_free(handle->video.codec);
    }
 
-   av_frame_free(&handle->video.conv_frame);
-   av_free(handle->video.conv_frame_buf);
-
    scaler_ctx_gen_reset(&handle->video.scaler);
 
    if (handle->video.sws)
@@ -1081,11 +1268,14 @@ error:
 static bool ffmpeg_push_video(void *data,
       const struct record_video_data *vid)
 {
-   unsigned y;
-   struct record_video_data attr_data;
-   bool drop_frame  = false;
-   ffmpeg_t *handle = (ffmpeg_t*)data;
-   int       offset = 0;
+   unsigned y, idx;
+   int64_t pts;
+   struct ff_frame_slot *slot;
+   struct ff_frame_ring *ring;
+   retro_time_t wait_start = 0;
+   bool drop_frame         = false;
+   ffmpeg_t *handle        = (ffmpeg_t*)data;
+   int       offset        = 0;
 
    if (!handle || !vid)
       return false;
@@ -1098,53 +1288,81 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
+   /* Frames thrown away below still take up their timestamp,
+    * so that the video stays in sync with the audio. */
+   ring = &handle->ring;
+   pts  = handle->video.frame_cnt++;
+
+   slock_lock(handle->lock);
    for (;;)
    {
-      unsigned avail;
-
-      slock_lock(handle->lock);
-      avail = (unsigned)FIFO_WRITE_AVAIL(handle->attr_fifo);
-      slock_unlock(handle->lock);
-
       if (!handle->alive)
+      {
+         slock_unlock(handle->lock);
          return false;
+      }
 
-      if (avail >= sizeof(*vid))
+      if (ring->free_q.count)
+      {
+         idx = ffmpeg_slot_queue_pop(ring, &ring->free_q);
          break;
+      }
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
+      if (handle->config.frame_queue_policy == FF_FRAME_QUEUE_DROP_NEWEST)
       {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
+         ring->dropped++;
+         slock_unlock(handle->lock);
+         return true;
       }
-      else
-         scond_signal(handle->cond);
 
-      slock_unlock(handle->cond_lock);
+      /* Converted frames are older than the ones waiting for the
+       * scaler. Slots being worked on are in neither queue. */
+      if (     handle->config.frame_queue_policy == FF_FRAME_QUEUE_DROP_OLDEST
+            && (ring->conv_q.count || ring->raw_q.count))
+      {
+         idx = ffmpeg_slot_queue_pop(ring,
+               ring->conv_q.count ? &ring->conv_q : &ring->raw_q);
+         ring->dropped++;
+         break;
+      }
+
+      if (!wait_start)
+      {
+         wait_start = cpu_features_get_time_usec();
+         ring->blocked++;
+      }
+      scond_wait(handle->space_cond, handle->lock);
    }
 
-   slock_lock(handle->lock);
+   if (wait_start)
+      ring->blocked_time += cpu_features_get_time_usec() - wait_start;
+   ring->pushed++;
+   slock_unlock(handle->lock);
 
-   /* Tightly pack our frame to conserve memory.
+   /* The slot is ours until it is queued, so the copy
+    * needs no lock. Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
     */
-   attr_data = *vid;
+   slot       = &ring->slots[idx];
+   slot->attr = *vid;
 
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (slot->attr.is_dupe)
+      slot->attr.width = slot->attr.height = slot->attr.pitch = 0;
    else
-      attr_data.pitch = (int)(attr_data.width * handle->video.pix_size);
+      slot->attr.pitch = (int)(slot->attr.width * handle->video.pix_size);
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   for (y = 0; y < slot->attr.height; y++, offset += vid->pitch)
+      memcpy(slot->buf + y * slot->attr.pitch,
+            (const uint8_t*)vid->data + offset, slot->attr.pitch);
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
-      fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+   slot->attr.data   = slot->buf;
+   slot->pts         = pts;
+   slot->pushed_time = cpu_features_get_time_usec();
 
+   slock_lock(handle->lock);
+   ffmpeg_slot_queue_push(ring, &ring->raw_q, idx);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
+   scond_signal(handle->scale_cond);
 
    return true;
 }
@@ -1152,6 +1370,7 @@ static bool ffmpeg_push_video(void *data,
 static bool ffmpeg_push_audio(void *data,
       const struct record_audio_data *audio_data)
 {
+   size_t size;
    ffmpeg_t *handle = (ffmpeg_t*)data;
 
    if (!handle || !audio_data)
@@ -1160,37 +1379,19 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-
-      slock_lock(handle->lock);
-      avail = (unsigned)FIFO_WRITE_AVAIL(handle->audio_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
-
-      if (avail >= audio_data->frames * handle->params.channels
-            * sizeof(int16_t))
-         break;
+   size = audio_data->frames * handle->params.channels * sizeof(int16_t);
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
+   slock_lock(handle->lock);
+   while (handle->alive && FIFO_WRITE_AVAIL(handle->audio_fifo) < size)
+      scond_wait(handle->space_cond, handle->lock);
 
-      slock_unlock(handle->cond_lock);
+   if (!handle->alive)
+   {
+      slock_unlock(handle->lock);
+      return false;
    }
 
-   slock_lock(handle->lock);
-   fifo_write(handle->audio_fifo, audio_data->data,
-         audio_data->frames * handle->params.channels * sizeof(int16_t));
+   fifo_write(handle->audio_fifo, audio_data->data, size);
    slock_unlock(handle->lock);
    scond_signal(handle->cond);
 
@@ -1250,7 +1451,7 @@ static bool encode_video(ffmpeg_t *handle, AVFrame *frame)
    return true;
 }
 
-static void ffmpeg_scale_input(ffmpeg_t *handle,
+static void ffmpeg_scale_input(ffmpeg_t *handle, AVFrame *frame,
       const struct record_video_data *vid)
 {
    /* Attempt to preserve more information if we scale down. */
@@ -1268,35 +1469,54 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
             shrunk ? SWS_BILINEAR : SWS_POINT, NULL, NULL, NULL);
 
       sws_scale(handle->video.sws, (const uint8_t* const*)&vid->data,
-            &linesize, 0, vid->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+            &linesize, 0, vid->height, frame->data, frame->linesize);
    }
    else
       video_frame_record_scale(
             &handle->video.scaler,
-            handle->video.conv_frame->data[0],
+            frame->data[0],
             vid->data,
             handle->params.out_width,
             handle->params.out_height,
-            handle->video.conv_frame->linesize[0],
+            frame->linesize[0],
             vid->width,
             vid->height,
             vid->pitch,
             shrunk);
 }
 
-static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+/* Only ever called by one thread at a time: the scaler thread,
+ * or ffmpeg_flush_buffers() once it is gone. */
+static void ffmpeg_convert_slot(ffmpeg_t *handle, struct ff_frame_slot *slot)
+{
+   struct ff_frame_ring *ring = &handle->ring;
+
+   if (!slot->attr.is_dupe)
+      ffmpeg_scale_input(handle, slot->frame, &slot->attr);
+   /* Nothing but the scaler writes converted frames, so the
+    * last one still holds the image to repeat. */
+   else if (ring->last && ring->last != slot)
+      av_frame_copy(slot->frame, ring->last->frame);
+
+   ring->last = slot;
+}
+
+static bool ffmpeg_encode_slot(ffmpeg_t *handle, struct ff_frame_slot *slot)
 {
-   if (!vid->is_dupe)
-      ffmpeg_scale_input(handle, vid);
+   retro_time_t lag;
+   struct ff_frame_ring *ring = &handle->ring;
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+   slot->frame->pts = slot->pts;
 
-   if (!encode_video(handle, handle->video.conv_frame))
+   if (!encode_video(handle, slot->frame))
       return false;
 
-   handle->video.frame_cnt++;
+   lag              = cpu_features_get_time_usec() - slot->pushed_time;
+   ring->lag_total += lag;
+   if (lag > ring->lag_max)
+      ring->lag_max = lag;
+   ring->encoded++;
+
    return true;
 }
 
@@ -1583,11 +1803,10 @@ static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
 
 static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
-   void *audio_buf       = NULL;
-   bool did_work         = false;
-   void *video_buf       = av_malloc(2 * handle->params.fb_width *
-         handle->params.fb_height * handle->video.pix_size);
-   size_t audio_buf_size = handle->config.audio_enable ?
+   void *audio_buf            = NULL;
+   bool did_work              = false;
+   struct ff_frame_ring *ring = &handle->ring;
+   size_t audio_buf_size      = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
 
@@ -1598,8 +1817,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    do
    {
-      struct record_video_data attr_buf;
-
       did_work = false;
 
       if (handle->config.audio_enable)
@@ -1617,13 +1834,23 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (FIFO_READ_AVAIL(handle->attr_fifo) >= sizeof(attr_buf))
+      /* The threads are gone; converted frames go first,
+       * as they are older than the ones still to be converted. */
+      if (ring->conv_q.count || ring->raw_q.count)
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
+         struct ff_frame_slot *slot;
+
+         if (ring->conv_q.count)
+            slot = &ring->slots[ffmpeg_slot_queue_pop(ring, &ring->conv_q)];
+         else
+         {
+            slot = &ring->slots[ffmpeg_slot_queue_pop(ring, &ring->raw_q)];
+            ffmpeg_convert_slot(handle, slot);
+         }
+
+         ffmpeg_encode_slot(handle, slot);
+         ffmpeg_slot_queue_push(ring, &ring->free_q,
+               (unsigned)(slot - ring->slots));
 
          did_work = true;
       }
@@ -1636,12 +1863,12 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    encode_video(handle, NULL);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
 static bool ffmpeg_finalize(void *data)
 {
+   struct ff_frame_ring *ring;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return false;
@@ -1651,6 +1878,17 @@ static bool ffmpeg_finalize(void *data)
    /* Flush out data still in buffers (internal, and FFmpeg internal). */
    ffmpeg_flush_buffers(handle);
 
+   ring = &handle->ring;
+   RARCH_LOG("[FFmpeg] Video: %llu frames encoded, %llu dropped, "
+         "blocked %llu times for %.1f ms, encoder lag %.1f ms avg, "
+         "%.1f ms max.\n",
+         (unsigned long long)ring->encoded,
+         (unsigned long long)ring->dropped,
+         (unsigned long long)ring->blocked,
+         ring->blocked_time / 1000.0,
+         ring->encoded ? ring->lag_total / 1000.0 / ring->encoded : 0.0,
+         ring->lag_max / 1000.0);
+
    deinit_thread_buf(handle);
 
    /* Write final data. */
@@ -1661,69 +1899,90 @@ static bool ffmpeg_finalize(void *data)
    return true;
 }
 
+static void ffmpeg_scale_thread(void *data)
+{
+   ffmpeg_t *ff               = (ffmpeg_t*)data;
+   struct ff_frame_ring *ring = &ff->ring;
+
+   for (;;)
+   {
+      unsigned idx;
+
+      slock_lock(ff->lock);
+      while (ff->alive && !ring->raw_q.count)
+         scond_wait(ff->scale_cond, ff->lock);
+
+      if (!ff->alive)
+      {
+         slock_unlock(ff->lock);
+         break;
+      }
+
+      idx = ffmpeg_slot_queue_pop(ring, &ring->raw_q);
+      slock_unlock(ff->lock);
+
+      ffmpeg_convert_slot(ff, &ring->slots[idx]);
+
+      slock_lock(ff->lock);
+      ffmpeg_slot_queue_push(ring, &ring->conv_q, idx);
+      slock_unlock(ff->lock);
+      scond_signal(ff->cond);
+   }
+}
+
 static void ffmpeg_thread(void *data)
 {
-   ffmpeg_t *ff          = (ffmpeg_t*)data;
-   /* For some reason, FFmpeg has a tendency to crash
-    * if we don't overallocate a bit. */
-   void *video_buf       = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-   size_t audio_buf_size = ff->config.audio_enable ?
+   ffmpeg_t *ff               = (ffmpeg_t*)data;
+   struct ff_frame_ring *ring = &ff->ring;
+   size_t audio_buf_size      = ff->config.audio_enable ?
       (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
-   void *audio_buf       = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
+   void *audio_buf            = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
 
-   while (ff->alive)
+   for (;;)
    {
-      struct record_video_data attr_buf;
-
+      unsigned idx     = 0;
       bool avail_video = false;
       bool avail_audio = false;
 
       slock_lock(ff->lock);
-      if (FIFO_READ_AVAIL(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
-
-      if (ff->config.audio_enable)
-         if (FIFO_READ_AVAIL(ff->audio_fifo) >= audio_buf_size)
-            avail_audio = true;
-      slock_unlock(ff->lock);
-
-      if (!avail_video && !avail_audio)
+      for (;;)
       {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
+         avail_video = ring->conv_q.count > 0;
+         avail_audio = audio_buf
+            && FIFO_READ_AVAIL(ff->audio_fifo) >= audio_buf_size;
+
+         if (!ff->alive || avail_video || avail_audio)
+            break;
 
-         slock_unlock(ff->cond_lock);
+         scond_wait(ff->cond, ff->lock);
       }
 
-      if (avail_video && video_buf)
+      if (!ff->alive)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
          slock_unlock(ff->lock);
-         scond_signal(ff->cond);
-
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
+         break;
       }
 
-      if (avail_audio && audio_buf)
+      if (avail_video)
+         idx = ffmpeg_slot_queue_pop(ring, &ring->conv_q);
+      if (avail_audio)
+         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+      slock_unlock(ff->lock);
+
+      if (avail_video)
       {
-         struct record_audio_data aud = {0};
+         ffmpeg_encode_slot(ff, &ring->slots[idx]);
 
          slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+         ffmpeg_slot_queue_push(ring, &ring->free_q, idx);
          slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+      }
+
+      scond_signal(ff->space_cond);
+
+      if (avail_audio)
+      {
+         struct record_audio_data aud = {0};
 
          aud.frames = ff->audio.codec->frame_size;
          aud.data   = audio_buf;
@@ -1732,7 +1991,6 @@ static void ffmpeg_thread(void *data)
       }
    }
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
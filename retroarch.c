@@ -136,6 +136,10 @@
 
 #include <audio/audio_resampler.h>
 
+#ifdef HAVE_ZLIB
+#include <streams/rzip_stream.h>
+#endif
+
 #include "audio/audio_driver.h"
 
 #ifdef HAVE_GFX_WIDGETS
@@ -3798,6 +3802,8 @@ bool command_event(enum event_command cmd, void *data)
 #ifdef HAVE_REWIND
          {
             bool rewind_enable        = settings->bools.rewind_enable;
+            bool rewind_threaded      = settings->bools.rewind_threaded;
+            bool rewind_compression   = settings->bools.rewind_compression;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
             bool core_type_is_dummy   = runloop_st->current_core_type == CORE_TYPE_DUMMY;
 
@@ -3821,7 +3827,8 @@ bool command_event(enum event_command cmd, void *data)
 #endif
                {
                   state_manager_event_init(&runloop_st->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size, rewind_threaded,
+                        rewind_compression);
                }
             }
          }
@@ -5826,6 +5833,34 @@ static void sdl_exit(void)
 }
 #endif
 
+static void retroarch_log_task_stats(void)
+{
+   static const char *class_names[TASK_CLASS_LAST] = {
+      "interactive",
+      "savestate",
+      "thumbnail",
+      "background"
+   };
+   unsigned i;
+
+   for (i = 0; i < TASK_CLASS_LAST; i++)
+   {
+      task_class_stats_t stats;
+
+      if (     !task_queue_get_class_stats((enum task_class)i, &stats)
+            || !stats.started)
+         continue;
+
+      RARCH_LOG("[Tasks] %-11s: %u completed, peak queue %u, "
+            "avg wait %.2f ms, avg run %.2f ms.\n",
+            class_names[i],
+            (unsigned)stats.completed,
+            stats.peak_queued,
+            stats.wait_time / (1000.0 * stats.started),
+            stats.run_time  / (1000.0 * stats.started));
+   }
+}
+
 /**
  * main_exit:
  *
@@ -5884,11 +5919,16 @@ void main_exit(void *args)
    runloop_msg_queue_deinit();
    driver_uninit(DRIVERS_CMD_ALL, (enum driver_lifetime_flags)0);
 
+   retroarch_log_task_stats();
    retro_main_log_file_deinit();
 
    retroarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+#ifdef HAVE_ZLIB
+   /* Only after the last save task is done with it */
+   rzipstream_deinit_threads();
+#endif
 
    ui_companion_driver_deinit();
    retroarch_config_deinit();
@@ -7891,6 +7931,9 @@ bool retroarch_main_init(int argc, char *argv[])
 
    retroarch_validate_cpu_features();
    retroarch_init_task_queue();
+#ifdef HAVE_ZLIB
+   rzipstream_init_threads();
+#endif
 
    {
       const char    *fullpath  = p_rarch->path_content;
@@ -8135,6 +8178,10 @@ void retroarch_init_task_queue(void)
 
    task_queue_deinit();
    task_queue_init(threaded_enable, runloop_task_msg_queue_push);
+
+   if (threaded_enable)
+      RARCH_LOG("[Tasks] Running tasks on %u worker threads.\n",
+            task_queue_get_worker_count());
 }
 
 bool retroarch_ctl(enum rarch_ctl_state state, void *data)
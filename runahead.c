@@ -17,6 +17,8 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -28,6 +30,7 @@
 #endif
 #endif
 
+#include <compat/intrinsics.h>
 #include <encodings/utf.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
@@ -44,19 +47,16 @@
 #include "runloop.h"
 #include "verbosity.h"
 
-static int16_t input_state_get_last(unsigned port,
+static int16_t input_list_get_state(my_list *list, unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
-   runloop_state_t      *runloop_st = runloop_state_get_ptr();
-
-   if (runloop_st->input_state_list)
+   if (list)
    {
       int i;
       /* find list item */
-      for (i = 0; i < runloop_st->input_state_list->size; i++)
+      for (i = 0; i < list->size; i++)
       {
-         input_list_element *element =
-            (input_list_element*)runloop_st->input_state_list->data[i];
+         input_list_element *element = (input_list_element*)list->data[i];
 
          if (     (element->port   == port)
                && (element->device == device)
@@ -72,6 +72,54 @@ static int16_t input_state_get_last(unsigned port,
    return 0;
 }
 
+static int16_t input_state_get_last(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   runloop_state_t      *runloop_st = runloop_state_get_ptr();
+   return input_list_get_state(runloop_st->input_state_list,
+         port, device, index, id);
+}
+
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+/* Second instance run on its own thread. While the main core runs
+ * the real frame, the secondary core runs the frame after the one
+ * just presented, assuming input does not change. */
+struct runahead_secondary_thread
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   my_list *input;          /* Input given to the secondary core */
+   const void *state;       /* State to load before running, or NULL */
+   void *frame[2];
+   size_t frame_size[2];
+   size_t state_size;
+   size_t pitch;
+   unsigned width;
+   unsigned height;
+   /* Core option values as of the last kick, answered to
+    * GET_VARIABLE from the thread */
+   struct runahead_secondary_option
+   {
+      char *key;
+      char *value;
+   } *options;
+   size_t options_count;
+   unsigned frames;         /* Frames to run for the current job */
+   uint8_t back;            /* Frame buffer the current job draws into */
+   bool capture;
+   bool frame_dupe;
+   bool variable_update;
+   bool options_valid;
+   bool speculative;        /* Current job runs the next frame */
+   bool busy;
+   bool quit;
+   bool ok;
+};
+
+static void runahead_secondary_thread_deinit(runloop_state_t *runloop_st);
+#endif
+
 static void free_retro_ctx_load_content_info(struct
       retro_ctx_load_content_info *dest)
 {
@@ -183,6 +231,9 @@ static void strcat_alloc(char **dst, const char *s)
 void runahead_secondary_core_destroy(void *data)
 {
    runloop_state_t *runloop_st      = (runloop_state_t*)data;
+#ifdef HAVE_THREADS
+   runahead_secondary_thread_deinit(runloop_st);
+#endif
    if (!runloop_st->secondary_lib_handle)
       return;
 
@@ -385,11 +436,173 @@ end:
    return NULL;
 }
 
+#ifdef HAVE_THREADS
+static retro_log_printf_t runahead_secondary_log_printf;
+static retro_perf_register_t runahead_secondary_perf_register;
+static retro_perf_log_t runahead_secondary_perf_log;
+
+static bool runahead_secondary_is_thread(runloop_state_t *runloop_st)
+{
+   struct runahead_secondary_thread *t = runloop_st->secondary_thread;
+   return t && t->thread && sthread_isself(t->thread);
+}
+
+/* The secondary core keeps the log and perf interfaces it got
+ * while loading. Messages and counter registrations from the
+ * run-ahead thread are dropped, the main core has the same ones. */
+static void runahead_secondary_log_cb(enum retro_log_level level,
+      const char *fmt, ...)
+{
+   va_list ap;
+   char msg[512];
+
+   if (     !runahead_secondary_log_printf
+         ||  runahead_secondary_is_thread(runloop_state_get_ptr()))
+      return;
+
+   va_start(ap, fmt);
+   vsnprintf(msg, sizeof(msg), fmt, ap);
+   va_end(ap);
+   runahead_secondary_log_printf(level, "%s", msg);
+}
+
+static void runahead_secondary_perf_register_cb(
+      struct retro_perf_counter *counter)
+{
+   if (!runahead_secondary_is_thread(runloop_state_get_ptr()))
+      runahead_secondary_perf_register(counter);
+}
+
+static void runahead_secondary_perf_log_cb(void)
+{
+   if (!runahead_secondary_is_thread(runloop_state_get_ptr()))
+      runahead_secondary_perf_log();
+}
+
+/**
+ * runahead_secondary_thread_environment:
+ *
+ * Answers environment calls the secondary core makes from the
+ * run-ahead thread. Only calls that read state are served, from
+ * what runahead_secondary_thread_kick() copied before the job
+ * started. Anything else would race with the main core, which
+ * runs at the same time, and is refused.
+ **/
+static bool runahead_secondary_thread_environment(
+      struct runahead_secondary_thread *t, unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         *(bool*)data       = t->variable_update;
+         t->variable_update = false;
+         return true;
+
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            size_t i;
+            struct retro_variable *var = (struct retro_variable*)data;
+
+            if (!var)
+               return true;
+
+            var->value = NULL;
+            for (i = 0; i < t->options_count; i++)
+            {
+               if (string_is_equal(t->options[i].key, var->key))
+               {
+                  var->value = t->options[i].value;
+                  break;
+               }
+            }
+         }
+         return true;
+
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+      case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+         if (data)
+            *(bool*)data = true;
+         return true;
+
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         if (data)
+         {
+            int result = RETRO_AV_ENABLE_HARD_DISABLE_AUDIO;
+            if (t->capture)
+               result |= RETRO_AV_ENABLE_VIDEO;
+            if (t->state)
+               result |= RETRO_AV_ENABLE_FAST_SAVESTATES;
+            *(enum retro_av_enable_flags*)data =
+               (enum retro_av_enable_flags)result;
+         }
+         return true;
+
+      case RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT:
+         if (data)
+            *(int*)data = t->state
+               ? RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_BINARY
+               : RETRO_SAVESTATE_CONTEXT_NORMAL;
+         return true;
+
+      default:
+         break;
+   }
+
+   return false;
+}
+#endif
+
 static bool runloop_environment_secondary_core_hook(
       unsigned cmd, void *data)
 {
+   bool result;
    runloop_state_t *runloop_st    = runloop_state_get_ptr();
-   bool result                    = runloop_environment_cb(cmd, data);
+#ifdef HAVE_THREADS
+   struct runahead_secondary_thread
+      *secondary_thread           = runloop_st->secondary_thread;
+
+   if (runahead_secondary_is_thread(runloop_st))
+      return runahead_secondary_thread_environment(
+            secondary_thread, cmd, data);
+
+   /* Answered here while the secondary core is driven from its
+    * own thread, so that it doesn't consume the main core's
+    * update */
+   if (secondary_thread && cmd == RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE)
+   {
+      bool *bool_p                        = (bool*)data;
+      *bool_p                             = secondary_thread->variable_update;
+      secondary_thread->variable_update   = false;
+      return true;
+   }
+#endif
+
+   result                         = runloop_environment_cb(cmd, data);
+
+#ifdef HAVE_THREADS
+   /* Hand out log and perf interfaces that are safe
+    * to call from the run-ahead thread */
+   if (result && data)
+   {
+      if (cmd == RETRO_ENVIRONMENT_GET_LOG_INTERFACE)
+      {
+         struct retro_log_callback *cb    = (struct retro_log_callback*)data;
+         runahead_secondary_log_printf    = cb->log;
+         cb->log                          = runahead_secondary_log_cb;
+      }
+      else if (cmd == RETRO_ENVIRONMENT_GET_PERF_INTERFACE)
+      {
+         struct retro_perf_callback *cb   = (struct retro_perf_callback*)data;
+         runahead_secondary_perf_register = cb->perf_register;
+         runahead_secondary_perf_log      = cb->perf_log;
+         cb->perf_register                = runahead_secondary_perf_register_cb;
+         cb->perf_log                     = runahead_secondary_perf_log_cb;
+      }
+   }
+
+   if (secondary_thread)
+      return result;
+#endif
 
    if (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE)
    {
@@ -600,6 +813,7 @@ void runahead_remember_controller_port_device(void *data,
    runloop_state_t *runloop_st   = (runloop_state_t*)data;
    if (port >= 0 && port < MAX_USERS)
       runloop_st->port_map[port] = (int)device;
+   runahead_secondary_core_wait(runloop_st);
    if (     runloop_st->secondary_lib_handle
          && runloop_st->secondary_core.retro_set_controller_port_device)
       runloop_st->secondary_core.retro_set_controller_port_device((unsigned)port, (unsigned)device);
@@ -721,6 +935,8 @@ static void *input_list_element_constructor(void)
    element->index              = 0;
    element->state              = (int16_t*)calloc(NAME_MAX_LENGTH,
          sizeof(int16_t));
+   element->queried            = (uint32_t*)calloc(
+         (NAME_MAX_LENGTH + 31) >> 5, sizeof(uint32_t));
    element->state_size         = NAME_MAX_LENGTH;
 
    return ptr;
@@ -731,10 +947,16 @@ static void input_list_element_realloc(input_list_element *element,
 {
    if (new_size > element->state_size)
    {
+      unsigned int old_words = (element->state_size + 31) >> 5;
+      unsigned int new_words = (new_size + 31) >> 5;
       element->state = (int16_t*)realloc(element->state,
             new_size * sizeof(int16_t));
       memset(&element->state[element->state_size], 0,
             (new_size - element->state_size) * sizeof(int16_t));
+      element->queried = (uint32_t*)realloc(element->queried,
+            new_words * sizeof(uint32_t));
+      memset(&element->queried[old_words], 0,
+            (new_words - old_words) * sizeof(uint32_t));
       element->state_size = new_size;
    }
 }
@@ -757,6 +979,7 @@ static void input_list_element_destructor(void* element_ptr)
       return;
 
    free(element->state);
+   free(element->queried);
    free(element_ptr);
 }
 
@@ -784,7 +1007,8 @@ static void runahead_input_state_set_last(
       {
          if (id >= element->state_size)
             input_list_element_expand(element, id);
-         element->state[id] = value;
+         element->state[id]          = value;
+         element->queried[id >> 5]  |= (1u << (id & 31));
          return;
       }
    }
@@ -800,7 +1024,8 @@ static void runahead_input_state_set_last(
       element->index        = index;
       if (id >= element->state_size)
          input_list_element_expand(element, id);
-      element->state[id]    = value;
+      element->state[id]          = value;
+      element->queried[id >> 5]  |= (1u << (id & 31));
    }
 }
 
@@ -830,6 +1055,7 @@ static void runahead_reset_hook(void)
 {
    runloop_state_t *runloop_st = runloop_state_get_ptr();
    runloop_st->flags          |= RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   runloop_st->runahead_cache_ahead = 0;
    if (runloop_st->retro_reset_callback_original)
       runloop_st->retro_reset_callback_original();
 }
@@ -838,6 +1064,7 @@ static bool runahead_unserialize_hook(const void *buf, size_t len)
 {
    runloop_state_t *runloop_st = runloop_state_get_ptr();
    runloop_st->flags          |= RUNLOOP_FLAG_INPUT_IS_DIRTY;
+   runloop_st->runahead_cache_ahead = 0;
    if (runloop_st->retro_unserialize_callback_original)
       return runloop_st->retro_unserialize_callback_original(buf, len);
    return false;
@@ -1014,6 +1241,7 @@ static void runahead_err(runloop_state_t *runloop_st)
    mylist_destroy(&runloop_st->runahead_save_state_list);
    runahead_remove_hooks(runloop_st);
    runloop_st->runahead_save_state_size       = 0;
+   runloop_st->runahead_cache_ahead           = 0;
    runloop_st->flags                         |= RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN;
 }
 
@@ -1092,14 +1320,15 @@ static bool runahead_load_state_secondary(runloop_state_t *runloop_st, settings_
 }
 #endif
 
-static void runahead_core_run_use_last_input(runloop_state_t *runloop_st)
+static void runahead_core_run_with_input(runloop_state_t *runloop_st,
+      retro_input_state_t state_cb)
 {
    struct retro_callbacks *cbs            = &runloop_st->retro_ctx;
    retro_input_poll_t old_poll_function   = cbs->poll_cb;
    retro_input_state_t old_input_function = cbs->state_cb;
 
    cbs->poll_cb                           = retro_input_poll_null;
-   cbs->state_cb                          = input_state_get_last;
+   cbs->state_cb                          = state_cb;
 
    runloop_st->current_core.retro_set_input_poll(cbs->poll_cb);
    runloop_st->current_core.retro_set_input_state(cbs->state_cb);
@@ -1113,15 +1342,614 @@ static void runahead_core_run_use_last_input(runloop_state_t *runloop_st)
    runloop_st->current_core.retro_set_input_state(cbs->state_cb);
 }
 
+static void runahead_core_run_use_last_input(runloop_state_t *runloop_st)
+{
+   runahead_core_run_with_input(runloop_st, input_state_get_last);
+}
+
+/* State cache - Single instance run-ahead that leaves the core
+ * ahead of the real frame and keeps the last confirmed state
+ * around, so that frames with unchanged input cost a single
+ * retro_run() instead of a full save/replay/load cycle. */
+
+/**
+ * runahead_input_is_dirty:
+ *
+ * Polls input and compares every input the core has requested
+ * so far against the value it was last given. The logged values
+ * are left untouched so that a replay from the confirmed state
+ * still sees the input of the previous frames.
+ *
+ * @return true if any requested input changed.
+ **/
+static bool runahead_input_is_dirty(runloop_state_t *runloop_st)
+{
+   int i;
+   my_list *list             = runloop_st->input_state_list;
+   retro_input_state_t state = runloop_st->input_state_callback_original;
+
+   input_driver_poll();
+
+   if (!list || !state)
+      return false;
+
+   for (i = 0; i < list->size; i++)
+   {
+      unsigned w;
+      input_list_element *element = (input_list_element*)list->data[i];
+      unsigned words              = (element->state_size + 31) >> 5;
+
+      for (w = 0; w < words; w++)
+      {
+         uint32_t bits = element->queried[w];
+
+         while (bits)
+         {
+            unsigned id = (w << 5) + compat_ctz(bits);
+            if (state(element->port, element->device,
+                     element->index, id) != element->state[id])
+               return true;
+            bits &= bits - 1;
+         }
+      }
+   }
+
+   return false;
+}
+
+/**
+ * runahead_cache_restore:
+ *
+ * Brings the core back from the speculative frame it was left on
+ * to the real current frame, by loading the confirmed state and
+ * replaying the frames run since with the logged input.
+ *
+ * @return true on success, false if the confirmed state could not
+ * be loaded.
+ **/
+static bool runahead_cache_restore(runloop_state_t *runloop_st)
+{
+   unsigned i;
+   video_driver_state_t *video_st = video_state_get_ptr();
+   audio_driver_state_t *audio_st = audio_state_get_ptr();
+
+   runloop_st->runahead_cache_ahead = 0;
+
+   if (!runahead_load_state(runloop_st))
+      return false;
+
+   audio_st->flags |=  AUDIO_FLAG_SUSPENDED;
+   video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+
+   for (i = 0; i < runloop_st->runahead_cache_frames; i++)
+      runahead_core_run_use_last_input(runloop_st);
+
+   if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
+      video_st->flags |=  VIDEO_FLAG_ACTIVE;
+   else
+      video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+   audio_st->flags    &= ~AUDIO_FLAG_SUSPENDED;
+
+   runloop_st->runahead_cache_frames  = 0;
+   runloop_st->runahead_cache_pending = 0;
+   return true;
+}
+
+/**
+ * runahead_run_cached:
+ * @runahead_count : number of frames to run ahead
+ *
+ * Single instance run-ahead that only reloads the confirmed state
+ * when input changes. While input stays the same the core simply
+ * keeps running @runahead_count frames ahead. A second state slot
+ * is filled every @runahead_count frames and promoted to confirmed
+ * once the real frame catches up with it, which bounds the replay
+ * needed when input does change.
+ *
+ * @return NULL on success, or the message to show on failure.
+ **/
+static const char *runahead_run_cached(runloop_state_t *runloop_st,
+      int runahead_count)
+{
+   int frame_number;
+   video_driver_state_t *video_st = video_state_get_ptr();
+   audio_driver_state_t *audio_st = audio_state_get_ptr();
+   my_list *list                  = runloop_st->runahead_save_state_list;
+   bool input_dirty               = runahead_input_is_dirty(runloop_st)
+         || (runloop_st->flags & (RUNLOOP_FLAG_INPUT_IS_DIRTY
+                                | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY));
+
+   if (list->size < 2)
+      mylist_resize(list, 2, true);
+
+   runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+   if (     !input_dirty
+         && runloop_st->runahead_cache_ahead == (unsigned)runahead_count)
+   {
+      if (     !runloop_st->runahead_cache_pending
+            &&  runloop_st->runahead_cache_frames >= (unsigned)runahead_count)
+      {
+         /* The core is on the state the real frame will reach
+          * in runahead_count frames, if input stays the same */
+         if (!core_serialize_special(
+                  (retro_ctx_serialize_info_t*)list->data[1]))
+            return msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+         runloop_st->runahead_cache_pending = runahead_count;
+      }
+
+      runahead_core_run_with_input(runloop_st,
+            runahead_input_state_with_logging);
+      runloop_st->runahead_cache_frames++;
+
+      if (     runloop_st->runahead_cache_pending
+            && --runloop_st->runahead_cache_pending == 0)
+      {
+         void *confirmed                   = list->data[0];
+         list->data[0]                     = list->data[1];
+         list->data[1]                     = confirmed;
+         runloop_st->runahead_cache_frames = 0;
+      }
+
+      /* If the core asked for an input it never requested before,
+       * the logging hook flags it and the next frame resyncs. */
+      runloop_st->runahead_skip_count++;
+      return NULL;
+   }
+
+   if (     runloop_st->runahead_cache_ahead
+         && !runahead_cache_restore(runloop_st))
+      return msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
+
+   /* Input was polled above, so the real frame must not poll again */
+   for (frame_number = 0; frame_number <= runahead_count; frame_number++)
+   {
+      bool suspended_frame = frame_number != runahead_count;
+
+      if (suspended_frame)
+      {
+         audio_st->flags  |=  AUDIO_FLAG_SUSPENDED;
+         video_st->flags  &= ~VIDEO_FLAG_ACTIVE;
+      }
+
+      if (frame_number == 0)
+         runahead_core_run_with_input(runloop_st,
+               runahead_input_state_with_logging);
+      else
+         runahead_core_run_use_last_input(runloop_st);
+
+      if (suspended_frame)
+      {
+         if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
+            video_st->flags |=  VIDEO_FLAG_ACTIVE;
+         else
+            video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+
+         audio_st->flags    &= ~AUDIO_FLAG_SUSPENDED;
+      }
+
+      if (frame_number == 0)
+      {
+         if (!runahead_save_state(runloop_st))
+            return msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+         runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+      }
+   }
+
+   runloop_st->runahead_cache_frames  = 0;
+   runloop_st->runahead_cache_pending = 0;
+   runloop_st->runahead_cache_ahead   = runahead_count;
+   runloop_st->runahead_reload_count++;
+   return NULL;
+}
+
+/**
+ * runahead_state_cache_sync:
+ *
+ * Brings the core back to the real frame if the state cache left
+ * it running ahead, before anything else reads or saves the core
+ * state. The next run-ahead frame then starts over from there.
+ *
+ * @return false if the confirmed state could not be loaded.
+ **/
+bool runahead_state_cache_sync(void *data)
+{
+   runloop_state_t *runloop_st = (runloop_state_t*)data;
+   if (!runloop_st->runahead_cache_ahead)
+      return true;
+   return runahead_cache_restore(runloop_st);
+}
+
+#if defined(HAVE_THREADS) && (defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB))
+static void runahead_secondary_thread_video_cb(const void *data,
+      unsigned width, unsigned height, size_t pitch)
+{
+   struct runahead_secondary_thread *t = runloop_state_get_ptr()->secondary_thread;
+   size_t _len                         = height * pitch;
+   uint8_t back                        = t->back;
+
+   if (!t->capture)
+      return;
+
+   t->frame_dupe = (!data || data == RETRO_HW_FRAME_BUFFER_VALID);
+   if (t->frame_dupe)
+      return;
+
+   if (t->frame_size[back] < _len)
+   {
+      void *frame = realloc(t->frame[back], _len);
+      if (!frame)
+      {
+         t->frame_dupe = true;
+         return;
+      }
+      t->frame[back]      = frame;
+      t->frame_size[back] = _len;
+   }
+
+   memcpy(t->frame[back], data, _len);
+   t->width  = width;
+   t->height = height;
+   t->pitch  = pitch;
+}
+
+static void runahead_secondary_thread_audio_cb(int16_t left, int16_t right) { }
+
+static size_t runahead_secondary_thread_audio_batch_cb(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static int16_t runahead_secondary_thread_input_state_cb(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   return input_list_get_state(
+         runloop_state_get_ptr()->secondary_thread->input,
+         port, device, index, id);
+}
+
+static void runahead_secondary_thread_loop(void *data)
+{
+   struct runahead_secondary_thread *t = (struct runahead_secondary_thread*)data;
+   struct retro_core_t *secondary_core = &runloop_state_get_ptr()->secondary_core;
+
+   slock_lock(t->lock);
+   for (;;)
+   {
+      unsigned i;
+      bool ok = true;
+
+      while (!t->busy && !t->quit)
+         scond_wait(t->cond, t->lock);
+      if (t->quit)
+         break;
+      slock_unlock(t->lock);
+
+      if (t->state)
+         ok = secondary_core->retro_unserialize(t->state, t->state_size);
+
+      t->frame_dupe = true;
+      for (i = 0; ok && i < t->frames; i++)
+      {
+         t->capture = (i == t->frames - 1);
+         secondary_core->retro_run();
+      }
+
+      slock_lock(t->lock);
+      t->ok   = ok;
+      t->busy = false;
+      scond_signal(t->cond);
+   }
+   slock_unlock(t->lock);
+}
+
+static void runahead_secondary_thread_wait(struct runahead_secondary_thread *t)
+{
+   slock_lock(t->lock);
+   while (t->busy)
+      scond_wait(t->cond, t->lock);
+   slock_unlock(t->lock);
+}
+
+static void runahead_secondary_thread_free_options(
+      struct runahead_secondary_thread *t)
+{
+   size_t i;
+   for (i = 0; i < t->options_count; i++)
+   {
+      free(t->options[i].key);
+      free(t->options[i].value);
+   }
+   free(t->options);
+   t->options       = NULL;
+   t->options_count = 0;
+   t->options_valid = false;
+}
+
+/* Copies the current core option values, so that the thread
+ * can answer GET_VARIABLE without the option manager */
+static void runahead_secondary_thread_snapshot_options(
+      runloop_state_t *runloop_st, struct runahead_secondary_thread *t)
+{
+   size_t i;
+   core_option_manager_t *opts = runloop_st->core_options;
+
+   runahead_secondary_thread_free_options(t);
+   t->options_valid            = true;
+
+   if (     !opts
+         || !opts->size
+         || !(t->options = (struct runahead_secondary_option*)
+               calloc(opts->size, sizeof(*t->options))))
+      return;
+
+   for (i = 0; i < opts->size; i++)
+   {
+      const char *value = core_option_manager_get_val(opts, i);
+      if (string_is_empty(opts->opts[i].key) || !value)
+         continue;
+      t->options[t->options_count].key   = strdup(opts->opts[i].key);
+      t->options[t->options_count].value = strdup(value);
+      t->options_count++;
+   }
+}
+
+/**
+ * runahead_secondary_thread_kick:
+ * @state  : state to load before running, NULL to continue from
+ *           the current state of the secondary core
+ * @frames : number of frames to run, the last one is captured
+ *
+ * Hands the secondary core a new job. The thread must be idle.
+ **/
+static void runahead_secondary_thread_kick(runloop_state_t *runloop_st,
+      const void *state, size_t state_size, unsigned frames)
+{
+   int i;
+   struct runahead_secondary_thread *t = runloop_st->secondary_thread;
+   my_list *src                        = runloop_st->input_state_list;
+
+   /* The main core keeps logging input while the job runs */
+   if (!t->input)
+      mylist_create(&t->input, 16,
+            input_list_element_constructor,
+            input_list_element_destructor);
+   mylist_resize(t->input, src ? src->size : 0, true);
+   for (i = 0; i < t->input->size; i++)
+   {
+      input_list_element *from = (input_list_element*)src->data[i];
+      input_list_element *to   = (input_list_element*)t->input->data[i];
+      to->port                 = from->port;
+      to->device               = from->device;
+      to->index                = from->index;
+      input_list_element_realloc(to, from->state_size);
+      memcpy(to->state, from->state, from->state_size * sizeof(int16_t));
+      memset(to->state + from->state_size, 0,
+            (to->state_size - from->state_size) * sizeof(int16_t));
+   }
+
+   if (runloop_st->flags & RUNLOOP_FLAG_HAS_VARIABLE_UPDATE)
+   {
+      t->variable_update  = true;
+      t->options_valid    = false;
+      runloop_st->flags  &= ~RUNLOOP_FLAG_HAS_VARIABLE_UPDATE;
+   }
+
+   if (!t->options_valid)
+      runahead_secondary_thread_snapshot_options(runloop_st, t);
+
+   slock_lock(t->lock);
+   t->state      = state;
+   t->state_size = state_size;
+   t->frames     = frames;
+   t->busy       = true;
+   scond_signal(t->cond);
+   slock_unlock(t->lock);
+}
+
+static void runahead_secondary_thread_deinit(runloop_state_t *runloop_st)
+{
+   struct runahead_secondary_thread *t = runloop_st->secondary_thread;
+   struct retro_core_t *secondary_core = &runloop_st->secondary_core;
+
+   if (!t)
+      return;
+
+   if (t->thread)
+   {
+      slock_lock(t->lock);
+      t->quit = true;
+      scond_signal(t->cond);
+      slock_unlock(t->lock);
+      sthread_join(t->thread);
+   }
+
+   scond_free(t->cond);
+   slock_free(t->lock);
+   mylist_destroy(&t->input);
+   runahead_secondary_thread_free_options(t);
+   free(t->frame[0]);
+   free(t->frame[1]);
+   free(t);
+   runloop_st->secondary_thread = NULL;
+
+   /* Give the secondary core its synchronous callbacks back */
+   if (secondary_core->flags & RETRO_CORE_FLAG_SYMBOLS_INITED)
+   {
+      secondary_core->retro_set_video_refresh(
+            runloop_st->secondary_callbacks.frame_cb);
+      secondary_core->retro_set_audio_sample(
+            runloop_st->secondary_callbacks.sample_cb);
+      secondary_core->retro_set_audio_sample_batch(
+            runloop_st->secondary_callbacks.sample_batch_cb);
+      secondary_core->retro_set_input_state(
+            runloop_st->secondary_callbacks.state_cb);
+      secondary_core->retro_set_input_poll(
+            runloop_st->secondary_callbacks.poll_cb);
+   }
+}
+
+static bool runahead_secondary_thread_init(runloop_state_t *runloop_st)
+{
+   struct runahead_secondary_thread *t = NULL;
+   struct retro_core_t *secondary_core = &runloop_st->secondary_core;
+   struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
+
+   if (runloop_st->secondary_thread)
+      return true;
+
+   /* Hardware rendered frames can only be presented
+    * from the thread owning the graphics context */
+   if (hwr && hwr->context_type != RETRO_HW_CONTEXT_NONE)
+      return false;
+
+   if (!(t = (struct runahead_secondary_thread*)
+            calloc(1, sizeof(*t))))
+      return false;
+
+   runloop_st->secondary_thread = t;
+   t->lock                      = slock_new();
+   t->cond                      = scond_new();
+
+   if (     !t->lock
+         || !t->cond
+         || !(t->thread = sthread_create(
+               runahead_secondary_thread_loop, t)))
+   {
+      runahead_secondary_thread_deinit(runloop_st);
+      return false;
+   }
+
+   secondary_core->retro_set_video_refresh(
+         runahead_secondary_thread_video_cb);
+   secondary_core->retro_set_audio_sample(
+         runahead_secondary_thread_audio_cb);
+   secondary_core->retro_set_audio_sample_batch(
+         runahead_secondary_thread_audio_batch_cb);
+   secondary_core->retro_set_input_state(
+         runahead_secondary_thread_input_state_cb);
+   secondary_core->retro_set_input_poll(
+         secondary_core_input_poll_null);
+
+   RARCH_LOG("[Run-Ahead] Running secondary instance on its own thread.\n");
+   return true;
+}
+
+/**
+ * runahead_secondary_thread_run:
+ * @runahead_count : number of frames to run ahead
+ *
+ * Threaded equivalent of the second instance path of
+ * runahead_run(). When input did not change, the frame the
+ * secondary core was already running in the background is
+ * presented. Otherwise the secondary core is resynced from
+ * the main core first.
+ *
+ * @return NULL on success, or the message to show on failure.
+ **/
+static const char *runahead_secondary_thread_run(
+      runloop_state_t *runloop_st, int runahead_count)
+{
+   struct runahead_secondary_thread *t = runloop_st->secondary_thread;
+   video_driver_state_t *video_st      = video_state_get_ptr();
+   bool input_dirty                    = runahead_input_is_dirty(runloop_st)
+         || (runloop_st->flags & (RUNLOOP_FLAG_INPUT_IS_DIRTY
+                                | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY));
+
+   runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+   /* Run main core with video suspended, input was polled above */
+   video_st->flags   &= ~VIDEO_FLAG_ACTIVE;
+   runahead_core_run_with_input(runloop_st,
+         runahead_input_state_with_logging);
+   if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
+      video_st->flags |=  VIDEO_FLAG_ACTIVE;
+   else
+      video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+
+   /* Also set when the core requested an input for the first time */
+   if (runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY)
+      input_dirty        = true;
+   runloop_st->flags    &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+   runahead_secondary_thread_wait(t);
+
+   if (input_dirty || !t->speculative)
+   {
+      retro_ctx_serialize_info_t *serialize_info;
+
+      if (!runahead_save_state(runloop_st))
+         return msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE);
+
+      serialize_info     = (retro_ctx_serialize_info_t*)
+         runloop_st->runahead_save_state_list->data[0];
+
+      runahead_secondary_thread_kick(runloop_st,
+            serialize_info->data_const, serialize_info->size,
+            runahead_count);
+      runahead_secondary_thread_wait(t);
+
+      if (!t->ok)
+      {
+         runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
+         runahead_err(runloop_st);
+         return msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
+      }
+
+      runloop_st->runahead_reload_count++;
+   }
+   else
+      runloop_st->runahead_skip_count++;
+
+   if (t->frame_dupe)
+      runloop_st->secondary_callbacks.frame_cb(NULL,
+            t->width, t->height, t->pitch);
+   else
+   {
+      runloop_st->secondary_callbacks.frame_cb(t->frame[t->back],
+            t->width, t->height, t->pitch);
+      /* The presented frame may be redrawn later,
+       * so the next job draws into the other buffer */
+      t->back ^= 1;
+   }
+
+   runahead_secondary_thread_kick(runloop_st, NULL, 0, 1);
+   t->speculative = true;
+   return NULL;
+}
+
+/**
+ * runahead_secondary_core_wait:
+ *
+ * Waits for the run-ahead thread to be done with the secondary
+ * core, before it is used from the main thread. The frame it
+ * was running is then assumed to be stale.
+ **/
+void runahead_secondary_core_wait(void *data)
+{
+   runloop_state_t *runloop_st = (runloop_state_t*)data;
+   if (!runloop_st->secondary_thread)
+      return;
+   runahead_secondary_thread_wait(runloop_st->secondary_thread);
+   runloop_st->secondary_thread->speculative = false;
+}
+#elif defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+void runahead_secondary_core_wait(void *data) { }
+#endif
+
 void runahead_run(void *data,
       int runahead_count,
       bool runahead_hide_warnings,
-      bool use_secondary)
+      bool use_secondary,
+      bool use_secondary_thread,
+      bool use_state_cache)
 {
    runloop_state_t *runloop_st = (runloop_state_t*)data;
    int frame_number        = 0;
    bool last_frame         = false;
    bool suspended_frame    = false;
+   bool single_instance    = true;
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    const bool have_dynamic = true;
    settings_t *settings    = config_get_ptr();
@@ -1179,12 +2007,41 @@ void runahead_run(void *data,
 
    runloop_st->runahead_last_frame_count  = frame_count;
 
-   if (     !use_secondary
+   single_instance         = !use_secondary
          || !have_dynamic
-         || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE))
+         || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE);
+
+   /* The state cache leaves the core ahead of the real frame,
+    * go back to it before running any other mode */
+   if (     runloop_st->runahead_cache_ahead
+         && !(single_instance && use_state_cache)
+         && !runahead_cache_restore(runloop_st))
    {
-      /* TODO: multiple savestates for higher performance
-       * when not using secondary core */
+      const char *_msg = msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE);
+      runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
+            MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      RARCH_WARN("[Run-Ahead] %s\n", _msg);
+      return;
+   }
+
+   if (single_instance)
+   {
+      if (use_state_cache)
+      {
+         const char *_msg = runahead_run_cached(runloop_st, runahead_count);
+         if (_msg)
+         {
+            runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
+                  MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            RARCH_WARN("[Run-Ahead] %s\n", _msg);
+            return;
+         }
+         runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+         return;
+      }
+
+      runloop_st->runahead_reload_count++;
+
       for (frame_number = 0; frame_number <= runahead_count; frame_number++)
       {
          last_frame      = frame_number == runahead_count;
@@ -1240,6 +2097,15 @@ void runahead_run(void *data,
    else
    {
 #if HAVE_DYNAMIC
+#ifdef HAVE_THREADS
+      /* The secondary core ran one more frame in the background */
+      if (!use_secondary_thread && runloop_st->secondary_thread)
+      {
+         runahead_secondary_thread_deinit(runloop_st);
+         runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+      }
+#endif
+
       if (!secondary_core_ensure_exists(runloop_st, config_get_ptr()))
       {
          const char *_msg =
@@ -1252,6 +2118,24 @@ void runahead_run(void *data,
          goto force_input_dirty;
       }
 
+#ifdef HAVE_THREADS
+      if (     use_secondary_thread
+            && runahead_secondary_thread_init(runloop_st))
+      {
+         const char *_msg = runahead_secondary_thread_run(runloop_st,
+               runahead_count);
+         if (_msg)
+         {
+            runloop_msg_queue_push(_msg, strlen(_msg), 0, 3 * 60, true, NULL,
+                  MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            RARCH_WARN("[Run-Ahead] %s\n", _msg);
+            return;
+         }
+         runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
+         return;
+      }
+#endif
+
       /* run main core with video suspended */
       video_st->flags &= ~VIDEO_FLAG_ACTIVE;
       core_run();
@@ -1264,6 +2148,7 @@ void runahead_run(void *data,
             || (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY))
       {
          runloop_st->flags &= ~RUNLOOP_FLAG_INPUT_IS_DIRTY;
+         runloop_st->runahead_reload_count++;
 
          if (!runahead_save_state(runloop_st))
          {
@@ -1300,6 +2185,8 @@ void runahead_run(void *data,
                video_st->flags          &= ~VIDEO_FLAG_ACTIVE;
          }
       }
+      else
+         runloop_st->runahead_skip_count++;
       audio_st->flags                   |= AUDIO_FLAG_SUSPENDED
                                          | AUDIO_FLAG_HARD_DISABLE;
       if (secondary_core_run_use_last_input(runloop_st))
@@ -1692,4 +2579,9 @@ void runahead_clear_variables(void *data)
                                           | RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE
                                           | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
    runloop_st->runahead_last_frame_count  = 0;
+   runloop_st->runahead_reload_count      = 0;
+   runloop_st->runahead_skip_count        = 0;
+   runloop_st->runahead_cache_frames      = 0;
+   runloop_st->runahead_cache_pending     = 0;
+   runloop_st->runahead_cache_ahead       = 0;
 }
@@ -7384,6 +7384,12 @@ int runloop_iterate(void)
       unsigned run_ahead_num_frames     = settings->uints.run_ahead_frames;
       bool run_ahead_hide_warnings      = settings->bools.run_ahead_hide_warnings;
       bool run_ahead_secondary_instance = settings->bools.run_ahead_secondary_instance;
+#ifdef HAVE_THREADS
+      bool run_ahead_secondary_thread   = settings->bools.run_ahead_secondary_thread;
+#else
+      bool run_ahead_secondary_thread   = false;
+#endif
+      bool run_ahead_state_cache        = settings->bools.run_ahead_state_cache;
       /* Run Ahead Feature replaces the call to core_run in this loop */
       bool want_runahead                = run_ahead_enabled
             && (run_ahead_num_frames > 0)
@@ -7391,18 +7397,39 @@ int runloop_iterate(void)
 #ifdef HAVE_NETWORKING
       want_runahead                     = want_runahead && !netplay_is_enabled;
 #endif
+#ifdef HAVE_CHEEVOS
+      /* Achievements read core memory after every frame, which
+       * has to be the real one and not the one run ahead to */
+      run_ahead_state_cache             = run_ahead_state_cache && !cheevos_enable;
+#endif
+#ifdef HAVE_REWIND
+      /* Rewind takes a state every frame, which would have the
+       * cache go back to the real frame and run ahead again each time */
+      run_ahead_state_cache             = run_ahead_state_cache
+            && !settings->bools.rewind_enable;
+#endif
 
       if (want_runahead)
          runahead_run(
                runloop_st,
                run_ahead_num_frames,
                run_ahead_hide_warnings,
-               run_ahead_secondary_instance);
-      else if (runloop_st->preempt_data)
-         preempt_run(runloop_st->preempt_data, runloop_st);
+               run_ahead_secondary_instance,
+               run_ahead_secondary_thread,
+               run_ahead_state_cache);
       else
+      {
+         /* Run-ahead was just turned off, or netplay took over */
+         runahead_state_cache_sync(runloop_st);
+
+         if (runloop_st->preempt_data)
+            preempt_run(runloop_st->preempt_data, runloop_st);
+         else
+            core_run();
+      }
+#else
+      core_run();
 #endif
-         core_run();
    }
 
    /* Increment runtime tick counter after each call to
@@ -7795,8 +7822,11 @@ bool core_set_cheat(retro_ctx_cheat_info_t *info)
          && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)
          && (secondary_core_ensure_exists(runloop_st, settings))
          && (runloop_st->secondary_core.retro_cheat_set))
+   {
+      runahead_secondary_core_wait(runloop_st);
       runloop_st->secondary_core.retro_cheat_set(
             info->index, info->enabled, info->code);
+   }
 #endif
 
    return true;
@@ -7835,7 +7865,10 @@ bool core_reset_cheat(void)
        && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE)
        && (secondary_core_ensure_exists(runloop_st, settings))
        && (runloop_st->secondary_core.retro_cheat_reset))
+   {
+      runahead_secondary_core_wait(runloop_st);
       runloop_st->secondary_core.retro_cheat_reset();
+   }
 #endif
 
    return true;
@@ -7979,7 +8012,15 @@ bool core_unserialize_special(retro_ctx_serialize_info_t *info)
 bool core_serialize(retro_ctx_serialize_info_t *info)
 {
    runloop_state_t *runloop_st  = &runloop_state;
-   if (!info || !runloop_st->current_core.retro_serialize(info->data, info->size))
+   if (!info)
+      return false;
+#ifdef HAVE_RUNAHEAD
+   /* Savestates, rewind and replays must see the real
+    * frame, not the one the state cache ran ahead to */
+   if (!runahead_state_cache_sync(runloop_st))
+      return false;
+#endif
+   if (!runloop_st->current_core.retro_serialize(info->data, info->size))
       return false;
    return true;
 }
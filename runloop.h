@@ -176,6 +176,8 @@ struct runloop
    struct retro_core_t        current_core;     /* uint64_t alignment */
 #if defined(HAVE_RUNAHEAD)
    uint64_t runahead_last_frame_count;          /* uint64_t alignment */
+   uint64_t runahead_reload_count;              /* uint64_t alignment */
+   uint64_t runahead_skip_count;                /* uint64_t alignment */
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    struct retro_core_t secondary_core;          /* uint64_t alignment */
 #endif
@@ -207,6 +209,9 @@ struct runloop
       retro_unserialize_callback_original;               /* ptr alignment */
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    struct retro_callbacks secondary_callbacks;           /* ptr alignment */
+#ifdef HAVE_THREADS
+   struct runahead_secondary_thread *secondary_thread;   /* ptr alignment */
+#endif
 #endif
 #endif
 #ifdef HAVE_THREADS
@@ -241,6 +246,13 @@ struct runloop
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    int port_map[MAX_USERS];
 #endif
+   /* Frames the core was left ahead of the real frame by the
+    * run-ahead state cache, 0 when it is on the real frame */
+   unsigned runahead_cache_ahead;
+   /* Frames run since the confirmed state was saved */
+   unsigned runahead_cache_frames;
+   /* Frames until the pending state becomes confirmed */
+   unsigned runahead_cache_pending;
 #endif
 
    runloop_core_status_msg_t core_status_msg;
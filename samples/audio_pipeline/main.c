@@ -0,0 +1,309 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Audio pipeline benchmark.
+ *
+ * Pushes core-sized s16 batches through the stages audio_driver_flush()
+ * runs when no DSP filter is loaded, once stage by stage over the whole
+ * batch and once through the fused convert_s16_resample(), and reports
+ * the cost of each in ns per input frame.
+ *
+ * Usage: audio_pipeline_bench [-r resampler] [-q quality] [-i in_rate]
+ *                             [-o out_rate] [-b batch_frames] [-m]
+ *
+ * -m plays a looping sound through the audio mixer while measuring,
+ * like menu sounds or background music would. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <boolean.h>
+#include <memalign.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <audio/audio_mixer.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/s16_to_float.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_resample.h>
+
+#define BENCH_MIN_FRAMES   (1 << 24)
+#define BENCH_MIXER_RATE   44100
+#define BENCH_MIXER_FRAMES BENCH_MIXER_RATE
+
+enum bench_stage
+{
+   BENCH_STAGE_S16_TO_FLOAT = 0,
+   BENCH_STAGE_RESAMPLE,
+   BENCH_STAGE_MIX,
+   BENCH_STAGE_FLOAT_TO_S16,
+   BENCH_STAGE_LAST
+};
+
+static const char *bench_stage_names[BENCH_STAGE_LAST] = {
+   "s16->float",
+   "resample",
+   "mix",
+   "float->s16"
+};
+
+static void bench_mix(float *buf, size_t frames, void *data)
+{
+   audio_mixer_mix(buf, frames, 0.0f, false);
+}
+
+/* Builds a 16-bit stereo RIFF/WAVE file holding a tone,
+ * for audio_mixer_load_wav() to chew on. */
+static uint8_t *bench_make_wav(int32_t *len)
+{
+   unsigned i;
+   uint32_t data_len = BENCH_MIXER_FRAMES * 4;
+   uint8_t *wav      = (uint8_t*)malloc(44 + data_len);
+   int16_t *samples  = (int16_t*)(wav + 44);
+   uint32_t hdr[11];
+
+   if (!wav)
+      return NULL;
+
+   memcpy(&hdr[0], "RIFF", 4);
+   hdr[1]  = 36 + data_len;
+   memcpy(&hdr[2], "WAVE", 4);
+   memcpy(&hdr[3], "fmt ", 4);
+   hdr[4]  = 16;
+   hdr[5]  = 1 | (2 << 16);         /* PCM, stereo */
+   hdr[6]  = BENCH_MIXER_RATE;
+   hdr[7]  = BENCH_MIXER_RATE * 4;
+   hdr[8]  = 4 | (16 << 16);        /* block align, bits per sample */
+   memcpy(&hdr[9], "data", 4);
+   hdr[10] = data_len;
+   memcpy(wav, hdr, sizeof(hdr));
+
+   for (i = 0; i < BENCH_MIXER_FRAMES; i++)
+   {
+      int16_t s          = (int16_t)(8000.0 * sin(i * 2.0 * M_PI * 440.0
+               / BENCH_MIXER_RATE));
+      samples[i * 2 + 0] = s;
+      samples[i * 2 + 1] = s;
+   }
+
+   *len = 44 + data_len;
+   return wav;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned j;
+   size_t k, out_max, staged_frames = 0, fused_frames = 0;
+   size_t batches, mismatches = 0;
+   const char *ident          = "sinc";
+   enum resampler_quality q   = RESAMPLER_QUALITY_NORMAL;
+   double in_rate             = 32040.5;
+   double out_rate            = 48000.0;
+   unsigned batch             = 0;
+   bool mixer                 = false;
+   const retro_resampler_t *staged_backend = NULL;
+   const retro_resampler_t *fused_backend  = NULL;
+   void *staged_re            = NULL;
+   void *fused_re             = NULL;
+   audio_mixer_sound_t *sound = NULL;
+   uint8_t *wav               = NULL;
+   int16_t *in, *staged_s16, *fused_s16;
+   float *in_float, *staged_out, *fused_out, *scratch;
+   retro_time_t stage_time[BENCH_STAGE_LAST] = {0};
+   retro_time_t staged_total, fused_time, start;
+   double ratio;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-r") && i + 1 < argc)
+         ident = argv[++i];
+      else if (!strcmp(argv[i], "-q") && i + 1 < argc)
+         q = (enum resampler_quality)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+         in_rate = atof(argv[++i]);
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+         out_rate = atof(argv[++i]);
+      else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+         batch = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-m"))
+         mixer = true;
+      else
+      {
+         fprintf(stderr, "Usage: %s [-r resampler] [-q quality] [-i in_rate]"
+               " [-o out_rate] [-b batch_frames] [-m]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   /* One video frame worth of audio at 60 Hz by default */
+   if (!batch)
+      batch = (unsigned)(in_rate / 60.0 + 0.5);
+   ratio   = out_rate / in_rate;
+   out_max = (size_t)(batch * ratio * 2.0) + 64;
+   batches = MAX(BENCH_MIN_FRAMES / batch, 1);
+
+   convert_s16_to_float_init_simd();
+   convert_float_to_s16_init_simd();
+
+   if (     !retro_resampler_realloc(&staged_re, &staged_backend, ident, q, ratio)
+         || !retro_resampler_realloc(&fused_re,  &fused_backend,  ident, q, ratio))
+   {
+      fprintf(stderr, "Failed to initialize resampler \"%s\".\n", ident);
+      return 1;
+   }
+
+   in         = (int16_t*)memalign_alloc(64, batch   * 2 * sizeof(int16_t));
+   in_float   = (float*)  memalign_alloc(64, batch   * 2 * sizeof(float));
+   staged_out = (float*)  memalign_alloc(64, out_max * 2 * sizeof(float));
+   fused_out  = (float*)  memalign_alloc(64, out_max * 2 * sizeof(float));
+   staged_s16 = (int16_t*)memalign_alloc(64, out_max * 2 * sizeof(int16_t));
+   fused_s16  = (int16_t*)memalign_alloc(64, out_max * 2 * sizeof(int16_t));
+   scratch    = (float*)  memalign_alloc(64,
+         S16_RESAMPLE_CHUNK_FRAMES * 2 * sizeof(float));
+
+   if (!in || !in_float || !staged_out || !fused_out
+         || !staged_s16 || !fused_s16 || !scratch)
+   {
+      fprintf(stderr, "Out of memory.\n");
+      return 1;
+   }
+
+   if (mixer)
+   {
+      int32_t wav_len = 0;
+      audio_mixer_init((unsigned)out_rate);
+      if (     !(wav   = bench_make_wav(&wav_len))
+            || !(sound = audio_mixer_load_wav(wav, wav_len, ident, q))
+            || !audio_mixer_play(sound, true, 0.5f, ident, q, NULL))
+      {
+         fprintf(stderr, "Failed to start the mixer voice.\n");
+         return 1;
+      }
+   }
+
+   srand(1);
+   for (j = 0; j < batch; j++)
+   {
+      int16_t s        = (int16_t)(12000.0 * sin(j * 2.0 * M_PI * 1000.0
+               / in_rate) + (rand() & 0x3ff) - 0x200);
+      in[j * 2 + 0]    = s;
+      in[j * 2 + 1]    = (int16_t)-s;
+   }
+
+   printf("%s resampler, %.1f -> %.1f Hz, %u frame batches%s\n",
+         fused_backend->ident, in_rate, out_rate, batch,
+         mixer ? ", mixer active" : "");
+
+   for (k = 0; k < batches; k++)
+   {
+      struct resampler_data src_data;
+
+      /* Stage by stage over the whole batch, as audio_driver_flush()
+       * used to do. */
+      start = cpu_features_get_time_usec();
+      convert_s16_to_float(in_float, in, batch * 2, 1.0f);
+      stage_time[BENCH_STAGE_S16_TO_FLOAT] += cpu_features_get_time_usec() - start;
+
+      src_data.data_in       = in_float;
+      src_data.data_out      = staged_out;
+      src_data.input_frames  = batch;
+      src_data.output_frames = 0;
+      src_data.ratio         = ratio;
+      start = cpu_features_get_time_usec();
+      staged_backend->process(staged_re, &src_data);
+      stage_time[BENCH_STAGE_RESAMPLE] += cpu_features_get_time_usec() - start;
+
+      if (mixer)
+      {
+         start = cpu_features_get_time_usec();
+         bench_mix(staged_out, src_data.output_frames, NULL);
+         stage_time[BENCH_STAGE_MIX] += cpu_features_get_time_usec() - start;
+      }
+
+      start = cpu_features_get_time_usec();
+      convert_float_to_s16(staged_s16, staged_out, src_data.output_frames * 2);
+      stage_time[BENCH_STAGE_FLOAT_TO_S16] += cpu_features_get_time_usec() - start;
+      staged_frames += src_data.output_frames;
+
+      /* Fused. Timed separately below so that the two pipelines
+       * don't share warm caches; this pass only checks the output. */
+      if (k < 64)
+      {
+         size_t n = convert_s16_resample(fused_backend, fused_re,
+               in, batch, 1.0f, ratio, scratch, fused_out, fused_s16,
+               NULL, NULL);
+
+         if (!mixer)
+         {
+            size_t l;
+            if (n != src_data.output_frames)
+               mismatches++;
+            else
+               /* The SIMD and scalar float->s16 paths round
+                * differently, so allow one LSB. */
+               for (l = 0; l < n * 2; l++)
+                  if (abs(fused_s16[l] - staged_s16[l]) > 1)
+                     mismatches++;
+         }
+      }
+   }
+
+   start = cpu_features_get_time_usec();
+   for (k = 0; k < batches; k++)
+      fused_frames += convert_s16_resample(fused_backend, fused_re,
+            in, batch, 1.0f, ratio, scratch, fused_out, fused_s16,
+            mixer ? bench_mix : NULL, NULL);
+   fused_time = cpu_features_get_time_usec() - start;
+
+   staged_total = 0;
+   for (j = 0; j < BENCH_STAGE_LAST; j++)
+   {
+      if (j == BENCH_STAGE_MIX && !mixer)
+         continue;
+      staged_total += stage_time[j];
+      printf("%-12s %8.2f ns/frame\n", bench_stage_names[j],
+            stage_time[j] * 1000.0 / ((double)batches * batch));
+   }
+   printf("%-12s %8.2f ns/frame\n", "staged",
+         staged_total * 1000.0 / ((double)batches * batch));
+   printf("%-12s %8.2f ns/frame (%.2fx)\n", "fused",
+         fused_time * 1000.0 / ((double)batches * batch),
+         fused_time ? (double)staged_total / fused_time : 0.0);
+   printf("%u -> %u output frames", (unsigned)staged_frames,
+         (unsigned)fused_frames);
+   if (!mixer)
+      printf(", %s", mismatches ? "OUTPUT MISMATCH" : "outputs match");
+   printf("\n");
+
+   if (mixer)
+   {
+      audio_mixer_done();
+      audio_mixer_destroy(sound);
+      free(wav);
+   }
+   staged_backend->free(staged_re);
+   fused_backend->free(fused_re);
+   memalign_free(in);
+   memalign_free(in_float);
+   memalign_free(staged_out);
+   memalign_free(fused_out);
+   memalign_free(staged_s16);
+   memalign_free(fused_s16);
+   memalign_free(scratch);
+
+   return mismatches ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Playlist path lookup benchmark.
+ *
+ * Builds a playlist the way a content scan does, by pushing N
+ * synthetic entries (every 4th one a file inside a zip archive),
+ * then times the path lookups that run against it: existence
+ * checks for present and absent content, fuzzy archive matches,
+ * re-pushing content that is already in the playlist and
+ * deleting by path. Lookup results are checked along the way.
+ *
+ * Usage: playlist_index_bench [-n entries] [-r repeats] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <lists/string_list.h>
+
+#include "../../playlist.h"
+#include "../../core_info.h"
+
+#define BENCH_CORE_PATH "/cores/bench_libretro.so"
+
+/* playlist.c only needs these for core
+ * path autofixing and archive browsing,
+ * neither of which is exercised here */
+bool core_info_find(const char *core_path,
+      core_info_t **core_info)
+{
+   return false;
+}
+
+bool core_info_core_file_id_is_equal(const char *core_path_a,
+      const char *core_path_b)
+{
+   return false;
+}
+
+struct string_list *file_archive_get_file_list(const char *path,
+      const char *valid_exts)
+{
+   return NULL;
+}
+
+static bool bench_in_archive(unsigned i)
+{
+   return (i & 3) == 3;
+}
+
+static void bench_path(char *s, size_t len, unsigned i)
+{
+   if (bench_in_archive(i))
+      snprintf(s, len, "/roms/arcade/game%05u.zip#game%05u.bin", i, i);
+   else
+      snprintf(s, len, "/roms/system%u/Game %05u (USA).bin", i % 7, i);
+}
+
+static void bench_report(const char *name, retro_time_t t, unsigned ops)
+{
+   printf("%-14s %8u ops %12.1f ns/op\n", name, ops,
+         ops ? t * 1000.0 / ops : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned j;
+   char path[PATH_MAX_LENGTH];
+   playlist_config_t config;
+   struct playlist_entry entry;
+   playlist_t *playlist = NULL;
+   unsigned n           = 50000;
+   unsigned repeats     = 1000;
+   unsigned errors      = 0;
+   unsigned hits        = 0;
+   unsigned deleted     = 0;
+   retro_time_t start;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         n = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+         repeats = (unsigned)atoi(argv[++i]);
+      else
+      {
+         fprintf(stderr, "Usage: %s [-n entries] [-r repeats]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (!n)
+      return 1;
+   if (repeats > n)
+      repeats = n;
+
+   memset(&config, 0, sizeof(config));
+   config.capacity            = n;
+   config.fuzzy_archive_match = true;
+   playlist_config_set_path(&config, "/nonexistent/playlist_index_bench.lpl");
+
+   if (!(playlist = playlist_init(&config)))
+   {
+      fprintf(stderr, "Failed to create playlist.\n");
+      return 1;
+   }
+
+   memset(&entry, 0, sizeof(entry));
+   entry.path      = path;
+   entry.core_path = BENCH_CORE_PATH;
+   entry.core_name = "Bench";
+
+   /* Scan: every push is new content */
+   start = cpu_features_get_time_usec();
+   for (j = 0; j < n; j++)
+   {
+      bench_path(path, sizeof(path), j);
+      if (!playlist_push(playlist, &entry))
+         errors++;
+   }
+   bench_report("push (new)", cpu_features_get_time_usec() - start, n);
+
+   if (playlist_size(playlist) != n)
+      errors++;
+
+   start = cpu_features_get_time_usec();
+   for (j = 0; j < n; j++)
+   {
+      bench_path(path, sizeof(path), j);
+      hits += playlist_entry_exists(playlist, path);
+   }
+   bench_report("exists (hit)", cpu_features_get_time_usec() - start, n);
+   if (hits != n)
+      errors++;
+
+   hits  = 0;
+   start = cpu_features_get_time_usec();
+   for (j = 0; j < n; j++)
+   {
+      snprintf(path, sizeof(path), "/roms/missing/Game %05u.bin", j);
+      hits += playlist_entry_exists(playlist, path);
+   }
+   bench_report("exists (miss)", cpu_features_get_time_usec() - start, n);
+   if (hits)
+      errors++;
+
+   /* A bare archive path matches the file inside it */
+   hits  = 0;
+   start = cpu_features_get_time_usec();
+   for (j = 3; j < n; j += 4)
+   {
+      const struct playlist_entry *found = NULL;
+      snprintf(path, sizeof(path), "/roms/arcade/game%05u.zip", j);
+      playlist_get_index_by_path(playlist, path, &found);
+      if (found && strstr(found->path, path))
+         hits++;
+   }
+   bench_report("get (archive)", cpu_features_get_time_usec() - start, n / 4);
+   if (hits != n / 4)
+      errors++;
+
+   /* Re-launching content moves it to the top */
+   start = cpu_features_get_time_usec();
+   for (j = 0; j < repeats; j++)
+   {
+      const struct playlist_entry *top = NULL;
+      unsigned k = (unsigned)(((unsigned long long)j * 7919) % n);
+      bench_path(path, sizeof(path), k);
+      playlist_push(playlist, &entry);
+      playlist_get_index(playlist, 0, &top);
+      if (!top || strcmp(top->path, path))
+         errors++;
+   }
+   bench_report("push (dupe)", cpu_features_get_time_usec() - start, repeats);
+   if (playlist_size(playlist) != n)
+      errors++;
+
+   start = cpu_features_get_time_usec();
+   for (j = 0; j < repeats; j++)
+   {
+      bench_path(path, sizeof(path), n - 1 - j);
+      playlist_delete_by_path(playlist, path);
+      deleted++;
+   }
+   bench_report("delete", cpu_features_get_time_usec() - start, repeats);
+   if (playlist_size(playlist) != n - deleted)
+      errors++;
+
+   for (j = 0; j < repeats; j++)
+   {
+      bench_path(path, sizeof(path), n - 1 - j);
+      if (playlist_entry_exists(playlist, path))
+         errors++;
+      bench_path(path, sizeof(path), j);
+      if (!playlist_entry_exists(playlist, path))
+         errors++;
+   }
+
+   printf("%u entries, %s\n", (unsigned)playlist_size(playlist),
+         errors ? "LOOKUP MISMATCH" : "lookups match");
+
+   playlist_free(playlist);
+   return errors ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Playlist load benchmark.
+ *
+ * Writes a JSON playlist of N synthetic entries laid out the way
+ * playlist_write_file() does, then times opening it with
+ * playlist_init() and closing it with playlist_free(), and reports
+ * the heap the open playlist holds on to. Each round opens the
+ * playlist twice: once with no binary cache next to it, so that
+ * the JSON file is parsed (and the cache written), and once more
+ * from the cache, whose entries are checked against the parsed
+ * ones. The best of several rounds is reported.
+ *
+ * Usage: playlist_load_bench [-n entries] [-r rounds] [-f file] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <lists/string_list.h>
+#include <file/file_path.h>
+#include <string/stdstring.h>
+
+#include "../../playlist.h"
+#include "../../core_info.h"
+#include "../../file_path_special.h"
+
+/* playlist.c only needs these for core
+ * path autofixing and archive browsing,
+ * neither of which is exercised here */
+bool core_info_find(const char *core_path,
+      core_info_t **core_info)
+{
+   return false;
+}
+
+bool core_info_core_file_id_is_equal(const char *core_path_a,
+      const char *core_path_b)
+{
+   return false;
+}
+
+struct string_list *file_archive_get_file_list(const char *path,
+      const char *valid_exts)
+{
+   return NULL;
+}
+
+static size_t bench_heap_used(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+   struct mallinfo2 mi = mallinfo2();
+   return mi.uordblks;
+#else
+   return 0;
+#endif
+}
+
+static bool bench_entries_equal(const struct playlist_entry *a,
+      const struct playlist_entry *b)
+{
+   return string_is_equal(a->path, b->path)
+       && string_is_equal(a->label, b->label)
+       && string_is_equal(a->core_path, b->core_path)
+       && string_is_equal(a->core_name, b->core_name)
+       && string_is_equal(a->crc32, b->crc32)
+       && string_is_equal(a->db_name, b->db_name)
+       && (a->entry_slot == b->entry_slot);
+}
+
+static bool bench_write_playlist(const char *path, unsigned n)
+{
+   unsigned i;
+   FILE *fp = fopen(path, "w");
+
+   if (!fp)
+      return false;
+
+   fprintf(fp, "{\n  \"version\": \"1.5\",\n"
+         "  \"default_core_path\": \"\",\n"
+         "  \"default_core_name\": \"\",\n"
+         "  \"label_display_mode\": 0,\n"
+         "  \"right_thumbnail_mode\": 0,\n"
+         "  \"left_thumbnail_mode\": 0,\n"
+         "  \"thumbnail_match_mode\": 0,\n"
+         "  \"sort_mode\": 0,\n"
+         "  \"items\": [\n");
+
+   for (i = 0; i < n; i++)
+      fprintf(fp,
+            "    {\n"
+            "      \"path\": \"/storage/roms/System %u/Game Title Number %05u (USA) (Rev 1).zip#Game Title Number %05u (USA) (Rev 1).bin\",\n"
+            "      \"label\": \"Game Title Number %05u (USA) (Rev 1)\",\n"
+            "      \"core_path\": \"/usr/lib/libretro/system%u_libretro.so\",\n"
+            "      \"core_name\": \"System %u (Core)\",\n"
+            "      \"crc32\": \"%08X|crc\",\n"
+            "      \"db_name\": \"System %u.lpl\"\n"
+            "    }%s\n",
+            i % 9, i, i, i, i % 9, i % 9, i * 2654435761u, i % 9,
+            (i + 1 < n) ? "," : "");
+
+   fprintf(fp, "  ]\n}\n");
+   fclose(fp);
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned j, k;
+   char cache_file[PATH_MAX_LENGTH];
+   playlist_config_t config;
+   const char *file           = "playlist_load_bench.lpl";
+   unsigned n                 = 50000;
+   unsigned rounds            = 5;
+   unsigned errors            = 0;
+   size_t heap[2]             = {0};
+   retro_time_t best_open[2]  = {0};
+   retro_time_t best_close[2] = {0};
+   static const char *names[2] = { "json", "cache" };
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         n = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+         rounds = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-f") && i + 1 < argc)
+         file = argv[++i];
+      else
+      {
+         fprintf(stderr, "Usage: %s [-n entries] [-r rounds] [-f file]\n",
+               argv[0]);
+         return 1;
+      }
+   }
+
+   if (!bench_write_playlist(file, n))
+   {
+      fprintf(stderr, "Failed to write \"%s\".\n", file);
+      return 1;
+   }
+
+   fill_pathname(cache_file, file, FILE_PATH_LPL_CACHE_EXTENSION,
+         sizeof(cache_file));
+
+   memset(&config, 0, sizeof(config));
+   config.capacity = n;
+   playlist_config_set_path(&config, file);
+
+   for (j = 0; j < rounds; j++)
+   {
+      playlist_t *playlist[2];
+
+      remove(cache_file);
+
+      for (k = 0; k < 2; k++)
+      {
+         const struct playlist_entry *entry = NULL;
+         size_t heap_before   = bench_heap_used();
+         retro_time_t start   = cpu_features_get_time_usec();
+         retro_time_t t_open;
+
+         if (!(playlist[k] = playlist_init(&config)))
+         {
+            fprintf(stderr, "Failed to load \"%s\".\n", file);
+            return 1;
+         }
+         t_open  = cpu_features_get_time_usec() - start;
+         heap[k] = bench_heap_used() - heap_before;
+
+         if (playlist_size(playlist[k]) != n)
+            errors++;
+         playlist_get_index(playlist[k], n - 1, &entry);
+         if (!entry || !entry->label || !strstr(entry->label, "Number"))
+            errors++;
+
+         if (!j || t_open < best_open[k])
+            best_open[k] = t_open;
+      }
+
+      for (k = 0; k < n; k++)
+      {
+         const struct playlist_entry *a = NULL;
+         const struct playlist_entry *b = NULL;
+         playlist_get_index(playlist[0], k, &a);
+         playlist_get_index(playlist[1], k, &b);
+         if (!a || !b || !bench_entries_equal(a, b))
+            errors++;
+      }
+
+      for (k = 0; k < 2; k++)
+      {
+         retro_time_t start   = cpu_features_get_time_usec();
+         retro_time_t t_close;
+
+         playlist_free(playlist[k]);
+         t_close = cpu_features_get_time_usec() - start;
+
+         if (!j || t_close < best_close[k])
+            best_close[k] = t_close;
+      }
+   }
+
+   remove(file);
+   remove(cache_file);
+
+   printf("%u entries\n", n);
+   for (k = 0; k < 2; k++)
+   {
+      printf("%-6s open  %10.2f ms\n", names[k], best_open[k]  / 1000.0);
+      printf("%-6s close %10.2f ms\n", names[k], best_close[k] / 1000.0);
+      if (heap[k])
+         printf("%-6s heap  %10.2f MiB (%u bytes/entry)\n", names[k],
+               heap[k] / (1024.0 * 1024.0), (unsigned)(heap[k] / n));
+   }
+   printf("%s\n", errors ? "LOAD MISMATCH" : "entries match");
+
+   return errors ? 1 : 0;
+}
@@ -0,0 +1,359 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Replay checkpoint deduplication benchmark.
+ *
+ * Pulls every checkpoint out of one or more recorded replays and
+ * re-encodes the sequence with bsv_movie_write_deduped_state(), once
+ * with block hashing on the calling thread and once spread over the
+ * hash pool, then reports checkpoints/sec and how many bytes the
+ * block and superblock dedup saved.
+ *
+ * Usage: replay_dedup_bench [-jTHREADS] [replay files ...]
+ *
+ * Replays with zstd-compressed checkpoints are not supported, since
+ * the benchmark is built without zstd. Without arguments, a synthetic
+ * 8 MB state with sparse per-frame changes is used instead. */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include <boolean.h>
+
+/* Pick the number of hashing threads from the benchmark rather than
+ * the host, so both paths can be measured in a single run. */
+#define cpu_features_get_core_amount bench_core_amount
+
+/* The replay code is pulled in whole so that the benchmark measures
+ * the exact static functions used by the frontend. */
+#include "../../input/bsv/bsvmovie.c"
+
+#undef cpu_features_get_core_amount
+unsigned cpu_features_get_core_amount(void);
+
+#define BENCH_SYNTHETIC_SIZE   (8 << 20)
+#define BENCH_SYNTHETIC_FRAMES 64
+#define BENCH_MIN_BYTES        ((uint64_t)1 << 30)
+
+/* Frontend hooks referenced by bsvmovie.c */
+static unsigned bench_threads = 1;
+static uint8_t **bench_states = NULL;
+static unsigned bench_count   = 0;
+static size_t bench_size      = 0;
+static input_driver_state_t bench_input_st;
+static runloop_state_t bench_runloop_st;
+static settings_t bench_settings;
+
+unsigned bench_core_amount(void) { return bench_threads; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_DBG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+settings_t *config_get_ptr(void) { return &bench_settings; }
+input_driver_state_t *input_state_get_ptr(void) { return &bench_input_st; }
+runloop_state_t *runloop_state_get_ptr(void) { return &bench_runloop_st; }
+void input_keyboard_event(bool down, unsigned code, uint32_t character,
+      uint16_t mod, unsigned device) { }
+bool movie_stop(input_driver_state_t *input_st) { return true; }
+bool state_manager_frame_is_reversed(void) { return false; }
+size_t core_serialize_size(void) { return bench_size; }
+bool core_serialize(retro_ctx_serialize_info_t *info) { return false; }
+void runloop_msg_queue_push(const char *msg, size_t len,
+      unsigned prio, unsigned duration, bool flush, char *title,
+      enum message_queue_icon icon, enum message_queue_category category) { }
+
+/* Every checkpoint the replay reader hands to the core is kept */
+bool core_unserialize(retro_ctx_serialize_info_t *info)
+{
+   uint8_t *copy;
+
+   if (!bench_size)
+      bench_size = info->size;
+   else if (info->size != bench_size)
+   {
+      fprintf(stderr, "Skipping checkpoint of %u bytes (expected %u)\n",
+            (unsigned)info->size, (unsigned)bench_size);
+      return true;
+   }
+
+   if (!(copy = (uint8_t*)malloc(info->size)))
+      return false;
+   memcpy(copy, info->data_const, info->size);
+   bench_states = (uint8_t**)realloc(bench_states,
+         (bench_count + 1) * sizeof(*bench_states));
+   bench_states[bench_count++] = copy;
+   return true;
+}
+
+void bsv_movie_free(bsv_movie_t *handle)
+{
+   if (!handle)
+      return;
+   if (handle->file)
+      intfstream_close(handle->file);
+   free(handle->frame_pos);
+   RBUF_FREE(handle->checkpoints);
+   uint32s_index_free(handle->superblocks);
+   uint32s_index_free(handle->blocks);
+   free(handle->superblock_seq);
+   free(handle->block_hashes);
+   free(handle->block_same);
+   if (handle->hash_pool)
+      tpool_destroy(handle->hash_pool);
+   free(handle->last_save);
+   free(handle->cur_save);
+   free(handle);
+}
+
+static bool bench_load_replay(const char *path)
+{
+   uint32_t header[REPLAY_HEADER_LEN] = {0};
+   bsv_movie_t *movie = (bsv_movie_t*)calloc(1, sizeof(*movie));
+
+   if (!movie)
+      return false;
+
+   if (!(movie->file = intfstream_open_file(path,
+               RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE))
+         || intfstream_read(movie->file, header, REPLAY_HEADER_LEN_BYTES)
+               < REPLAY_HEADER_LEN_BYTES
+         || swap_if_big32(header[REPLAY_HEADER_MAGIC_INDEX]) != REPLAY_MAGIC)
+   {
+      fprintf(stderr, "Not a replay file: %s\n", path);
+      bsv_movie_free(movie);
+      return false;
+   }
+
+   movie->version      = swap_if_big32(header[REPLAY_HEADER_VERSION_INDEX]);
+   movie->playback     = true;
+   movie->min_file_pos = (movie->version < 2
+         ? REPLAY_HEADER_V0V1_LEN_BYTES : REPLAY_HEADER_LEN_BYTES)
+      + swap_if_big32(header[REPLAY_HEADER_STATE_SIZE_INDEX]);
+   bsv_movie_read_index(movie);
+
+   if (bsv_movie_reset_playback(movie))
+      while (bsv_movie_read_next_events(movie,
+               REPLAY_CPBEHAVIOR_DESERIALIZE, false)) { }
+
+   /* The last checkpoint is only handed over on the following frame */
+   if (movie->checkpoint_ready)
+   {
+      retro_ctx_serialize_info_t serial_info;
+      serial_info.data_const = movie->cur_save;
+      serial_info.size       = movie->cur_save_size;
+      core_unserialize(&serial_info);
+   }
+
+   bsv_movie_free(movie);
+   return true;
+}
+
+static void bench_synthesize(void)
+{
+   unsigned i;
+   uint32_t seed = 1;
+
+   bench_count  = BENCH_SYNTHETIC_FRAMES;
+   bench_size   = BENCH_SYNTHETIC_SIZE;
+   bench_states = (uint8_t**)calloc(bench_count, sizeof(*bench_states));
+
+   for (i = 0; i < bench_count; i++)
+   {
+      size_t j;
+      bench_states[i] = (uint8_t*)malloc(bench_size);
+
+      if (i == 0)
+      {
+         /* Mostly zeroes with a few random pages, like a typical state */
+         memset(bench_states[i], 0, bench_size);
+         for (j = 0; j < bench_size / 4; j++)
+         {
+            seed               = seed * 1103515245 + 12345;
+            bench_states[i][j] = (uint8_t)(seed >> 16);
+         }
+         continue;
+      }
+
+      memcpy(bench_states[i], bench_states[i - 1], bench_size);
+      /* A few hundred small writes per checkpoint */
+      for (j = 0; j < 256; j++)
+      {
+         seed = seed * 1103515245 + 12345;
+         bench_states[i][(seed >> 4) % bench_size]++;
+      }
+   }
+}
+
+static bsv_movie_t *bench_new_movie(void)
+{
+   bsv_movie_t *movie = (bsv_movie_t*)calloc(1, sizeof(*movie));
+   /* Same tuning as bsv_movie_init_record() */
+   bool is_small      = bench_size < (1 << 20);
+   size_t block_size  = is_small ? 128 : 16384;
+
+   movie->commit_interval  = 4;
+   movie->commit_threshold = 2;
+   movie->superblocks      = uint32s_index_new(16,
+         movie->commit_interval, movie->commit_threshold);
+   movie->blocks           = uint32s_index_new(block_size / 4,
+         movie->commit_interval, movie->commit_threshold);
+   return movie;
+}
+
+/* Encodes every checkpoint once; returns the encoded byte count */
+static uint64_t bench_encode_all(bsv_movie_t *movie, uint8_t *out, size_t cap)
+{
+   unsigned i;
+   uint64_t out_bytes = 0;
+
+   for (i = 0; i < bench_count; i++)
+   {
+      int64_t len;
+      /* Stand in for the cur_save/last_save swap in
+       * bsv_movie_write_checkpoint() without copying */
+      movie->last_save      = i ? bench_states[i - 1] : NULL;
+      movie->last_save_size = i ? bench_size : 0;
+      movie->cur_save_valid = i > 0;
+      movie->frame_counter++;
+      len = bsv_movie_write_deduped_state(movie, bench_states[i],
+            bench_size, out, cap);
+      if (len < 0)
+         return 0;
+      out_bytes += (uint64_t)len;
+   }
+   movie->last_save = NULL;
+   return out_bytes;
+}
+
+static bool bench_verify(uint8_t *out, size_t cap)
+{
+   unsigned i;
+   bool ok              = true;
+   bsv_movie_t *encoder = bench_new_movie();
+   bsv_movie_t *decoder = bench_new_movie();
+
+   decoder->cur_save       = (uint8_t*)malloc(bench_size);
+   decoder->cur_save_size  = bench_size;
+   decoder->last_save_size = bench_size;
+
+   for (i = 0; i < bench_count && ok; i++)
+   {
+      int64_t len;
+      encoder->last_save      = i ? bench_states[i - 1] : NULL;
+      encoder->last_save_size = i ? bench_size : 0;
+      encoder->cur_save_valid = i > 0;
+      encoder->frame_counter++;
+      len = bsv_movie_write_deduped_state(encoder, bench_states[i],
+            bench_size, out, cap);
+      ok  = len > 0
+         && bsv_movie_read_deduped_state(decoder, out, (size_t)len)
+         && !memcmp(decoder->cur_save, bench_states[i], bench_size);
+      if (!ok)
+         printf("FAILED round trip on checkpoint %u\n", i);
+   }
+
+   encoder->last_save = NULL;
+   bsv_movie_free(encoder);
+   bsv_movie_free(decoder);
+   return ok;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned runs[2];
+   unsigned cores = cpu_features_get_core_amount();
+   size_t cap;
+   uint8_t *out;
+
+   int replays    = 0;
+
+   for (i = 1; i < argc; i++)
+   {
+      /* -jN overrides the detected core count */
+      if (!strncmp(argv[i], "-j", 2))
+      {
+         if (atoi(argv[i] + 2) > 0)
+            cores = (unsigned)atoi(argv[i] + 2);
+         continue;
+      }
+      bench_load_replay(argv[i]);
+      replays++;
+   }
+   if (!replays)
+      bench_synthesize();
+
+   if (bench_count < 2)
+   {
+      fprintf(stderr, "Need at least two checkpoints.\n");
+      return 1;
+   }
+
+   printf("%u checkpoints of %u bytes\n", bench_count, (unsigned)bench_size);
+
+   /* Generous bound: every block new, plus msgpack framing */
+   cap = bench_size * 2 + 4096;
+   out = (uint8_t*)malloc(cap);
+
+   bench_threads = cores;
+   if (!bench_verify(out, cap))
+      return 1;
+
+   runs[0] = 1;
+   runs[1] = cores;
+
+   for (i = 0; i < (cores > 1 ? 2 : 1); i++)
+   {
+      retro_time_t start, elapsed;
+      uint64_t in_bytes    = 0;
+      uint64_t out_bytes   = 0;
+      uint64_t checkpoints = 0;
+
+      bench_threads = runs[i];
+
+      /* Each pass starts from an empty index, as a new recording would */
+      start = cpu_features_get_time_usec();
+      do
+      {
+         bsv_movie_t *movie = bench_new_movie();
+         out_bytes   += bench_encode_all(movie, out, cap);
+         in_bytes    += (uint64_t)bench_size * bench_count;
+         checkpoints += bench_count;
+         bsv_movie_free(movie);
+      } while (in_bytes < BENCH_MIN_BYTES);
+      elapsed = cpu_features_get_time_usec() - start;
+
+      printf("%2u thread%s %10.1f checkpoints/s %8.1f MB/s, "
+            "%llu of %llu bytes deduplicated (%.2f%%)\n",
+            runs[i], runs[i] == 1 ? " " : "s",
+            checkpoints * 1000000.0 / (elapsed ? elapsed : 1),
+            in_bytes / (double)(elapsed ? elapsed : 1),
+            (unsigned long long)(in_bytes - out_bytes),
+            (unsigned long long)in_bytes,
+            100.0 * (in_bytes - out_bytes) / in_bytes);
+   }
+
+   for (i = 0; i < (int)bench_count; i++)
+      free(bench_states[i]);
+   free(bench_states);
+   free(out);
+   return 0;
+}
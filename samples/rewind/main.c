@@ -0,0 +1,224 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Rewind delta encoder benchmark.
+ *
+ * Feeds consecutive savestates through state_manager_raw_compress()
+ * once per delta scanner variant compiled in and supported by the
+ * host CPU, and reports the throughput of each.
+ *
+ * Usage: rewind_bench [state files ...]
+ *
+ * The state files should be consecutive savestates of the same
+ * core and content (e.g. saved a few frames apart); rzip-compressed
+ * states are unpacked transparently. Without arguments, a synthetic
+ * 8 MB state with sparse per-frame changes is used instead. */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include <boolean.h>
+
+#include <streams/rzip_stream.h>
+
+/* The state manager is pulled in whole so that the benchmark
+ * measures the exact static functions used by the frontend. */
+#include "../../state_manager.c"
+
+#define BENCH_SYNTHETIC_SIZE   (8 << 20)
+#define BENCH_SYNTHETIC_FRAMES 32
+#define BENCH_MIN_BYTES        ((uint64_t)1 << 31)
+
+/* Frontend hooks referenced by state_manager.c */
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+void audio_driver_setup_rewind(void) { }
+bool audio_driver_has_callback(void) { return false; }
+void audio_driver_frame_is_reverse(void) { }
+void audio_driver_sample(int16_t left, int16_t right) { }
+size_t audio_driver_sample_batch(const int16_t *data, size_t frames) { return frames; }
+void audio_driver_sample_rewind(int16_t left, int16_t right) { }
+size_t audio_driver_sample_batch_rewind(const int16_t *data, size_t frames) { return frames; }
+size_t content_get_serialized_size_rewind(void) { return 0; }
+bool content_serialize_state_rewind(void *buffer, size_t buffer_size) { return false; }
+bool content_deserialize_state(const void *serialized_data, size_t serialized_size) { return false; }
+bool core_info_get_current_core(core_info_t **core) { return false; }
+bool core_info_current_supports_rewind(void) { return false; }
+bool retroarch_ctl(enum rarch_ctl_state state, void *data) { return false; }
+void runloop_msg_queue_push(const char *msg, size_t len,
+      unsigned prio, unsigned duration, bool flush, char *title,
+      enum message_queue_icon icon, enum message_queue_category category) { }
+
+static uint8_t **bench_load_states(int argc, char *argv[],
+      unsigned *count, size_t *size)
+{
+   unsigned i;
+   uint8_t **states = NULL;
+
+   if (argc < 2)
+   {
+      uint32_t seed = 1;
+
+      *count = BENCH_SYNTHETIC_FRAMES;
+      *size  = BENCH_SYNTHETIC_SIZE;
+      states = (uint8_t**)calloc(*count, sizeof(*states));
+
+      for (i = 0; i < *count; i++)
+      {
+         size_t j;
+         states[i] = (uint8_t*)state_manager_raw_alloc(*size, i & 1);
+
+         if (i == 0)
+         {
+            for (j = 0; j < *size; j++)
+            {
+               seed         = seed * 1103515245 + 12345;
+               states[i][j] = (uint8_t)(seed >> 16);
+            }
+            continue;
+         }
+
+         memcpy(states[i], states[i - 1], *size);
+         /* ~0.5% of the bytes change per frame, in short runs */
+         for (j = 0; j < *size / 1024; j++)
+         {
+            size_t k;
+            size_t pos;
+            seed = seed * 1103515245 + 12345;
+            pos  = (seed >> 4) % (*size - 8);
+            for (k = 0; k < 5; k++)
+               states[i][pos + k]++;
+         }
+      }
+
+      return states;
+   }
+
+   *count = argc - 1;
+   *size  = 0;
+   states = (uint8_t**)calloc(*count, sizeof(*states));
+
+   for (i = 0; i < *count; i++)
+   {
+      void *buf   = NULL;
+      int64_t len = 0;
+
+      if (!rzipstream_read_file(argv[i + 1], &buf, &len) || len <= 0)
+      {
+         fprintf(stderr, "Failed to read state: %s\n", argv[i + 1]);
+         exit(1);
+      }
+
+      if (!*size)
+         *size = (size_t)len;
+      else if ((size_t)len != *size)
+      {
+         fprintf(stderr, "State size mismatch: %s\n", argv[i + 1]);
+         exit(1);
+      }
+
+      states[i] = (uint8_t*)state_manager_raw_alloc(*size, i & 1);
+      memcpy(states[i], buf, *size);
+      free(buf);
+   }
+
+   return states;
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   size_t size      = 0;
+   unsigned count   = 0;
+   uint64_t cpu     = state_manager_cpu_features();
+   uint8_t **states = NULL;
+   uint8_t *patch   = NULL;
+   uint8_t *check   = NULL;
+
+   rzipstream_init_threads();
+   states = bench_load_states(argc, argv, &count, &size);
+   rzipstream_deinit_threads();
+
+   if (count < 2)
+   {
+      fprintf(stderr, "Need at least two states.\n");
+      return 1;
+   }
+
+   patch = (uint8_t*)malloc(state_manager_raw_maxsize(size));
+   check = (uint8_t*)state_manager_raw_alloc(size, 0);
+
+   printf("%u states of %u bytes\n", count, (unsigned)size);
+
+   for (i = 0; i < ARRAY_SIZE(state_manager_scanners); i++)
+   {
+      unsigned j;
+      retro_time_t start, elapsed;
+      uint64_t bytes     = 0;
+      uint64_t out_bytes = 0;
+      const struct state_manager_scanner *scanner =
+         &state_manager_scanners[i];
+
+      if ((cpu & scanner->simd) != scanner->simd)
+      {
+         printf("%-8s unsupported by this CPU\n", scanner->ident);
+         continue;
+      }
+
+      find_change = scanner->find_change;
+      find_same   = scanner->find_same;
+
+      /* Verify the patches before timing anything */
+      for (j = 1; j < count; j++)
+      {
+         state_manager_raw_compress(states[j - 1], states[j], size, patch);
+         memcpy(check, states[j], size);
+         state_manager_raw_decompress(patch, check);
+         if (memcmp(check, states[j - 1], size))
+         {
+            printf("%-8s FAILED round trip on state %u\n",
+                  scanner->ident, j);
+            return 1;
+         }
+      }
+
+      start = cpu_features_get_time_usec();
+      do
+      {
+         for (j = 1; j < count; j++)
+         {
+            out_bytes += state_manager_raw_compress(
+                  states[j - 1], states[j], size, patch);
+            bytes     += size;
+         }
+      } while (bytes < BENCH_MIN_BYTES);
+      elapsed = cpu_features_get_time_usec() - start;
+
+      printf("%-8s %8.3f GB/s, %8.1f us/state, %5.2f%% patch size\n",
+            scanner->ident,
+            (double)bytes / (elapsed ? elapsed : 1) / 1000.0,
+            (double)elapsed * size / bytes,
+            100.0 * out_bytes / bytes);
+   }
+
+   for (i = 0; i < count; i++)
+      free(states[i]);
+   free(states);
+   free(patch);
+   free(check);
+
+   return 0;
+}
@@ -0,0 +1,203 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Thread pool scheduling benchmark.
+ *
+ * Measures what it costs to get a piece of work run by the pool:
+ * once for independent jobs queued with tpool_add_work(), and once
+ * for tpool_parallel_for() at a range of grain sizes, over a loop
+ * whose body is cheap enough that scheduling dominates. Every loop
+ * is checked against a serial run.
+ *
+ * Usage: tpool_bench [-t threads] [-n iterations] [-j jobs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <compat/strl.h>
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+
+#define BENCH_RUNS 3
+
+struct bench_loop
+{
+   const uint32_t *in;
+   uint32_t *out;
+};
+
+static slock_t *bench_lock;
+static unsigned bench_jobs_done;
+
+static void bench_job(void *arg)
+{
+   slock_lock(bench_lock);
+   bench_jobs_done++;
+   slock_unlock(bench_lock);
+}
+
+static void bench_body(size_t begin, size_t end, void *arg)
+{
+   struct bench_loop *loop = (struct bench_loop*)arg;
+   size_t i;
+
+   for (i = begin; i < end; i++)
+   {
+      uint32_t v  = loop->in[i];
+      v          ^= v >> 16;
+      v          *= 0x7feb352dU;
+      v          ^= v >> 15;
+      loop->out[i] = v;
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   static const size_t grains[] = { 1, 4, 16, 64, 256, 4096, 0 };
+   int i;
+   size_t g, k;
+   unsigned cores    = cpu_features_get_core_amount();
+   unsigned threads  = cores;
+   unsigned busy;
+   size_t n          = 1 << 22;
+   unsigned jobs     = 200000;
+   struct bench_loop loop;
+   uint32_t *in, *out, *ref;
+   retro_time_t start, serial;
+   tpool_t *tp;
+   int ret           = 0;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-t") && i + 1 < argc)
+         threads = (unsigned)atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         n = (size_t)atol(argv[++i]);
+      else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+         jobs = (unsigned)atoi(argv[++i]);
+      else
+      {
+         fprintf(stderr, "Usage: %s [-t threads] [-n iterations] [-j jobs]\n",
+               argv[0]);
+         return 1;
+      }
+   }
+
+   if (!threads)
+      threads = 1;
+   /* The calling thread takes part in loops too */
+   busy = MIN(threads + 1, cores);
+
+   in  = (uint32_t*)malloc(n * sizeof(uint32_t));
+   out = (uint32_t*)malloc(n * sizeof(uint32_t));
+   ref = (uint32_t*)malloc(n * sizeof(uint32_t));
+   if (!in || !out || !ref || !(tp = tpool_create(threads)))
+   {
+      fprintf(stderr, "Out of memory.\n");
+      return 1;
+   }
+   bench_lock = slock_new();
+
+   for (k = 0; k < n; k++)
+      in[k] = (uint32_t)(k * 2654435761U);
+   /* Fault the output pages in up front, the serial run
+    * would pay for it otherwise. */
+   memset(out, 0, n * sizeof(uint32_t));
+   memset(ref, 0, n * sizeof(uint32_t));
+
+   printf("%u worker threads, %u cores\n", threads, cores);
+
+   /* Independent jobs */
+   start = cpu_features_get_time_usec();
+   for (k = 0; k < jobs; k++)
+      tpool_add_work(tp, bench_job, NULL);
+   tpool_wait(tp);
+   start = cpu_features_get_time_usec() - start;
+   printf("%-18s %8.1f ns/job\n", "add_work + wait",
+         start * 1000.0 / jobs);
+   if (bench_jobs_done != jobs)
+   {
+      printf("%u of %u jobs ran\n", bench_jobs_done, jobs);
+      ret = 1;
+   }
+
+   /* Data parallel loop */
+   loop.in  = in;
+   loop.out = ref;
+   serial   = 0;
+   for (k = 0; k < BENCH_RUNS; k++)
+   {
+      retro_time_t elapsed;
+      start   = cpu_features_get_time_usec();
+      bench_body(0, n, &loop);
+      elapsed = cpu_features_get_time_usec() - start;
+      if (!serial || elapsed < serial)
+         serial = elapsed;
+   }
+   printf("%-18s %8.2f ns/iteration\n", "serial", serial * 1000.0 / n);
+
+   loop.out = out;
+   for (g = 0; g < ARRAY_SIZE(grains); g++)
+   {
+      retro_time_t elapsed = 0;
+      char name[32];
+      size_t grain         = grains[g];
+
+      for (k = 0; k < BENCH_RUNS; k++)
+      {
+         retro_time_t t;
+         memset(out, 0, n * sizeof(uint32_t));
+         start = cpu_features_get_time_usec();
+         tpool_parallel_for(tp, 0, n, grain, bench_body, &loop);
+         t     = cpu_features_get_time_usec() - start;
+         if (!elapsed || t < elapsed)
+            elapsed = t;
+      }
+
+      if (grain)
+         snprintf(name, sizeof(name), "grain %u", (unsigned)grain);
+      else
+         strlcpy(name, "grain auto", sizeof(name));
+
+      printf("%-18s %8.2f ns/iteration, %.2fx", name,
+            elapsed * 1000.0 / n,
+            elapsed ? (double)serial / elapsed : 0.0);
+
+      /* Scheduling overhead is the CPU time the pool spent on
+       * top of the serial loop, spread over the grains. */
+      if (grain)
+         printf(", %6.1f ns/grain overhead",
+               (elapsed * (double)busy - serial) * 1000.0
+               / ((n + grain - 1) / grain));
+
+      printf("%s\n",
+            memcmp(out, ref, n * sizeof(uint32_t)) ? ", MISMATCH" : "");
+
+      if (memcmp(out, ref, n * sizeof(uint32_t)))
+         ret = 1;
+   }
+
+   tpool_destroy(tp);
+   slock_free(bench_lock);
+   free(in);
+   free(out);
+   free(ref);
+
+   return ret;
+}
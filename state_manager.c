@@ -24,8 +24,10 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <features/features_cpu.h>
 
 #include "state_manager.h"
 #include "msg_hash.h"
@@ -61,8 +63,31 @@
 #define NO_UNALIGNED_MEM
 #endif
 
-#if __SSE2__
-#include <emmintrin.h>
+/* The x86 scanners are built with per-function target
+ * attributes, so they are always compiled in and only
+ * picked at runtime when the CPU supports them. */
+#if defined(CPU_X86) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define STATE_MANAGER_X86_SIMD
+#define STATE_MANAGER_TARGET(isa) __attribute__((target(isa)))
+#include <cpuid.h>
+#elif defined(CPU_X86) && defined(_MSC_VER) && _MSC_VER >= 1910
+#define STATE_MANAGER_X86_SIMD
+#define STATE_MANAGER_TARGET(isa)
+#include <intrin.h>
+#endif
+
+#ifdef STATE_MANAGER_X86_SIMD
+#include <immintrin.h>
+
+/* libretro.h has no RETRO_SIMD flag for AVX-512, so
+ * state_manager_cpu_features() reports it with this
+ * private bit instead. */
+#define STATE_MANAGER_SIMD_AVX512BW (UINT64_C(1) << 63)
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define STATE_MANAGER_NEON
 #endif
 
 /* Format per frame (pseudocode): */
@@ -85,35 +110,19 @@ repeat {
 size thisstart;
 #endif
 
+/* The scanners below don't check bounds, they rely on
+ * the end-of-buffer marker and padding written by
+ * state_manager_raw_alloc() to stop.
+ *
+ * find_change returns the uint16 offset of the first word
+ * that differs, find_same the uint16 offset of the first
+ * uint32 (relative to 'a') that is identical again. */
+typedef size_t (*state_manager_scan_t)(const uint16_t *a, const uint16_t *b);
+
 /* There's no equivalent in libc, you'd think so ...
  * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
+static size_t find_change_c(const uint16_t *a, const uint16_t *b)
 {
-#if __SSE2__
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
-
-   for (;;)
-   {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
-      __m128i c     = _mm_cmpeq_epi8(v0, v1);
-      uint32_t mask = _mm_movemask_epi8(c);
-
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         /* calculate the real offset to the differing byte */
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask)));
-
-         /* and convert that to the uint16_t offset */
-         return (ret >> 1);
-      }
-
-      a128++;
-      b128++;
-   }
-#else
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
    while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
@@ -142,10 +151,9 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       }
    }
    return a - a_org;
-#endif
 }
 
-static size_t find_same(const uint16_t *a, const uint16_t *b)
+static size_t find_same_c(const uint16_t *a, const uint16_t *b)
 {
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -185,6 +193,322 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
+/* The SIMD variants of find_same compare the same uint32
+ * lanes as find_same_c, so all variants produce identical
+ * patches. */
+#if defined(STATE_MANAGER_X86_SIMD)
+static STATE_MANAGER_TARGET("sse2") size_t find_change_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi8(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask != 0xffff) /* Something has changed, figure out where. */
+      {
+         /* calculate the real offset to the differing byte */
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+
+         /* and convert that to the uint16_t offset */
+         return (ret >> 1);
+      }
+
+      a128++;
+      b128++;
+   }
+}
+
+static STATE_MANAGER_TARGET("sse2") size_t find_same_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask)
+      {
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a)
+               + compat_ctz(mask)) >> 1;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+
+      a128++;
+      b128++;
+   }
+}
+
+static STATE_MANAGER_TARGET("avx2") size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi8(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffff)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+         return (ret >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+static STATE_MANAGER_TARGET("avx2") size_t find_same_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a)
+               + compat_ctz(mask)) >> 1;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+static STATE_MANAGER_TARGET("avx512f,avx512bw") size_t find_change_avx512(const uint16_t *a, const uint16_t *b)
+{
+   const __m512i *a512 = (const __m512i*)a;
+   const __m512i *b512 = (const __m512i*)b;
+
+   for (;;)
+   {
+      __m512i v0    = _mm512_loadu_si512(a512);
+      __m512i v1    = _mm512_loadu_si512(b512);
+      uint64_t mask = _mm512_cmpneq_epi8_mask(v0, v1);
+
+      if (mask)
+      {
+         size_t ret = ((uint8_t*)a512 - (uint8_t*)a);
+         if ((uint32_t)mask)
+            ret    += compat_ctz((uint32_t)mask);
+         else
+            ret    += 32 + compat_ctz((uint32_t)(mask >> 32));
+         return (ret >> 1);
+      }
+
+      a512++;
+      b512++;
+   }
+}
+
+static STATE_MANAGER_TARGET("avx512f,avx512bw") size_t find_same_avx512(const uint16_t *a, const uint16_t *b)
+{
+   const __m512i *a512 = (const __m512i*)a;
+   const __m512i *b512 = (const __m512i*)b;
+
+   for (;;)
+   {
+      __m512i v0    = _mm512_loadu_si512(a512);
+      __m512i v1    = _mm512_loadu_si512(b512);
+      uint32_t mask = _mm512_cmpeq_epi32_mask(v0, v1);
+
+      if (mask)
+      {
+         /* One mask bit per uint32 lane */
+         size_t ret = (((uint8_t*)a512 - (uint8_t*)a) >> 1)
+            + compat_ctz(mask) * 2;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+
+      a512++;
+      b512++;
+   }
+}
+#endif
+
+#if defined(STATE_MANAGER_NEON)
+/* NEON has no movemask; narrowing the compare result
+ * leaves a 64-bit mask with 4 bits per byte instead. */
+static INLINE uint64_t neon_mask_u8(uint8x16_t c)
+{
+   return vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(c), 4)), 0);
+}
+
+static INLINE unsigned neon_ctz64(uint64_t mask)
+{
+   if ((uint32_t)mask)
+      return compat_ctz((uint32_t)mask);
+   return 32 + compat_ctz((uint32_t)(mask >> 32));
+}
+
+static size_t find_change_neon(const uint16_t *a, const uint16_t *b)
+{
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      uint8x16_t c  = vceqq_u8(vld1q_u8(a8), vld1q_u8(b8));
+      uint64_t mask = ~neon_mask_u8(c);
+
+      if (mask)
+         return ((a8 - (const uint8_t*)a)
+               + (neon_ctz64(mask) >> 2)) >> 1;
+
+      a8 += 16;
+      b8 += 16;
+   }
+}
+
+static size_t find_same_neon(const uint16_t *a, const uint16_t *b)
+{
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      uint32x4_t c  = vceqq_u32(
+            vreinterpretq_u32_u8(vld1q_u8(a8)),
+            vreinterpretq_u32_u8(vld1q_u8(b8)));
+      uint64_t mask = neon_mask_u8(vreinterpretq_u8_u32(c));
+
+      if (mask)
+      {
+         size_t ret = ((a8 - (const uint8_t*)a)
+               + (neon_ctz64(mask) >> 2)) >> 1;
+         if (ret && a[ret - 1] == b[ret - 1])
+            ret--;
+         return ret;
+      }
+
+      a8 += 16;
+      b8 += 16;
+   }
+}
+#endif
+
+struct state_manager_scanner
+{
+   const char *ident;
+   /* RETRO_SIMD_* flags required by this variant */
+   uint64_t simd;
+   state_manager_scan_t find_change;
+   state_manager_scan_t find_same;
+};
+
+/* Ordered from fastest to slowest; the first one
+ * supported by the host CPU is used. */
+static const struct state_manager_scanner state_manager_scanners[] = {
+#if defined(STATE_MANAGER_X86_SIMD)
+   { "avx512", STATE_MANAGER_SIMD_AVX512BW,
+                                find_change_avx512, find_same_avx512 },
+   { "avx2",   RETRO_SIMD_AVX | RETRO_SIMD_AVX2,
+                                find_change_avx2,   find_same_avx2   },
+   { "sse2",   RETRO_SIMD_SSE2, find_change_sse2,   find_same_sse2   },
+#endif
+#if defined(STATE_MANAGER_NEON)
+   { "neon",   RETRO_SIMD_NEON, find_change_neon,   find_same_neon   },
+#endif
+   { "c",      0,               find_change_c,      find_same_c      }
+};
+
+static state_manager_scan_t find_change = find_change_c;
+static state_manager_scan_t find_same   = find_same_c;
+
+/* cpu_features_get(), plus STATE_MANAGER_SIMD_AVX512BW
+ * when the CPU has AVX-512BW and the OS saves the opmask
+ * and ZMM registers. */
+static uint64_t state_manager_cpu_features(void)
+{
+   uint64_t cpu = cpu_features_get();
+#if defined(STATE_MANAGER_X86_SIMD)
+   uint32_t leaf7_ebx;
+   uint64_t xcr0;
+
+   /* RETRO_SIMD_AVX already implies CPUID leaf 7 and
+    * XGETBV are usable */
+   if ((cpu & (RETRO_SIMD_AVX | RETRO_SIMD_AVX2))
+         != (RETRO_SIMD_AVX | RETRO_SIMD_AVX2))
+      return cpu;
+
+#if defined(_MSC_VER)
+   {
+      int regs[4];
+      __cpuidex(regs, 7, 0);
+      leaf7_ebx = (uint32_t)regs[1];
+      xcr0      = _xgetbv(0);
+   }
+#else
+   {
+      unsigned eax, ebx, ecx, edx;
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      leaf7_ebx = ebx;
+      /* xgetbv, stamped out as in features_cpu.c */
+      __asm__ volatile (".byte 0x0f, 0x01, 0xd0\n"
+            : "=a"(eax), "=d"(edx) : "c"(0));
+      xcr0      = ((uint64_t)edx << 32) | eax;
+   }
+#endif
+
+   /* AVX512F (bit 16) and AVX512BW (bit 30), with the
+    * opmask, ZMM_Hi256 and Hi16_ZMM state enabled */
+   if (     (leaf7_ebx & (1u << 16))
+         && (leaf7_ebx & (1u << 30))
+         && ((xcr0 & 0xe6) == 0xe6))
+      cpu |= STATE_MANAGER_SIMD_AVX512BW;
+#endif
+   return cpu;
+}
+
+static const struct state_manager_scanner *state_manager_scanner_select(
+      uint64_t cpu)
+{
+   size_t i;
+
+   for (i = 0; i < ARRAY_SIZE(state_manager_scanners); i++)
+   {
+      const struct state_manager_scanner *scanner =
+         &state_manager_scanners[i];
+
+      if ((cpu & scanner->simd) == scanner->simd)
+      {
+         find_change = scanner->find_change;
+         find_same   = scanner->find_same;
+         return scanner;
+      }
+   }
+
+   return NULL;
+}
+
 /* Returns the maximum compressed size of a savestate.
  * It is very likely to compress to far less. */
 static size_t state_manager_raw_maxsize(size_t uncomp)
@@ -199,6 +523,15 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
       3; /* three u16 to end it */
 }
 
+/* Stamps the end-of-buffer marker of a block returned
+ * from state_manager_raw_alloc(); see there for details. */
+static INLINE void state_manager_raw_set_uniq(void *data,
+      size_t len, uint16_t uniq)
+{
+   size_t _len = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
+   ((uint16_t*)data)[_len / sizeof(uint16_t) + 3] = uniq;
+}
+
 /*
  * See state_manager_raw_compress for information about this.
  * When you're done with it, send it to free().
@@ -206,7 +539,7 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
 static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  _len  = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(_len + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(_len + sizeof(uint16_t) * 4 + 64, 1);
 
    if (!ret)
       return NULL;
@@ -220,9 +553,9 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
-   ret[_len / sizeof(uint16_t) + 3] = uniq;
+    * It doesn't make any difference to us, but sacrificing 64 bytes
+    * (one AVX-512 load) to get Valgrind happy is worth it. */
+   state_manager_raw_set_uniq(ret, len, uniq);
 
    return ret;
 }
@@ -374,11 +707,66 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+/* Bytes of the ring buffer holding history */
+static size_t state_manager_used(const state_manager_t *state)
+{
+   return (state->head - state->tail + state->capacity)
+      % state->capacity;
+}
+
+#ifdef HAVE_THREADS
+/* Blocks until the encoder thread has consumed every queued
+ * snapshot. Afterwards the thread is idle and the main thread
+ * may safely touch the ring buffer again. */
+static void state_manager_thread_flush(state_manager_t *state)
+{
+   if (!state->thread)
+      return;
+
+   slock_lock(state->lock);
+   while (state->slot_read != state->slot_write)
+      scond_wait(state->cond, state->lock);
+   slock_unlock(state->lock);
+}
+#endif
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   {
+      unsigned i;
+
+      if (state->thread)
+      {
+         slock_lock(state->lock);
+         state->thread_quit = true;
+         scond_signal(state->cond);
+         slock_unlock(state->lock);
+
+         sthread_join(state->thread);
+      }
+
+      if (state->lock)
+         slock_free(state->lock);
+      if (state->cond)
+         scond_free(state->cond);
+
+      for (i = 0; i < STATE_MANAGER_THREAD_SLOTS; i++)
+      {
+         if (state->slots[i])
+            free(state->slots[i]);
+         state->slots[i] = NULL;
+      }
+
+      state->thread = NULL;
+      state->lock   = NULL;
+      state->cond   = NULL;
+   }
+#endif
+
    if (state->data)
       free(state->data);
    if (state->thisblock)
@@ -390,61 +778,107 @@ static void state_manager_free(state_manager_t *state)
       free(state->debugblock);
    state->debugblock = NULL;
 #endif
-   state->data       = NULL;
-   state->thisblock  = NULL;
-   state->nextblock  = NULL;
+   if (state->patchblock)
+      free(state->patchblock);
+   if (state->compress_stream)
+      state->compress_backend->stream_free(state->compress_stream);
+   if (state->decompress_stream)
+      state->compress_backend->reverse->stream_free(
+            state->decompress_stream);
+   state->data              = NULL;
+   state->thisblock         = NULL;
+   state->nextblock         = NULL;
+   state->patchblock        = NULL;
+   state->compress_stream   = NULL;
+   state->decompress_stream = NULL;
 }
 
-static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
-{
-   size_t max_comp_size, block_size;
-   uint8_t *next_block    = NULL;
-   uint8_t *this_block    = NULL;
-   uint8_t *state_data    = NULL;
-   state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
+/* Second compression stage.
+ *
+ * Each packed patch starts with a uint32 holding its packed size;
+ * patches that don't shrink are stored as-is with
+ * STATE_MANAGER_PATCH_RAW set in that size instead. */
+#define STATE_MANAGER_PATCH_RAW 0x80000000u
 
-   if (!state)
-      return NULL;
+static void *state_manager_stream_new(
+      const struct trans_stream_backend *backend)
+{
+   void *stream = backend->stream_new();
+   /* Favour speed, this runs for every pushed state */
+   if (stream && backend->define)
+      backend->define(stream, "level", 1);
+   return stream;
+}
 
-   block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   /* the compressed data is surrounded by pointers to the other side */
-   max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
-   state_data         = (uint8_t*)malloc(buffer_size);
+static size_t state_manager_patch_pack(state_manager_t *state,
+      const uint8_t *patch, size_t len, uint8_t *out)
+{
+   uint32_t rd                 = 0;
+   uint32_t wn                 = 0;
+   uint32_t header             = (uint32_t)len | STATE_MANAGER_PATCH_RAW;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+   const struct trans_stream_backend *backend = state->compress_backend;
+   uint8_t *payload            = out + sizeof(uint32_t);
+
+   if (state->compress_stream)
+   {
+      backend->set_in(state->compress_stream, patch, (uint32_t)len);
+      backend->set_out(state->compress_stream, payload, (uint32_t)len);
 
-   if (!state_data)
-      goto error;
+      if (     backend->trans(state->compress_stream, true, &rd, &wn, &err)
+            && err == TRANS_STREAM_ERROR_NONE
+            && wn < len)
+         header = wn;
+      else
+      {
+         /* Output didn't fit; the stream may be left mid-frame,
+          * so start from a fresh one next time. */
+         backend->stream_free(state->compress_stream);
+         state->compress_stream = state_manager_stream_new(backend);
+      }
+   }
 
-   this_block         = (uint8_t*)state_manager_raw_alloc(state_size, 0);
-   next_block         = (uint8_t*)state_manager_raw_alloc(state_size, 1);
+   if (header & STATE_MANAGER_PATCH_RAW)
+   {
+      memcpy(payload, patch, len);
+      wn = (uint32_t)len;
+   }
 
-   if (!this_block || !next_block)
-      goto error;
+   memcpy(out, &header, sizeof(header));
+   return sizeof(header) + wn;
+}
 
-   state->blocksize   = block_size;
-   state->maxcompsize = max_comp_size;
-   state->data        = state_data;
-   state->thisblock   = this_block;
-   state->nextblock   = next_block;
-   state->capacity    = buffer_size;
+/* Returns the uncompressed patch, either in place or unpacked
+ * into state->patchblock. */
+static const uint8_t *state_manager_patch_unpack(state_manager_t *state,
+      const uint8_t *in)
+{
+   uint32_t header;
+   uint32_t rd                 = 0;
+   uint32_t wn                 = 0;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+   const struct trans_stream_backend *backend = state->compress_backend->reverse;
 
-   state->head        = state->data + sizeof(size_t);
-   state->tail        = state->data + sizeof(size_t);
+   memcpy(&header, in, sizeof(header));
+   in += sizeof(header);
 
-#if STRICT_BUF_SIZE
-   state->debugsize   = state_size;
-   state->debugblock  = (uint8_t*)malloc(state_size);
-#endif
+   if (header & STATE_MANAGER_PATCH_RAW)
+      return in;
 
-   return state;
+   backend->set_in(state->decompress_stream, in, header);
+   backend->set_out(state->decompress_stream, state->patchblock,
+         (uint32_t)state_manager_raw_maxsize(state->blocksize));
 
-error:
-   if (state_data)
-      free(state_data);
-   state_manager_free(state);
-   free(state);
+   if (     !backend->trans(state->decompress_stream, true, &rd, &wn, &err)
+         || err != TRANS_STREAM_ERROR_NONE)
+   {
+      RARCH_ERR("[Rewind] Failed to unpack state.\n");
+      backend->stream_free(state->decompress_stream);
+      state->decompress_stream = state_manager_stream_new(backend);
+      return NULL;
+   }
 
-   return NULL;
+   return state->patchblock;
 }
 
 static bool state_manager_pop(state_manager_t *state, const void **data)
@@ -455,6 +889,10 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = NULL;
 
+#ifdef HAVE_THREADS
+   state_manager_thread_flush(state);
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid    = false;
@@ -472,6 +910,17 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
    compressed                   = state->data + start + sizeof(size_t);
    out                          = state->thisblock;
 
+   if (state->compress_backend)
+   {
+      if (!(compressed = state_manager_patch_unpack(state, compressed)))
+      {
+         /* Can't go back any further, drop the remaining history */
+         state->head            = state->tail;
+         state->entries         = 0;
+         return false;
+      }
+   }
+
    state_manager_raw_decompress(compressed, out);
 
    state->entries--;
@@ -480,6 +929,38 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
 static void state_manager_push_where(state_manager_t *state, void **data)
 {
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      bool restore = false;
+
+      /* Only wait here if the encoder has fallen behind
+       * by a full ring of snapshots. */
+      slock_lock(state->lock);
+      while (state->slot_write - state->slot_read
+            >= STATE_MANAGER_THREAD_SLOTS)
+         scond_wait(state->cond, state->lock);
+      /* thisblock_valid is owned by the encoder thread
+       * unless the queue is empty. */
+      restore = (state->slot_read == state->slot_write)
+         && !state->thisblock_valid;
+      slock_unlock(state->lock);
+
+      if (restore)
+      {
+         const void *ignored;
+         if (state_manager_pop(state, &ignored))
+         {
+            state->thisblock_valid = true;
+            state->entries++;
+         }
+      }
+
+      *data = state->slots[state->slot_write % STATE_MANAGER_THREAD_SLOTS];
+      return;
+   }
+#endif
+
    /* We need to ensure we have an uncompressed copy of the last
     * pushed state, or we could end up applying a 'patch' to wrong
     * savestate, and that'd blow up rather quickly. */
@@ -500,24 +981,24 @@ static void state_manager_push_where(state_manager_t *state, void **data)
 #endif
 }
 
-static void state_manager_push_do(state_manager_t *state)
+/* Appends the delta between 'thisblock' and 'block' to the
+ * ring buffer, then makes 'block' the new 'thisblock'.
+ * Returns the buffer that is no longer in use, which the
+ * caller should serialize the next state into. */
+static uint8_t *state_manager_push_encode(state_manager_t *state,
+      uint8_t *block)
 {
    uint8_t *swap = NULL;
 
-#if STRICT_BUF_SIZE
-   memcpy(state->nextblock, state->debugblock, state->debugsize);
-#endif
-
    if (state->thisblock_valid)
    {
       uint8_t *compressed;
-      const uint8_t *oldb, *newb;
       size_t headpos, tailpos, remaining;
       if (state->capacity < sizeof(size_t) + state->maxcompsize)
       {
          RARCH_ERR("[Rewind] %s.\n",
                msg_hash_to_str(MSG_REWIND_BUFFER_CAPACITY_INSUFFICIENT));
-         return;
+         return block;
       }
 
 recheckcapacity:;
@@ -533,12 +1014,22 @@ recheckcapacity:;
          goto recheckcapacity;
       }
 
-      oldb              = state->thisblock;
-      newb              = state->nextblock;
+      /* Blocks get recycled in arbitrary order when the encoder
+       * runs threaded, so make sure the end markers differ. */
+      state_manager_raw_set_uniq(state->thisblock, state->blocksize, 0);
+      state_manager_raw_set_uniq(block, state->blocksize, 1);
+
       compressed        = state->head + sizeof(size_t);
 
-      compressed       += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
+      if (state->compress_backend)
+         compressed    += state_manager_patch_pack(state,
+               state->patchblock,
+               state_manager_raw_compress(state->thisblock,
+                  block, state->blocksize, state->patchblock),
+               compressed);
+      else
+         compressed    += state_manager_raw_compress(state->thisblock,
+               block, state->blocksize, compressed);
 
       if (compressed - state->data + state->maxcompsize > state->capacity)
       {
@@ -555,15 +1046,218 @@ recheckcapacity:;
       state->thisblock_valid = true;
 
    swap                      = state->thisblock;
-   state->thisblock          = state->nextblock;
-   state->nextblock          = swap;
+   state->thisblock          = block;
 
    state->entries++;
+
+   return swap;
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_thread(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   slock_lock(state->lock);
+
+   for (;;)
+   {
+      unsigned idx;
+      uint8_t *block;
+
+      while (    state->slot_read == state->slot_write
+              && !state->thread_quit)
+         scond_wait(state->cond, state->lock);
+
+      if (state->thread_quit)
+         break;
+
+      idx   = state->slot_read % STATE_MANAGER_THREAD_SLOTS;
+      block = state->slots[idx];
+      slock_unlock(state->lock);
+
+      /* Only this thread touches the ring buffer while
+       * the queue is non-empty. */
+      block = state_manager_push_encode(state, block);
+
+      slock_lock(state->lock);
+      state->slots[idx]      = block;
+      state->history_entries = state->entries;
+      state->history_used    = state_manager_used(state);
+      state->slot_read++;
+      scond_signal(state->cond);
+   }
+
+   slock_unlock(state->lock);
+}
+#endif
+
+static void state_manager_push_do(state_manager_t *state)
+{
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->slot_write++;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+      return;
+   }
+#endif
+
+#if STRICT_BUF_SIZE
+   memcpy(state->nextblock, state->debugblock, state->debugsize);
+#endif
+
+   state->nextblock = state_manager_push_encode(state, state->nextblock);
+}
+
+static state_manager_t *state_manager_new(
+      size_t state_size, size_t buffer_size, bool threaded,
+      bool compression)
+{
+   size_t max_comp_size, block_size;
+   uint8_t *next_block    = NULL;
+   uint8_t *this_block    = NULL;
+   uint8_t *state_data    = NULL;
+   state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
+   const struct state_manager_scanner *scanner = NULL;
+
+   if (!state)
+      return NULL;
+
+   if ((scanner = state_manager_scanner_select(
+               state_manager_cpu_features())))
+      RARCH_LOG("[Rewind] Using %s delta scanner.\n", scanner->ident);
+
+   block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
+   /* the compressed data is surrounded by pointers to the other side */
+   max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+   state_data         = (uint8_t*)malloc(buffer_size);
+
+   if (!state_data)
+      goto error;
+
+   this_block         = (uint8_t*)state_manager_raw_alloc(state_size, 0);
+   next_block         = (uint8_t*)state_manager_raw_alloc(state_size, 1);
+
+   if (!this_block || !next_block)
+      goto error;
+
+   state->blocksize   = block_size;
+   state->maxcompsize = max_comp_size;
+   state->data        = state_data;
+   state->thisblock   = this_block;
+   state->nextblock   = next_block;
+   state->capacity    = buffer_size;
+
+   state->head        = state->data + sizeof(size_t);
+   state->tail        = state->data + sizeof(size_t);
+
+   if (compression)
+   {
+      const struct trans_stream_backend *backend =
+         trans_stream_get_zstd_compress_backend();
+      if (!backend)
+         backend = trans_stream_get_zlib_deflate_backend();
+
+      if (backend)
+      {
+         state->compress_backend  = backend;
+         state->compress_stream   = state_manager_stream_new(backend);
+         state->decompress_stream = backend->reverse->stream_new();
+         state->patchblock        = (uint8_t*)malloc(
+               state_manager_raw_maxsize(state_size));
+
+         if (  !state->compress_stream
+             || !state->decompress_stream
+             || !state->patchblock)
+            goto error;
+
+         /* Room for the packed size, in case a patch is stored raw */
+         state->maxcompsize += sizeof(uint32_t);
+
+         RARCH_LOG("[Rewind] Compressing states with %s.\n",
+               backend->ident);
+      }
+   }
+
+#if STRICT_BUF_SIZE
+   state->debugsize   = state_size;
+   state->debugblock  = (uint8_t*)malloc(state_size);
+#elif defined(HAVE_THREADS)
+   if (threaded)
+   {
+      unsigned i;
+
+      /* nextblock becomes the first slot of the ring */
+      state->slots[0]    = state->nextblock;
+      state->nextblock   = NULL;
+
+      for (i = 1; i < STATE_MANAGER_THREAD_SLOTS; i++)
+      {
+         if (!(state->slots[i] = (uint8_t*)
+                  state_manager_raw_alloc(state_size, 1)))
+            goto error_thread;
+      }
+
+      if (!(state->lock = slock_new()))
+         goto error_thread;
+      if (!(state->cond = scond_new()))
+         goto error_thread;
+      if (!(state->thread = sthread_create(
+                  state_manager_thread, state)))
+         goto error_thread;
+   }
+#endif
+
+   return state;
+
+#if !STRICT_BUF_SIZE && defined(HAVE_THREADS)
+error_thread:
+   /* Fall back to encoding on the calling thread */
+   RARCH_WARN("[Rewind] Failed to start encoder thread.\n");
+   {
+      unsigned i;
+      for (i = 1; i < STATE_MANAGER_THREAD_SLOTS; i++)
+      {
+         if (state->slots[i])
+            free(state->slots[i]);
+         state->slots[i] = NULL;
+      }
+      if (state->lock)
+         slock_free(state->lock);
+      if (state->cond)
+         scond_free(state->cond);
+      state->lock      = NULL;
+      state->cond      = NULL;
+      state->nextblock = state->slots[0];
+      state->slots[0]  = NULL;
+   }
+   return state;
+#endif
+
+error:
+   /* Not yet owned by 'state' */
+   if (!state->data)
+   {
+      if (state_data)
+         free(state_data);
+      if (this_block)
+         free(this_block);
+      if (next_block)
+         free(next_block);
+   }
+   state_manager_free(state);
+   free(state);
+
+   return NULL;
 }
 
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, bool rewind_threaded,
+      bool rewind_compression)
 {
    core_info_t *core_info = NULL;
    void *state            = NULL;
@@ -618,7 +1312,7 @@ void state_manager_event_init(
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+         rewind_buffer_size, rewind_threaded, rewind_compression);
 
    if (!rewind_st->state)
       RARCH_WARN("[Rewind] %s.\n",
@@ -674,6 +1368,42 @@ void state_manager_event_deinit(
    }
 }
 
+bool state_manager_get_history(
+      struct state_manager_rewind_state *rewind_st,
+      unsigned *entries, size_t *used)
+{
+   state_manager_t *state = NULL;
+
+   if (!rewind_st || !(state = rewind_st->state))
+      return false;
+
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      bool busy;
+
+      /* While snapshots are queued the encoder thread owns
+       * the ring buffer. Don't wait for it, report the size
+       * it published after its last snapshot instead. */
+      slock_lock(state->lock);
+      if ((busy = (state->slot_read != state->slot_write)))
+      {
+         *entries = state->history_entries;
+         *used    = state->history_used;
+      }
+      slock_unlock(state->lock);
+
+      if (busy)
+         return true;
+   }
+#endif
+
+   *entries = state->entries;
+   *used    = state_manager_used(state);
+
+   return true;
+}
+
 /**
  * check_rewind:
  * @pressed              : was rewind key pressed or held?
@@ -24,8 +24,19 @@
 #include <boolean.h>
 #include <retro_common_api.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include <streams/trans_stream.h>
+
 #include "dynamic.h"
 
+/* Number of serialized snapshots that can be queued up
+ * for the rewind encoder thread before the main thread
+ * has to wait for it. */
+#define STATE_MANAGER_THREAD_SLOTS 4
+
 RETRO_BEGIN_DECLS
 
 enum state_manager_rewind_st_flags
@@ -60,6 +71,30 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+   /* Optional second stage applied to every patch; 'patchblock'
+    * holds the uncompressed patch while it is being (un)packed. */
+   const struct trans_stream_backend *compress_backend;
+   void *compress_stream;
+   void *decompress_stream;
+   uint8_t *patchblock;
+
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   /* Ring of preallocated snapshot buffers. The main thread
+    * serializes into slots[slot_write], the encoder thread
+    * delta-encodes slots[slot_read] against thisblock. */
+   uint8_t *slots[STATE_MANAGER_THREAD_SLOTS];
+   unsigned slot_read;
+   unsigned slot_write;
+   /* History size as of the last snapshot the encoder
+    * thread finished, for state_manager_get_history() */
+   size_t history_used;
+   unsigned history_entries;
+   bool thread_quit;
+#endif
+
    unsigned entries;
    bool thisblock_valid;
 };
@@ -81,7 +116,23 @@ void state_manager_event_deinit(
       struct retro_core_t *current_core);
 
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, bool rewind_threaded,
+      bool rewind_compression);
+
+/**
+ * state_manager_get_history:
+ * @rewind_st            : rewind state
+ * @entries              : number of states currently held
+ * @used                 : bytes of the rewind buffer in use
+ *
+ * Never waits for the encoder thread; while it is busy the
+ * figures are those of the last snapshot it finished.
+ *
+ * Returns false if the rewind buffer is not initialised.
+ **/
+bool state_manager_get_history(
+      struct state_manager_rewind_state *rewind_st,
+      unsigned *entries, size_t *used);
 
 /**
  * check_rewind:
@@ -1371,6 +1371,8 @@ void task_push_cloud_sync(void)
 
    task->state    = sync_state;
    task->title    = strdup(task_title);
+   /* Reads and replaces save files and states */
+   task->task_class = TASK_CLASS_SAVESTATE;
    task->handler  = task_cloud_sync_task_handler;
    task->callback = task_cloud_sync_cb;
 
@@ -27,6 +27,11 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -44,6 +49,44 @@
 #include "../verbosity.h"
 #include "task_database_cue.h"
 
+/* Size of the buffer files are read into while
+ * they are run through the CRC */
+#define DATABASE_CRC_CHUNK_SIZE 0x10000
+
+#ifdef HAVE_THREADS
+/* How many files each hashing thread may
+ * be ahead of the one being looked up */
+#define DATABASE_HASH_AHEAD_PER_THREAD 4
+
+struct database_hash_queue;
+
+typedef struct database_hash_job
+{
+   struct database_hash_queue *queue;
+   char *path;
+   size_t index;   /* Position in the scan list */
+   uint32_t crc;
+   bool ok;
+   bool done;
+} database_hash_job_t;
+
+/* Hashing stage of the scan. Files coming up in
+ * the scan list are CRC'd on a thread pool while
+ * the task thread looks the current one up in the
+ * databases. The jobs form a ring indexed by list
+ * position, which bounds how far ahead hashing
+ * can run. */
+typedef struct database_hash_queue
+{
+   tpool_t *pool;
+   slock_t *lock;
+   scond_t *cond;
+   database_hash_job_t *jobs;
+   size_t size;
+   size_t next;    /* Next list position to queue */
+} database_hash_queue_t;
+#endif
+
 typedef struct database_state_handle
 {
    database_info_list_t *info;
@@ -72,6 +115,9 @@ typedef struct db_handle
    char *fullpath;
    database_info_handle_t *handle;
    database_state_handle_t state;
+#ifdef HAVE_THREADS
+   database_hash_queue_t *hash_queue;
+#endif
    playlist_config_t playlist_config; /* size_t alignment */
    unsigned status;
    uint8_t flags;
@@ -384,63 +430,61 @@ static int task_database_chd_get_serial(const char *name, char *serial, size_t l
    return result;
 }
 
+/* Runs @len bytes of the file at @offset through the CRC,
+ * a chunk at a time. A range that does not cover the whole
+ * file must be readable in full. */
 static bool intfstream_file_get_crc(const char *name,
       uint64_t offset, int64_t len, uint32_t *crc)
 {
-   bool rv;
-   intfstream_t *fd  = intfstream_open_file(name,
+   bool ranged;
+   int64_t file_size;
+   int64_t data_read    = 0;
+   uint32_t accumulator = 0;
+   uint8_t *buf         = NULL;
+   intfstream_t *fd     = intfstream_open_file(name,
          RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   uint8_t *data     = NULL;
-   int64_t file_size = -1;
 
    if (!fd)
-      return 0;
+      return false;
 
    if (intfstream_seek(fd, 0, SEEK_END) == -1)
       goto error;
 
-   file_size = intfstream_tell(fd);
+   if ((file_size = intfstream_tell(fd)) < 0)
+      goto error;
 
-   if (intfstream_seek(fd, 0, SEEK_SET) == -1)
+   if (!(ranged = (offset != 0 || len < file_size)))
+      len = file_size;
+
+   if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
       goto error;
 
-   if (file_size < 0)
+   if (!(buf = (uint8_t*)malloc(DATABASE_CRC_CHUNK_SIZE)))
       goto error;
 
-   if (offset != 0 || len < file_size)
+   while (len > 0)
    {
-      if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
-         goto error;
-
-      data = (uint8_t*)malloc(len);
-
-      if (intfstream_read(fd, data, len) != (int64_t)len)
-         goto error;
-
-      intfstream_close(fd);
-      free(fd);
-      fd = intfstream_open_memory(data, RETRO_VFS_FILE_ACCESS_READ,
-            RETRO_VFS_FILE_ACCESS_HINT_NONE, len);
-
-      if (!fd)
-         goto error;
+      if ((data_read = intfstream_read(fd, buf,
+            MIN(len, DATABASE_CRC_CHUNK_SIZE))) <= 0)
+         break;
+      accumulator = encoding_crc32(accumulator, buf, (size_t)data_read);
+      len        -= data_read;
    }
 
-   rv = intfstream_get_crc(fd, crc);
+   if (data_read < 0 || (ranged && len > 0))
+      goto error;
+
+   *crc = accumulator;
    intfstream_close(fd);
    free(fd);
-   free(data);
-   return rv;
+   free(buf);
+   return true;
 
 error:
-   if (fd)
-   {
-      intfstream_close(fd);
-      free(fd);
-   }
-   if (data)
-      free(data);
-   return 0;
+   intfstream_close(fd);
+   free(fd);
+   free(buf);
+   return false;
 }
 
 static int task_database_cue_get_crc(const char *name, uint32_t *crc)
@@ -611,7 +655,198 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
+#ifdef HAVE_THREADS
+static void task_database_hash_worker(void *data)
+{
+   database_hash_job_t *job    = (database_hash_job_t*)data;
+   database_hash_queue_t *queue = job->queue;
+   uint32_t crc                 = 0;
+   bool ok                      = intfstream_file_get_crc(job->path,
+         0, INT64_MAX, &crc);
+
+   slock_lock(queue->lock);
+   job->crc  = crc;
+   job->ok   = ok;
+   job->done = true;
+   scond_broadcast(queue->cond);
+   slock_unlock(queue->lock);
+}
+
+/* Only files that task_database_iterate_playlist()
+ * would CRC in full are hashed ahead of time;
+ * disc images go through their own serial and
+ * track detection when their turn comes. */
+static bool task_database_hash_is_eligible(const char *path)
+{
+   if (string_is_empty(path) || path_contains_compressed_file(path))
+      return false;
+
+   switch (extension_to_file_type(path_get_extension(path)))
+   {
+      case FILE_TYPE_COMPRESSED:
+#ifdef HAVE_COMPRESSION
+         return true;
+#else
+         return false;
+#endif
+      case FILE_TYPE_CUE:
+      case FILE_TYPE_GDI:
+      case FILE_TYPE_WBFS:
+      case FILE_TYPE_RVZ:
+      case FILE_TYPE_WIA:
+      case FILE_TYPE_ISO:
+      case FILE_TYPE_CHD:
+      case FILE_TYPE_LUTRO:
+         return false;
+      default:
+         break;
+   }
+
+   return true;
+}
+
+static database_hash_queue_t *task_database_hash_queue_new(size_t list_size)
+{
+   unsigned threads             = cpu_features_get_core_amount();
+   database_hash_queue_t *queue = NULL;
+
+   /* The task thread keeps doing the lookups */
+   if (threads > 1)
+      threads--;
+
+   if (list_size < 2)
+      return NULL;
+
+   if (!(queue = (database_hash_queue_t*)calloc(1, sizeof(*queue))))
+      return NULL;
+
+   queue->size = MIN(threads * DATABASE_HASH_AHEAD_PER_THREAD, list_size);
+   queue->jobs = (database_hash_job_t*)calloc(queue->size,
+         sizeof(*queue->jobs));
+   queue->lock = slock_new();
+   queue->cond = scond_new();
+   queue->pool = tpool_create(threads);
+
+   if (!queue->jobs || !queue->lock || !queue->cond || !queue->pool)
+   {
+      tpool_destroy(queue->pool);
+      scond_free(queue->cond);
+      slock_free(queue->lock);
+      free(queue->jobs);
+      free(queue);
+      return NULL;
+   }
+
+   return queue;
+}
+
+static void task_database_hash_queue_free(database_hash_queue_t *queue)
+{
+   size_t i;
+
+   if (!queue)
+      return;
+
+   /* Drops the files still waiting to be
+    * hashed and waits for those in flight */
+   tpool_destroy(queue->pool);
+
+   for (i = 0; i < queue->size; i++)
+      free(queue->jobs[i].path);
+
+   scond_free(queue->cond);
+   slock_free(queue->lock);
+   free(queue->jobs);
+   free(queue);
+}
+
+/* Queues the files following the current one for
+ * hashing, until the ring is full or a slot is
+ * held by a file that is still being hashed. */
+static void task_database_hash_queue_fill(database_hash_queue_t *queue,
+      database_info_handle_t *db)
+{
+   while (   queue->next < db->list->size
+          && queue->next < db->list_ptr + queue->size)
+   {
+      bool busy;
+      database_hash_job_t *job = &queue->jobs[queue->next % queue->size];
+      const char *path         = db->list->elems[queue->next].data;
+
+      if (queue->next < db->list_ptr)
+      {
+         queue->next = db->list_ptr;
+         continue;
+      }
+
+      slock_lock(queue->lock);
+      busy = job->path && !job->done;
+      slock_unlock(queue->lock);
+
+      if (busy)
+         break;
+
+      free(job->path);
+      job->path = NULL;
+
+      if (task_database_hash_is_eligible(path))
+      {
+         job->queue = queue;
+         job->path  = strdup(path);
+         job->index = queue->next;
+         job->crc   = 0;
+         job->ok    = false;
+         job->done  = false;
+
+         if (job->path && !tpool_add_work(queue->pool,
+                  task_database_hash_worker, job))
+         {
+            free(job->path);
+            job->path = NULL;
+         }
+      }
+
+      queue->next++;
+   }
+}
+#endif
+
+/* CRC of the whole file being scanned, taken from
+ * the hashing stage when it got to it first. */
+static bool task_database_get_file_crc(db_handle_t *_db,
+      database_info_handle_t *db, const char *name, uint32_t *crc)
+{
+#ifdef HAVE_THREADS
+   database_hash_queue_t *queue = _db->hash_queue;
+
+   if (queue)
+   {
+      database_hash_job_t *job;
+
+      task_database_hash_queue_fill(queue, db);
+
+      job = &queue->jobs[db->list_ptr % queue->size];
+
+      if (     job->path
+            && job->index == db->list_ptr
+            && string_is_equal(job->path, name))
+      {
+         slock_lock(queue->lock);
+         while (!job->done)
+            scond_wait(queue->cond, queue->lock);
+         slock_unlock(queue->lock);
+
+         *crc = job->crc;
+         return job->ok;
+      }
+   }
+#endif
+
+   return intfstream_file_get_crc(name, 0, INT64_MAX, crc);
+}
+
 static int task_database_iterate_playlist(
+      db_handle_t *_db,
       database_state_handle_t *db_state,
       database_info_handle_t *db, const char *name)
 {
@@ -621,8 +856,8 @@ static int task_database_iterate_playlist(
 #ifdef HAVE_COMPRESSION
          db->type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, INT64_MAX, &db_state->archive_crc);
+         return task_database_get_file_crc(_db, db, name,
+               &db_state->archive_crc);
 #else
          break;
 #endif
@@ -673,7 +908,7 @@ static int task_database_iterate_playlist(
       default:
          db_state->serial[0] = '\0';
          db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, INT64_MAX, &db_state->crc);
+         return task_database_get_file_crc(_db, db, name, &db_state->crc);
    }
 
    return 1;
@@ -1184,7 +1419,7 @@ static int task_database_iterate(
    switch (db->type)
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
 #ifdef HAVE_COMPRESSION
          return task_database_iterate_crc_lookup(
@@ -1321,9 +1556,19 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+#ifdef HAVE_THREADS
+         if (!db->hash_queue)
+            db->hash_queue = task_database_hash_queue_new(dbinfo->list->size);
+#endif
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
+#ifdef HAVE_THREADS
+         /* Keep the hashing stage busy while this
+          * file is being looked up */
+         if (db->hash_queue)
+            task_database_hash_queue_fill(db->hash_queue, dbinfo);
+#endif
          name                 = database_info_get_current_element_name(dbinfo);
          task_database_cleanup_state(dbstate);
          dbstate->list_index  = 0;
@@ -1400,6 +1645,9 @@ task_finished:
 
    if (db)
    {
+#ifdef HAVE_THREADS
+      task_database_hash_queue_free(db->hash_queue);
+#endif
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
       if (!string_is_empty(db->content_database_path))
@@ -1445,6 +1693,7 @@ bool task_push_dbscan(
       goto error;
 
    t->handler                              = task_database_handler;
+   t->task_class                           = TASK_CLASS_BACKGROUND;
    t->state                                = db;
    t->callback                             = cb;
    t->title                                = strdup(msg_hash_to_str(
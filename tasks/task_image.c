@@ -18,9 +18,13 @@
 #include <string.h>
 
 #include <file/nbio.h>
+#include <file/file_path.h>
 #include <formats/image.h>
+#include <lists/dir_list.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <streams/trans_stream.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
 
@@ -28,6 +32,7 @@
 #include "tasks_internal.h"
 
 #include "../configuration.h"
+#include "../file_path_special.h"
 
 enum image_status_enum
 {
@@ -49,6 +54,8 @@ struct nbio_image_handle
 {
    void *handle;
    transfer_cb_t  cb;
+   char *cache_dir;         /* Image cache to look in, until checked */
+   char *cache_path;        /* Cache file to write the decoded image to */
    struct texture_image ti; /* ptr alignment */
    size_t size;
    int processing_final_state;
@@ -168,8 +175,15 @@ static void task_image_cleanup(nbio_handle_t *nbio)
    {
       image_transfer_free(image->handle, image->type);
 
-      image->handle  = NULL;
-      image->cb      = NULL;
+      if (image->cache_dir)
+         free(image->cache_dir);
+      if (image->cache_path)
+         free(image->cache_path);
+
+      image->handle     = NULL;
+      image->cb         = NULL;
+      image->cache_dir  = NULL;
+      image->cache_path = NULL;
    }
    if (!string_is_empty(nbio->path))
       free(nbio->path);
@@ -236,6 +250,218 @@ static int cb_nbio_image_thumbnail(void *data, size_t len)
    return 0;
 }
 
+/* Image cache
+ *
+ * Images loaded with a cache directory are written there once
+ * decoded, after colour conversion and upscaling, so that loading
+ * them again costs a file read and a zstd decompression instead of
+ * an image decode. Each image has its own file, named after a hash
+ * of the source path, size and modification time, the upscale
+ * threshold and the pixel format: a changed source, or a change of
+ * settings, simply maps to another file. */
+#define IMAGE_CACHE_MAGIC           0x43544c52 /* "RLTC" */
+#define IMAGE_CACHE_VERSION         1
+#define IMAGE_CACHE_MAX_DIMENSION   16384
+#define IMAGE_CACHE_FLAG_RGBA       (1 << 0)
+#define IMAGE_CACHE_FLAG_COMPRESSED (1 << 1)
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   uint32_t flags;
+   uint32_t size;   /* Size of the pixel data that follows */
+} image_cache_header_t;
+
+static uint64_t task_image_cache_hash(uint64_t h,
+      const void *data, size_t len)
+{
+   /* FNV-1a */
+   const uint8_t *p = (const uint8_t*)data;
+   while (len--)
+   {
+      h ^= *p++;
+      h *= 0x100000001b3ULL;
+   }
+   return h;
+}
+
+static bool task_image_cache_get_path(
+      struct nbio_image_handle *image, const char *path,
+      bool supports_rgba, char *s, size_t len)
+{
+   char name[32];
+   uint64_t h           = 0xcbf29ce484222325ULL;
+   int64_t size         = 0;
+   int64_t mtime        = 0;
+   uint32_t rgba        = supports_rgba ? 1 : 0;
+   int flags            = path_stat(path);
+
+   if (     !(flags & RETRO_VFS_STAT_IS_VALID)
+         ||  (flags & RETRO_VFS_STAT_IS_DIRECTORY)
+         || (size = path_get_size(path)) < 0)
+      return false;
+
+   mtime = path_get_mtime(path);
+
+   h     = task_image_cache_hash(h, path, strlen(path));
+   h     = task_image_cache_hash(h, &size, sizeof(size));
+   h     = task_image_cache_hash(h, &mtime, sizeof(mtime));
+   h     = task_image_cache_hash(h, &image->upscale_threshold,
+         sizeof(image->upscale_threshold));
+   h     = task_image_cache_hash(h, &rgba, sizeof(rgba));
+
+   snprintf(name, sizeof(name), "%08x%08x" FILE_PATH_THUMBNAIL_CACHE_EXTENSION,
+         (unsigned)(h >> 32), (unsigned)h);
+   fill_pathname_join_special(s, image->cache_dir, name, len);
+   return true;
+}
+
+static bool task_image_cache_read(struct nbio_image_handle *image,
+      const char *path, bool supports_rgba)
+{
+   image_cache_header_t header;
+   size_t pixels_size;
+   const uint8_t *data = NULL;
+   uint32_t *pixels    = NULL;
+   void *buf           = NULL;
+   int64_t len         = 0;
+
+   if (     !filestream_exists(path)
+         || !filestream_read_file(path, &buf, &len)
+         || !buf)
+      return false;
+
+   if (len < (int64_t)sizeof(header))
+      goto error;
+
+   memcpy(&header, buf, sizeof(header));
+   data = (const uint8_t*)buf + sizeof(header);
+
+   if (     header.magic   != IMAGE_CACHE_MAGIC
+         || header.version != IMAGE_CACHE_VERSION
+         || header.width   <  1
+         || header.height  <  1
+         || header.width   >  IMAGE_CACHE_MAX_DIMENSION
+         || header.height  >  IMAGE_CACHE_MAX_DIMENSION
+         || (header.flags & IMAGE_CACHE_FLAG_RGBA)
+               != (supports_rgba ? IMAGE_CACHE_FLAG_RGBA : 0)
+         || (int64_t)header.size != len - (int64_t)sizeof(header))
+      goto error;
+
+   pixels_size = (size_t)header.width * header.height * sizeof(uint32_t);
+
+   if (!(pixels = (uint32_t*)malloc(pixels_size)))
+      goto error;
+
+   if (header.flags & IMAGE_CACHE_FLAG_COMPRESSED)
+   {
+      uint32_t rd                 = 0;
+      uint32_t wn                 = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+      const struct trans_stream_backend *backend =
+         trans_stream_get_zstd_decompress_backend();
+      void *stream                = backend ? backend->stream_new() : NULL;
+      bool ok                     = false;
+
+      if (stream)
+      {
+         backend->set_in(stream, data, header.size);
+         backend->set_out(stream, (uint8_t*)pixels, (uint32_t)pixels_size);
+         ok = backend->trans(stream, true, &rd, &wn, &err)
+            && err == TRANS_STREAM_ERROR_NONE
+            && wn  == pixels_size;
+         backend->stream_free(stream);
+      }
+
+      if (!ok)
+         goto error;
+   }
+   else if (header.size == pixels_size)
+      memcpy(pixels, data, pixels_size);
+   else
+      goto error;
+
+   free(buf);
+
+   image->ti.pixels = pixels;
+   image->ti.width  = header.width;
+   image->ti.height = header.height;
+   return true;
+
+error:
+   free(pixels);
+   free(buf);
+   return false;
+}
+
+static void task_image_cache_write(struct nbio_image_handle *image,
+      const char *path, bool supports_rgba)
+{
+   image_cache_header_t header;
+   char dir[PATH_MAX_LENGTH];
+   size_t pixels_size = (size_t)image->ti.width * image->ti.height
+      * sizeof(uint32_t);
+   uint8_t *buf       = NULL;
+   uint8_t *data      = NULL;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zstd_compress_backend();
+
+   if (     !image->ti.pixels
+         || (image->ti.width  > IMAGE_CACHE_MAX_DIMENSION)
+         || (image->ti.height > IMAGE_CACHE_MAX_DIMENSION)
+         || !(buf = (uint8_t*)malloc(sizeof(header) + pixels_size)))
+      return;
+
+   data           = buf + sizeof(header);
+
+   header.magic   = IMAGE_CACHE_MAGIC;
+   header.version = IMAGE_CACHE_VERSION;
+   header.width   = image->ti.width;
+   header.height  = image->ti.height;
+   header.flags   = supports_rgba ? IMAGE_CACHE_FLAG_RGBA : 0;
+   header.size    = (uint32_t)pixels_size;
+
+   /* Pixel data that doesn't shrink is stored as-is */
+   if (backend)
+   {
+      uint32_t rd                 = 0;
+      uint32_t wn                 = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+      void *stream                = backend->stream_new();
+
+      if (stream)
+      {
+         backend->set_in(stream, (const uint8_t*)image->ti.pixels,
+               (uint32_t)pixels_size);
+         backend->set_out(stream, data, (uint32_t)pixels_size);
+         if (     backend->trans(stream, true, &rd, &wn, &err)
+               && err == TRANS_STREAM_ERROR_NONE
+               && wn  <  pixels_size)
+         {
+            header.flags |= IMAGE_CACHE_FLAG_COMPRESSED;
+            header.size   = wn;
+         }
+         backend->stream_free(stream);
+      }
+   }
+
+   if (!(header.flags & IMAGE_CACHE_FLAG_COMPRESSED))
+      memcpy(data, image->ti.pixels, pixels_size);
+   memcpy(buf, &header, sizeof(header));
+
+   fill_pathname_basedir(dir, path, sizeof(dir));
+   if (!path_is_directory(dir))
+      path_mkdir(dir);
+
+   /* A partly written file fails the size check
+    * when read back, and is simply replaced */
+   filestream_write_file(path, buf, sizeof(header) + header.size);
+   free(buf);
+}
+
 static bool upscale_image(
       unsigned scale_factor,
       struct texture_image *image_src,
@@ -376,6 +602,11 @@ bool task_image_load_handler(retro_task_t *task)
             }
          }
 
+         if (image->cache_path)
+            task_image_cache_write(image, image->cache_path,
+                  BIT32_GET(nbio->status_flags,
+                     NBIO_FLAG_IMAGE_SUPPORTS_RGBA));
+
          img->width         = image->ti.width;
          img->height        = image->ti.height;
          img->pixels        = image->ti.pixels;
@@ -390,7 +621,56 @@ bool task_image_load_handler(retro_task_t *task)
    return true;
 }
 
-bool task_push_image_load(const char *fullpath,
+/* Looks the image up in the image cache before falling
+ * back to loading and decoding it */
+static void task_image_load_cached_handler(retro_task_t *task)
+{
+   nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
+
+   if (image->cache_dir)
+   {
+      char cache_path[PATH_MAX_LENGTH];
+      bool supports_rgba = BIT32_GET(nbio->status_flags,
+            NBIO_FLAG_IMAGE_SUPPORTS_RGBA);
+
+      if (     !(task_get_flags(task) & RETRO_TASK_FLG_CANCELLED)
+            && task_image_cache_get_path(image, nbio->path, supports_rgba,
+                  cache_path, sizeof(cache_path)))
+      {
+         if (task_image_cache_read(image, cache_path, supports_rgba))
+         {
+            struct texture_image *img = (struct texture_image*)
+               malloc(sizeof(struct texture_image));
+
+            if (img)
+            {
+               img->width         = image->ti.width;
+               img->height        = image->ti.height;
+               img->pixels        = image->ti.pixels;
+               img->supports_rgba = image->ti.supports_rgba;
+            }
+            else
+               free(image->ti.pixels);
+            image->ti.pixels      = NULL;
+
+            task_set_data(task, img);
+            task_set_flags(task, RETRO_TASK_FLG_FINISHED, true);
+            return;
+         }
+
+         image->cache_path = strdup(cache_path);
+      }
+
+      free(image->cache_dir);
+      image->cache_dir = NULL;
+   }
+
+   task_file_load_handler(task);
+}
+
+static bool task_image_push_load(const char *fullpath,
+      const char *cache_dir,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *user_data)
 {
@@ -435,6 +715,11 @@ bool task_push_image_load(const char *fullpath,
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
    image->handle                     = NULL;
+   image->cb                         = NULL;
+   image->flags                      = 0;
+   image->cache_dir                  = string_is_empty(cache_dir)
+      ? NULL : strdup(cache_dir);
+   image->cache_path                 = NULL;
 
    image->ti.width                   = 0;
    image->ti.height                  = 0;
@@ -464,7 +749,10 @@ bool task_push_image_load(const char *fullpath,
    nbio->data          = (struct nbio_image_handle*)image;
 
    t->state           = nbio;
-   t->handler         = task_file_load_handler;
+   t->handler         = image->cache_dir
+      ? task_image_load_cached_handler
+      : task_file_load_handler;
+   t->task_class      = TASK_CLASS_THUMBNAIL;
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
@@ -473,3 +761,154 @@ bool task_push_image_load(const char *fullpath,
 
    return true;
 }
+
+bool task_push_image_load(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_image_push_load(fullpath, NULL, supports_rgba,
+         upscale_threshold, cb, user_data);
+}
+
+/* Same as task_push_image_load(), but keeps the decoded
+ * (and upscaled) image in 'cache_dir' so that loading
+ * it again skips the decode */
+bool task_push_image_load_cached(const char *fullpath,
+      const char *cache_dir,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_image_push_load(fullpath, cache_dir, supports_rgba,
+         upscale_threshold, cb, user_data);
+}
+
+/* Image cache size cap
+ *
+ * Once the files in a cache directory add up to more than the
+ * cap, the oldest ones are deleted until they are back under
+ * three quarters of it, so that the next few images written
+ * don't trigger another trim right away. The VFS has no access
+ * times, so the images that were cached first are dropped first. */
+typedef struct
+{
+   const char *path;
+   int64_t mtime;
+   int32_t size;
+} image_cache_file_t;
+
+typedef struct
+{
+   char *cache_dir;
+   uint64_t max_size;
+} image_cache_trim_t;
+
+static int task_image_cache_file_cmp(const void *a, const void *b)
+{
+   const image_cache_file_t *file_a = (const image_cache_file_t*)a;
+   const image_cache_file_t *file_b = (const image_cache_file_t*)b;
+
+   if (file_a->mtime < file_b->mtime)
+      return -1;
+   return file_a->mtime > file_b->mtime;
+}
+
+static void task_image_cache_trim_handler(retro_task_t *task)
+{
+   image_cache_trim_t *trim  = (image_cache_trim_t*)task->state;
+   image_cache_file_t *files = NULL;
+   uint64_t total            = 0;
+   size_t i;
+   struct string_list *list  = dir_list_new(trim->cache_dir,
+         FILE_PATH_THUMBNAIL_CACHE_EXTENSION_NO_DOT,
+         false, false, false, false);
+
+   if (     !list
+         || !list->size
+         || !(files = (image_cache_file_t*)
+               malloc(list->size * sizeof(*files))))
+      goto end;
+
+   for (i = 0; i < list->size; i++)
+   {
+      files[i].path  = list->elems[i].data;
+      files[i].mtime = path_get_mtime(files[i].path);
+      files[i].size  = path_get_size(files[i].path);
+      if (files[i].size < 0)
+         files[i].size = 0;
+      total         += (uint64_t)files[i].size;
+   }
+
+   if (total > trim->max_size)
+   {
+      uint64_t target = trim->max_size / 4 * 3;
+
+      qsort(files, list->size, sizeof(*files), task_image_cache_file_cmp);
+
+      for (i = 0; i < list->size && total > target; i++)
+         if (filestream_delete(files[i].path) == 0)
+            total -= (uint64_t)files[i].size;
+   }
+
+end:
+   free(files);
+   if (list)
+      string_list_free(list);
+   task_set_flags(task, RETRO_TASK_FLG_FINISHED, true);
+}
+
+static void task_image_cache_trim_free(retro_task_t *task)
+{
+   image_cache_trim_t *trim = (image_cache_trim_t*)task->state;
+
+   if (trim)
+   {
+      free(trim->cache_dir);
+      free(trim);
+   }
+}
+
+static bool task_image_cache_trim_finder(retro_task_t *task, void *user_data)
+{
+   return (task && task->handler == task_image_cache_trim_handler);
+}
+
+/* Deletes the oldest images in 'cache_dir' while it holds
+ * more than 'max_size' bytes of them */
+bool task_push_image_cache_trim(const char *cache_dir, uint64_t max_size)
+{
+   task_finder_data_t find_data;
+   retro_task_t *task       = NULL;
+   image_cache_trim_t *trim = NULL;
+
+   if (string_is_empty(cache_dir) || !path_is_directory(cache_dir))
+      return false;
+
+   /* One pass over the directory at a time is enough */
+   find_data.func     = task_image_cache_trim_finder;
+   find_data.userdata = NULL;
+
+   if (task_queue_find(&find_data))
+      return false;
+
+   if (!(task = task_init()))
+      return false;
+
+   if (!(trim = (image_cache_trim_t*)malloc(sizeof(*trim))))
+   {
+      free(task);
+      return false;
+   }
+
+   trim->cache_dir  = strdup(cache_dir);
+   trim->max_size   = max_size;
+
+   task->state      = trim;
+   task->handler    = task_image_cache_trim_handler;
+   task->task_class = TASK_CLASS_BACKGROUND;
+   task->cleanup    = task_image_cache_trim_free;
+   task->flags     |= RETRO_TASK_FLG_MUTE;
+
+   task_queue_push(task);
+
+   return true;
+}
@@ -608,6 +608,7 @@ bool task_push_manual_content_scan(
 
    /* > Configure task */
    task->handler                 = task_manual_content_scan_handler;
+   task->task_class              = TASK_CLASS_BACKGROUND;
    task->state                   = manual_scan;
    task->title                   = strdup(task_title);
    task->progress                = 0;
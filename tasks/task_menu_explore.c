@@ -197,6 +197,8 @@ bool task_push_menu_explore_init(const char *directory_playlist,
    /* Configure task
     * > Note: This is silent task, with no title
     *   and no user notification messages */
+   /* Reads the playlists and databases that scans rewrite */
+   task->task_class = TASK_CLASS_BACKGROUND;
    task->handler  = task_menu_explore_init_handler;
    task->state    = menu_explore;
    task->title    = NULL;
@@ -25,6 +25,7 @@
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
+#include <array/rbuf.h>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -49,6 +50,9 @@
 #if DEBUG
 #include "input/bsv/uint32s_index.h"
 #endif
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
 
 #define REPLAY_DEFAULT_COMMIT_INTERVAL 4
 #define REPLAY_DEFAULT_COMMIT_THRESHOLD 2
@@ -75,9 +79,11 @@ static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
    uint32_t header[REPLAY_HEADER_LEN] = {0};
    uint64_t header_size = REPLAY_HEADER_LEN_BYTES;
    uint32_t vsn                = 0;
+   /* Seeking jumps around the file a lot; have it memory mapped
+    * where the platform allows */
    intfstream_t *file          = intfstream_open_file(path,
          RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS);
 
    if (!file)
    {
@@ -109,6 +115,9 @@ static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
    handle->identifier = swap_if_big64(*identifier_loc);
 
    handle->min_file_pos = header_size + state_size;
+   if (bsv_movie_read_index(handle))
+      RARCH_LOG("[Replay] Checkpoint index found: %u checkpoints.\n",
+            (unsigned)RBUF_LEN(handle->checkpoints));
    return bsv_movie_reset_playback(handle);
 }
 
@@ -201,11 +210,18 @@ void bsv_movie_free(bsv_movie_t *handle)
    free(handle->file);
 
    free(handle->frame_pos);
+   RBUF_FREE(handle->checkpoints);
 
 #ifdef HAVE_STATESTREAM
    uint32s_index_free(handle->superblocks);
    uint32s_index_free(handle->blocks);
    free(handle->superblock_seq);
+   free(handle->block_hashes);
+   free(handle->block_same);
+#ifdef HAVE_THREADS
+   if (handle->hash_pool)
+      tpool_destroy(handle->hash_pool);
+#endif
 #endif
    if (handle->last_save)
       free(handle->last_save);
@@ -415,6 +431,7 @@ bool movie_stop_record(input_driver_state_t *input_st)
    uint32s_index_print_count_data(movie->blocks);
 #endif
 #endif
+   bsv_movie_write_index(movie);
    frame_count = swap_if_big32(movie->frame_counter);
    intfstream_seek(movie->file, REPLAY_HEADER_FRAME_COUNT_INDEX*sizeof(uint32_t), SEEK_SET);
    intfstream_write(movie->file, &frame_count, sizeof(uint32_t));
@@ -853,6 +853,8 @@ bool task_push_netplay_crc_scan(uint32_t crc, const char *content,
    scan_state.state   = STATE_NONE;
    scan_state.running = true;
 
+   /* Reads the playlists that scans rewrite */
+   task->task_class = TASK_CLASS_BACKGROUND;
    task->handler   = task_netplay_crc_scan_handler;
    task->callback  = task_netplay_crc_scan_callback;
    task->cleanup   = task_netplay_crc_scan_cleanup;
@@ -942,6 +944,8 @@ bool task_push_netplay_content_reload(const char *hostname)
 
    scan_state.running = true;
 
+   /* Reads the playlists that scans rewrite */
+   task->task_class = TASK_CLASS_BACKGROUND;
    task->handler   = task_netplay_crc_scan_handler;
    task->callback  = task_netplay_crc_scan_callback;
    task->cleanup   = task_netplay_crc_scan_cleanup;
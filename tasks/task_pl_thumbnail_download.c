@@ -613,6 +613,7 @@ bool task_push_pl_thumbnail_download(
 
    /* Configure task */
    task->handler                 = task_pl_thumbnail_download_handler;
+   task->task_class              = TASK_CLASS_BACKGROUND;
    task->state                   = pl_thumb;
    task->title                   = strdup(system);
    task->progress                = 0;
@@ -962,6 +963,7 @@ bool task_push_pl_entry_thumbnail_download(
 
    /* Configure task */
    task->handler                 = task_pl_entry_thumbnail_download_handler;
+   task->task_class              = TASK_CLASS_THUMBNAIL;
    task->state                   = pl_thumb;
    task->title                   = strdup(system);
    task->progress                = 0;
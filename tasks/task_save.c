@@ -633,6 +633,7 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t len)
          state->flags      |= SAVE_TASK_FLAG_MUTE;
 
       task->type            = TASK_TYPE_BLOCKING;
+      task->task_class      = TASK_CLASS_SAVESTATE;
       task->state           = state;
       task->handler         = task_save_handler;
       task->callback        = undo_save_state_cb;
@@ -1186,6 +1187,7 @@ static void task_push_save_state(const char *path, void *data, size_t len, bool
       state->flags              |= SAVE_TASK_FLAG_MUTE;
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->task_class              = TASK_CLASS_SAVESTATE;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = save_state_cb;
@@ -1297,6 +1299,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    task->state                   = state;
    task->type                    = TASK_TYPE_BLOCKING;
+   task->task_class              = TASK_CLASS_SAVESTATE;
    task->handler                 = task_load_handler;
    task->callback                = content_load_and_save_state_cb;
    task->title                   = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1582,6 +1585,7 @@ bool content_load_state(const char *path,
       state->flags             |= SAVE_TASK_FLAG_MUTE;
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->task_class             = TASK_CLASS_SAVESTATE;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
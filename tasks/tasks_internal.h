@@ -178,6 +178,13 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+bool task_push_image_load_cached(const char *fullpath,
+      const char *cache_dir,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *userdata);
+
+bool task_push_image_cache_trim(const char *cache_dir, uint64_t max_size);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,